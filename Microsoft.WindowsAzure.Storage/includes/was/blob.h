@@ -36,6 +36,7 @@ namespace azure { namespace storage {
 
     class cloud_file;
     class file_access_condition;
+    class file_request_options;
 
     namespace protocol
     {
@@ -1002,10 +1003,13 @@ namespace azure { namespace storage {
     };
 
     class list_blob_item;
+    class list_blob_record;
 
     typedef result_segment<list_blob_item> list_blob_item_segment;
     typedef result_iterator<list_blob_item> list_blob_item_iterator;
 
+    typedef result_segment<list_blob_record> list_blob_record_segment;
+
     typedef result_segment<cloud_blob_container> container_result_segment;
     typedef result_iterator<cloud_blob_container> container_result_iterator;
 
@@ -1413,6 +1417,8 @@ namespace azure { namespace storage {
         friend class cloud_append_blob;
         friend class protocol::blob_response_parsers;
         friend class protocol::list_blobs_reader;
+        friend class list_blob_record;
+        friend class cloud_blob_container;
     };
 
     /// <summary>
@@ -2346,6 +2352,243 @@ namespace azure { namespace storage {
         utility::string_t key;
     };
 
+    /// <summary>
+    /// Specifies the type of a request in a blob batch.
+    /// </summary>
+    enum class blob_batch_request_type
+    {
+        /// <summary>
+        /// Deletes a blob.
+        /// </summary>
+        delete_blob,
+
+        /// <summary>
+        /// Sets the tier of a block blob in a standard storage account.
+        /// </summary>
+        set_standard_blob_tier
+    };
+
+    /// <summary>
+    /// Represents a request in a blob batch.
+    /// </summary>
+    class blob_batch_request
+    {
+    public:
+
+        /// <summary>
+        /// Gets the type of the request.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::blob_batch_request_type" /> object.</returns>
+        blob_batch_request_type request_type() const
+        {
+            return m_request_type;
+        }
+
+        /// <summary>
+        /// Gets the primary URI of the blob the request applies to, not including the snapshot time.
+        /// </summary>
+        /// <returns>A <see cref="web::http::uri" /> object.</returns>
+        const web::http::uri& blob_uri() const
+        {
+            return m_blob_uri;
+        }
+
+        /// <summary>
+        /// Gets the time of the snapshot the request applies to, or an empty string if it applies to the base blob.
+        /// </summary>
+        /// <returns>A string containing the snapshot time.</returns>
+        const utility::string_t& snapshot_time() const
+        {
+            return m_snapshot_time;
+        }
+
+        /// <summary>
+        /// Gets whether a delete request also deletes the snapshots of the blob.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::delete_snapshots_option" /> object.</returns>
+        delete_snapshots_option snapshots_option() const
+        {
+            return m_snapshots_option;
+        }
+
+        /// <summary>
+        /// Gets the tier that a set tier request sets.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::standard_blob_tier" /> object.</returns>
+        standard_blob_tier tier() const
+        {
+            return m_tier;
+        }
+
+        /// <summary>
+        /// Gets the access condition for the request.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::access_condition" /> object.</returns>
+        const access_condition& condition() const
+        {
+            return m_condition;
+        }
+
+    private:
+
+        blob_batch_request(blob_batch_request_type request_type, web::http::uri blob_uri, utility::string_t snapshot_time, delete_snapshots_option snapshots_option, standard_blob_tier tier, access_condition condition)
+            : m_request_type(request_type), m_blob_uri(std::move(blob_uri)), m_snapshot_time(std::move(snapshot_time)), m_snapshots_option(snapshots_option), m_tier(tier), m_condition(std::move(condition))
+        {
+        }
+
+        blob_batch_request_type m_request_type;
+        web::http::uri m_blob_uri;
+        utility::string_t m_snapshot_time;
+        delete_snapshots_option m_snapshots_option;
+        standard_blob_tier m_tier;
+        access_condition m_condition;
+
+        friend class blob_batch_operation;
+    };
+
+    /// <summary>
+    /// Represents a set of delete and set tier requests on blobs in one storage account, which are sent to the service in blob batches.
+    /// </summary>
+    class blob_batch_operation
+    {
+    public:
+
+        typedef std::vector<azure::storage::blob_batch_request> requests_type;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::blob_batch_operation" /> class.
+        /// </summary>
+        blob_batch_operation()
+        {
+        }
+
+        /// <summary>
+        /// Adds a request to delete the specified blob.
+        /// </summary>
+        /// <param name="blob">The blob to delete, or the snapshot to delete if the reference is to a snapshot.</param>
+        void delete_blob(const cloud_blob& blob)
+        {
+            delete_blob(blob, delete_snapshots_option::none, access_condition());
+        }
+
+        /// <summary>
+        /// Adds a request to delete the specified blob.
+        /// </summary>
+        /// <param name="blob">The blob to delete, or the snapshot to delete if the reference is to a snapshot.</param>
+        /// <param name="snapshots_option">Indicates whether to delete only the blob, to delete the blob and all snapshots, or to delete only snapshots.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the request.</param>
+        WASTORAGE_API void delete_blob(const cloud_blob& blob, delete_snapshots_option snapshots_option, const access_condition& condition);
+
+        /// <summary>
+        /// Adds a request to set the tier of the specified block blob in a standard storage account.
+        /// </summary>
+        /// <param name="blob">The block blob.</param>
+        /// <param name="tier">An enum that represents the blob tier to be set.</param>
+        void set_standard_blob_tier(const cloud_blob& blob, standard_blob_tier tier)
+        {
+            set_standard_blob_tier(blob, tier, access_condition());
+        }
+
+        /// <summary>
+        /// Adds a request to set the tier of the specified block blob in a standard storage account.
+        /// </summary>
+        /// <param name="blob">The block blob.</param>
+        /// <param name="tier">An enum that represents the blob tier to be set.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the request.</param>
+        WASTORAGE_API void set_standard_blob_tier(const cloud_blob& blob, standard_blob_tier tier, const access_condition& condition);
+
+        /// <summary>
+        /// Gets a reference to an <see cref="azure::storage::blob_batch_operation::requests_type" /> object containing an enumerable collection
+        /// of the requests in the batch operation.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::blob_batch_operation::requests_type" /> object.</returns>
+        requests_type& requests()
+        {
+            return m_requests;
+        }
+
+        /// <summary>
+        /// Gets a reference to an <see cref="azure::storage::blob_batch_operation::requests_type" /> object containing an enumerable collection
+        /// of the requests in the batch operation.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::blob_batch_operation::requests_type" /> object.</returns>
+        const requests_type& requests() const
+        {
+            return m_requests;
+        }
+
+        /// <summary>
+        /// Gets the number of requests in the batch operation.
+        /// </summary>
+        /// <returns>The number of requests in the batch operation.</returns>
+        size_t size() const
+        {
+            return m_requests.size();
+        }
+
+    private:
+
+        requests_type m_requests;
+    };
+
+    /// <summary>
+    /// Represents the result of a request in a blob batch.
+    /// </summary>
+    class blob_batch_result
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::blob_batch_result" /> class.
+        /// </summary>
+        blob_batch_result()
+            : m_http_status_code(0)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::blob_batch_result" /> class.
+        /// </summary>
+        /// <param name="http_status_code">The HTTP status code of the request.</param>
+        /// <param name="extended_error">The extended error information returned for a request that failed.</param>
+        blob_batch_result(int http_status_code, storage_extended_error extended_error)
+            : m_http_status_code(http_status_code), m_extended_error(std::move(extended_error))
+        {
+        }
+
+        /// <summary>
+        /// Gets the HTTP status code of the request.
+        /// </summary>
+        /// <returns>The HTTP status code of the request.</returns>
+        int http_status_code() const
+        {
+            return m_http_status_code;
+        }
+
+        /// <summary>
+        /// Gets whether the request succeeded.
+        /// </summary>
+        /// <returns><c>true</c> if the request succeeded; otherwise, <c>false</c>.</returns>
+        bool succeeded() const
+        {
+            return m_http_status_code >= 200 && m_http_status_code < 300;
+        }
+
+        /// <summary>
+        /// Gets the extended error information returned for a request that failed.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::storage_extended_error" /> object.</returns>
+        const storage_extended_error& extended_error() const
+        {
+            return m_extended_error;
+        }
+
+    private:
+
+        int m_http_status_code;
+        storage_extended_error m_extended_error;
+    };
+
     /// <summary>
     /// Provides a client-side logical representation of the Windows Azure Blob Service. This client is used to configure and execute requests against the Blob Service.
     /// </summary>
@@ -2849,6 +3092,78 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::service_stats" /> that represents the current operation.</returns>
         WASTORAGE_API pplx::task<account_properties> download_account_properties_async(const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
 
+        /// <summary>
+        /// Executes a blob batch, which sends up to 256 requests to the service in a single multipart request.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::blob_batch_operation" /> object that represents the requests to execute.</param>
+        /// <returns>An enumerable collection of <see cref="azure::storage::blob_batch_result" /> objects, one for each request in the order of the requests.</returns>
+        /// <remarks>A request that fails does not stop the others, and its failure is reported in its result.</remarks>
+        std::vector<blob_batch_result> execute_batch(const blob_batch_operation& operation) const
+        {
+            return execute_batch_async(operation).get();
+        }
+
+        /// <summary>
+        /// Executes a blob batch, which sends up to 256 requests to the service in a single multipart request.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::blob_batch_operation" /> object that represents the requests to execute.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>An enumerable collection of <see cref="azure::storage::blob_batch_result" /> objects, one for each request in the order of the requests.</returns>
+        /// <remarks>A request that fails does not stop the others, and its failure is reported in its result.</remarks>
+        std::vector<blob_batch_result> execute_batch(const blob_batch_operation& operation, const blob_request_options& options, operation_context context) const
+        {
+            return execute_batch_async(operation, options, context).get();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to execute a blob batch, which sends up to 256 requests to the service in a single multipart request.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::blob_batch_operation" /> object that represents the requests to execute.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type enumerable collection of <see cref="azure::storage::blob_batch_result" /> that represents the current operation.</returns>
+        pplx::task<std::vector<blob_batch_result>> execute_batch_async(const blob_batch_operation& operation) const
+        {
+            return execute_batch_async(operation, blob_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to execute a blob batch, which sends up to 256 requests to the service in a single multipart request.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::blob_batch_operation" /> object that represents the requests to execute.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type enumerable collection of <see cref="azure::storage::blob_batch_result" /> that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<std::vector<blob_batch_result>> execute_batch_async(const blob_batch_operation& operation, const blob_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Executes any number of requests in blob batches of up to 256 requests each.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::blob_batch_operation" /> object that represents the requests to execute.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>An enumerable collection of <see cref="azure::storage::blob_batch_result" /> objects, one for each request in the order of the requests.</returns>
+        /// <remarks>
+        /// Up to <see cref="azure::storage::blob_request_options::parallelism_factor" /> batches are in flight at a time. A request that fails does not stop the
+        /// others and is reported in its result, while a batch that fails as a whole fails the operation once the batches in flight have completed.
+        /// </remarks>
+        std::vector<blob_batch_result> execute_bulk_batch(const blob_batch_operation& operation, const blob_request_options& options, operation_context context) const
+        {
+            return execute_bulk_batch_async(operation, options, context).get();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to execute any number of requests in blob batches of up to 256 requests each.
+        /// </summary>
+        /// <param name="operation">An <see cref="azure::storage::blob_batch_operation" /> object that represents the requests to execute.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type enumerable collection of <see cref="azure::storage::blob_batch_result" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// Up to <see cref="azure::storage::blob_request_options::parallelism_factor" /> batches are in flight at a time. A request that fails does not stop the
+        /// others and is reported in its result, while a batch that fails as a whole fails the operation once the batches in flight have completed.
+        /// </remarks>
+        WASTORAGE_API pplx::task<std::vector<blob_batch_result>> execute_bulk_batch_async(const blob_batch_operation& operation, const blob_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Returns a reference to an <see cref="azure::storage::cloud_blob_container" /> object.
         /// </summary>
@@ -3768,6 +4083,24 @@ namespace azure { namespace storage {
         /// <returns>An <see cref="azure::storage::list_blob_item_iterator" /> that can be used to to lazily enumerate a collection of blob items in the the container.</returns>
         WASTORAGE_API list_blob_item_iterator list_blobs(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const blob_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Initiates an asynchronous operation to enumerate the blob items in the container, passing each item to a callback.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned.
+        /// If this value is zero, the maximum possible number of results will be returned.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::list_blob_item" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Segments are requested through the asynchronous segmented listing. Up to <see cref="azure::storage::request_options::listing_prefetch_depth" />
+        /// segments are requested ahead of the one being delivered, and the callback is never invoked concurrently.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_blobs_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const std::function<void(const list_blob_item&)>& item_callback, const blob_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Returns a result segment containing a collection of blob items in the container.
         /// </summary>
@@ -3814,45 +4147,200 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
         pplx::task<list_blob_item_segment> list_blobs_segmented_async(const continuation_token& token) const
         {
-            return list_blobs_segmented_async(utility::string_t(), token);
+            return list_blobs_segmented_async(utility::string_t(), token);
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to return an <see cref="azure::storage::list_blob_item_segment" /> containing a collection of blob items
+        /// in the container.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="token">A continuation token returned by a previous listing operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
+        pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, const continuation_token& token) const
+        {
+            return list_blobs_segmented_async(prefix, false, blob_listing_details::none, 0, token, blob_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to return an <see cref="azure::storage::list_blob_item_segment" /> containing a collection of blob items
+        /// in the container.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">A continuation token returned by a previous listing operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
+        pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, max_results, token, options, context, pplx::cancellation_token::none());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to return an <see cref="azure::storage::list_blob_item_segment" /> containing a collection of blob items
+        /// in the container.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">A continuation token returned by a previous listing operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
+
+        /// <summary>
+        /// Lists one segment of blob items in the container, passing each item to a callback as soon as it has been parsed instead of collecting the segment.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">A continuation token returned by a previous listing operation.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::list_blob_item" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A continuation token for the next segment, which is empty once the listing is complete.</returns>
+        continuation_token list_blobs_segmented(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, max_results, token, item_callback, options, context).get();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to list one segment of blob items in the container, passing each item to a callback as soon as it has been parsed
+        /// instead of collecting the segment.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">A continuation token returned by a previous listing operation.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::list_blob_item" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::continuation_token" /> that represents the current operation.</returns>
+        pplx::task<continuation_token> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, max_results, token, item_callback, options, context, pplx::cancellation_token::none());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to list one segment of blob items in the container, passing each item to a callback as soon as it has been parsed
+        /// instead of collecting the segment.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
+        /// <param name="token">A continuation token returned by a previous listing operation.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::list_blob_item" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::continuation_token" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// The response body is read in full before it is parsed, but no XML document or per-segment collection is built: items are created
+        /// and passed to the callback one at a time. If the request is retried, the listing resumes after the name of the last item delivered,
+        /// so no item is delivered twice. An exception thrown by the callback ends the operation without a retry and is rethrown as is.
+        /// </remarks>
+        WASTORAGE_API pplx::task<continuation_token> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
+
+        /// <summary>
+        /// Lists all blobs in the container whose names begin with the specified prefix, listing each virtual directory as a separate shard so that
+        /// several listing requests proceed in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="lexical_order"><c>true</c> to deliver blobs in the same order as a flat listing; <c>false</c> to deliver them as soon as each shard returns them.</param>
+        /// <param name="item_callback">A function invoked with each blob <see cref="azure::storage::list_blob_item" />. It is never invoked concurrently.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void list_blobs_parallel(const utility::string_t& prefix, blob_listing_details::values includes, bool lexical_order, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context) const
+        {
+            list_blobs_parallel_async(prefix, includes, lexical_order, item_callback, options, context).wait();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to list all blobs in the container whose names begin with the specified prefix, listing each virtual directory
+        /// as a separate shard so that several listing requests proceed in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="lexical_order"><c>true</c> to deliver blobs in the same order as a flat listing; <c>false</c> to deliver them as soon as each shard returns them.</param>
+        /// <param name="item_callback">A function invoked with each blob <see cref="azure::storage::list_blob_item" />. It is never invoked concurrently.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> list_blobs_parallel_async(const utility::string_t& prefix, blob_listing_details::values includes, bool lexical_order, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context) const
+        {
+            return list_blobs_parallel_async(prefix, includes, lexical_order, item_callback, options, context, pplx::cancellation_token::none());
         }
 
         /// <summary>
-        /// Initiates an asynchronous operation to return an <see cref="azure::storage::list_blob_item_segment" /> containing a collection of blob items
-        /// in the container.
+        /// Initiates an asynchronous operation to list all blobs in the container whose names begin with the specified prefix, listing each virtual directory
+        /// as a separate shard so that several listing requests proceed in parallel.
+        /// </summary>
+        /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="lexical_order"><c>true</c> to deliver blobs in the same order as a flat listing; <c>false</c> to deliver them as soon as each shard returns them.</param>
+        /// <param name="item_callback">A function invoked with each blob <see cref="azure::storage::list_blob_item" />. It is never invoked concurrently.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Virtual directories are discovered breadth-first using the service client's directory delimiter, and the number of listing requests in flight is
+        /// bounded by <see cref="azure::storage::blob_request_options::parallelism_factor" />. Snapshots cannot be included. When <paramref name="lexical_order" />
+        /// is <c>true</c>, blobs that arrive ahead of an unfinished directory are buffered until it completes.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_blobs_parallel_async(const utility::string_t& prefix, blob_listing_details::values includes, bool lexical_order, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
+
+        /// <summary>
+        /// Returns a result segment of compact records describing the blobs in the container, using a flat listing.
         /// </summary>
         /// <param name="prefix">The blob name prefix.</param>
+        /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
+        /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
         /// <param name="token">A continuation token returned by a previous listing operation.</param>
-        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
-        pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, const continuation_token& token) const
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A result segment containing <see cref="azure::storage::list_blob_record" /> objects.</returns>
+        list_blob_record_segment list_blob_records_segmented(const utility::string_t& prefix, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context) const
         {
-            return list_blobs_segmented_async(prefix, false, blob_listing_details::none, 0, token, blob_request_options(), operation_context());
+            return list_blob_records_segmented_async(prefix, includes, max_results, token, options, context).get();
         }
 
         /// <summary>
-        /// Initiates an asynchronous operation to return an <see cref="azure::storage::list_blob_item_segment" /> containing a collection of blob items
-        /// in the container.
+        /// Initiates an asynchronous operation to return a result segment of compact records describing the blobs in the container, using a flat listing.
         /// </summary>
         /// <param name="prefix">The blob name prefix.</param>
-        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
         /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
         /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
         /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
         /// <param name="token">A continuation token returned by a previous listing operation.</param>
         /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
         /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
-        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
-        pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context) const
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_record_segment" /> that represents the current operation.</returns>
+        pplx::task<list_blob_record_segment> list_blob_records_segmented_async(const utility::string_t& prefix, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context) const
         {
-            return list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, max_results, token, options, context, pplx::cancellation_token::none());
+            return list_blob_records_segmented_async(prefix, includes, max_results, token, options, context, pplx::cancellation_token::none());
         }
 
         /// <summary>
-        /// Initiates an asynchronous operation to return an <see cref="azure::storage::list_blob_item_segment" /> containing a collection of blob items
-        /// in the container.
+        /// Initiates an asynchronous operation to return a result segment of compact records describing the blobs in the container, using a flat listing.
         /// </summary>
         /// <param name="prefix">The blob name prefix.</param>
-        /// <param name="use_flat_blob_listing">Indicates whether to list blobs in a flat listing, or whether to list blobs hierarchically, by virtual directory.</param>
         /// <param name="includes">An <see cref="azure::storage::blob_listing_details::values" /> enumeration describing which items to include in the listing.</param>
         /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned at a time, up to the 
         /// per-operation limit of 5000. If this value is 0, the maximum possible number of results will be returned, up to 5000.</param>
@@ -3860,8 +4348,13 @@ namespace azure { namespace storage {
         /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
         /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
         /// <param name="cancellation_token">An <see cref="pplx::cancellation_token" /> object that is used to cancel the current operation.</param>
-        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_item_segment" /> that represents the current operation.</returns>
-        WASTORAGE_API pplx::task<list_blob_item_segment> list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::list_blob_record_segment" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// Records carry only the name, snapshot timestamp, size, ETag, last-modified time, standard tier and content-MD5 of each blob, plus its
+        /// metadata when <see cref="azure::storage::blob_listing_details::metadata" /> is included. Use <see cref="azure::storage::list_blob_record::as_blob" />
+        /// to obtain a full <see cref="azure::storage::cloud_blob" /> for the records that need one.
+        /// </remarks>
+        WASTORAGE_API pplx::task<list_blob_record_segment> list_blob_records_segmented_async(const utility::string_t& prefix, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const;
 
         /// <summary>
         /// Sets permissions for the container.
@@ -6222,6 +6715,7 @@ namespace azure { namespace storage {
         friend class cloud_blob_container;
         friend class cloud_blob_directory;
         friend class list_blob_item;
+        friend class list_blob_record;
         friend class core::basic_cloud_page_blob_ostreambuf;
         friend class core::basic_cloud_append_blob_ostreambuf;
     };
@@ -6592,6 +7086,114 @@ namespace azure { namespace storage {
             return upload_block_async_impl(block_id, block_data, content_checksum, condition, options, context, cancellation_token, true);
         }
 
+        /// <summary>
+        /// Uploads a single block whose data the service reads from a range of a source object.
+        /// </summary>
+        /// <param name="block_id">A Base64-encoded block ID that identifies the block.</param>
+        /// <param name="source">The URI of the source object, including a shared access signature unless the source is public.</param>
+        /// <param name="offset">The offset of the range in the source object.</param>
+        /// <param name="length">The length of the range in bytes, which may not exceed 100 MB.</param>
+        /// <param name="source_checksum">A hash value of the source range that the service checks the data it reads against. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
+        void upload_block_from_url(const utility::string_t& block_id, const web::http::uri& source, utility::size64_t offset, utility::size64_t length, const checksum& source_checksum) const
+        {
+            upload_block_from_url_async(block_id, source, offset, length, source_checksum).wait();
+        }
+
+        /// <summary>
+        /// Uploads a single block whose data the service reads from a range of a source object.
+        /// </summary>
+        /// <param name="block_id">A Base64-encoded block ID that identifies the block.</param>
+        /// <param name="source">The URI of the source object, including a shared access signature unless the source is public.</param>
+        /// <param name="offset">The offset of the range in the source object.</param>
+        /// <param name="length">The length of the range in bytes, which may not exceed 100 MB.</param>
+        /// <param name="source_checksum">A hash value of the source range that the service checks the data it reads against. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
+        /// <param name="source_condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the source object.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void upload_block_from_url(const utility::string_t& block_id, const web::http::uri& source, utility::size64_t offset, utility::size64_t length, const checksum& source_checksum, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, operation_context context) const
+        {
+            upload_block_from_url_async(block_id, source, offset, length, source_checksum, source_condition, condition, options, context).wait();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to upload a single block whose data the service reads from a range of a source object.
+        /// </summary>
+        /// <param name="block_id">A Base64-encoded block ID that identifies the block.</param>
+        /// <param name="source">The URI of the source object, including a shared access signature unless the source is public.</param>
+        /// <param name="offset">The offset of the range in the source object.</param>
+        /// <param name="length">The length of the range in bytes, which may not exceed 100 MB.</param>
+        /// <param name="source_checksum">A hash value of the source range that the service checks the data it reads against. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> upload_block_from_url_async(const utility::string_t& block_id, const web::http::uri& source, utility::size64_t offset, utility::size64_t length, const checksum& source_checksum) const
+        {
+            return upload_block_from_url_async(block_id, source, offset, length, source_checksum, access_condition(), access_condition(), blob_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to upload a single block whose data the service reads from a range of a source object.
+        /// </summary>
+        /// <param name="block_id">A Base64-encoded block ID that identifies the block.</param>
+        /// <param name="source">The URI of the source object, including a shared access signature unless the source is public.</param>
+        /// <param name="offset">The offset of the range in the source object.</param>
+        /// <param name="length">The length of the range in bytes, which may not exceed 100 MB.</param>
+        /// <param name="source_checksum">A hash value of the source range that the service checks the data it reads against. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
+        /// <param name="source_condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the source object.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<void> upload_block_from_url_async(const utility::string_t& block_id, const web::http::uri& source, utility::size64_t offset, utility::size64_t length, const checksum& source_checksum, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Copies a blob into this block blob and returns once the copy is complete. If the blob already exists on the service, it will be overwritten.
+        /// </summary>
+        /// <param name="source">The source blob.</param>
+        /// <remarks>
+        /// The source is split into blocks of at least <see cref="azure::storage::blob_request_options::stream_write_size_in_bytes" /> bytes, and up to
+        /// <see cref="azure::storage::blob_request_options::parallelism_factor" /> blocks at a time are copied by the service with Put Block From URL
+        /// before the block list is committed, so the data does not pass through the client. The source must be readable with the URI of the source
+        /// reference, and the content properties and metadata of the source are given to this blob.
+        /// </remarks>
+        void copy_from_blob(const cloud_blob& source)
+        {
+            copy_from_blob_async(source).wait();
+        }
+
+        /// <summary>
+        /// Copies a blob into this block blob and returns once the copy is complete. If the blob already exists on the service, it will be overwritten.
+        /// </summary>
+        /// <param name="source">The source blob.</param>
+        /// <param name="source_condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the source blob.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void copy_from_blob(const cloud_blob& source, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, operation_context context)
+        {
+            copy_from_blob_async(source, source_condition, condition, options, context).wait();
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to copy a blob into this block blob, which completes once the copy is complete. If the blob already exists on the service, it will be overwritten.
+        /// </summary>
+        /// <param name="source">The source blob.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> copy_from_blob_async(const cloud_blob& source)
+        {
+            return copy_from_blob_async(source, access_condition(), access_condition(), blob_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Initiates an asynchronous operation to copy a blob into this block blob, which completes once the copy is complete. If the blob already exists on the service, it will be overwritten.
+        /// </summary>
+        /// <param name="source">The source blob.</param>
+        /// <param name="source_condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the source blob.</param>
+        /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<void> copy_from_blob_async(const cloud_blob& source, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, operation_context context);
+
         /// <summary>
         /// Uploads a list of blocks to a new or existing blob. 
         /// </summary>
@@ -9296,6 +9898,307 @@ namespace azure { namespace storage {
         cloud_metadata m_metadata;
         copy_state m_copy_state;
     };
+
+    /// <summary>
+    /// Represents a compact record of a blob returned by a listing operation.
+    /// </summary>
+    /// <remarks>
+    /// All records of a segment share a single character buffer holding their names, snapshot timestamps, ETags, content MD5 values and metadata,
+    /// so a record owns no strings of its own and its text accessors return views into that buffer. A full <see cref="azure::storage::cloud_blob" />
+    /// is built only when <see cref="as_blob" /> is called.
+    /// </remarks>
+    class list_blob_record
+    {
+    public:
+
+        /// <summary>
+        /// Represents a read-only view of a string held by the records of a listing segment.
+        /// </summary>
+        typedef azure::storage::text_view text_view;
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::list_blob_record" /> class.
+        /// </summary>
+        list_blob_record()
+            : m_metadata_offset(0), m_metadata_size(0), m_size(0), m_last_modified(), m_standard_blob_tier(azure::storage::standard_blob_tier::unknown)
+        {
+        }
+
+        /// <summary>
+        /// Gets the name of the blob.
+        /// </summary>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the name of the blob.</returns>
+        text_view name() const
+        {
+            return text(m_name);
+        }
+
+        /// <summary>
+        /// Gets the snapshot timestamp of the blob.
+        /// </summary>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the snapshot timestamp, which is empty if the blob is not a snapshot.</returns>
+        text_view snapshot_time() const
+        {
+            return text(m_snapshot_time);
+        }
+
+        /// <summary>
+        /// Gets the size of the blob, in bytes.
+        /// </summary>
+        /// <returns>The size of the blob, in bytes.</returns>
+        utility::size64_t size() const
+        {
+            return m_size;
+        }
+
+        /// <summary>
+        /// Gets the ETag value of the blob.
+        /// </summary>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the ETag value.</returns>
+        text_view etag() const
+        {
+            return text(m_etag);
+        }
+
+        /// <summary>
+        /// Gets the last-modified time for the blob, expressed as a UTC value.
+        /// </summary>
+        /// <returns>The last-modified time, in UTC format.</returns>
+        utility::datetime last_modified() const
+        {
+            return m_last_modified;
+        }
+
+        /// <summary>
+        /// Gets the tier of the block blob on a standard storage account.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::standard_blob_tier" /> object that indicates the block blob's tier.</returns>
+        azure::storage::standard_blob_tier standard_blob_tier() const
+        {
+            return m_standard_blob_tier;
+        }
+
+        /// <summary>
+        /// Gets the content-MD5 value stored for the blob.
+        /// </summary>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the blob's content-MD5 hash.</returns>
+        text_view content_md5() const
+        {
+            return text(m_content_md5);
+        }
+
+        /// <summary>
+        /// Gets the number of user-defined metadata entries of the blob.
+        /// </summary>
+        /// <returns>The number of metadata entries, which is zero unless metadata was included in the listing.</returns>
+        size_t metadata_size() const
+        {
+            return m_metadata_size;
+        }
+
+        /// <summary>
+        /// Gets the name of a user-defined metadata entry of the blob.
+        /// </summary>
+        /// <param name="index">The index of the entry, in the order the service returned them.</param>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the name of the metadata entry.</returns>
+        text_view metadata_name(size_t index) const
+        {
+            return text(m_buffer->metadata[m_metadata_offset + 2 * check_metadata_index(index)]);
+        }
+
+        /// <summary>
+        /// Gets the value of a user-defined metadata entry of the blob.
+        /// </summary>
+        /// <param name="index">The index of the entry, in the order the service returned them.</param>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the value of the metadata entry.</returns>
+        text_view metadata_value(size_t index) const
+        {
+            return text(m_buffer->metadata[m_metadata_offset + 2 * check_metadata_index(index) + 1]);
+        }
+
+        /// <summary>
+        /// Gets the user-defined metadata for the blob.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::cloud_metadata" /> object containing the metadata, which is empty unless metadata was included in the listing.</returns>
+        /// <remarks>The metadata is copied out of the buffer on every call; use <see cref="metadata_name" /> and <see cref="metadata_value" /> to read it in place.</remarks>
+        cloud_metadata metadata() const
+        {
+            cloud_metadata metadata;
+            for (size_t i = 0; i < m_metadata_size; ++i)
+            {
+                metadata[metadata_name(i).str()] = metadata_value(i).str();
+            }
+
+            return metadata;
+        }
+
+        /// <summary>
+        /// Creates an <see cref="azure::storage::cloud_blob" /> object for the blob this record describes.
+        /// </summary>
+        /// <param name="container">The container that was listed.</param>
+        /// <returns>An <see cref="azure::storage::cloud_blob" /> object whose properties and metadata are populated from the record.</returns>
+        cloud_blob as_blob(const cloud_blob_container& container) const
+        {
+            cloud_blob_properties properties;
+            properties.m_size = m_size;
+            properties.m_etag = etag().str();
+            properties.m_last_modified = m_last_modified;
+            properties.m_content_md5 = content_md5().str();
+            properties.m_standard_blob_tier = m_standard_blob_tier;
+            properties.m_type = blob_type::unspecified;
+
+            return cloud_blob(name().str(), snapshot_time().str(), container, std::move(properties), metadata(), azure::storage::copy_state());
+        }
+
+    private:
+
+        // The offset and length of a string in the segment's character buffer.
+        struct text_range
+        {
+            text_range()
+                : offset(0), length(0)
+            {
+            }
+
+            size_t offset;
+            size_t length;
+        };
+
+        // Shared by all records of a segment. Metadata entries are stored as consecutive name and value ranges.
+        struct segment_buffer
+        {
+            utility::string_t text;
+            std::vector<text_range> metadata;
+        };
+
+        text_view text(const text_range& range) const
+        {
+            // A default-constructed record has no buffer, and all of its strings are empty.
+            if (range.length == 0)
+            {
+                return text_view();
+            }
+
+            return text_view(m_buffer->text.data() + range.offset, range.length);
+        }
+
+        size_t check_metadata_index(size_t index) const
+        {
+            if (index >= m_metadata_size)
+            {
+                throw std::out_of_range("index");
+            }
+
+            return index;
+        }
+
+        std::shared_ptr<const segment_buffer> m_buffer;
+        text_range m_name;
+        text_range m_snapshot_time;
+        text_range m_etag;
+        text_range m_content_md5;
+        size_t m_metadata_offset;
+        size_t m_metadata_size;
+        utility::size64_t m_size;
+        utility::datetime m_last_modified;
+        azure::storage::standard_blob_tier m_standard_blob_tier;
+
+        friend class cloud_blob_container;
+    };
+
+    namespace core
+    {
+        class copy_orchestrator_engine;
+    }
+
+    /// <summary>
+    /// Starts server-side copies of blobs and files, and waits for all of them to complete with a single polling scheduler.
+    /// </summary>
+    /// <remarks>
+    /// No more than the given number of requests, to start copies or to check their state, are in flight at a time, and checks that are due are sent
+    /// before copies that have not been started yet. A pending copy is checked again
+    /// when the rate of progress seen since the previous check says it should have completed, but at most twice as late as last time, so that a fast
+    /// copy is checked again soon and a slow one seldom. A copy that makes no progress is checked half as often each time, within the minimum and
+    /// maximum intervals. Copies keep being tracked after the orchestrator is destroyed, until every one of them has completed.
+    /// </remarks>
+    class cloud_copy_orchestrator
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_copy_orchestrator" /> class that checks pending copies between every
+        /// 500 milliseconds and every minute.
+        /// </summary>
+        /// <param name="parallelism_factor">The maximum number of requests in flight at a time.</param>
+        explicit cloud_copy_orchestrator(int parallelism_factor)
+            : cloud_copy_orchestrator(parallelism_factor, std::chrono::milliseconds(500), std::chrono::milliseconds(60000))
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_copy_orchestrator" /> class.
+        /// </summary>
+        /// <param name="parallelism_factor">The maximum number of requests in flight at a time.</param>
+        /// <param name="minimum_poll_interval">The shortest time to wait before checking the state of a pending copy.</param>
+        /// <param name="maximum_poll_interval">The longest time to wait before checking the state of a pending copy.</param>
+        WASTORAGE_API cloud_copy_orchestrator(int parallelism_factor, std::chrono::milliseconds minimum_poll_interval, std::chrono::milliseconds maximum_poll_interval);
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to copy a blob and wait for the copy to complete.
+        /// </summary>
+        /// <param name="destination">The destination blob.</param>
+        /// <param name="source">The source blob.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::copy_state" /> that represents the current operation.</returns>
+        pplx::task<azure::storage::copy_state> start_copy_async(cloud_blob destination, const cloud_blob& source)
+        {
+            return start_copy_async(std::move(destination), source, blob_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to copy a blob and wait for the copy to complete.
+        /// </summary>
+        /// <param name="destination">The destination blob.</param>
+        /// <param name="source">The source blob.</param>
+        /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::copy_state" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// The task completes with the final copy state once the copy is no longer pending, whether it succeeded, failed or was aborted.
+        /// </remarks>
+        WASTORAGE_API pplx::task<azure::storage::copy_state> start_copy_async(cloud_blob destination, const cloud_blob& source, const blob_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to copy a file and wait for the copy to complete.
+        /// </summary>
+        /// <param name="destination">The destination file.</param>
+        /// <param name="source">The source file.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::copy_state" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// The task completes with the final copy state once the copy is no longer pending, whether it succeeded, failed or was aborted.
+        /// </remarks>
+        WASTORAGE_API pplx::task<azure::storage::copy_state> start_copy_async(cloud_file destination, const cloud_file& source, const file_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to start a copy with the given functions and wait for it to complete.
+        /// </summary>
+        /// <param name="start">The function that starts the copy and returns its state once started.</param>
+        /// <param name="poll">The function that retrieves the current state of the copy.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::copy_state" /> that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<azure::storage::copy_state> start_copy_async(std::function<pplx::task<azure::storage::copy_state>()> start, std::function<pplx::task<azure::storage::copy_state>()> poll);
+
+        /// <summary>
+        /// Gets the number of copies that have not completed yet.
+        /// </summary>
+        /// <returns>The number of copies that are waiting to start or are pending.</returns>
+        WASTORAGE_API size_t pending_count() const;
+
+    private:
+
+        std::shared_ptr<core::copy_orchestrator_engine> m_engine;
+    };
+
 }} // namespace azure::storage
 
 #pragma pop_macro("max")
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <deque>
 #include <iterator>
 #include <unordered_map>
 
@@ -49,6 +50,126 @@ namespace azure { namespace storage {
     /// </summary>
     typedef std::unordered_map<utility::string_t, utility::string_t> cloud_metadata;
 
+    /// <summary>
+    /// Represents a read-only view of a string held in a buffer shared by the records of a result segment.
+    /// </summary>
+    /// <remarks>
+    /// The view remains valid for as long as any record of the segment it was taken from exists.
+    /// </remarks>
+    class text_view
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::text_view" /> class that views an empty string.
+        /// </summary>
+        text_view()
+            : m_data(_XPLATSTR("")), m_size(0)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::text_view" /> class.
+        /// </summary>
+        /// <param name="data">A pointer to the first character of the string.</param>
+        /// <param name="size">The number of characters in the string.</param>
+        text_view(const utility::char_t* data, size_t size)
+            : m_data(data), m_size(size)
+        {
+        }
+
+        /// <summary>
+        /// Gets a pointer to the first character of the string, which is not null-terminated.
+        /// </summary>
+        /// <returns>A pointer to the first character of the string.</returns>
+        const utility::char_t* data() const
+        {
+            return m_data;
+        }
+
+        /// <summary>
+        /// Gets the number of characters in the string.
+        /// </summary>
+        /// <returns>The number of characters in the string.</returns>
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        /// <summary>
+        /// Gets a value indicating whether the string is empty.
+        /// </summary>
+        /// <returns><c>true</c> if the string is empty; otherwise, <c>false</c>.</returns>
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        /// <summary>
+        /// Copies the string out of the segment's buffer.
+        /// </summary>
+        /// <returns>A string containing a copy of the viewed characters.</returns>
+        utility::string_t str() const
+        {
+            return utility::string_t(m_data, m_size);
+        }
+
+        /// <summary>
+        /// Copies the string out of the segment's buffer.
+        /// </summary>
+        operator utility::string_t() const
+        {
+            return str();
+        }
+
+        /// <summary>
+        /// Compares the viewed string with another string.
+        /// </summary>
+        /// <param name="other">The string to compare with.</param>
+        /// <returns><c>true</c> if both strings hold the same characters; otherwise, <c>false</c>.</returns>
+        bool operator==(const utility::string_t& other) const
+        {
+            return other.compare(0, other.size(), m_data, m_size) == 0;
+        }
+
+        /// <summary>
+        /// Compares the viewed string with another string.
+        /// </summary>
+        /// <param name="other">The string to compare with.</param>
+        /// <returns><c>true</c> if the strings differ; otherwise, <c>false</c>.</returns>
+        bool operator!=(const utility::string_t& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+
+        const utility::char_t* m_data;
+        size_t m_size;
+    };
+
+    /// <summary>
+    /// Compares a string with a viewed string.
+    /// </summary>
+    /// <param name="left">The string to compare.</param>
+    /// <param name="right">The viewed string to compare with.</param>
+    /// <returns><c>true</c> if both strings hold the same characters; otherwise, <c>false</c>.</returns>
+    inline bool operator==(const utility::string_t& left, const text_view& right)
+    {
+        return right == left;
+    }
+
+    /// <summary>
+    /// Compares a string with a viewed string.
+    /// </summary>
+    /// <param name="left">The string to compare.</param>
+    /// <param name="right">The viewed string to compare with.</param>
+    /// <returns><c>true</c> if the strings differ; otherwise, <c>false</c>.</returns>
+    inline bool operator!=(const utility::string_t& left, const text_view& right)
+    {
+        return right != left;
+    }
+
     /// <summary>
     /// Represents a continuation token for listing operations. 
     /// </summary>
@@ -257,10 +378,12 @@ namespace azure { namespace storage {
         /// </summary>
         result_iterator() :
             m_result_generator(nullptr),
+            m_async_result_generator(nullptr),
             m_segment_index(0),
             m_returned_results(0),
             m_max_results(0),
-            m_max_results_per_segment(0)
+            m_max_results_per_segment(0),
+            m_prefetch_depth(0)
         {
         }
 
@@ -275,10 +398,39 @@ namespace azure { namespace storage {
         ///  determined by individual service.</param>
         result_iterator(std::function<result_segment<result_type>(const continuation_token &, size_t)> result_generator, utility::size64_t max_results, size_t max_results_per_segment) :
             m_result_generator(std::move(result_generator)),
+            m_async_result_generator(nullptr),
+            m_segment_index(0),
+            m_returned_results(0),
+            m_max_results(max_results),
+            m_max_results_per_segment(max_results_per_segment),
+            m_prefetch_depth(0)
+        {
+            fetch_first_segment();
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::result_iterator{result_type}" /> class that can request segments ahead of time.
+        /// </summary>
+        /// <param name="async_result_generator">The asynchronous result segment generator.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned 
+        /// by the result iterator. If this value is 0, the maximum possible number of results will be returned.</param>
+        /// <param name="max_results_per_segment">A non-negative integer value that indicates the maximum number of results to 
+        /// be returned in one segment. If this value is 0, the maximum possible number of results returned in a segment will be
+        ///  determined by individual service.</param>
+        /// <param name="prefetch_depth">The number of segments to request ahead of the segment being enumerated. If this value is 0,
+        /// a segment is only requested once the current one is exhausted.</param>
+        /// <remarks>
+        /// Each prefetched request is issued as soon as the continuation token it depends on is known, so with a depth of N up to N
+        /// requests are in flight while the current segment is being enumerated.
+        /// </remarks>
+        result_iterator(std::function<pplx::task<result_segment<result_type>>(const continuation_token &, size_t)> async_result_generator, utility::size64_t max_results, size_t max_results_per_segment, size_t prefetch_depth) :
+            m_result_generator(nullptr),
+            m_async_result_generator(std::move(async_result_generator)),
             m_segment_index(0),
             m_returned_results(0),
             m_max_results(max_results),
-            m_max_results_per_segment(max_results_per_segment)
+            m_max_results_per_segment(max_results_per_segment),
+            m_prefetch_depth(prefetch_depth)
         {
             fetch_first_segment();
         }
@@ -306,11 +458,14 @@ namespace azure { namespace storage {
             if (this != &other)
             {
                 m_result_generator = std::move(other.m_result_generator);
+                m_async_result_generator = std::move(other.m_async_result_generator);
                 m_result_segment = std::move(other.m_result_segment);
+                m_prefetched_segments = std::move(other.m_prefetched_segments);
                 m_segment_index = other.m_segment_index;
                 m_returned_results = other.m_returned_results;
                 m_max_results = other.m_max_results;
                 m_max_results_per_segment = other.m_max_results_per_segment;
+                m_prefetch_depth = other.m_prefetch_depth;
             }
 
             return *this;
@@ -393,6 +548,8 @@ namespace azure { namespace storage {
 
     private:
 
+        typedef pplx::task<std::shared_ptr<result_segment<result_type>>> segment_task;
+
         void fetch_first_segment()
         {
             if (nullptr != m_result_generator)
@@ -406,6 +563,22 @@ namespace azure { namespace storage {
                     fetch_next_segment();
                 }
             }
+            else if (nullptr != m_async_result_generator)
+            {
+                request_segment(continuation_token());
+                m_result_segment = take_prefetched_segment();
+                m_segment_index = 0;
+
+                if (m_result_segment.results().empty())
+                {
+                    // continue if returned result segment is empty
+                    fetch_next_segment();
+                }
+                else
+                {
+                    prefetch_segments();
+                }
+            }
         }
 
         void fetch_next_segment()
@@ -421,6 +594,112 @@ namespace azure { namespace storage {
                 m_result_segment = std::move(tmp_segment);
                 m_segment_index = 0;
             }
+            else if (nullptr != m_async_result_generator && !m_result_segment.continuation_token().empty())
+            {
+                if (m_prefetched_segments.empty())
+                {
+                    request_segment(m_result_segment.continuation_token());
+                }
+
+                auto tmp_segment = take_prefetched_segment();
+                while (tmp_segment.results().empty() && !tmp_segment.continuation_token().empty())
+                {
+                    if (m_prefetched_segments.empty())
+                    {
+                        request_segment(tmp_segment.continuation_token());
+                    }
+
+                    tmp_segment = take_prefetched_segment();
+                }
+
+                m_result_segment = std::move(tmp_segment);
+                m_segment_index = 0;
+                prefetch_segments();
+            }
+        }
+
+        void request_segment(const continuation_token& token)
+        {
+            auto segment = m_async_result_generator(token, get_remaining_results_num()).then([](result_segment<result_type> result)
+            {
+                return std::make_shared<result_segment<result_type>>(std::move(result));
+            });
+
+            push_prefetched_segment(segment);
+        }
+
+        void prefetch_segments()
+        {
+            // Stop once the segments already received or requested are known to cover the remaining results.
+            if (m_max_results > 0 && m_returned_results + m_result_segment.results().size() >= m_max_results)
+            {
+                return;
+            }
+
+            if (m_prefetched_segments.empty() && m_prefetch_depth > 0 && !m_result_segment.continuation_token().empty())
+            {
+                request_segment(m_result_segment.continuation_token());
+            }
+
+            while (!m_prefetched_segments.empty() && m_prefetched_segments.size() < m_prefetch_depth)
+            {
+                // The continuation token of a queued request is only known once it completes, so chain the next request to it.
+                auto generator = m_async_result_generator;
+                auto max_results = get_remaining_results_num();
+                auto segment = m_prefetched_segments.back().then([generator, max_results](std::shared_ptr<result_segment<result_type>> previous) -> pplx::task<std::shared_ptr<result_segment<result_type>>>
+                {
+                    if (previous->continuation_token().empty())
+                    {
+                        return pplx::task_from_result(std::make_shared<result_segment<result_type>>());
+                    }
+
+                    return generator(previous->continuation_token(), max_results).then([](result_segment<result_type> result)
+                    {
+                        return std::make_shared<result_segment<result_type>>(std::move(result));
+                    });
+                });
+
+                push_prefetched_segment(segment);
+            }
+        }
+
+        void push_prefetched_segment(segment_task segment)
+        {
+            // Observe failures of requests that are abandoned along with the iterator, so they are not reported as unhandled.
+            segment.then([](segment_task task)
+            {
+                try
+                {
+                    task.wait();
+                }
+                catch (...)
+                {
+                }
+            });
+
+            m_prefetched_segments.push_back(std::move(segment));
+        }
+
+        result_segment<result_type> take_prefetched_segment()
+        {
+            auto segment = m_prefetched_segments.front();
+            m_prefetched_segments.pop_front();
+
+            std::shared_ptr<result_segment<result_type>> result;
+            try
+            {
+                result = segment.get();
+            }
+            catch (...)
+            {
+                // Every queued request is chained to the failed one, so drop them all and let the next fetch start over.
+                m_prefetched_segments.clear();
+                throw;
+            }
+
+            // Copies of this iterator share the queued requests and a chained request may still be reading the continuation token,
+            // so the segment is copied rather than moved out.
+            return *result;
         }
 
         size_t get_remaining_results_num() const
@@ -441,11 +720,14 @@ namespace azure { namespace storage {
         }
 
         std::function<result_segment<result_type>(const continuation_token &, size_t)> m_result_generator;
+        std::function<pplx::task<result_segment<result_type>>(const continuation_token &, size_t)> m_async_result_generator;
         result_segment<result_type> m_result_segment;
+        std::deque<segment_task> m_prefetched_segments;
         size_t m_segment_index;
         utility::size64_t m_returned_results;
         utility::size64_t m_max_results;
         size_t m_max_results_per_segment;
+        size_t m_prefetch_depth;
     };
 
     /// <summary>
@@ -2611,6 +2893,7 @@ namespace azure { namespace storage {
                 m_maximum_execution_time = std::move(other.m_maximum_execution_time);
                 m_location_mode = std::move(other.m_location_mode);
                 m_http_buffer_size = std::move(other.m_http_buffer_size);
+                m_listing_prefetch_depth = std::move(other.m_listing_prefetch_depth);
             }
             return *this;
         }
@@ -2758,6 +3041,29 @@ namespace azure { namespace storage {
             m_validate_certificates = validate_certificates;
         }
 
+        /// <summary>
+        /// Gets the number of result segments a listing or query iterator requests ahead of the segment being enumerated.
+        /// </summary>
+        /// <returns>The number of segments to prefetch.</returns>
+        size_t listing_prefetch_depth() const
+        {
+            return m_listing_prefetch_depth;
+        }
+
+        /// <summary>
+        /// Sets the number of result segments a listing or query iterator requests ahead of the segment being enumerated.
+        /// </summary>
+        /// <param name="listing_prefetch_depth">The number of segments to prefetch. If this value is 0, a segment is only requested once the
+        /// previous one has been enumerated.</param>
+        /// <remarks>
+        /// Prefetching overlaps the enumeration of one segment with the requests for the following ones, at the cost of holding up to
+        /// this many additional segments in memory.
+        /// </remarks>
+        void set_listing_prefetch_depth(size_t listing_prefetch_depth)
+        {
+            m_listing_prefetch_depth = listing_prefetch_depth;
+        }
+
         /// <summary>
         /// Gets the expiry time across all potential retries for the request.
         /// </summary>
@@ -2793,6 +3099,7 @@ namespace azure { namespace storage {
             m_location_mode.merge(other.m_location_mode);
             m_http_buffer_size.merge(other.m_http_buffer_size);
             m_validate_certificates.merge(other.m_validate_certificates);
+            m_listing_prefetch_depth.merge(other.m_listing_prefetch_depth);
 
             if (apply_expiry)
             {
@@ -2818,6 +3125,7 @@ namespace azure { namespace storage {
         option_with_default<azure::storage::location_mode> m_location_mode;
         option_with_default<size_t> m_http_buffer_size;
         option_with_default<bool> m_validate_certificates;
+        option_with_default<size_t> m_listing_prefetch_depth;
     };
 
     /// <summary>
@@ -760,12 +760,7 @@ namespace azure { namespace storage {
         /// Gets the CRC64 error-detecting code.
         /// </summary>
         /// <returns>A string containing base64-encoded CRC64 error-detecting code.</returns>
-        utility::string_t crc64() const
-        {
-            std::vector<uint8_t> crc64_str(sizeof(m_crc64) / sizeof(uint8_t));
-            memcpy(crc64_str.data(), &m_crc64, sizeof(m_crc64));
-            return utility::conversions::to_base64(crc64_str);
-        }
+        WASTORAGE_API utility::string_t crc64() const;
 
     private:
         checksum_type m_type;
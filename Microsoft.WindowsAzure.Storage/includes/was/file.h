@@ -533,6 +533,7 @@ namespace azure { namespace storage {
         file_request_options()
             : request_options(),
             m_use_transactional_md5(false),
+            m_use_transactional_crc64(false),
             m_disable_content_md5_validation(false),
             m_store_file_content_md5(false),
             m_parallelism_factor(1)
@@ -554,6 +555,7 @@ namespace azure { namespace storage {
             {
                 request_options::operator=(std::move(other));
                 m_use_transactional_md5 = other.m_use_transactional_md5;
+                m_use_transactional_crc64 = other.m_use_transactional_crc64;
                 m_disable_content_md5_validation = other.m_disable_content_md5_validation;
                 m_store_file_content_md5 = other.m_store_file_content_md5;
                 m_parallelism_factor = other.m_parallelism_factor;
@@ -572,7 +574,12 @@ namespace azure { namespace storage {
         {
             request_options::apply_defaults(other, apply_expiry);
 
-            m_use_transactional_md5.merge(other.m_use_transactional_md5);
+            // MD5 overrides CRC64 in the same scope. While explicit CRC64 overrides default MD5.
+            if (!m_use_transactional_crc64.has_value() || !m_use_transactional_crc64)
+            {
+                m_use_transactional_md5.merge(other.m_use_transactional_md5);
+            }
+            m_use_transactional_crc64.merge(other.m_use_transactional_crc64);
             m_disable_content_md5_validation.merge(other.m_disable_content_md5_validation);
             m_store_file_content_md5.merge(other.m_store_file_content_md5);
             m_parallelism_factor.merge(other.m_parallelism_factor);
@@ -596,6 +603,24 @@ namespace azure { namespace storage {
             m_use_transactional_md5 = value;
         }
 
+        /// <summary>
+        /// Gets a value indicating whether the content-CRC64 hash will be calculated and validated for the request.
+        /// </summary>
+        /// <returns><c>true</c> if the content-CRC64 hash will be calculated and validated for the request; otherwise, <c>false</c>.</returns>
+        bool use_transactional_crc64() const
+        {
+            return m_use_transactional_crc64;
+        }
+
+        /// <summary>
+        /// Indicates whether to calculate and validate the content-CRC64 hash for the request.
+        /// </summary>
+        /// <param name="value"><c>true</c> to calculate and validate the content-CRC64 hash for the request; otherwise, <c>false</c>.</param>
+        void set_use_transactional_crc64(bool value)
+        {
+            m_use_transactional_crc64 = value;
+        }
+
         /// <summary>
         /// Gets a value indicating whether content-MD5 validation will be disabled when downloading files.
         /// </summary>
@@ -655,6 +680,7 @@ namespace azure { namespace storage {
     private:
 
         option_with_default<bool> m_use_transactional_md5;
+        option_with_default<bool> m_use_transactional_crc64;
         option_with_default<bool> m_disable_content_md5_validation;
         option_with_default<bool> m_store_file_content_md5;
         option_with_default<int> m_parallelism_factor;
@@ -770,6 +796,23 @@ namespace azure { namespace storage {
         /// <returns>An <see cref="azure::storage::share_result_iterator" /> that can be used to to lazily enumerate a collection of shares.</returns>
         WASTORAGE_API share_result_iterator list_shares(const utility::string_t& prefix, bool get_metadata, int max_results, const file_request_options& options, operation_context context);
 
+        /// <summary>
+        /// Initiates an asynchronous operation to enumerate the shares that begin with the specified prefix, passing each share to a callback.
+        /// </summary>
+        /// <param name="prefix">The share name prefix.</param>
+        /// <param name="get_metadata">A flag that specifies whether to retrieve share metadata.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned.
+        /// If this value is zero, the maximum possible number of results will be returned.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::cloud_file_share" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Segments are requested through the asynchronous segmented listing. Up to <see cref="azure::storage::request_options::listing_prefetch_depth" />
+        /// segments are requested ahead of the one being delivered, and the callback is never invoked concurrently.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_shares_async(const utility::string_t& prefix, bool get_metadata, int max_results, const std::function<void(const cloud_file_share&)>& item_callback, const file_request_options& options, operation_context context);
+
         /// <summary>
         /// Returns a result segment containing a collection of <see cref="azure::storage::cloud_file_share" /> objects.
         /// </summary>
@@ -2259,6 +2302,22 @@ namespace azure { namespace storage {
         /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
         /// <returns>An <see cref="azure::storage::list_file_and_diretory_result_iterator" /> that can be used to to lazily enumerate a collection of file or directory items in the the directory.</returns>
         WASTORAGE_API list_file_and_diretory_result_iterator list_files_and_directories(const utility::string_t& prefix, int64_t max_results, const file_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Initiates an asynchronous operation to enumerate the files and directories in the directory, passing each item to a callback.
+        /// </summary>
+        /// <param name="prefix">The file/directory name prefix.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned.
+        /// If this value is zero, the maximum possible number of results will be returned.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::list_file_and_directory_item" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Segments are requested through the asynchronous segmented listing. Up to <see cref="azure::storage::request_options::listing_prefetch_depth" />
+        /// segments are requested ahead of the one being delivered, and the callback is never invoked concurrently.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_files_and_directories_async(const utility::string_t& prefix, int64_t max_results, const std::function<void(const list_file_and_directory_item&)>& item_callback, const file_request_options& options, operation_context context) const;
         
         /// <summary>
         /// Returns a result segment <see cref="azure::storage::list_file_and_directory_result_segment" /> that can be used to to lazily enumerate a collection of file or directory items.
@@ -2517,6 +2576,94 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object that that represents the current operation.</returns>
         WASTORAGE_API pplx::task<bool> delete_directory_if_exists_async(const file_access_condition& condition, const file_request_options& options, operation_context context);
 
+        /// <summary>
+        /// Lists the files and directories in the directory and in all of its sub-directories.
+        /// </summary>
+        /// <param name="handler">The function called with each file or directory item as it is listed.</param>
+        void list_files_and_directories_recursively(std::function<void(const list_file_and_directory_item&)> handler) const
+        {
+            list_files_and_directories_recursively_async(handler).wait();
+        }
+
+        /// <summary>
+        /// Lists the files and directories in the directory and in all of its sub-directories.
+        /// </summary>
+        /// <param name="handler">The function called with each file or directory item as it is listed.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object
+        /// is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        void list_files_and_directories_recursively(std::function<void(const list_file_and_directory_item&)> handler, const file_request_options& options, operation_context context) const
+        {
+            list_files_and_directories_recursively_async(handler, options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to list the files and directories in the directory and in all of its sub-directories.
+        /// </summary>
+        /// <param name="handler">The function called with each file or directory item as it is listed.</param>
+        /// <returns>A <see cref="pplx::task" /> object that that represents the current operation.</returns>
+        pplx::task<void> list_files_and_directories_recursively_async(std::function<void(const list_file_and_directory_item&)> handler) const
+        {
+            return list_files_and_directories_recursively_async(handler, file_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to list the files and directories in the directory and in all of its sub-directories.
+        /// </summary>
+        /// <param name="handler">The function called with each file or directory item as it is listed.</param>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object
+        /// is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>A <see cref="pplx::task" /> object that that represents the current operation.</returns>
+        /// <remarks>
+        /// Up to <see cref="azure::storage::file_request_options::parallelism_factor" /> directories are listed at a time. Items are reported in no particular order,
+        /// but the handler is never called concurrently. If the handler throws an exception, the listing stops and the operation fails with that exception.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_files_and_directories_recursively_async(std::function<void(const list_file_and_directory_item&)> handler, const file_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Deletes the directory together with all of the files and directories it contains.
+        /// </summary>
+        void delete_directory_recursively()
+        {
+            delete_directory_recursively_async().wait();
+        }
+
+        /// <summary>
+        /// Deletes the directory together with all of the files and directories it contains.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object
+        /// is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        void delete_directory_recursively(const file_request_options& options, operation_context context)
+        {
+            delete_directory_recursively_async(options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to delete the directory together with all of the files and directories it contains.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that that represents the current operation.</returns>
+        pplx::task<void> delete_directory_recursively_async()
+        {
+            return delete_directory_recursively_async(file_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to delete the directory together with all of the files and directories it contains.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::file_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object
+        /// is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>A <see cref="pplx::task" /> object that that represents the current operation.</returns>
+        /// <remarks>
+        /// Up to <see cref="azure::storage::file_request_options::parallelism_factor" /> requests are made at a time. Files are deleted as soon as they are listed,
+        /// and each directory is deleted as soon as everything in it has been deleted. The root directory of a share cannot be deleted, so only its contents are.
+        /// Listing pauses while the items waiting to be deleted fill a few listing segments per request, so that memory use stays bounded in large directories.
+        /// A file or directory that is already gone, for example because a retried delete had succeeded, counts as deleted.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> delete_directory_recursively_async(const file_request_options& options, operation_context context);
+
         /// <summary>
         /// Checks existence of the directory.
         /// </summary>
@@ -4179,11 +4326,10 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="stream">A stream providing the file range data.</param>
         /// <param name="start_offset">The offset at which to begin writing, in bytes. The offset must be a multiple of 512.</param>
-        /// <param name="content_md5">An optional hash value that will be used to set the Content-MD5 property
-        /// on the blob. May be an empty string.</param>
-        void write_range(Concurrency::streams::istream stream, int64_t start_offset, utility::string_t content_md5) const
+        /// <param name="content_checksum">A hash value used to ensure transactional integrity. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
+        void write_range(Concurrency::streams::istream stream, int64_t start_offset, const checksum& content_checksum) const
         {
-            write_range_async(stream, start_offset, content_md5).wait();
+            write_range_async(stream, start_offset, content_checksum).wait();
         }
 
         /// <summary>
@@ -4191,14 +4337,13 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="stream">A stream providing the file range data.</param>
         /// <param name="start_offset">The offset at which to begin writing, in bytes. The offset must be a multiple of 512.</param>
-        /// <param name="content_md5">An optional hash value that will be used to set the Content-MD5 property
-        /// on the blob. May be an empty string.</param>
+        /// <param name="content_checksum">A hash value used to ensure transactional integrity. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
         /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
         /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
         /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
-        void write_range(Concurrency::streams::istream stream, int64_t start_offset, utility::string_t content_md5, const file_access_condition& condition, const file_request_options& options, operation_context context) const
+        void write_range(Concurrency::streams::istream stream, int64_t start_offset, const checksum& content_checksum, const file_access_condition& condition, const file_request_options& options, operation_context context) const
         {
-            write_range_async(stream, start_offset, content_md5, condition, options, context).wait();
+            write_range_async(stream, start_offset, content_checksum, condition, options, context).wait();
         }
 
         /// <summary>
@@ -4206,11 +4351,10 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="stream">A stream providing the file range data.</param>
         /// <param name="start_offset">The offset at which to begin writing, in bytes. The offset must be a multiple of 512.</param>
-        /// <param name="content_md5">An optional hash value that will be used to set the Content-MD5 property
-        /// on the blob. May be an empty string.</param>
-        pplx::task<void> write_range_async(Concurrency::streams::istream stream, int64_t start_offset, utility::string_t content_md5) const
+        /// <param name="content_checksum">A hash value used to ensure transactional integrity. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
+        pplx::task<void> write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const checksum& content_checksum) const
         {
-            return write_range_async(stream, start_offset, content_md5, file_access_condition(), file_request_options(), operation_context());
+            return write_range_async(stream, start_offset, content_checksum, file_access_condition(), file_request_options(), operation_context());
         }
 
         /// <summary>
@@ -4218,12 +4362,11 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="stream">A stream providing the file range data.</param>
         /// <param name="start_offset">The offset at which to begin writing, in bytes. The offset must be a multiple of 512.</param>
-        /// <param name="content_md5">An optional hash value that will be used to set the Content-MD5 property
-        /// on the blob. May be an empty string.</param>
+        /// <param name="content_checksum">A hash value used to ensure transactional integrity. May be <see cref="azure::storage::checksum_none" /> or a base64-encoded MD5 string or CRC64 integer.</param>
         /// <param name="condition">An <see cref="azure::storage::access_condition" /> object that represents the access condition for the operation.</param>
         /// <param name="options">An <see cref="azure::storage::blob_request_options" /> object that specifies additional options for the request.</param>
         /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
-        WASTORAGE_API pplx::task<void> write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const file_access_condition& condition, const file_request_options& options, operation_context context) const;
+        WASTORAGE_API pplx::task<void> write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const checksum& content_checksum, const file_access_condition& condition, const file_request_options& options, operation_context context) const;
 
         /// <summary>
         /// Downloads the contents of a file to a stream.
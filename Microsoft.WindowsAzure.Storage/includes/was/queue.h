@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "service_client.h"
 
 namespace azure { namespace storage {
@@ -24,6 +26,12 @@ namespace azure { namespace storage {
     class cloud_queue_message;
     class cloud_queue;
     class cloud_queue_client;
+    class cloud_sharded_queue;
+
+    namespace protocol
+    {
+        class message_writer;
+    }
     
     /// <summary>
     /// Represents a shared access policy, which specifies the start time, expiry time, 
@@ -148,7 +156,7 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_message" /> class.
         /// </summary>
         cloud_queue_message()
-            : m_dequeue_count(0)
+            : m_is_binary(false), m_dequeue_count(0)
         {
         }
 
@@ -157,7 +165,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="content">The content of the message.</param>
         explicit cloud_queue_message(utility::string_t content)
-            : m_content(std::move(content)), m_dequeue_count(0)
+            : m_content(std::move(content)), m_converted(std::make_shared<converted_content>()), m_is_binary(false), m_dequeue_count(0)
         {
         }
 
@@ -165,8 +173,11 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_message" /> class with the specified raw data.
         /// </summary>
         /// <param name="content">The content of the message as raw data.</param>
-        explicit cloud_queue_message(const std::vector<uint8_t>& content)
-            : m_content(utility::conversions::to_base64(content)), m_dequeue_count(0)
+        /// <remarks>
+        /// The data is kept as is and shared by copies of the message. It is only encoded as Base64 when the request body is written.
+        /// </remarks>
+        explicit cloud_queue_message(std::vector<uint8_t> content)
+            : m_binary_content(std::make_shared<std::vector<uint8_t>>(std::move(content))), m_converted(std::make_shared<converted_content>()), m_is_binary(true), m_dequeue_count(0)
         {
         }
 
@@ -176,7 +187,7 @@ namespace azure { namespace storage {
         /// <param name="id">The unique ID of the message.</param>
         /// <param name="pop_receipt">The pop receipt token.</param>
         cloud_queue_message(utility::string_t id, utility::string_t pop_receipt)
-            : m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_dequeue_count(0)
+            : m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_is_binary(false), m_dequeue_count(0)
         {
         }
 
@@ -203,6 +214,9 @@ namespace azure { namespace storage {
             if (this != &other)
             {
                 m_content = std::move(other.m_content);
+                m_binary_content = std::move(other.m_binary_content);
+                m_converted = std::move(other.m_converted);
+                m_is_binary = other.m_is_binary;
                 m_id = std::move(other.m_id);
                 m_pop_receipt = std::move(other.m_pop_receipt);
                 m_insertion_time = std::move(other.m_insertion_time);
@@ -218,10 +232,10 @@ namespace azure { namespace storage {
         /// Gets the content of the message as text.
         /// </summary>
         /// <returns>The content of the message as text.</returns>
-        const utility::string_t content_as_string() const
-        {
-            return m_content;
-        }
+        /// <remarks>
+        /// Binary content is encoded as Base64 the first time it is requested, and the encoded text is kept for later requests.
+        /// </remarks>
+        WASTORAGE_API const utility::string_t content_as_string() const;
 
         /// <summary>
         /// Gets the content of the message as raw data.
@@ -229,9 +243,34 @@ namespace azure { namespace storage {
         /// <returns>The content of the message as raw data.</returns>
         const std::vector<uint8_t> content_as_binary() const
         {
-            return std::vector<uint8_t>(utility::conversions::from_base64(m_content));
+            return *shared_content_as_binary();
         }
 
+        /// <summary>
+        /// Gets the content of the message as raw data, without copying it.
+        /// </summary>
+        /// <returns>The content of the message as raw data, which is shared with the message.</returns>
+        /// <remarks>
+        /// Text content is decoded from Base64 the first time it is requested, and the decoded data is kept for later requests. Concurrent
+        /// requests on the same message decode it only once.
+        /// </remarks>
+        WASTORAGE_API std::shared_ptr<const std::vector<uint8_t>> shared_content_as_binary() const;
+
+        /// <summary>
+        /// Moves the content of the message out as text, leaving the message empty.
+        /// </summary>
+        /// <returns>The content of the message as text.</returns>
+        WASTORAGE_API utility::string_t release_content_as_string();
+
+        /// <summary>
+        /// Moves the content of the message out as raw data, leaving the message empty.
+        /// </summary>
+        /// <returns>The content of the message as raw data.</returns>
+        /// <remarks>
+        /// The data is only copied if it is still shared with a copy of the message.
+        /// </remarks>
+        WASTORAGE_API std::vector<uint8_t> release_content_as_binary();
+
         /// <summary>
         /// Sets the content of this message.
         /// </summary>
@@ -239,15 +278,21 @@ namespace azure { namespace storage {
         void set_content(utility::string_t value)
         {
             m_content = std::move(value);
+            m_binary_content.reset();
+            m_converted = std::make_shared<converted_content>();
+            m_is_binary = false;
         }
 
         /// <summary>
         /// Sets the content of this message.
         /// </summary>
         /// <param name="value">The new message content.</param>
-        void set_content(const std::vector<uint8_t>& value)
+        void set_content(std::vector<uint8_t> value)
         {
-            m_content = utility::conversions::to_base64(value);
+            m_content.clear();
+            m_binary_content = std::make_shared<std::vector<uint8_t>>(std::move(value));
+            m_converted = std::make_shared<converted_content>();
+            m_is_binary = true;
         }
 
         /// <summary>
@@ -322,7 +367,7 @@ namespace azure { namespace storage {
     private:
 
         cloud_queue_message(utility::string_t content, utility::string_t id, utility::string_t pop_receipt, utility::datetime insertion_time, utility::datetime expiration_time, utility::datetime next_visible_time, int dequeue_count)
-            : m_content(std::move(content)), m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_insertion_time(insertion_time), m_expiration_time(expiration_time), m_next_visible_time(next_visible_time), m_dequeue_count(dequeue_count)
+            : m_content(std::move(content)), m_converted(std::make_shared<converted_content>()), m_is_binary(false), m_id(std::move(id)), m_pop_receipt(std::move(pop_receipt)), m_insertion_time(insertion_time), m_expiration_time(expiration_time), m_next_visible_time(next_visible_time), m_dequeue_count(dequeue_count)
         {
         }
 
@@ -336,7 +381,19 @@ namespace azure { namespace storage {
             m_next_visible_time = next_visible_time;
         }
 
+        // The content in the other form than the one it was set in, converted at most once and shared by the copies of the message
+        struct converted_content
+        {
+            std::once_flag once;
+            std::shared_ptr<std::vector<uint8_t>> binary;
+            utility::string_t text;
+        };
+
+        // Text content is held in m_content and binary content in m_binary_content. Neither is changed by the const accessors.
         utility::string_t m_content;
+        std::shared_ptr<std::vector<uint8_t>> m_binary_content;
+        std::shared_ptr<converted_content> m_converted;
+        bool m_is_binary;
         utility::string_t m_id;
         utility::string_t m_pop_receipt;
         utility::datetime m_insertion_time;
@@ -347,6 +404,7 @@ namespace azure { namespace storage {
         void update_message_info(const cloud_queue_message& message_info);
 
         friend class cloud_queue;
+        friend class protocol::message_writer;
     };
 
     /// <summary>
@@ -360,7 +418,7 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::queue_request_options" /> class.
         /// </summary>
         queue_request_options()
-            : request_options()
+            : request_options(), m_parallelism_factor(1)
         {
         }
 
@@ -387,6 +445,7 @@ namespace azure { namespace storage {
             if (this != &other)
             {
                 request_options::operator=(other);
+                m_parallelism_factor = std::move(other.m_parallelism_factor);
             }
             return *this;
         }
@@ -399,7 +458,34 @@ namespace azure { namespace storage {
         void apply_defaults(const queue_request_options& other)
         {
             request_options::apply_defaults(other, true);
+
+            m_parallelism_factor.merge(other.m_parallelism_factor);
+        }
+
+        /// <summary>
+        /// Gets the number of requests that may be simultaneously outstanding when a bulk operation, such as
+        /// <see cref="azure::storage::cloud_queue::add_messages_async" />, sends many messages to one queue.
+        /// </summary>
+        /// <returns>The number of parallel requests that may proceed.</returns>
+        int parallelism_factor() const
+        {
+            return m_parallelism_factor;
         }
+
+        /// <summary>
+        /// Sets the number of requests that may be simultaneously outstanding when a bulk operation, such as
+        /// <see cref="azure::storage::cloud_queue::add_messages_async" />, sends many messages to one queue.
+        /// </summary>
+        /// <param name="value">The number of parallel requests that may proceed.</param>
+        void set_parallelism_factor(int value)
+        {
+            utility::assert_in_bounds(_XPLATSTR("value"), value, 0);
+            m_parallelism_factor = value;
+        }
+
+    private:
+
+        option_with_default<int> m_parallelism_factor;
     };
 
     typedef result_segment<cloud_queue> queue_result_segment;
@@ -516,6 +602,23 @@ namespace azure { namespace storage {
         /// <returns>An <see cref="azure::storage::queue_result_iterator" /> that can be used to to lazily enumerate a collection of queues.</returns>
         WASTORAGE_API queue_result_iterator list_queues(const utility::string_t& prefix, bool get_metadata, utility::size64_t max_results, const queue_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Initiates an asynchronous operation to enumerate the queues that begin with the specified prefix, passing each queue to a callback.
+        /// </summary>
+        /// <param name="prefix">The queue name prefix.</param>
+        /// <param name="get_metadata">A flag that specifies whether to retrieve queue metadata.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned.
+        /// If this value is zero, the maximum possible number of results will be returned.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::cloud_queue" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Segments are requested through the asynchronous segmented listing. Up to <see cref="azure::storage::request_options::listing_prefetch_depth" />
+        /// segments are requested ahead of the one being delivered, and the callback is never invoked concurrently.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_queues_async(const utility::string_t& prefix, bool get_metadata, utility::size64_t max_results, const std::function<void(const cloud_queue&)>& item_callback, const queue_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Returns a result segment containing a collection of queues in the storage account.
         /// </summary>
@@ -711,6 +814,14 @@ namespace azure { namespace storage {
         /// <returns>The queue.</returns>
         WASTORAGE_API cloud_queue get_queue_reference(utility::string_t queue_name) const;
 
+        /// <summary>
+        /// Returns a reference to a sharded queue made of the specified number of queues.
+        /// </summary>
+        /// <param name="name_prefix">The prefix of the names of the queues, each of which is named by the prefix followed by its index.</param>
+        /// <param name="shard_count">The number of queues.</param>
+        /// <returns>The sharded queue.</returns>
+        WASTORAGE_API cloud_sharded_queue get_sharded_queue_reference(const utility::string_t& name_prefix, size_t shard_count) const;
+
         const queue_request_options& default_request_options() const
         {
             return m_default_request_options;
@@ -1016,6 +1127,37 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
         WASTORAGE_API pplx::task<void> add_message_async(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context);
 
+        /// <summary>
+        /// Adds a sequence of messages to the queue, keeping several requests in flight.
+        /// </summary>
+        /// <param name="messages">The messages to add to the queue.</param>
+        /// <param name="time_to_live">The maximum time to allow the messages to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which the messages will be invisible.</param>
+        /// <param name="update_messages"><c>true</c> to update each message with the ID, pop receipt and times returned by the service; <c>false</c> to leave the responses unparsed.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void add_messages(std::vector<cloud_queue_message>& messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, bool update_messages, queue_request_options& options, operation_context context)
+        {
+            add_messages_async(messages, time_to_live, initial_visibility_timeout, update_messages, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation to add a sequence of messages to the queue, keeping several requests in flight.
+        /// </summary>
+        /// <param name="messages">The messages to add to the queue, which must not be changed or destroyed until the operation completes.</param>
+        /// <param name="time_to_live">The maximum time to allow the messages to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which the messages will be invisible.</param>
+        /// <param name="update_messages"><c>true</c> to update each message with the ID, pop receipt and times returned by the service; <c>false</c> to leave the responses unparsed.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Each message is still added by its own request, but up to <see cref="azure::storage::queue_request_options::parallelism_factor" /> requests are in flight
+        /// at once, and their bodies are written into buffers that are reused from one message to the next. Messages are not necessarily added in order.
+        /// If a request fails, no further messages are sent and the task fails with the first exception once the requests in flight complete.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> add_messages_async(std::vector<cloud_queue_message>& messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, bool update_messages, queue_request_options& options, operation_context context);
+
         /// <summary>
         /// Retrieves a message from the front of the queue
         /// </summary>
@@ -1566,5 +1708,481 @@ namespace azure { namespace storage {
         friend class cloud_queue_client;
     };
 
+    namespace core
+    {
+        class queue_consumer_engine;
+    }
+
+    /// <summary>
+    /// Processes the messages of a queue with a pool of workers, keeping a local buffer of messages filled ahead of the workers.
+    /// </summary>
+    /// <remarks>
+    /// Messages are retrieved 32 at a time, with several requests in flight when the buffer has room for them, and each message is handed to the
+    /// handler on a worker. The number of workers is <see cref="azure::storage::queue_request_options::parallelism_factor" />. While a message is buffered
+    /// or being handled, its visibility timeout is extended before it ends, so no other consumer receives it. When the handler returns, the message is
+    /// deleted, and deletes are sent with no more requests in flight than there are workers. When the handler throws, the exception is passed to the
+    /// error handler, if any, and logged, and the message is left to become visible again, so that it can be retried. A message whose visibility timeout
+    /// could not be extended is dropped without being handled or deleted, since another consumer may already have received it. When the queue is empty, the consumer waits before polling again, doubling the wait each time up
+    /// to 30 seconds, so that an idle consumer makes few requests.
+    /// </remarks>
+    class cloud_queue_consumer
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_consumer" /> class.
+        /// </summary>
+        /// <param name="queue">The queue to process.</param>
+        /// <param name="handler">The function that processes a message. It is invoked concurrently on different messages.</param>
+        /// <param name="visibility_timeout">The visibility timeout of retrieved messages, which is extended for as long as a message is held. It must be positive.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        WASTORAGE_API cloud_queue_consumer(cloud_queue queue, std::function<void(cloud_queue_message)> handler, std::chrono::seconds visibility_timeout, const queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_queue_consumer" /> class.
+        /// </summary>
+        /// <param name="queue">The queue to process.</param>
+        /// <param name="handler">The function that processes a message. It is invoked concurrently on different messages.</param>
+        /// <param name="error_handler">The function that is invoked with a message and the exception thrown by the handler for it. It may be empty.</param>
+        /// <param name="visibility_timeout">The visibility timeout of retrieved messages, which is extended for as long as a message is held. It must be positive.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        WASTORAGE_API cloud_queue_consumer(cloud_queue queue, std::function<void(cloud_queue_message)> handler, std::function<void(const cloud_queue_message&, std::exception_ptr)> error_handler,
+            std::chrono::seconds visibility_timeout, const queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Stops the consumer without waiting for the messages being handled.
+        /// </summary>
+        WASTORAGE_API ~cloud_queue_consumer();
+
+        cloud_queue_consumer(const cloud_queue_consumer& other) = delete;
+        cloud_queue_consumer& operator=(const cloud_queue_consumer& other) = delete;
+
+        /// <summary>
+        /// Starts retrieving and processing messages.
+        /// </summary>
+        WASTORAGE_API void start();
+
+        /// <summary>
+        /// Stops retrieving messages and waits for the messages being handled to be processed.
+        /// </summary>
+        void stop()
+        {
+            stop_async().get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that stops retrieving messages and waits for the messages being handled to be processed.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Messages that were buffered but not yet handed to a worker become visible again when their visibility timeout ends. If a request to retrieve,
+        /// extend or delete messages failed while the consumer was running, the task fails with the first exception encountered.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> stop_async();
+
+    private:
+
+        std::shared_ptr<core::queue_consumer_engine> m_engine;
+    };
+
+    /// <summary>
+    /// Represents a message retrieved from a <see cref="azure::storage::cloud_sharded_queue" />, together with the shard it came from.
+    /// </summary>
+    class cloud_sharded_queue_message
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_sharded_queue_message" /> class.
+        /// </summary>
+        cloud_sharded_queue_message()
+            : m_shard_index(0)
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_sharded_queue_message" /> class.
+        /// </summary>
+        /// <param name="shard_index">The index of the shard that holds the message.</param>
+        /// <param name="message">The message.</param>
+        cloud_sharded_queue_message(size_t shard_index, cloud_queue_message message)
+            : m_shard_index(shard_index), m_message(std::move(message))
+        {
+        }
+
+        /// <summary>
+        /// Gets the index of the shard that holds the message.
+        /// </summary>
+        /// <returns>The index of the shard.</returns>
+        size_t shard_index() const
+        {
+            return m_shard_index;
+        }
+
+        /// <summary>
+        /// Gets the message.
+        /// </summary>
+        /// <returns>The message.</returns>
+        const cloud_queue_message& message() const
+        {
+            return m_message;
+        }
+
+        /// <summary>
+        /// Gets the message.
+        /// </summary>
+        /// <returns>The message.</returns>
+        cloud_queue_message& message()
+        {
+            return m_message;
+        }
+
+    private:
+
+        size_t m_shard_index;
+        cloud_queue_message m_message;
+    };
+
+    namespace core
+    {
+        class sharded_queue_state;
+    }
+
+    /// <summary>
+    /// Represents a logical queue that is spread over several Windows Azure queues, called shards, to go beyond the throughput of a single queue.
+    /// </summary>
+    /// <remarks>
+    /// Shard i is the queue named by the name prefix followed by i. Producers spread messages over the shards in turn, or by a key, which always
+    /// maps to the same shard. Consumers poll the shards in turn, skipping shards that were recently found empty, and take messages from other shards
+    /// when one runs dry. A default-constructed <see cref="azure::storage::cloud_sharded_queue" /> has no shards, and throws when it is used to add
+    /// or retrieve messages. Copies of a <see cref="azure::storage::cloud_sharded_queue" /> share the producer and consumer state.
+    /// </remarks>
+    class cloud_sharded_queue
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_sharded_queue" /> class.
+        /// </summary>
+        cloud_sharded_queue()
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::cloud_sharded_queue" /> class.
+        /// </summary>
+        /// <param name="client">The Queue service client.</param>
+        /// <param name="name_prefix">The prefix of the names of the shards.</param>
+        /// <param name="shard_count">The number of shards, which must be positive.</param>
+        WASTORAGE_API cloud_sharded_queue(const cloud_queue_client& client, const utility::string_t& name_prefix, size_t shard_count);
+
+        /// <summary>
+        /// Gets the number of shards.
+        /// </summary>
+        /// <returns>The number of shards.</returns>
+        size_t shard_count() const
+        {
+            return m_shards.size();
+        }
+
+        /// <summary>
+        /// Gets the queue of a shard.
+        /// </summary>
+        /// <param name="index">The index of the shard.</param>
+        /// <returns>The queue.</returns>
+        const cloud_queue& shard(size_t index) const
+        {
+            return m_shards.at(index);
+        }
+
+        /// <summary>
+        /// Gets the index of the shard that messages with the specified key are added to.
+        /// </summary>
+        /// <param name="key">The key.</param>
+        /// <returns>The index of the shard.</returns>
+        /// <remarks>
+        /// The mapping only depends on the key and the number of shards, so it is the same in every process.
+        /// </remarks>
+        WASTORAGE_API size_t shard_for_key(const utility::string_t& key) const;
+
+        /// <summary>
+        /// Creates the shards that do not exist yet.
+        /// </summary>
+        void create_if_not_exists()
+        {
+            create_if_not_exists_async().wait();
+        }
+
+        /// <summary>
+        /// Creates the shards that do not exist yet.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void create_if_not_exists(const queue_request_options& options, operation_context context)
+        {
+            create_if_not_exists_async(options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that creates the shards that do not exist yet.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> create_if_not_exists_async()
+        {
+            return create_if_not_exists_async(queue_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that creates the shards that do not exist yet.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<void> create_if_not_exists_async(const queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Deletes the shards that exist.
+        /// </summary>
+        void delete_if_exists()
+        {
+            delete_if_exists_async().wait();
+        }
+
+        /// <summary>
+        /// Deletes the shards that exist.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void delete_if_exists(const queue_request_options& options, operation_context context)
+        {
+            delete_if_exists_async(options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that deletes the shards that exist.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> delete_if_exists_async()
+        {
+            return delete_if_exists_async(queue_request_options(), operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that deletes the shards that exist.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        WASTORAGE_API pplx::task<void> delete_if_exists_async(const queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Adds a message to the next shard in turn.
+        /// </summary>
+        /// <param name="message">The message to add.</param>
+        /// <returns>The index of the shard the message was added to.</returns>
+        size_t add_message(cloud_queue_message& message)
+        {
+            return add_message_async(message).get();
+        }
+
+        /// <summary>
+        /// Adds a message to the next shard in turn.
+        /// </summary>
+        /// <param name="message">The message to add.</param>
+        /// <param name="time_to_live">The maximum time to allow the message to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which the message will be invisible.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>The index of the shard the message was added to.</returns>
+        size_t add_message(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context)
+        {
+            return add_message_async(message, time_to_live, initial_visibility_timeout, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that adds a message to the next shard in turn.
+        /// </summary>
+        /// <param name="message">The message to add.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="size_t" /> that represents the current operation, and returns the index of the shard the message was added to.</returns>
+        pplx::task<size_t> add_message_async(cloud_queue_message& message)
+        {
+            queue_request_options options;
+            return add_message_async(message, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), options, operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that adds a message to the next shard in turn.
+        /// </summary>
+        /// <param name="message">The message to add.</param>
+        /// <param name="time_to_live">The maximum time to allow the message to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which the message will be invisible.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="size_t" /> that represents the current operation, and returns the index of the shard the message was added to.</returns>
+        WASTORAGE_API pplx::task<size_t> add_message_async(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Adds a message to the shard that the specified key maps to.
+        /// </summary>
+        /// <param name="key">The key that selects the shard.</param>
+        /// <param name="message">The message to add.</param>
+        /// <returns>The index of the shard the message was added to.</returns>
+        size_t add_message(const utility::string_t& key, cloud_queue_message& message)
+        {
+            return add_message_async(key, message).get();
+        }
+
+        /// <summary>
+        /// Adds a message to the shard that the specified key maps to.
+        /// </summary>
+        /// <param name="key">The key that selects the shard.</param>
+        /// <param name="message">The message to add.</param>
+        /// <param name="time_to_live">The maximum time to allow the message to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which the message will be invisible.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>The index of the shard the message was added to.</returns>
+        size_t add_message(const utility::string_t& key, cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context)
+        {
+            return add_message_async(key, message, time_to_live, initial_visibility_timeout, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that adds a message to the shard that the specified key maps to.
+        /// </summary>
+        /// <param name="key">The key that selects the shard.</param>
+        /// <param name="message">The message to add.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="size_t" /> that represents the current operation, and returns the index of the shard the message was added to.</returns>
+        pplx::task<size_t> add_message_async(const utility::string_t& key, cloud_queue_message& message)
+        {
+            queue_request_options options;
+            return add_message_async(key, message, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), options, operation_context());
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that adds a message to the shard that the specified key maps to.
+        /// </summary>
+        /// <param name="key">The key that selects the shard.</param>
+        /// <param name="message">The message to add.</param>
+        /// <param name="time_to_live">The maximum time to allow the message to be in the queue.</param>
+        /// <param name="initial_visibility_timeout">The length of time from now during which the message will be invisible.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="size_t" /> that represents the current operation, and returns the index of the shard the message was added to.</returns>
+        WASTORAGE_API pplx::task<size_t> add_message_async(const utility::string_t& key, cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Retrieves up to the specified number of messages from the shards.
+        /// </summary>
+        /// <param name="message_count">The number of messages to retrieve.</param>
+        /// <param name="visibility_timeout">The length of time from now during which the messages will be invisible.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>An enumerable collection of <see cref="azure::storage::cloud_sharded_queue_message" /> objects.</returns>
+        std::vector<cloud_sharded_queue_message> get_messages(size_t message_count, std::chrono::seconds visibility_timeout, queue_request_options& options, operation_context context)
+        {
+            return get_messages_async(message_count, visibility_timeout, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that retrieves up to the specified number of messages from the shards.
+        /// </summary>
+        /// <param name="message_count">The number of messages to retrieve.</param>
+        /// <param name="visibility_timeout">The length of time from now during which the messages will be invisible.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="std::vector" />, of type <see cref="azure::storage::cloud_sharded_queue_message" />, that represents the current operation.</returns>
+        /// <remarks>
+        /// The shards that are due are polled in parallel, starting with the next shard in turn, until enough messages have been retrieved, and no
+        /// more messages than requested are retrieved. A shard that was found empty is skipped for a while, for longer each time it is found empty
+        /// again. When no shard is due, only the one that becomes due first is polled. A shard that fails does not stop the other shards from
+        /// being polled: the messages retrieved from them are returned, and the operation only fails, with the first failure, when no message was
+        /// retrieved.
+        /// </remarks>
+        WASTORAGE_API pplx::task<std::vector<cloud_sharded_queue_message>> get_messages_async(size_t message_count, std::chrono::seconds visibility_timeout, queue_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Updates the visibility timeout and optionally the content of a message in its shard.
+        /// </summary>
+        /// <param name="message">The message to update.</param>
+        /// <param name="visibility_timeout">The length of time from now during which the message will be invisible.</param>
+        /// <param name="update_content"><c>true</c> to update the content of the message.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void update_message(cloud_sharded_queue_message& message, std::chrono::seconds visibility_timeout, bool update_content, queue_request_options& options, operation_context context)
+        {
+            update_message_async(message, visibility_timeout, update_content, options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that updates the visibility timeout and optionally the content of a message in its shard.
+        /// </summary>
+        /// <param name="message">The message to update.</param>
+        /// <param name="visibility_timeout">The length of time from now during which the message will be invisible.</param>
+        /// <param name="update_content"><c>true</c> to update the content of the message.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> update_message_async(cloud_sharded_queue_message& message, std::chrono::seconds visibility_timeout, bool update_content, queue_request_options& options, operation_context context)
+        {
+            return m_shards.at(message.shard_index()).update_message_async(message.message(), visibility_timeout, update_content, options, context);
+        }
+
+        /// <summary>
+        /// Deletes a message from its shard.
+        /// </summary>
+        /// <param name="message">The message to delete.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void delete_message(cloud_sharded_queue_message& message, queue_request_options& options, operation_context context)
+        {
+            delete_message_async(message, options, context).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that deletes a message from its shard.
+        /// </summary>
+        /// <param name="message">The message to delete.</param>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        pplx::task<void> delete_message_async(cloud_sharded_queue_message& message, queue_request_options& options, operation_context context)
+        {
+            return m_shards.at(message.shard_index()).delete_message_async(message.message(), options, context);
+        }
+
+        /// <summary>
+        /// Retrieves the approximate number of messages in each shard.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>The approximate number of messages in each shard, indexed by shard.</returns>
+        std::vector<int> download_shard_depths(const queue_request_options& options, operation_context context) const
+        {
+            return download_shard_depths_async(options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that retrieves the approximate number of messages in each shard.
+        /// </summary>
+        /// <param name="options">An <see cref="azure::storage::queue_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="std::vector" />, of type <see cref="int" />, that represents the current operation.</returns>
+        /// <remarks>
+        /// The depths are read from the approximate message count of each shard, which is requested from all shards at once. They can be used to
+        /// find shards that fall behind and to decide how to spread producers and consumers over the shards.
+        /// </remarks>
+        WASTORAGE_API pplx::task<std::vector<int>> download_shard_depths_async(const queue_request_options& options, operation_context context) const;
+
+    private:
+
+        void assert_has_shards() const;
+
+        std::vector<cloud_queue> m_shards;
+        std::shared_ptr<core::sharded_queue_state> m_state;
+    };
+
 
 }} // namespace azure::storage
@@ -17,6 +17,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+
 #include "common.h"
 #include "service_client.h"
 
@@ -29,6 +32,7 @@ namespace azure { namespace storage {
     namespace protocol
     {
         table_entity parse_table_entity(const web::json::value& document);
+        class table_entity_json_reader;
     }
 
     /// <summary>
@@ -262,7 +266,8 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::table_request_options" /> class.
         /// </summary>
         table_request_options()
-            : m_payload_format(azure::storage::table_payload_format::json)
+            : m_payload_format(azure::storage::table_payload_format::json),
+            m_parallelism_factor(1)
         {
         }
 
@@ -290,6 +295,7 @@ namespace azure { namespace storage {
             {
                 request_options::operator=(std::move(other));
                 m_payload_format = std::move(other.m_payload_format);
+                m_parallelism_factor = std::move(other.m_parallelism_factor);
             }
             return *this;
         }
@@ -304,6 +310,7 @@ namespace azure { namespace storage {
             request_options::apply_defaults(other, true);
             
             m_payload_format.merge(other.m_payload_format);
+            m_parallelism_factor.merge(other.m_parallelism_factor);
         }
 
         /// <summary>
@@ -324,9 +331,31 @@ namespace azure { namespace storage {
             m_payload_format = payload_format;
         }
 
+        /// <summary>
+        /// Gets the number of requests that may be simultaneously outstanding when a bulk operation, such as a <see cref="azure::storage::table_batch_writer" />,
+        /// spreads its work across partitions.
+        /// </summary>
+        /// <returns>The number of parallel requests that may proceed.</returns>
+        int parallelism_factor() const
+        {
+            return m_parallelism_factor;
+        }
+
+        /// <summary>
+        /// Sets the number of requests that may be simultaneously outstanding when a bulk operation, such as a <see cref="azure::storage::table_batch_writer" />,
+        /// spreads its work across partitions.
+        /// </summary>
+        /// <param name="value">The number of parallel requests that may proceed.</param>
+        void set_parallelism_factor(int value)
+        {
+            utility::assert_in_bounds(_XPLATSTR("value"), value, 0);
+            m_parallelism_factor = value;
+        }
+
     private:
 
         option_with_default<table_payload_format> m_payload_format;
+        option_with_default<int> m_parallelism_factor;
     };
 
     /// <summary>
@@ -340,7 +369,7 @@ namespace azure { namespace storage {
         /// Initializes a new instance of the <see cref="azure::storage::entity_property" /> class.
         /// </summary>
         entity_property()
-            : m_property_type(edm_type::string), m_is_null(true)
+            : m_property_type(edm_type::string), m_is_null(true), m_has_native(false), m_native(), m_text_state(text_ready)
         {
         }
 
@@ -349,7 +378,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A byte array.</param>
         entity_property(const std::vector<uint8_t>& value)
-            : m_property_type(edm_type::binary), m_is_null(false)
+            : m_property_type(edm_type::binary), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -359,7 +388,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A boolean value.</param>
         entity_property(bool value)
-            : m_property_type(edm_type::boolean), m_is_null(false)
+            : m_property_type(edm_type::boolean), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -369,7 +398,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A datetime value.</param>
         entity_property(utility::datetime value)
-            : m_property_type(edm_type::datetime), m_is_null(false)
+            : m_property_type(edm_type::datetime), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -379,7 +408,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A double value.</param>
         entity_property(double value)
-            : m_property_type(edm_type::double_floating_point), m_is_null(false)
+            : m_property_type(edm_type::double_floating_point), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -389,7 +418,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A GUID value.</param>
         entity_property(const utility::uuid& value)
-            : m_property_type(edm_type::guid), m_is_null(false)
+            : m_property_type(edm_type::guid), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -399,7 +428,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A 32-bit integer value.</param>
         entity_property(int32_t value)
-            : m_property_type(edm_type::int32), m_is_null(false)
+            : m_property_type(edm_type::int32), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -409,7 +438,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A 64-bit integer value.</param>
         entity_property(int64_t value)
-            : m_property_type(edm_type::int64), m_is_null(false)
+            : m_property_type(edm_type::int64), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
@@ -419,7 +448,7 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A string value.</param>
         entity_property(utility::string_t value)
-            : m_property_type(edm_type::string), m_is_null(false), m_value(std::move(value))
+            : m_property_type(edm_type::string), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready), m_value(std::move(value))
         {
         }
 
@@ -428,22 +457,47 @@ namespace azure { namespace storage {
         /// </summary>
         /// <param name="value">A string value.</param>
         entity_property(const utility::char_t* value)
-            : m_property_type(edm_type::string), m_is_null(false)
+            : m_property_type(edm_type::string), m_is_null(false), m_has_native(false), m_native(), m_text_state(text_ready)
         {
             set_value_impl(value);
         }
 
-#if defined(_MSC_VER) && _MSC_VER < 1900
-        // Compilers that fully support C++ 11 rvalue reference, e.g. g++ 4.8+, clang++ 3.3+ and Visual Studio 2015+, 
-        // have implicitly-declared move constructor and move assignment operator.
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::entity_property" /> class based on an existing instance.
+        /// </summary>
+        /// <param name="other">An existing <see cref="azure::storage::entity_property" /> object.</param>
+        entity_property(const entity_property& other)
+            : m_property_type(other.m_property_type), m_is_null(other.m_is_null), m_has_native(other.m_has_native), m_native(other.m_native), m_text_state(text_missing)
+        {
+            copy_text(other);
+        }
 
         /// <summary>
         /// Initializes a new instance of the <see cref="azure::storage::entity_property" /> class based on an existing instance.
         /// </summary>
         /// <param name="other">An existing <see cref="azure::storage::entity_property" /> object.</param>
         entity_property(entity_property&& other)
+            : m_property_type(other.m_property_type), m_is_null(other.m_is_null), m_has_native(other.m_has_native), m_native(other.m_native), m_text_state(text_missing)
         {
-            *this = std::move(other);
+            move_text(other);
+        }
+
+        /// <summary>
+        /// Returns a reference to an <see cref="azure::storage::entity_property" /> object.
+        /// </summary>
+        /// <param name="other">An existing <see cref="azure::storage::entity_property" /> object to use to set properties.</param>
+        /// <returns>An <see cref="azure::storage::entity_property" /> object with properties set.</returns>
+        entity_property& operator=(const entity_property& other)
+        {
+            if (this != &other)
+            {
+                m_property_type = other.m_property_type;
+                m_is_null = other.m_is_null;
+                m_has_native = other.m_has_native;
+                m_native = other.m_native;
+                copy_text(other);
+            }
+            return *this;
         }
 
         /// <summary>
@@ -455,13 +509,14 @@ namespace azure { namespace storage {
         {
             if (this != &other)
             {
-                m_property_type = std::move(other.m_property_type);
-                m_is_null = std::move(other.m_is_null);
-                m_value = std::move(other.m_value);
+                m_property_type = other.m_property_type;
+                m_is_null = other.m_is_null;
+                m_has_native = other.m_has_native;
+                m_native = other.m_native;
+                move_text(other);
             }
             return *this;
         }
-#endif
 
         /// <summary>
         /// Gets the property type of the <see cref="azure::storage::entity_property" /> object.
@@ -476,10 +531,10 @@ namespace azure { namespace storage {
         /// Sets the property type of the <see cref="azure::storage::entity_property" /> object.
         /// </summary>
         /// <param name="property_type">An <see cref="azure::storage::edm_type" /> object indicating the property type.</param>
-        void set_property_type(azure::storage::edm_type property_type)
-        {
-            m_property_type = property_type;
-        }
+        /// <remarks>
+        /// The current value is kept and reinterpreted as the new type. Accessors for the new type throw if the value cannot be converted.
+        /// </remarks>
+        WASTORAGE_API void set_property_type(azure::storage::edm_type property_type);
 
         /// <summary>
         /// Indicates whether the value is null.
@@ -658,7 +713,7 @@ namespace azure { namespace storage {
         {
             m_property_type = edm_type::string;
             m_is_null = false;
-            m_value = std::move(value);
+            set_text(std::move(value));
         }
 
         /// <summary>
@@ -676,33 +731,53 @@ namespace azure { namespace storage {
         /// Returns the value of the <see cref="azure::storage::entity_property" /> object as a string.
         /// </summary>
         /// <returns>A string containing the property value.</returns>
+        /// <remarks>
+        /// Values other than strings and byte arrays are stored in their native form, and their text is only produced on the first call.
+        /// Concurrent calls on the same object are safe.
+        /// </remarks>
         const utility::string_t& str() const
         {
+            if (m_text_state.load(std::memory_order_acquire) != text_ready)
+            {
+                format_native_value();
+            }
+
             return m_value;
         }
 
     private:
 
-        void set_value_impl(const std::vector<uint8_t>& value)
+        // Holds the value of every fixed-size type so that it is not parsed again each time it is read.
+        union native_value
         {
-            m_value = utility::conversions::to_base64(value);
-        }
+            bool boolean;
+            int32_t int32;
+            int64_t int64;
+            double double_floating_point;
+            utility::datetime::interval_type datetime_interval;
+            utility::uuid guid;
+        };
+
+        WASTORAGE_API void set_value_impl(const std::vector<uint8_t>& value);
 
         void set_value_impl(bool value)
         {
-            m_value = value ? _XPLATSTR("true") : _XPLATSTR("false");
+            m_native.boolean = value;
+            set_native();
         }
 
         void set_value_impl(utility::datetime value)
         {
-            m_value = value.to_string(utility::datetime::ISO_8601);
+            m_native.datetime_interval = value.to_interval();
+            set_native();
         }
 
         WASTORAGE_API void set_value_impl(double value);
 
         void set_value_impl(const utility::uuid& value)
         {
-            m_value = utility::uuid_to_string(value);
+            m_native.guid = value;
+            set_native();
         }
 
         WASTORAGE_API void set_value_impl(int32_t value);
@@ -711,12 +786,69 @@ namespace azure { namespace storage {
 
         void set_value_impl(const utility::char_t * value)
         {
-            m_value = value;
+            set_text(value);
+        }
+
+        void set_text(utility::string_t value)
+        {
+            m_value = std::move(value);
+            m_text_state.store(text_ready, std::memory_order_relaxed);
+            m_has_native = false;
+        }
+
+        void set_native()
+        {
+            // The text is left to the first call to str(), so setting a value never formats it.
+            m_text_state.store(text_missing, std::memory_order_relaxed);
+            m_has_native = true;
+        }
+
+        void copy_text(const entity_property& other)
+        {
+            // Another thread may be formatting the text of other, so it is only copied once complete; the native value is copied regardless.
+            if (other.m_text_state.load(std::memory_order_acquire) == text_ready)
+            {
+                m_value = other.m_value;
+                m_text_state.store(text_ready, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_text_state.store(text_missing, std::memory_order_relaxed);
+            }
+        }
+
+        void move_text(entity_property& other)
+        {
+            if (other.m_text_state.load(std::memory_order_relaxed) == text_ready)
+            {
+                m_value = std::move(other.m_value);
+                m_text_state.store(text_ready, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_text_state.store(text_missing, std::memory_order_relaxed);
+            }
         }
 
+        WASTORAGE_API void format_native_value() const;
+        void parse_native_value();
+
+        enum text_state
+        {
+            text_missing,
+            text_formatting,
+            text_ready
+        };
+
         edm_type m_property_type;
         bool m_is_null;
-        utility::string_t m_value;
+
+        // At least one of the native value and the text is valid. When both are, they represent the same value. The text of a native
+        // value is written once, by the first call to str() that moves m_text_state from text_missing to text_formatting.
+        bool m_has_native;
+        native_value m_native;
+        mutable std::atomic<int> m_text_state;
+        mutable utility::string_t m_value;
     };
 
     /// <summary>
@@ -895,6 +1027,326 @@ namespace azure { namespace storage {
         utility::string_t m_etag;
 
         friend table_entity protocol::parse_table_entity(const web::json::value& document);
+        friend class protocol::table_entity_json_reader;
+        friend class table_entity_record;
+    };
+
+    namespace core
+    {
+        // Gives the EDM type each member type a table_entity_mapping supports is stored as.
+        template<typename T>
+        struct mapped_edm_type;
+
+        template<> struct mapped_edm_type<std::vector<uint8_t>> { static const edm_type value = edm_type::binary; };
+        template<> struct mapped_edm_type<bool> { static const edm_type value = edm_type::boolean; };
+        template<> struct mapped_edm_type<utility::datetime> { static const edm_type value = edm_type::datetime; };
+        template<> struct mapped_edm_type<double> { static const edm_type value = edm_type::double_floating_point; };
+        template<> struct mapped_edm_type<utility::uuid> { static const edm_type value = edm_type::guid; };
+        template<> struct mapped_edm_type<int32_t> { static const edm_type value = edm_type::int32; };
+        template<> struct mapped_edm_type<int64_t> { static const edm_type value = edm_type::int64; };
+        template<> struct mapped_edm_type<utility::string_t> { static const edm_type value = edm_type::string; };
+
+        // Locates a data member of a mapped type in an object passed as an untyped pointer. The member pointer is kept as raw bytes and
+        // read back by a function instantiated for its exact type, so locating a member is a single direct call.
+        class member_locator
+        {
+        public:
+
+            member_locator()
+                : m_locate(nullptr)
+            {
+            }
+
+            template<typename T, typename V>
+            explicit member_locator(V T::* member)
+                : m_locate(&locate<T, V>)
+            {
+                static_assert(sizeof(member) <= sizeof(m_member), "The member pointer does not fit in a member_locator.");
+                std::memcpy(m_member, &member, sizeof(member));
+            }
+
+            bool empty() const
+            {
+                return m_locate == nullptr;
+            }
+
+            void* operator()(void* entity) const
+            {
+                return m_locate(entity, m_member);
+            }
+
+        private:
+
+            template<typename T, typename V>
+            static void* locate(void* entity, const unsigned char* storage)
+            {
+                V T::* member;
+                std::memcpy(&member, storage, sizeof(member));
+                return &(static_cast<T*>(entity)->*member);
+            }
+
+            void* (*m_locate)(void* entity, const unsigned char* storage);
+            unsigned char m_member[16];
+        };
+    }
+
+    /// <summary>
+    /// Describes how an application type is stored as a table entity, independently of the type itself.
+    /// </summary>
+    /// <remarks>
+    /// Instances are created through <see cref="azure::storage::table_entity_mapping" />. Entities are passed as untyped pointers
+    /// to objects of the mapped type.
+    /// </remarks>
+    class table_entity_schema
+    {
+    public:
+
+        /// <summary>
+        /// Describes a single mapped property.
+        /// </summary>
+        struct property_field
+        {
+            /// <summary>
+            /// The name of the property.
+            /// </summary>
+            utility::string_t name;
+
+            /// <summary>
+            /// The name of the property, encoded as UTF-8 so that it can be matched against the response without conversion.
+            /// </summary>
+            std::string utf8_name;
+
+            /// <summary>
+            /// The EDM type the property is stored as, which also determines the type of the member.
+            /// </summary>
+            edm_type type;
+
+            /// <summary>
+            /// Locates the member holding the property in an entity.
+            /// </summary>
+            core::member_locator member;
+        };
+
+        /// <summary>
+        /// Gets the mapped properties, other than the partition key, row key, timestamp and ETag.
+        /// </summary>
+        /// <returns>The mapped properties, in the order they were added.</returns>
+        const std::vector<property_field>& properties() const
+        {
+            return m_properties;
+        }
+
+        /// <summary>
+        /// Finds a mapped property by its name.
+        /// </summary>
+        /// <param name="utf8_name">The name of the property, encoded as UTF-8.</param>
+        /// <returns>A pointer to the mapped property, or <c>nullptr</c> if no property has that name.</returns>
+        const property_field* find_property(const std::string& utf8_name) const
+        {
+            size_t position = 0;
+            return find_property(utf8_name, position);
+        }
+
+        /// <summary>
+        /// Finds a mapped property by its name, starting at the position where the next property is expected.
+        /// </summary>
+        /// <param name="utf8_name">The name of the property, encoded as UTF-8.</param>
+        /// <param name="position">The position of the property expected next, which is updated to follow the property found.</param>
+        /// <returns>A pointer to the mapped property, or <c>nullptr</c> if no property has that name.</returns>
+        /// <remarks>
+        /// The service returns the properties of every entity in the same order, so passing the same position for all members of an entity
+        /// finds each of them with a single comparison once they were mapped in that order.
+        /// </remarks>
+        const property_field* find_property(const std::string& utf8_name, size_t& position) const
+        {
+            size_t count = m_properties.size();
+            if (position < count && !m_shadowed[position] && m_properties[position].utf8_name == utf8_name)
+            {
+                return &m_properties[position++];
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (m_properties[i].utf8_name == utf8_name)
+                {
+                    position = i + 1;
+                    return &m_properties[i];
+                }
+            }
+
+            return nullptr;
+        }
+
+        /// <summary>
+        /// Gets the partition key member of an entity.
+        /// </summary>
+        /// <param name="entity">A pointer to an object of the mapped type.</param>
+        /// <returns>A pointer to the member holding the partition key.</returns>
+        utility::string_t* partition_key(void* entity) const
+        {
+            return static_cast<utility::string_t*>(m_partition_key(entity));
+        }
+
+        /// <summary>
+        /// Gets the row key member of an entity.
+        /// </summary>
+        /// <param name="entity">A pointer to an object of the mapped type.</param>
+        /// <returns>A pointer to the member holding the row key.</returns>
+        utility::string_t* row_key(void* entity) const
+        {
+            return static_cast<utility::string_t*>(m_row_key(entity));
+        }
+
+        /// <summary>
+        /// Gets the ETag member of an entity.
+        /// </summary>
+        /// <param name="entity">A pointer to an object of the mapped type.</param>
+        /// <returns>A pointer to the member holding the ETag, or <c>nullptr</c> if the ETag is not mapped.</returns>
+        utility::string_t* etag(void* entity) const
+        {
+            return m_etag.empty() ? nullptr : static_cast<utility::string_t*>(m_etag(entity));
+        }
+
+        /// <summary>
+        /// Gets the timestamp member of an entity.
+        /// </summary>
+        /// <param name="entity">A pointer to an object of the mapped type.</param>
+        /// <returns>A pointer to the member holding the timestamp, or <c>nullptr</c> if the timestamp is not mapped.</returns>
+        utility::datetime* timestamp(void* entity) const
+        {
+            return m_timestamp.empty() ? nullptr : static_cast<utility::datetime*>(m_timestamp(entity));
+        }
+
+    protected:
+
+        table_entity_schema()
+        {
+        }
+
+        std::vector<property_field> m_properties;
+        core::member_locator m_partition_key;
+        core::member_locator m_row_key;
+        core::member_locator m_etag;
+        core::member_locator m_timestamp;
+
+        // Set for the properties whose name was mapped before, since only the first mapping of a name is read.
+        std::vector<bool> m_shadowed;
+    };
+
+    /// <summary>
+    /// Specialize this template for an application type to read and write it as a table entity.
+    /// </summary>
+    /// <remarks>
+    /// The specialization must provide a static function <c>void map(table_entity_mapping&lt;T&gt;&amp; mapping)</c> that maps at least the
+    /// partition key and the row key, for example:
+    /// <code>
+    /// template&lt;&gt; struct table_entity_traits&lt;order&gt;
+    /// {
+    ///     static void map(table_entity_mapping&lt;order&gt;&amp; mapping)
+    ///     {
+    ///         mapping.partition_key(&amp;order::customer).row_key(&amp;order::id).property(_XPLATSTR("Total"), &amp;order::total);
+    ///     }
+    /// };
+    /// </code>
+    /// </remarks>
+    template<typename T>
+    struct table_entity_traits;
+
+    /// <summary>
+    /// Maps the members of an application type to the properties of a table entity.
+    /// </summary>
+    /// <typeparam name="T">The application type, which must be default-constructible.</typeparam>
+    template<typename T>
+    class table_entity_mapping : public table_entity_schema
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_entity_mapping" /> class from the specialization of
+        /// <see cref="azure::storage::table_entity_traits" /> for the type.
+        /// </summary>
+        table_entity_mapping()
+        {
+            table_entity_traits<T>::map(*this);
+
+            if (m_partition_key.empty() || m_row_key.empty())
+            {
+                throw std::logic_error("A table entity mapping must map both the partition key and the row key.");
+            }
+        }
+
+        /// <summary>
+        /// Maps the partition key.
+        /// </summary>
+        /// <param name="member">The member holding the partition key.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& partition_key(utility::string_t T::* member)
+        {
+            m_partition_key = core::member_locator(member);
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the row key.
+        /// </summary>
+        /// <param name="member">The member holding the row key.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& row_key(utility::string_t T::* member)
+        {
+            m_row_key = core::member_locator(member);
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the ETag, which is then used for optimistic concurrency and updated by every operation.
+        /// </summary>
+        /// <param name="member">The member holding the ETag.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& etag(utility::string_t T::* member)
+        {
+            m_etag = core::member_locator(member);
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps the timestamp, which is read from the service but never written.
+        /// </summary>
+        /// <param name="member">The member holding the timestamp.</param>
+        /// <returns>A reference to this mapping.</returns>
+        table_entity_mapping& timestamp(utility::datetime T::* member)
+        {
+            m_timestamp = core::member_locator(member);
+            return *this;
+        }
+
+        /// <summary>
+        /// Maps a property. The EDM type is derived from the member type.
+        /// </summary>
+        /// <param name="name">The name of the property.</param>
+        /// <param name="member">The member holding the property value.</param>
+        /// <returns>A reference to this mapping.</returns>
+        template<typename V>
+        table_entity_mapping& property(utility::string_t name, V T::* member)
+        {
+            property_field field;
+            field.utf8_name = utility::conversions::to_utf8string(name);
+            field.name = std::move(name);
+            field.type = core::mapped_edm_type<V>::value;
+            field.member = core::member_locator(member);
+            m_shadowed.push_back(find_property(field.utf8_name) != nullptr);
+            m_properties.push_back(std::move(field));
+            return *this;
+        }
+
+        /// <summary>
+        /// Gets the mapping for the type, which is built the first time it is requested and shared by every operation afterwards.
+        /// </summary>
+        /// <returns>The shared mapping for the type.</returns>
+        static std::shared_ptr<const table_entity_mapping<T>> instance()
+        {
+            static const std::shared_ptr<const table_entity_mapping<T>> mapping = std::make_shared<const table_entity_mapping<T>>();
+            return mapping;
+        }
     };
 
     /// <summary>
@@ -1501,68 +1953,282 @@ namespace azure { namespace storage {
     };
 
     /// <summary>
-    /// Represents the result of a table operation.
+    /// Represents a read-only view of an entity in a <see cref="azure::storage::table_entity_record_segment" />.
     /// </summary>
-    /// <remarks>The <see cref="azure::storage::table_result" /> class encapsulates the HTTP response and any query 
-    /// results returned for a particular <see cref="azure::storage::table_operation" />.</remarks>
-    class table_result
+    /// <remarks>The records in a segment share one character buffer holding their keys, ETags and textual property values, and each
+    /// property name is stored in it once per segment. A record owns no strings of its own: its keys, ETag and property names are
+    /// returned as views into the buffer, so reading them does not allocate. <see cref="azure::storage::table_entity_record::property_value" />
+    /// and <see cref="azure::storage::table_entity_record::to_entity" /> copy values out into owning objects.</remarks>
+    class table_entity_record
     {
     public:
 
         /// <summary>
-        /// Initializes a new instance of the <see cref="azure::storage::table_result" /> class.
+        /// Initializes a new instance of the <see cref="azure::storage::table_entity_record" /> class.
         /// </summary>
-        table_result()
-            : m_http_status_code(0)
+        table_entity_record()
+            : m_first_property(0), m_property_count(0)
         {
         }
 
-#if defined(_MSC_VER) && _MSC_VER < 1900
-        // Compilers that fully support C++ 11 rvalue reference, e.g. g++ 4.8+, clang++ 3.3+ and Visual Studio 2015+, 
-        // have implicitly-declared move constructor and move assignment operator.
-
         /// <summary>
-        /// Initializes a new instance of the <see cref="azure::storage::table_result" /> class based on an existing instance.
+        /// Gets the partition key of the entity.
         /// </summary>
-        /// <param name="other">An existing <see cref="azure::storage::table_result" /> object.</param>
-        table_result(table_result&& other)
+        /// <returns>A <see cref="azure::storage::text_view" /> of the entity's partition key.</returns>
+        text_view partition_key() const
         {
-            *this = std::move(other);
+            return text(m_partition_key);
         }
 
         /// <summary>
-        /// Returns a reference to an <see cref="azure::storage::table_result" /> object.
+        /// Gets the row key of the entity.
         /// </summary>
-        /// <param name="other">An existing <see cref="azure::storage::table_result" /> object to use to set properties.</param>
-        /// <returns>An <see cref="azure::storage::table_result" /> object with properties set.</returns>
-        table_result& operator=(table_result&& other)
+        /// <returns>A <see cref="azure::storage::text_view" /> of the entity's row key.</returns>
+        text_view row_key() const
         {
-            if (this != &other)
-            {
-                m_entity = std::move(other.m_entity);
-                m_http_status_code = std::move(other.m_http_status_code);
-                m_etag = std::move(other.m_etag);
-            }
-            return *this;
+            return text(m_row_key);
         }
-#endif
 
         /// <summary>
-        /// Gets an <see cref="azure::storage::table_entity" /> object returned as part of an <see cref="azure::storage::table_result" /> object.
+        /// Gets the ETag of the entity.
         /// </summary>
-        /// <returns>An <see cref="azure::storage::table_entity" /> object.</returns>
-        const azure::storage::table_entity& entity() const
+        /// <returns>A <see cref="azure::storage::text_view" /> of the entity's ETag value, as a string.</returns>
+        text_view etag() const
         {
-            return m_entity;
+            return text(m_etag);
         }
 
         /// <summary>
-        /// Sets an <see cref="azure::storage::table_entity" /> object returned as part of an <see cref="azure::storage::table_result" /> object.
+        /// Gets the entity's timestamp.
         /// </summary>
-        /// <param name="value">An <see cref="azure::storage::table_entity" /> object.</param>
-        void set_entity(azure::storage::table_entity value)
+        /// <returns>The entity's timestamp.</returns>
+        utility::datetime timestamp() const
         {
-            m_entity = std::move(value);
+            return m_timestamp;
+        }
+
+        /// <summary>
+        /// Gets the number of properties of the entity.
+        /// </summary>
+        /// <returns>The number of properties, not counting the partition key, row key and timestamp.</returns>
+        size_t property_count() const
+        {
+            return m_property_count;
+        }
+
+        /// <summary>
+        /// Gets the name of a property of the entity.
+        /// </summary>
+        /// <param name="index">The index of the property, which must be less than <see cref="azure::storage::table_entity_record::property_count" />.</param>
+        /// <returns>A <see cref="azure::storage::text_view" /> of the property name, which is shared by every record in the segment that has the property.</returns>
+        text_view property_name(size_t index) const
+        {
+            return text(m_arena->names[m_arena->properties[m_first_property + index].name]);
+        }
+
+        /// <summary>
+        /// Gets the value of a property of the entity.
+        /// </summary>
+        /// <param name="index">The index of the property, which must be less than <see cref="azure::storage::table_entity_record::property_count" />.</param>
+        /// <returns>An <see cref="azure::storage::entity_property" /> object holding a copy of the property value.</returns>
+        /// <remarks>Values held as text, such as strings, byte arrays and GUIDs, are copied into the returned object.</remarks>
+        WASTORAGE_API entity_property property_value(size_t index) const;
+
+        /// <summary>
+        /// Finds a property of the entity by name.
+        /// </summary>
+        /// <param name="name">The name of the property.</param>
+        /// <returns>The index of the property, or <see cref="azure::storage::table_entity_record::property_count" /> if the entity has no property with that name.</returns>
+        WASTORAGE_API size_t find_property(const utility::string_t& name) const;
+
+        /// <summary>
+        /// Copies the record into an owning <see cref="azure::storage::table_entity" /> object.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::table_entity" /> object with the keys, ETag, timestamp and properties of the record.</returns>
+        WASTORAGE_API table_entity to_entity() const;
+
+    private:
+
+        union native_value
+        {
+            bool boolean;
+            int32_t int32;
+            int64_t int64;
+            double double_floating_point;
+            utility::datetime::interval_type datetime_interval;
+        };
+
+        // The offset and length of a string in the character buffer of the arena
+        struct text_range
+        {
+            text_range()
+                : offset(0), length(0)
+            {
+            }
+
+            size_t offset;
+            size_t length;
+        };
+
+        // A property value is held in its native form when it has one, and otherwise as text, which is how binary and GUID values are kept
+        struct property_data
+        {
+            size_t name;
+            edm_type type;
+            bool is_null;
+            bool has_native;
+            native_value native;
+            text_range value;
+        };
+
+        // Shared by all records of a segment. Property names are indexes into names, which hold each distinct name once.
+        struct arena
+        {
+            utility::string_t text;
+            std::vector<text_range> names;
+            std::vector<property_data> properties;
+        };
+
+        text_view text(const text_range& range) const
+        {
+            // A default-constructed record has no arena, and all of its strings are empty
+            if (range.length == 0)
+            {
+                return text_view();
+            }
+
+            return text_view(m_arena->text.data() + range.offset, range.length);
+        }
+
+        std::shared_ptr<const arena> m_arena;
+        text_range m_partition_key;
+        text_range m_row_key;
+        text_range m_etag;
+        utility::datetime m_timestamp;
+        size_t m_first_property;
+        size_t m_property_count;
+
+        friend class protocol::table_entity_json_reader;
+    };
+
+    /// <summary>
+    /// Represents a range of partition keys, from an inclusive lower bound to an exclusive upper bound, that a parallel table scan queries on its own.
+    /// </summary>
+    class table_partition_key_range
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_partition_key_range" /> class that covers every partition key.
+        /// </summary>
+        table_partition_key_range()
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_partition_key_range" /> class.
+        /// </summary>
+        /// <param name="lower_bound">The lowest partition key in the range, or an empty string for no lower bound.</param>
+        /// <param name="upper_bound">The partition key just past the range, or an empty string for no upper bound.</param>
+        table_partition_key_range(utility::string_t lower_bound, utility::string_t upper_bound)
+            : m_lower_bound(std::move(lower_bound)), m_upper_bound(std::move(upper_bound))
+        {
+        }
+
+        /// <summary>
+        /// Gets the lowest partition key in the range.
+        /// </summary>
+        /// <returns>The inclusive lower bound, or an empty string if the range has no lower bound.</returns>
+        const utility::string_t& lower_bound() const
+        {
+            return m_lower_bound;
+        }
+
+        /// <summary>
+        /// Gets the partition key just past the range.
+        /// </summary>
+        /// <returns>The exclusive upper bound, or an empty string if the range has no upper bound.</returns>
+        const utility::string_t& upper_bound() const
+        {
+            return m_upper_bound;
+        }
+
+        /// <summary>
+        /// Splits the whole partition key space into contiguous ranges at the specified partition keys.
+        /// </summary>
+        /// <param name="split_points">The partition keys at which a new range starts, in any order. Duplicates and empty strings are ignored.</param>
+        /// <returns>The ranges, in key order. There is one more range than there are distinct split points.</returns>
+        WASTORAGE_API static std::vector<table_partition_key_range> split(std::vector<utility::string_t> split_points);
+
+    private:
+
+        utility::string_t m_lower_bound;
+        utility::string_t m_upper_bound;
+    };
+
+    /// <summary>
+    /// Represents the result of a table operation.
+    /// </summary>
+    /// <remarks>The <see cref="azure::storage::table_result" /> class encapsulates the HTTP response and any query 
+    /// results returned for a particular <see cref="azure::storage::table_operation" />.</remarks>
+    class table_result
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_result" /> class.
+        /// </summary>
+        table_result()
+            : m_http_status_code(0)
+        {
+        }
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+        // Compilers that fully support C++ 11 rvalue reference, e.g. g++ 4.8+, clang++ 3.3+ and Visual Studio 2015+, 
+        // have implicitly-declared move constructor and move assignment operator.
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_result" /> class based on an existing instance.
+        /// </summary>
+        /// <param name="other">An existing <see cref="azure::storage::table_result" /> object.</param>
+        table_result(table_result&& other)
+        {
+            *this = std::move(other);
+        }
+
+        /// <summary>
+        /// Returns a reference to an <see cref="azure::storage::table_result" /> object.
+        /// </summary>
+        /// <param name="other">An existing <see cref="azure::storage::table_result" /> object to use to set properties.</param>
+        /// <returns>An <see cref="azure::storage::table_result" /> object with properties set.</returns>
+        table_result& operator=(table_result&& other)
+        {
+            if (this != &other)
+            {
+                m_entity = std::move(other.m_entity);
+                m_http_status_code = std::move(other.m_http_status_code);
+                m_etag = std::move(other.m_etag);
+            }
+            return *this;
+        }
+#endif
+
+        /// <summary>
+        /// Gets an <see cref="azure::storage::table_entity" /> object returned as part of an <see cref="azure::storage::table_result" /> object.
+        /// </summary>
+        /// <returns>An <see cref="azure::storage::table_entity" /> object.</returns>
+        const azure::storage::table_entity& entity() const
+        {
+            return m_entity;
+        }
+
+        /// <summary>
+        /// Sets an <see cref="azure::storage::table_entity" /> object returned as part of an <see cref="azure::storage::table_result" /> object.
+        /// </summary>
+        /// <param name="value">An <see cref="azure::storage::table_entity" /> object.</param>
+        void set_entity(azure::storage::table_entity value)
+        {
+            m_entity = std::move(value);
         }
 
         /// <summary>
@@ -1614,6 +2280,8 @@ namespace azure { namespace storage {
     typedef result_segment<table_entity> table_query_segment;
     typedef result_iterator<table_entity> table_query_iterator;
 
+    typedef result_segment<table_entity_record> table_entity_record_segment;
+
     /// <summary>
     /// Provides a client-side logical representation of the Windows Azure Table service. 
     /// This client is used to configure and execute requests against the Table service.
@@ -1734,6 +2402,22 @@ namespace azure { namespace storage {
         /// <returns>An <see cref="azure::storage::table_result_iterator" /> that can be used to to lazily enumerate a collection of tables.</returns>
         WASTORAGE_API table_result_iterator list_tables(const utility::string_t& prefix, utility::size64_t max_results, const table_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Initiates an asynchronous operation to enumerate the tables that begin with the specified prefix, passing each table to a callback.
+        /// </summary>
+        /// <param name="prefix">The table name prefix.</param>
+        /// <param name="max_results">A non-negative integer value that indicates the maximum number of results to be returned.
+        /// If this value is zero, the maximum possible number of results will be returned.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::cloud_table" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Segments are requested through the asynchronous segmented listing. Up to <see cref="azure::storage::request_options::listing_prefetch_depth" />
+        /// segments are requested ahead of the one being delivered, and the callback is never invoked concurrently.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> list_tables_async(const utility::string_t& prefix, utility::size64_t max_results, const std::function<void(const cloud_table&)>& item_callback, const table_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Returns an <see cref="azure::storage::table_result_segment" /> containing an enumerable collection of tables.
         /// </summary>
@@ -2110,6 +2794,20 @@ namespace azure { namespace storage {
         /// <returns>An <see cref="azure::storage::table_query_iterator" /> that can be used to to lazily enumerate a collection of <see cref="azure::storage::table_entity" /> objects.</returns>
         WASTORAGE_API table_query_iterator execute_query(const table_query& query, const table_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Initiates an asynchronous operation that executes a query on a table, passing each entity to a callback.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="item_callback">A function invoked with each <see cref="azure::storage::table_entity" />, in the order the service returned them.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Segments are requested through the asynchronous segmented listing. Up to <see cref="azure::storage::request_options::listing_prefetch_depth" />
+        /// segments are requested ahead of the one being delivered, and the callback is never invoked concurrently.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> execute_query_async(const table_query& query, const std::function<void(const table_entity&)>& item_callback, const table_request_options& options, operation_context context) const;
+
         /// <summary>
         /// Executes a query with the specified <see cref="azure::storage::continuation_token" /> to retrieve the next page of results.
         /// </summary>
@@ -2155,6 +2853,192 @@ namespace azure { namespace storage {
         /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result_segment" /> that represents the current operation.</returns>
         WASTORAGE_API pplx::task<table_query_segment> execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const;
 
+        /// <summary>
+        /// Executes a query with the specified <see cref="azure::storage::continuation_token" /> to retrieve the next page of results as entity records.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>An <see cref="azure::storage::table_entity_record_segment" /> object containing the results of the query.</returns>
+        table_entity_record_segment execute_query_records_segmented(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const
+        {
+            return execute_query_records_segmented_async(query, token, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query with the specified <see cref="azure::storage::continuation_token" /> to retrieve the next page of results as entity records.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation. This object is used to track requests to the storage service, and to provide additional runtime information about the operation. </param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_entity_record_segment" /> that represents the current operation.</returns>
+        /// <remarks>The records in the segment share their storage, which suits segments of many entities that are read once; see <see cref="azure::storage::table_entity_record" />.</remarks>
+        WASTORAGE_API pplx::task<table_entity_record_segment> execute_query_records_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Executes a query on a table by querying several partition key ranges in parallel.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="ranges">The partition key ranges to query, which must not overlap. Entities outside all ranges are not returned.</param>
+        /// <param name="key_order"><c>true</c> to deliver entities in key order; <c>false</c> to deliver them as soon as each range returns them.</param>
+        /// <param name="entity_callback">A function invoked with each <see cref="azure::storage::table_entity" />. It is never invoked concurrently.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        void execute_query_parallel(const table_query& query, const std::vector<table_partition_key_range>& ranges, bool key_order, const std::function<void(table_entity)>& entity_callback, const table_request_options& options, operation_context context) const
+        {
+            execute_query_parallel_async(query, ranges, key_order, entity_callback, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query on a table by querying several partition key ranges in parallel.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="ranges">The partition key ranges to query, which must not overlap. Entities outside all ranges are not returned.</param>
+        /// <param name="key_order"><c>true</c> to deliver entities in key order; <c>false</c> to deliver them as soon as each range returns them.</param>
+        /// <param name="entity_callback">A function invoked with each <see cref="azure::storage::table_entity" />. It is never invoked concurrently.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// Each range is queried with the filter of <paramref name="query" /> narrowed to the range, following its own continuation tokens, and the number of
+        /// requests in flight is bounded by <see cref="azure::storage::table_request_options::parallelism_factor" />. The take count of the query limits each
+        /// request rather than the total. When <paramref name="key_order" /> is <c>true</c>, entities of a range are buffered until every range before it completes.
+        /// Ranges can be created with <see cref="azure::storage::table_partition_key_range::split" />.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> execute_query_parallel_async(const table_query& query, const std::vector<table_partition_key_range>& ranges, bool key_order, const std::function<void(table_entity)>& entity_callback, const table_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Deletes every entity that a query returns.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object that selects the entities to delete.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>The number of entities deleted.</returns>
+        size_t delete_entities(const table_query& query, const table_request_options& options, operation_context context) const
+        {
+            return delete_entities_async(query, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that deletes every entity that a query returns.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object that selects the entities to delete.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="size_t" /> that represents the current operation, and holds the number of entities deleted.</returns>
+        /// <remarks>
+        /// Only the keys and ETags of the entities are queried, and the deletes are sent in batches per partition, as by a <see cref="azure::storage::table_batch_writer" />,
+        /// while the next segment of the query is requested. Each delete is conditional on the ETag the query returned, so an entity that is changed in the meantime
+        /// is not deleted. Because a response without metadata carries no ETags, a <see cref="azure::storage::table_payload_format::json_no_metadata" />
+        /// payload format is replaced by minimal metadata for this operation. The take count of the query limits each request rather than the total.
+        /// If any delete fails, the task fails with the first <see cref="azure::storage::storage_exception" /> encountered once every other delete
+        /// has been executed.
+        /// </remarks>
+        WASTORAGE_API pplx::task<size_t> delete_entities_async(const table_query& query, const table_request_options& options, operation_context context) const;
+
+        /// <summary>
+        /// Executes an operation on a table for an entity of an application type described by <see cref="azure::storage::table_entity_traits" />.
+        /// </summary>
+        /// <param name="operation_type">The type of operation to execute.</param>
+        /// <param name="entity">The entity, which is read for write operations, filled in by retrieve operations, and whose mapped ETag is updated.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="azure::storage::table_result" /> containing the result of executing the operation on the table. Its entity is left empty.</returns>
+        template<typename T>
+        table_result execute(table_operation_type operation_type, T& entity, const table_request_options& options, operation_context context) const
+        {
+            return execute_async(operation_type, entity, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes an operation on a table for an entity of an application type described by
+        /// <see cref="azure::storage::table_entity_traits" />.
+        /// </summary>
+        /// <param name="operation_type">The type of operation to execute.</param>
+        /// <param name="entity">The entity, which is read for write operations, filled in by retrieve operations, and whose mapped ETag is updated.
+        /// It must remain valid until the operation completes.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::table_result" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// The entity is serialized straight from its members and retrieved entities are deserialized straight into them, without a
+        /// <see cref="azure::storage::table_entity" /> in between. A retrieve that finds no entity leaves it unchanged and reports status code 404.
+        /// </remarks>
+        template<typename T>
+        pplx::task<table_result> execute_async(table_operation_type operation_type, T& entity, const table_request_options& options, operation_context context) const
+        {
+            return execute_async_impl(operation_type, &entity, table_entity_mapping<T>::instance(), options, context);
+        }
+
+        /// <summary>
+        /// Executes a query on a table, returning entities of an application type described by <see cref="azure::storage::table_entity_traits" />.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="azure::storage::result_iterator" /> over the entities that match the query.</returns>
+        template<typename T>
+        result_iterator<T> execute_query(const table_query& query, const table_request_options& options, operation_context context) const
+        {
+            table_request_options modified_options = get_modified_options(options);
+
+            auto instance = std::make_shared<cloud_table>(*this);
+            return result_iterator<T>(
+                [instance, query, options, context](const continuation_token& token, size_t)
+            {
+                return instance->execute_query_segmented_async<T>(query, token, options, context);
+            },
+                query.take_count() <= 0 ? 0 : query.take_count(), 0, modified_options.listing_prefetch_depth());
+        }
+
+        /// <summary>
+        /// Executes a query with the specified <see cref="azure::storage::continuation_token" /> to retrieve the next page of results, as entities of an
+        /// application type described by <see cref="azure::storage::table_entity_traits" />.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="azure::storage::result_segment" /> containing the entities and a continuation token for the next page.</returns>
+        template<typename T>
+        result_segment<T> execute_query_segmented(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const
+        {
+            return execute_query_segmented_async<T>(query, token, options, context).get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that executes a query with the specified <see cref="azure::storage::continuation_token" /> to retrieve
+        /// the next page of results, as entities of an application type described by <see cref="azure::storage::table_entity_traits" />.
+        /// </summary>
+        /// <param name="query">An <see cref="azure::storage::table_query" /> object.</param>
+        /// <param name="token">An <see cref="azure::storage::continuation_token" /> object.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the request.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the current operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object of type <see cref="azure::storage::result_segment" /> that represents the current operation.</returns>
+        /// <remarks>
+        /// Entities are deserialized from the response straight into the members of the mapped type, without a <see cref="azure::storage::table_entity" /> in between.
+        /// Properties that are not mapped are ignored.
+        /// </remarks>
+        template<typename T>
+        pplx::task<result_segment<T>> execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const
+        {
+            auto entities = std::make_shared<std::vector<T>>();
+            return execute_query_segmented_async_impl(query, token, table_entity_mapping<T>::instance(), [entities] () -> void*
+            {
+                entities->push_back(T());
+                return &entities->back();
+            },
+            [entities] ()
+            {
+                entities->clear();
+            }, options, context).then([entities] (continuation_token next_token) -> result_segment<T>
+            {
+                return result_segment<T>(std::move(*entities), std::move(next_token));
+            });
+        }
+
         /// <summary>
         /// Creates a table.
         /// </summary>
@@ -2479,10 +3363,12 @@ namespace azure { namespace storage {
         static cloud_table_client create_service_client(const storage_uri& uri, storage_credentials credentials);
         static utility::string_t read_table_name(const storage_uri& uri);
         static storage_uri create_uri(const storage_uri& uri);
-        table_request_options get_modified_options(const table_request_options& options) const;
+        WASTORAGE_API table_request_options get_modified_options(const table_request_options& options) const;
         pplx::task<bool> create_async_impl(const table_request_options& options, operation_context context, bool allow_conflict);
         pplx::task<bool> delete_async_impl(const table_request_options& options, operation_context context, bool allow_not_found);
         pplx::task<bool> exists_async_impl(const table_request_options& options, operation_context context, bool allow_secondary) const;
+        WASTORAGE_API pplx::task<table_result> execute_async_impl(table_operation_type operation_type, void* entity, std::shared_ptr<const table_entity_schema> schema, const table_request_options& options, operation_context context) const;
+        WASTORAGE_API pplx::task<continuation_token> execute_query_segmented_async_impl(const table_query& query, const continuation_token& token, std::shared_ptr<const table_entity_schema> schema, std::function<void*()> add_entity, std::function<void()> clear_entities, const table_request_options& options, operation_context context) const;
 
         cloud_table_client m_client;
         utility::string_t m_name;
@@ -2491,4 +3377,174 @@ namespace azure { namespace storage {
         friend class cloud_table_client;
     };
 
+    namespace core
+    {
+        class table_batch_dispatcher;
+        class table_write_coalescer;
+    }
+
+    /// <summary>
+    /// Writes a stream of table operations as entity group transactions, grouping the operations by partition key.
+    /// </summary>
+    /// <remarks>
+    /// Operations are buffered per partition key and sent as a batch once the batch reaches 100 operations or its request body approaches the
+    /// 4 MB limit, or when the writer is flushed. Batches for different partitions are sent in parallel, bounded by
+    /// <see cref="azure::storage::table_request_options::parallelism_factor" />, while the batches of a single partition are sent in the order
+    /// the operations were added. Operations spread over many partitions do not accumulate without bound: once 1000 operations are waiting in
+    /// batches that are not full yet, the batch that was started first is sent. When the service rejects a batch because of one of its
+    /// operations, that operation fails by itself and the operations around it are sent again in smaller batches. The first failure is
+    /// reported by <see cref="azure::storage::table_batch_writer::flush_async" />.
+    /// </remarks>
+    class table_batch_writer
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_batch_writer" /> class.
+        /// </summary>
+        /// <param name="table">The table to write to.</param>
+        explicit table_batch_writer(cloud_table table)
+            : table_batch_writer(std::move(table), table_request_options(), operation_context())
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_batch_writer" /> class.
+        /// </summary>
+        /// <param name="table">The table to write to.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        WASTORAGE_API table_batch_writer(cloud_table table, const table_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Sends the operations that are still buffered, without waiting for them.
+        /// </summary>
+        /// <remarks>
+        /// The failures of operations sent after the last flush cannot be reported, so the writer should be flushed before it is destroyed.
+        /// Copies of a writer share its buffered operations, and destroying any of them sends them.
+        /// </remarks>
+        WASTORAGE_API ~table_batch_writer();
+
+        /// <summary>
+        /// Adds an operation to the writer.
+        /// </summary>
+        /// <param name="operation">The operation to add, which cannot be a retrieve operation.</param>
+        void add(table_operation operation)
+        {
+            add_async(std::move(operation)).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that adds an operation to the writer.
+        /// </summary>
+        /// <param name="operation">The operation to add, which cannot be a retrieve operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// The task completes as soon as the operation is buffered, unless too many batches are waiting to be sent, in which case it completes once
+        /// one of them finishes. Waiting for the task keeps a fast producer from buffering an unbounded number of operations.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> add_async(table_operation operation);
+
+        /// <summary>
+        /// Sends all buffered operations and waits for every outstanding batch to finish.
+        /// </summary>
+        void flush()
+        {
+            flush_async().get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that sends all buffered operations and waits for every outstanding batch to finish.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// If any operation failed since the previous flush, the task fails with the first <see cref="azure::storage::storage_exception" /> encountered.
+        /// The other operations have been executed regardless.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> flush_async();
+
+    private:
+
+        std::shared_ptr<core::table_batch_dispatcher> m_dispatcher;
+    };
+
+    /// <summary>
+    /// Buffers writes to frequently updated entities, and combines the writes to each entity that arrive within a time window into one operation.
+    /// </summary>
+    /// <remarks>
+    /// The window starts with the first write that is buffered and ends after the specified duration, when every buffered write is sent in batches
+    /// grouped by partition, as by a <see cref="azure::storage::table_batch_writer" />, so a write is never delayed by much more than the window.
+    /// Insert-or-merge and insert-or-replace operations, and merge and replace operations whose ETag is empty or "*", are combined when the
+    /// result has the same effect as executing them in order. Operations with a specific ETag are never combined, so the service always checks
+    /// their precondition: they are sent after any buffered write to the same entity. Insert and delete operations are sent the same way.
+    /// Operations that are not combined also start a window if none is open, and are sent no later than when it ends.
+    /// Failures are reported by <see cref="azure::storage::table_write_cache::flush_async" />.
+    /// </remarks>
+    class table_write_cache
+    {
+    public:
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_write_cache" /> class.
+        /// </summary>
+        /// <param name="table">The table to write to.</param>
+        /// <param name="window">The time for which writes are buffered and combined before they are sent, which must be positive.</param>
+        table_write_cache(cloud_table table, std::chrono::milliseconds window)
+            : table_write_cache(std::move(table), window, table_request_options(), operation_context())
+        {
+        }
+
+        /// <summary>
+        /// Initializes a new instance of the <see cref="azure::storage::table_write_cache" /> class.
+        /// </summary>
+        /// <param name="table">The table to write to.</param>
+        /// <param name="window">The time for which writes are buffered and combined before they are sent, which must be positive.</param>
+        /// <param name="options">An <see cref="azure::storage::table_request_options" /> object that specifies additional options for the requests.</param>
+        /// <param name="context">An <see cref="azure::storage::operation_context" /> object that represents the context for the requests.</param>
+        WASTORAGE_API table_write_cache(cloud_table table, std::chrono::milliseconds window, const table_request_options& options, operation_context context);
+
+        /// <summary>
+        /// Writes an entity through the cache.
+        /// </summary>
+        /// <param name="operation">The operation to execute, which cannot be a retrieve operation.</param>
+        void write(table_operation operation)
+        {
+            write_async(std::move(operation)).wait();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that writes an entity through the cache.
+        /// </summary>
+        /// <param name="operation">The operation to execute, which cannot be a retrieve operation.</param>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// The task completes once the operation is buffered. When operations have to be sent, it can take longer for the same reason as
+        /// <see cref="azure::storage::table_batch_writer::add_async" />.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> write_async(table_operation operation);
+
+        /// <summary>
+        /// Sends all buffered writes and waits for every outstanding batch to finish.
+        /// </summary>
+        void flush()
+        {
+            flush_async().get();
+        }
+
+        /// <summary>
+        /// Intitiates an asynchronous operation that sends all buffered writes and waits for every outstanding batch to finish.
+        /// </summary>
+        /// <returns>A <see cref="pplx::task" /> object that represents the current operation.</returns>
+        /// <remarks>
+        /// If any operation failed since the previous flush, the task fails with the first <see cref="azure::storage::storage_exception" /> encountered.
+        /// Writes still buffered when the cache is destroyed are sent when their window ends, but their failures cannot be reported, so the cache
+        /// should be flushed before it is destroyed.
+        /// </remarks>
+        WASTORAGE_API pplx::task<void> flush_async();
+
+    private:
+
+        std::shared_ptr<core::table_write_coalescer> m_coalescer;
+    };
+
 }} // namespace azure::storage
@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="base64.h" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "cpprest/asyncrt_utils.h"
+
+#include "wascore/basic_types.h"
+
+namespace azure { namespace storage { namespace core {
+
+    // Returns the number of characters that length bytes are encoded into.
+    inline size_t base64_encoded_length(size_t length)
+    {
+        return (length + 2) / 3 * 4;
+    }
+
+    // Returns the number of bytes that length characters decode into at most. The output buffer passed to base64_decode must be at least this large.
+    inline size_t base64_decoded_max_length(size_t length)
+    {
+        return length / 4 * 3;
+    }
+
+    // Encodes data into output, which must hold base64_encoded_length(length) characters, and returns the number of characters written. Large inputs
+    // are encoded with AVX2 or NEON instructions where the processor supports them.
+    WASTORAGE_API size_t base64_encode(const uint8_t* data, size_t length, char* output);
+
+    // Decodes padded Base64 text into output, which must hold base64_decoded_max_length(length) bytes. Returns false if the text is not valid Base64,
+    // and otherwise sets output_length to the number of bytes written.
+    WASTORAGE_API bool base64_decode(const char* text, size_t length, uint8_t* output, size_t& output_length);
+
+    void append_base64(std::string& buffer, const uint8_t* data, size_t length);
+    WASTORAGE_API utility::string_t to_base64(const uint8_t* data, size_t length);
+    WASTORAGE_API std::vector<uint8_t> from_base64(const utility::string_t& value);
+
+    inline utility::string_t to_base64(const std::vector<uint8_t>& data)
+    {
+        return to_base64(data.data(), data.size());
+    }
+
+}}} // namespace azure::storage::core
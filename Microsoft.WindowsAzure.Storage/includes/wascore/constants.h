@@ -27,7 +27,9 @@ namespace azure { namespace storage { namespace protocol {
     const size_t max_block_number = 50000;
     const utility::size64_t max_block_size = 4 * 1000 * 1024 * 1024ULL;
     const utility::size64_t max_block_blob_size = static_cast<utility::size64_t>(max_block_number) * max_block_size;
+    const utility::size64_t max_block_from_url_size = 100 * 1024 * 1024;
     const size_t max_append_block_size = 4 * 1024 * 1024;
+    const size_t max_blob_batch_size = 256;
     const size_t max_page_size = 4 * 1024 * 1024;
     const size_t max_range_size = 4 * 1024 * 1024;
     const utility::size64_t max_single_blob_upload_threshold = 5000 * 1024 * 1024ULL;
@@ -36,6 +38,7 @@ namespace azure { namespace storage { namespace protocol {
     const size_t default_stream_read_size = 4 * 1024 * 1024;
     const size_t default_buffer_size = 64 * 1024;
     const bool default_validate_certificates = true;
+    const size_t default_listing_prefetch_depth = 0;
     const utility::size64_t default_single_blob_upload_threshold = 128 * 1024 * 1024;
     const utility::size64_t default_single_blob_download_threshold = 32 * 1024 * 1024;
     const utility::size64_t default_single_block_download_threshold = 4 * 1024 * 1024;
@@ -39,6 +39,10 @@ namespace azure { namespace storage { namespace core {
             {
                 m_transaction_hash_provider = hash_provider::create_md5_hash_provider();
             }
+            else if (m_options.use_transactional_crc64())
+            {
+                m_transaction_hash_provider = hash_provider::create_crc64_hash_provider();
+            }
             if (m_options.store_file_content_md5())
             {
                 m_total_hash_provider = hash_provider::create_md5_hash_provider();
@@ -19,6 +19,7 @@
 
 #include "cpprest/streams.h"
 
+#include "wascore/base64.h"
 #include "wascore/basic_types.h"
 #include "was/core.h"
 #include "was/crc64.h"
@@ -113,7 +114,7 @@ namespace azure { namespace storage { namespace core {
 
         checksum hash() const override
         {
-            return checksum(checksum_hmac_sha256, utility::conversions::to_base64(m_hash));
+            return checksum(checksum_hmac_sha256, core::to_base64(m_hash));
         }
 
     private:
@@ -140,7 +141,7 @@ namespace azure { namespace storage { namespace core {
 
         checksum hash() const override
         {
-            return checksum(checksum_md5, utility::conversions::to_base64(m_hash));
+            return checksum(checksum_md5, core::to_base64(m_hash));
         }
 
     private:
@@ -167,7 +168,7 @@ namespace azure { namespace storage { namespace core {
 
         checksum hash() const override
         {
-            return checksum(checksum_sha256, utility::conversions::to_base64(m_hash));
+            return checksum(checksum_sha256, core::to_base64(m_hash));
         }
 
     private:
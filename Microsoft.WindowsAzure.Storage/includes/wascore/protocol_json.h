@@ -27,4 +27,136 @@ namespace azure { namespace storage { namespace protocol {
     utility::string_t parse_file_permission(const web::json::value& document);
     utility::string_t construct_file_permission(const utility::string_t& value);
 
+    // Reads table entities straight from a UTF-8 JSON response body in a single pass, without building a web::json::value document.
+    // The result is the same as parsing the body with web::json and passing it to parse_table_entity.
+    class table_entity_json_reader
+    {
+    public:
+
+        table_entity_json_reader(const std::vector<unsigned char>& body)
+            : m_current(body.data()), m_end(body.data() + body.size())
+        {
+        }
+
+        // Reads from a range within a larger buffer, such as one part of a multipart response.
+        table_entity_json_reader(const unsigned char* begin, const unsigned char* end)
+            : m_current(begin), m_end(end)
+        {
+        }
+
+        // Reads a query response of the form {"value": [entity, ...]}. Empty entity objects are skipped.
+        std::vector<table_entity> read_query_results();
+
+        // Reads a query response into records that share one arena for their text and property names. Empty entity objects are skipped.
+        std::vector<table_entity_record> read_query_records();
+
+        // Reads a response consisting of a single entity object.
+        table_entity read_entity();
+
+        // Reads a query response into objects of a mapped type. add_entity is called to create each object before its members are read.
+        void read_query_results(const table_entity_schema& schema, const std::function<void*()>& add_entity);
+
+        // Reads a response consisting of a single entity object into an object of a mapped type.
+        void read_entity(const table_entity_schema& schema, void* entity);
+
+    private:
+
+        // The kinds of members an entity object holds
+        enum class member_kind
+        {
+            etag,
+            type_annotation,
+            partition_key,
+            row_key,
+            timestamp,
+            property,
+            ignored
+        };
+
+        // The kinds of values a property can have
+        enum class value_kind
+        {
+            null_value,
+            boolean,
+            string,
+            number
+        };
+
+        // Classifies a member of an entity object by its name. The suffix of a type annotation is removed, which leaves the name of the
+        // property the annotation applies to.
+        static member_kind classify_member(std::string& name);
+
+        // Reads the value of a property. A string is unescaped into text, and a boolean or a number is stored in scalar. Objects, arrays
+        // and null are skipped and reported as null values.
+        value_kind read_value(std::string& text, entity_property& scalar);
+
+        void read_query_envelope(const std::function<void()>& read_element);
+        bool read_entity_object(table_entity& entity);
+        void read_entity_member(table_entity& entity, std::string& name, std::vector<std::pair<utility::string_t, edm_type>>& pending_types, utility::string_t& timestamp_str);
+        void read_mapped_entity_object(const table_entity_schema& schema, const std::function<void*()>& add_entity);
+        void read_mapped_entity_member(const table_entity_schema& schema, void* entity, std::string& name, size_t& position);
+
+        // Reads the value of a mapped property straight into the member holding it, whose type is the one the EDM type corresponds to.
+        // Null, object and array values leave the member unchanged.
+        void read_mapped_property(edm_type type, void* member);
+        void read_property_value(entity_property& property);
+        void read_string(std::string& value);
+        utility::string_t read_string();
+        void read_number(entity_property& property);
+
+        // Reads a number, and returns true if it is a whole number within the 64-bit range, which is then stored in integer rather than
+        // in floating.
+        bool read_number(int64_t& integer, double& floating);
+        void read_literal(const char* literal);
+        void skip_value();
+        void skip_whitespace();
+        bool try_consume(char c);
+        void expect(char c);
+        char peek();
+
+        const unsigned char* m_current;
+        const unsigned char* m_end;
+    };
+
+    // Writes table entities as UTF-8 JSON straight into a caller-owned buffer, without building a web::json::value document,
+    // so that a whole request body, such as a batch, can be assembled into a single buffer.
+    class table_entity_json_writer
+    {
+    public:
+
+        explicit table_entity_json_writer(std::string& buffer)
+            : m_buffer(buffer), m_first_member(true)
+        {
+        }
+
+        // Writes an entity object holding the partition key, row key and properties of the entity.
+        void write_entity(const table_entity& entity);
+
+        // Writes an entity object from the mapped members of an object of a mapped type.
+        void write_entity(const table_entity_schema& schema, void* entity);
+
+        // Returns an estimate of the number of bytes write_entity produces for the entity, for sizing the buffer up front.
+        static size_t estimate_size(const table_entity& entity);
+
+    private:
+
+        void write_property(const utility::string_t& name, const entity_property& property);
+
+        // Writes a mapped property straight from the member holding it, whose type is the one the EDM type of the property corresponds to.
+        void write_mapped_property(const table_entity_schema::property_field& field, void* member);
+        void write_boolean(const utility::string_t& name, bool value);
+        void write_int32(const utility::string_t& name, int32_t value);
+        void write_int64(const utility::string_t& name, int64_t value);
+        void write_double(const utility::string_t& name, double value);
+        void write_annotated_string(const utility::string_t& name, edm_type type, const utility::string_t& value);
+        void write_type_annotation(const utility::string_t& name, edm_type type);
+        void write_name(const utility::string_t& name);
+        void write_string(const utility::string_t& value);
+        void write_string_content(const utility::string_t& value);
+        void write_separator();
+
+        std::string& m_buffer;
+        bool m_first_member;
+    };
+
 }}} // namespace azure::storage::protocol
@@ -266,12 +266,78 @@ namespace azure { namespace storage { namespace protocol {
             return std::move(m_next_marker);
         }
 
+        // Parses the listing incrementally, handing each blob and blob prefix to the callbacks as soon as its element
+        // is complete instead of collecting them all first. Returns the next marker.
+        utility::string_t parse_items(const std::function<void(cloud_blob_list_item&)>& blob_callback, const std::function<void(cloud_blob_prefix_list_item&)>& blob_prefix_callback);
+
+        typedef std::vector<std::pair<utility::string_t, utility::string_t>> metadata_pairs;
+        typedef std::function<void(utility::string_t& name, utility::string_t& snapshot_time, cloud_blob_properties& properties, metadata_pairs& metadata)> record_callback;
+
+        // Parses a flat listing, handing the raw fields of each blob to the callback as soon as its element is complete.
+        // No blob URI is built and metadata is kept in document order instead of a map. Returns the next marker.
+        utility::string_t parse_records(const record_callback& blob_callback);
+
     protected:
 
+        // Element names the reader dispatches on. Each element is looked up once when it begins, so the
+        // handlers below switch on tokens instead of comparing the element and parent names as strings.
+        enum class element_token
+        {
+            unknown,
+            enumeration_results,
+            blobs,
+            blob,
+            blob_prefix,
+            properties,
+            metadata,
+            name,
+            snapshot,
+            version_id,
+            is_current_version,
+            next_marker,
+            last_modified,
+            etag,
+            lease_status,
+            lease_state,
+            lease_duration,
+            content_length,
+            content_disposition,
+            content_type,
+            content_encoding,
+            content_language,
+            content_md5,
+            cache_control,
+            blob_sequence_number,
+            blob_type,
+            copy_id,
+            copy_status,
+            copy_source,
+            copy_progress,
+            copy_completion_time,
+            copy_status_description,
+            incremental_copy,
+            copy_destination_snapshot,
+            access_tier,
+            access_tier_inferred,
+            access_tier_change_time,
+        };
+
+        static element_token get_element_token(const utility::string_t& element_name);
+
+        element_token get_parent_element_token() const
+        {
+            return m_element_tokens.size() > 1 ? m_element_tokens[m_element_tokens.size() - 2] : element_token::unknown;
+        }
+
         virtual void handle_begin_element(const utility::string_t& element_name);
         virtual void handle_element(const utility::string_t& element_name);
         virtual void handle_end_element(const utility::string_t& element_name);
+        void handle_property_element(element_token token);
 
+        std::vector<element_token> m_element_tokens;
+        bool m_pause_on_item = false;
+        const record_callback* m_record_callback = nullptr;
+        metadata_pairs m_metadata_pairs;
         std::vector<cloud_blob_list_item> m_blob_items;
         std::vector<cloud_blob_prefix_list_item> m_blob_prefix_items;
         utility::string_t m_next_marker;
@@ -665,6 +731,10 @@ namespace azure { namespace storage { namespace protocol {
         }
 
         std::string write(const cloud_queue_message& message);
+
+        // Writes the request body for a message into a caller-owned buffer, without building an XML document, so that the buffer can be reused
+        // for many messages.
+        static void write(const cloud_queue_message& message, std::string& buffer);
     };
 
     class cloud_file_share_list_item
@@ -17,13 +17,19 @@
 
 #pragma once
 
+#include <algorithm>
+#include <locale>
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 #ifndef _WIN32
     #include "pplx/threadpool.h"
 #endif
 #include "cpprest/streams.h"
 
+#include "was/common.h"
 #include "was/core.h"
 #include "wascore/timer_handler.h"
 
@@ -58,6 +64,85 @@ namespace azure { namespace storage { namespace core {
     void write_request_line(utility::string_t& body_text, const web::http::method& method, const web::http::uri& uri);
     void write_request_headers(utility::string_t& body_text, const web::http::http_headers& headers);
     void write_request_payload(utility::string_t& body_text, const web::json::value& json_object);
+    void write_boundary(std::string& body, const utility::string_t& boundary_name, bool is_closure = false);
+    void write_mime_changeset_headers(std::string& body);
+    void write_mime_changeset_headers(std::string& body, const utility::string_t& content_id);
+    void write_request_line(std::string& body, const web::http::method& method, const web::http::uri& uri);
+    void write_request_headers(std::string& body, const web::http::http_headers& headers);
+
+    // A range of bytes within a multipart response buffer
+    struct mime_byte_range
+    {
+        mime_byte_range()
+            : begin(nullptr), end(nullptr)
+        {
+        }
+
+        mime_byte_range(const uint8_t* begin, const uint8_t* end)
+            : begin(begin), end(end)
+        {
+        }
+
+        bool empty() const
+        {
+            return begin == end;
+        }
+
+        bool starts_with(const char* prefix, size_t prefix_size) const
+        {
+            return static_cast<size_t>(end - begin) >= prefix_size && std::equal(prefix, prefix + prefix_size, begin);
+        }
+
+        std::string str() const
+        {
+            return std::string(begin, end);
+        }
+
+        const uint8_t* begin;
+        const uint8_t* end;
+    };
+
+    typedef std::vector<std::pair<mime_byte_range, mime_byte_range>> mime_headers;
+
+    // Reads a multipart batch response, and the HTTP responses embedded in its parts, in a single pass over the response buffer.
+    // Everything it returns refers to the buffer, which must outlive the reader.
+    class mime_multipart_reader
+    {
+    public:
+
+        explicit mime_multipart_reader(const std::vector<uint8_t>& body)
+            : m_current(body.data()), m_end(body.data() + body.size())
+        {
+        }
+
+        // Reads the opening delimiter line of the batch and returns the delimiter, which is "--" followed by the boundary.
+        mime_byte_range read_opening_delimiter();
+
+        // Reads MIME part headers up to and including the blank line that ends them, adding them to headers if it is given.
+        // Returns the boundary of a nested multipart part, or an empty range if the part is not multipart.
+        mime_byte_range read_part_headers(mime_headers* headers = nullptr);
+
+        // Reads an embedded HTTP response whose body ends at the next line starting with the delimiter. The headers of the response replace
+        // the contents of headers.
+        void read_http_response(const std::string& delimiter, int& status_code, mime_byte_range& status_message, mime_headers& headers, mime_byte_range& body);
+
+        // Advances past the next delimiter line. Returns false if the delimiter closes the multipart body or if the buffer ends.
+        bool read_next_part(const std::string& delimiter);
+
+        // Returns the value of the first header with the given name, compared without regard to case, or an empty range if there is none.
+        static mime_byte_range find_header(const mime_headers& headers, const char* name);
+
+        static bool equals_ignore_case(mime_byte_range range, const char* value);
+        static mime_byte_range trim(mime_byte_range range);
+
+    private:
+
+        mime_byte_range read_line();
+        static bool split_header(mime_byte_range line, mime_byte_range& name, mime_byte_range& value);
+
+        const uint8_t* m_current;
+        const uint8_t* m_end;
+    };
 
 #pragma endregion
 
@@ -77,6 +162,8 @@ namespace azure { namespace storage { namespace core {
     utility::string_t convert_to_string(double value);
     utility::string_t convert_to_string(const utility::string_t& source);
     utility::string_t convert_to_string(const std::vector<uint8_t>& value);
+    void append_utf8(std::string& buffer, const utility::string_t& value);
+    void append_from_utf8(utility::string_t& buffer, const std::string& value);
     utility::string_t convert_to_iso8601_string(const utility::datetime& value, int num_decimal_digits);
     utility::char_t utility_char_tolower(const utility::char_t& character);
     utility::string_t str_trim_starting_trailing_whitespaces(const utility::string_t& str);
@@ -86,6 +173,7 @@ namespace azure { namespace storage { namespace core {
     utility::string_t convert_to_string(T value)
     {
         utility::ostringstream_t buffer;
+        buffer.imbue(std::locale::classic());
         buffer << value;
         return buffer.str();
     }
@@ -115,6 +203,145 @@ namespace azure { namespace storage { namespace core {
         return make_query_parameter(parameter_name, convert_to_string(parameter_value), do_encoding);
     }
 
+    // Walks every segment of a listing and hands each result to a callback. Up to prefetch_depth segments beyond the one being
+    // delivered are requested ahead of time, each as soon as the continuation token it depends on is known. Segments are
+    // delivered one after another, so the callback is never invoked concurrently.
+    template<typename result_type>
+    class segment_enumerator : public std::enable_shared_from_this<segment_enumerator<result_type>>
+    {
+    public:
+        typedef std::function<pplx::task<result_segment<result_type>>(const continuation_token&, size_t)> generator_type;
+
+        segment_enumerator(generator_type generator, utility::size64_t max_results, size_t prefetch_depth, std::function<void(const result_type&)> callback)
+            : m_generator(std::move(generator)), m_callback(std::move(callback)), m_max_results(max_results), m_returned_results(0), m_prefetch_depth(prefetch_depth)
+        {
+        }
+
+        pplx::task<void> run()
+        {
+            push_segment(request_segment(continuation_token()));
+            return deliver_next_segment();
+        }
+
+    private:
+
+        typedef pplx::task<std::shared_ptr<result_segment<result_type>>> segment_task;
+
+        pplx::task<void> deliver_next_segment()
+        {
+            auto segment = m_pending_segments.front();
+            m_pending_segments.pop_front();
+
+            auto instance = this->shared_from_this();
+            return segment.then([instance](std::shared_ptr<result_segment<result_type>> segment) -> pplx::task<void>
+            {
+                // Queue the following requests before handing out the results, so they overlap with the callback.
+                instance->prefetch_segments(*segment);
+
+                for (const auto& result : segment->results())
+                {
+                    if (instance->m_max_results > 0 && instance->m_returned_results >= instance->m_max_results)
+                    {
+                        return pplx::task_from_result();
+                    }
+
+                    instance->m_callback(result);
+                    ++instance->m_returned_results;
+                }
+
+                if (segment->continuation_token().empty() || (instance->m_max_results > 0 && instance->m_returned_results >= instance->m_max_results))
+                {
+                    return pplx::task_from_result();
+                }
+
+                if (instance->m_pending_segments.empty())
+                {
+                    instance->push_segment(instance->request_segment(segment->continuation_token()));
+                }
+
+                return instance->deliver_next_segment();
+            });
+        }
+
+        void prefetch_segments(const result_segment<result_type>& segment)
+        {
+            // Stop once the segments already received or requested are known to cover the remaining results.
+            if (m_prefetch_depth == 0 || segment.continuation_token().empty() ||
+                (m_max_results > 0 && m_returned_results + segment.results().size() >= m_max_results))
+            {
+                return;
+            }
+
+            if (m_pending_segments.empty())
+            {
+                push_segment(request_segment(segment.continuation_token()));
+            }
+
+            while (m_pending_segments.size() < m_prefetch_depth)
+            {
+                // The continuation token of a queued request is only known once it completes, so chain the next request to it.
+                auto generator = m_generator;
+                auto max_results = get_remaining_results_num();
+                push_segment(m_pending_segments.back().then([generator, max_results](std::shared_ptr<result_segment<result_type>> previous) -> segment_task
+                {
+                    if (previous->continuation_token().empty())
+                    {
+                        return pplx::task_from_result(std::make_shared<result_segment<result_type>>());
+                    }
+
+                    return generator(previous->continuation_token(), max_results).then([](result_segment<result_type> result)
+                    {
+                        return std::make_shared<result_segment<result_type>>(std::move(result));
+                    });
+                }));
+            }
+        }
+
+        segment_task request_segment(const continuation_token& token)
+        {
+            return m_generator(token, get_remaining_results_num()).then([](result_segment<result_type> result)
+            {
+                return std::make_shared<result_segment<result_type>>(std::move(result));
+            });
+        }
+
+        void push_segment(segment_task segment)
+        {
+            // Observe failures of requests that are abandoned once the enumeration stops, so they are not reported as unhandled.
+            segment.then([](segment_task task)
+            {
+                try
+                {
+                    task.wait();
+                }
+                catch (...)
+                {
+                }
+            });
+
+            m_pending_segments.push_back(std::move(segment));
+        }
+
+        size_t get_remaining_results_num() const
+        {
+            // 0 lets the service decide the segment size
+            return m_max_results == 0 ? 0 : static_cast<size_t>(m_max_results - m_returned_results);
+        }
+
+        generator_type m_generator;
+        std::function<void(const result_type&)> m_callback;
+        std::deque<segment_task> m_pending_segments;
+        utility::size64_t m_max_results;
+        utility::size64_t m_returned_results;
+        size_t m_prefetch_depth;
+    };
+
+    template<typename result_type>
+    pplx::task<void> enumerate_segments_async(typename segment_enumerator<result_type>::generator_type generator, utility::size64_t max_results, size_t prefetch_depth, std::function<void(const result_type&)> callback)
+    {
+        return std::make_shared<segment_enumerator<result_type>>(std::move(generator), max_results, prefetch_depth, std::move(callback))->run();
+    }
+
 #pragma endregion
 
 #ifndef _WIN32
@@ -31,6 +31,7 @@
 #include <string>
 #include <libxml/xmlreader.h>
 #include <libxml/xmlwriter.h>
+#include "cpprest/streams.h"
 
 #include "wascore/basic_types.h"
 
@@ -45,6 +46,12 @@ namespace azure { namespace storage { namespace core { namespace xml {
     public:
         xml_text_reader_wrapper(const unsigned char* buffer, unsigned int size);
 
+        /// <summary>
+        /// Creates a reader that pulls the document from the stream as parsing proceeds instead of reading it into memory first.
+        /// </summary>
+        /// <param name="stream">The stream to read the document from.</param>
+        xml_text_reader_wrapper(concurrency::streams::istream stream);
+
         ~xml_text_reader_wrapper();
 
         /// <summary>
@@ -90,7 +97,10 @@ namespace azure { namespace storage { namespace core { namespace xml {
         bool move_to_next_attribute();
 
     private:
+        static int read_stream(void* context, char* buffer, int length);
+
         xmlTextReaderPtr m_reader;
+        concurrency::streams::istream m_stream;
     };
 
     /// <summary>
@@ -174,6 +174,16 @@ protected:
         iss >> value;
     }
 
+    /// <summary>
+    /// Extracts the current element value as a signed 64-bit integer without going through a string stream
+    /// </summary>
+    void extract_current_element(int64_t& value);
+
+    /// <summary>
+    /// Extracts the current element value as an unsigned 64-bit integer without going through a string stream
+    /// </summary>
+    void extract_current_element(uint64_t& value);
+
     /// <summary>
     /// Initialize the reader
     /// </summary>
@@ -189,7 +199,6 @@ protected:
     CComPtr<IXmlReader> m_reader;
 #else
     std::shared_ptr<xml_text_reader_wrapper> m_reader;
-    std::string m_data;
 #endif 
 
     std::vector<utility::string_t> m_elementStack;
@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="Base64PerformanceBenchmark.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "samples_common.h"
+
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include <wascore/base64.h>
+
+namespace azure { namespace storage { namespace samples {
+
+    SAMPLE(Base64PerformanceBenchmark, base64_performance_benchmark)
+    void base64_performance_benchmark()
+    {
+        // Block IDs and checksums, queue messages and table properties, and large payloads
+        const size_t sizes[] = { 16, 48, 4 * 1024, 48 * 1024, 4 * 1024 * 1024 };
+        const size_t bytes_per_size = 256 * 1024 * 1024;
+
+        std::mt19937 rand_engine(std::random_device{}());
+        std::uniform_int_distribution<int> dist(0, 255);
+
+        for (size_t size : sizes)
+        {
+            std::vector<uint8_t> data(size);
+            std::generate(data.begin(), data.end(), [&dist, &rand_engine]() { return static_cast<uint8_t>(dist(rand_engine)); });
+
+            std::string text(azure::storage::core::base64_encoded_length(size), '\0');
+            std::vector<uint8_t> decoded(azure::storage::core::base64_decoded_max_length(text.size()));
+            const size_t iterations = std::max<size_t>(bytes_per_size / size, 1);
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                azure::storage::core::base64_encode(data.data(), data.size(), &text[0]);
+            }
+            auto end = std::chrono::steady_clock::now();
+            double encode_s = std::chrono::duration<double>(end - start).count();
+
+            size_t decoded_length = 0;
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++i)
+            {
+                azure::storage::core::base64_decode(text.data(), text.size(), decoded.data(), decoded_length);
+            }
+            end = std::chrono::steady_clock::now();
+            double decode_s = std::chrono::duration<double>(end - start).count();
+
+            if (decoded_length != size || !std::equal(data.cbegin(), data.cend(), decoded.cbegin()))
+            {
+                std::cout << "Round trip of " << size << " bytes failed" << std::endl;
+                return;
+            }
+
+            double data_mb = double(size) * iterations / 1024 / 1024;
+            std::cout << size << " bytes: encode " << data_mb / encode_s << "MBps, decode " << data_mb / decode_s << "MBps" << std::endl;
+        }
+    }
+
+}}}  // namespace azure::storage::samples
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="ListingPerformanceBenchmark.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "samples_common.h"
+
+#include <chrono>
+#include <sstream>
+
+#include <wascore/protocol_xml.h>
+
+namespace azure { namespace storage { namespace samples {
+
+    SAMPLE(ListingPerformanceBenchmark, listing_performance_benchmark)
+    void listing_performance_benchmark()
+    {
+        // A full List Blobs segment as returned by the service
+        const size_t blobs_per_segment = 5000;
+        const size_t iterations = 50;
+
+        std::ostringstream body;
+        body << "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"https://account.blob.core.windows.net/\" ContainerName=\"container\"><Blobs>";
+        for (size_t i = 0; i < blobs_per_segment; ++i)
+        {
+            body << "<Blob><Name>folder/blob" << i << "</Name><Properties>"
+                << "<Creation-Time>Sun, 06 Nov 1994 08:49:37 GMT</Creation-Time><Last-Modified>Sun, 06 Nov 1994 08:49:37 GMT</Last-Modified>"
+                << "<Etag>0x8D6F0F7E9E0A" << i << "</Etag><Content-Length>" << i * 4096 << "</Content-Length>"
+                << "<Content-Type>application/octet-stream</Content-Type><Content-MD5>1B2M2Y8AsgTpgAmY7PhCfg==</Content-MD5>"
+                << "<BlobType>BlockBlob</BlobType><AccessTier>Hot</AccessTier><AccessTierInferred>true</AccessTierInferred>"
+                << "<LeaseStatus>unlocked</LeaseStatus><LeaseState>available</LeaseState><ServerEncrypted>true</ServerEncrypted>"
+                << "</Properties><Metadata><owner>benchmark</owner></Metadata></Blob>";
+        }
+        body << "</Blobs><NextMarker>marker</NextMarker></EnumerationResults>";
+        const std::string segment = body.str();
+
+        size_t blob_count = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            protocol::list_blobs_reader reader(concurrency::streams::bytestream::open_istream(segment));
+            blob_count += reader.move_blob_items().size();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double parse_s = std::chrono::duration<double>(end - start).count();
+
+        if (blob_count != blobs_per_segment * iterations)
+        {
+            std::cout << "Parsed " << blob_count << " blobs instead of " << blobs_per_segment * iterations << std::endl;
+            return;
+        }
+
+        double data_mb = double(segment.size()) * iterations / 1024 / 1024;
+        std::cout << "List Blobs parsing: " << blob_count / parse_s << " blobs/s, " << data_mb / parse_s << "MBps" << std::endl;
+    }
+
+}}}  // namespace azure::storage::samples
@@ -0,0 +1,88 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="TableQueryPerformanceBenchmark.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "samples_common.h"
+
+#include <chrono>
+#include <sstream>
+
+#include <wascore/protocol.h>
+#include <wascore/protocol_json.h>
+
+namespace azure { namespace storage { namespace samples {
+
+    SAMPLE(TableQueryPerformanceBenchmark, table_query_performance_benchmark)
+    void table_query_performance_benchmark()
+    {
+        // A full Query Entities segment as returned by the service with minimal metadata
+        const size_t entities_per_segment = 1000;
+        const size_t iterations = 50;
+
+        std::ostringstream body;
+        body << "{\"odata.metadata\":\"https://account.table.core.windows.net/$metadata#table\",\"value\":[";
+        for (size_t i = 0; i < entities_per_segment; ++i)
+        {
+            if (i != 0)
+            {
+                body << ",";
+            }
+
+            body << "{\"odata.etag\":\"W/\\\"datetime'2019-01-01T00%3A00%3A00.0000000Z'\\\"\",\"PartitionKey\":\"partition\",\"RowKey\":\"row" << i << "\","
+                << "\"Timestamp\":\"2019-01-01T00:00:00.0000000Z\",\"Name\":\"entity " << i << "\",\"Count\":" << i << ","
+                << "\"Total@odata.type\":\"Edm.Int64\",\"Total\":\"" << i * 10000000000LL << "\",\"Ratio\":" << i << ".5,\"Enabled\":true,"
+                << "\"Id@odata.type\":\"Edm.Guid\",\"Id\":\"c9da6455-213d-42c9-9a79-3e9149a57833\","
+                << "\"Created@odata.type\":\"Edm.DateTime\",\"Created\":\"2019-01-01T00:00:00.0000000Z\"}";
+        }
+        body << "]}";
+        const std::string text = body.str();
+        const std::vector<unsigned char> segment(text.cbegin(), text.cend());
+
+        // The baseline decodes the body and builds a web::json::value document before reading the entities out of it, as responses were
+        // parsed before table_entity_json_reader.
+        size_t dom_entity_count = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            web::json::value document = web::json::value::parse(utility::conversions::to_string_t(text));
+            dom_entity_count += protocol::table_response_parsers::parse_query_results(document).size();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double dom_parse_s = std::chrono::duration<double>(end - start).count();
+
+        size_t entity_count = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            protocol::table_entity_json_reader reader(segment);
+            entity_count += reader.read_query_results().size();
+        }
+        end = std::chrono::steady_clock::now();
+        double parse_s = std::chrono::duration<double>(end - start).count();
+
+        if (entity_count != entities_per_segment * iterations || dom_entity_count != entity_count)
+        {
+            std::cout << "Parsed " << entity_count << " entities with the reader and " << dom_entity_count << " with the document instead of " << entities_per_segment * iterations << std::endl;
+            return;
+        }
+
+        double data_mb = double(segment.size()) * iterations / 1024 / 1024;
+        std::cout << "Query Entities parsing with web::json::value: " << iterations / dom_parse_s << " segments/s, " << entity_count / dom_parse_s << " entities/s, " << data_mb / dom_parse_s << "MBps" << std::endl;
+        std::cout << "Query Entities parsing with table_entity_json_reader: " << iterations / parse_s << " segments/s, " << entity_count / parse_s << " entities/s, " << data_mb / parse_s << "MBps" << std::endl;
+        std::cout << "Speedup: " << dom_parse_s / parse_s << "x" << std::endl;
+    }
+
+}}}  // namespace azure::storage::samples
@@ -0,0 +1,420 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="base64.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+#include "wascore/base64.h"
+#include "wascore/resources.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define WASTORAGE_BASE64_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define WASTORAGE_TARGET_AVX2
+#else
+#define WASTORAGE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define WASTORAGE_BASE64_NEON
+#include <arm_neon.h>
+#endif
+
+namespace azure { namespace storage { namespace core {
+
+    namespace
+    {
+        const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        // Maps each character to its 6-bit value, or to 0xFF if it is not part of the alphabet
+        const uint8_t base64_values[256] =
+        {
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+            0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+            0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+            0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        };
+
+        size_t encode_scalar(const uint8_t* data, size_t length, char* output)
+        {
+            char* position = output;
+
+            size_t i = 0;
+            for (; i + 3 <= length; i += 3)
+            {
+                uint32_t triple = (static_cast<uint32_t>(data[i]) << 16) | (static_cast<uint32_t>(data[i + 1]) << 8) | data[i + 2];
+                *position++ = base64_alphabet[(triple >> 18) & 0x3F];
+                *position++ = base64_alphabet[(triple >> 12) & 0x3F];
+                *position++ = base64_alphabet[(triple >> 6) & 0x3F];
+                *position++ = base64_alphabet[triple & 0x3F];
+            }
+
+            if (i < length)
+            {
+                uint32_t triple = static_cast<uint32_t>(data[i]) << 16;
+                if (i + 1 < length)
+                {
+                    triple |= static_cast<uint32_t>(data[i + 1]) << 8;
+                }
+
+                *position++ = base64_alphabet[(triple >> 18) & 0x3F];
+                *position++ = base64_alphabet[(triple >> 12) & 0x3F];
+                *position++ = i + 1 < length ? base64_alphabet[(triple >> 6) & 0x3F] : '=';
+                *position++ = '=';
+            }
+
+            return static_cast<size_t>(position - output);
+        }
+
+        bool decode_scalar(const char* text, size_t length, uint8_t* output, size_t& output_length)
+        {
+            uint8_t* position = output;
+
+            for (size_t i = 0; i < length; i += 4)
+            {
+                uint8_t a = base64_values[static_cast<uint8_t>(text[i])];
+                uint8_t b = base64_values[static_cast<uint8_t>(text[i + 1])];
+                if ((a | b) & 0x80)
+                {
+                    return false;
+                }
+
+                // Padding may only end the text, as "x==" or "xxx="
+                bool last = i + 4 == length;
+                if (last && text[i + 2] == '=' && text[i + 3] == '=')
+                {
+                    *position++ = static_cast<uint8_t>((a << 2) | (b >> 4));
+                    break;
+                }
+
+                uint8_t c = base64_values[static_cast<uint8_t>(text[i + 2])];
+                if (last && text[i + 3] == '=')
+                {
+                    if (c & 0x80)
+                    {
+                        return false;
+                    }
+
+                    *position++ = static_cast<uint8_t>((a << 2) | (b >> 4));
+                    *position++ = static_cast<uint8_t>((b << 4) | (c >> 2));
+                    break;
+                }
+
+                uint8_t d = base64_values[static_cast<uint8_t>(text[i + 3])];
+                if ((c | d) & 0x80)
+                {
+                    return false;
+                }
+
+                *position++ = static_cast<uint8_t>((a << 2) | (b >> 4));
+                *position++ = static_cast<uint8_t>((b << 4) | (c >> 2));
+                *position++ = static_cast<uint8_t>((c << 6) | d);
+            }
+
+            output_length = static_cast<size_t>(position - output);
+            return true;
+        }
+
+#if defined(WASTORAGE_BASE64_AVX2)
+
+        bool has_avx2()
+        {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 1);
+
+            // The processor must support AVX, and the operating system must save the YMM registers
+            const int osxsave_and_avx = (1 << 27) | (1 << 28);
+            if ((info[2] & osxsave_and_avx) != osxsave_and_avx || (_xgetbv(0) & 6) != 6)
+            {
+                return false;
+            }
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+        }
+
+        // Encodes 24 bytes into 32 characters per iteration, splitting the bytes into 6-bit values with multiplications and mapping them to the
+        // alphabet with a shuffle. Returns the number of bytes consumed, which is a multiple of 3.
+        WASTORAGE_TARGET_AVX2 size_t encode_avx2(const uint8_t* data, size_t length, char* output)
+        {
+            const __m256i shuffle = _mm256_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+            const __m256i offsets = _mm256_setr_epi8(
+                65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+                65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+
+            size_t consumed = 0;
+
+            // Each iteration reads 28 bytes, as both halves are loaded 16 bytes at a time
+            while (length - consumed >= 28)
+            {
+                __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + consumed));
+                __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + consumed + 12));
+                __m256i input = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1), shuffle);
+
+                __m256i first = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+                __m256i second = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+                __m256i values = _mm256_or_si256(first, second);
+
+                __m256i indices = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+                indices = _mm256_sub_epi8(indices, _mm256_cmpgt_epi8(values, _mm256_set1_epi8(25)));
+                __m256i characters = _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, indices));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + consumed / 3 * 4), characters);
+                consumed += 24;
+            }
+
+            return consumed;
+        }
+
+        // Decodes 32 characters into 24 bytes per iteration, validating the characters with nibble lookups. Stops at the first block that holds
+        // padding or an invalid character, which the scalar decoder then handles. Returns the number of characters consumed.
+        WASTORAGE_TARGET_AVX2 size_t decode_avx2(const char* text, size_t length, uint8_t* output)
+        {
+            const __m256i low_nibble_flags = _mm256_setr_epi8(
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+                0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+            const __m256i high_nibble_flags = _mm256_setr_epi8(
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+            const __m256i offsets = _mm256_setr_epi8(
+                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+            const __m256i pack = _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+            const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+
+            size_t consumed = 0;
+
+            // Each half stores 16 bytes of which 12 are used, so at least 8 more characters must follow for the output buffer to have room
+            while (length - consumed >= 40)
+            {
+                __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + consumed));
+                __m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask_2f);
+                __m256i low_nibbles = _mm256_and_si256(input, mask_2f);
+                __m256i high_flags = _mm256_shuffle_epi8(high_nibble_flags, high_nibbles);
+                __m256i low_flags = _mm256_shuffle_epi8(low_nibble_flags, low_nibbles);
+                if (!_mm256_testz_si256(low_flags, high_flags))
+                {
+                    break;
+                }
+
+                __m256i is_slash = _mm256_cmpeq_epi8(input, mask_2f);
+                __m256i values = _mm256_add_epi8(input, _mm256_shuffle_epi8(offsets, _mm256_add_epi8(is_slash, high_nibbles)));
+
+                __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+                __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+                __m256i bytes = _mm256_shuffle_epi8(words, pack);
+
+                uint8_t* position = output + consumed / 4 * 3;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(position), _mm256_castsi256_si128(bytes));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(position + 12), _mm256_extracti128_si256(bytes, 1));
+                consumed += 32;
+            }
+
+            return consumed;
+        }
+
+#elif defined(WASTORAGE_BASE64_NEON)
+
+        // Encodes 48 bytes into 64 characters per iteration, deinterleaving the bytes on load and mapping the 6-bit values with a table lookup.
+        // Returns the number of bytes consumed, which is a multiple of 3.
+        size_t encode_neon(const uint8_t* data, size_t length, char* output)
+        {
+            const uint8_t* alphabet = reinterpret_cast<const uint8_t*>(base64_alphabet);
+            uint8x16x4_t table;
+            table.val[0] = vld1q_u8(alphabet);
+            table.val[1] = vld1q_u8(alphabet + 16);
+            table.val[2] = vld1q_u8(alphabet + 32);
+            table.val[3] = vld1q_u8(alphabet + 48);
+            const uint8x16_t mask = vdupq_n_u8(0x3F);
+
+            size_t consumed = 0;
+            while (length - consumed >= 48)
+            {
+                uint8x16x3_t input = vld3q_u8(data + consumed);
+
+                uint8x16x4_t characters;
+                characters.val[0] = vqtbl4q_u8(table, vshrq_n_u8(input.val[0], 2));
+                characters.val[1] = vqtbl4q_u8(table, vandq_u8(vorrq_u8(vshlq_n_u8(input.val[0], 4), vshrq_n_u8(input.val[1], 4)), mask));
+                characters.val[2] = vqtbl4q_u8(table, vandq_u8(vorrq_u8(vshlq_n_u8(input.val[1], 2), vshrq_n_u8(input.val[2], 6)), mask));
+                characters.val[3] = vqtbl4q_u8(table, vandq_u8(input.val[2], mask));
+
+                vst4q_u8(reinterpret_cast<uint8_t*>(output + consumed / 3 * 4), characters);
+                consumed += 48;
+            }
+
+            return consumed;
+        }
+
+        // Decodes 64 characters into 48 bytes per iteration with a 128-entry table lookup. Stops at the first block that holds padding or an
+        // invalid character, which the scalar decoder then handles. Returns the number of characters consumed.
+        size_t decode_neon(const char* text, size_t length, uint8_t* output)
+        {
+            uint8x16x4_t low_table;
+            uint8x16x4_t high_table;
+            for (int i = 0; i < 4; ++i)
+            {
+                low_table.val[i] = vld1q_u8(base64_values + 16 * i);
+                high_table.val[i] = vld1q_u8(base64_values + 64 + 16 * i);
+            }
+
+            const uint8x16_t high_start = vdupq_n_u8(64);
+
+            size_t consumed = 0;
+            while (length - consumed >= 64)
+            {
+                uint8x16x4_t input = vld4q_u8(reinterpret_cast<const uint8_t*>(text + consumed));
+
+                // Characters from 64 to 127 are looked up in the second table, and characters from 128 up are caught by their high bit
+                uint8x16x4_t values;
+                uint8x16_t invalid = vdupq_n_u8(0);
+                for (int i = 0; i < 4; ++i)
+                {
+                    values.val[i] = vqtbx4q_u8(vqtbl4q_u8(low_table, input.val[i]), high_table, vsubq_u8(input.val[i], high_start));
+                    invalid = vorrq_u8(invalid, vorrq_u8(values.val[i], input.val[i]));
+                }
+
+                if (vmaxvq_u8(invalid) & 0x80)
+                {
+                    break;
+                }
+
+                uint8x16x3_t bytes;
+                bytes.val[0] = vorrq_u8(vshlq_n_u8(values.val[0], 2), vshrq_n_u8(values.val[1], 4));
+                bytes.val[1] = vorrq_u8(vshlq_n_u8(values.val[1], 4), vshrq_n_u8(values.val[2], 2));
+                bytes.val[2] = vorrq_u8(vshlq_n_u8(values.val[2], 6), values.val[3]);
+
+                vst3q_u8(output + consumed / 4 * 3, bytes);
+                consumed += 64;
+            }
+
+            return consumed;
+        }
+
+#endif
+    }
+
+    size_t base64_encode(const uint8_t* data, size_t length, char* output)
+    {
+        size_t consumed = 0;
+
+#if defined(WASTORAGE_BASE64_AVX2)
+        static const bool use_avx2 = has_avx2();
+        if (use_avx2)
+        {
+            consumed = encode_avx2(data, length, output);
+        }
+#elif defined(WASTORAGE_BASE64_NEON)
+        consumed = encode_neon(data, length, output);
+#endif
+
+        return consumed / 3 * 4 + encode_scalar(data + consumed, length - consumed, output + consumed / 3 * 4);
+    }
+
+    bool base64_decode(const char* text, size_t length, uint8_t* output, size_t& output_length)
+    {
+        if (length % 4 != 0)
+        {
+            return false;
+        }
+
+        size_t consumed = 0;
+
+#if defined(WASTORAGE_BASE64_AVX2)
+        static const bool use_avx2 = has_avx2();
+        if (use_avx2)
+        {
+            consumed = decode_avx2(text, length, output);
+        }
+#elif defined(WASTORAGE_BASE64_NEON)
+        consumed = decode_neon(text, length, output);
+#endif
+
+        size_t remaining_length = 0;
+        if (!decode_scalar(text + consumed, length - consumed, output + consumed / 4 * 3, remaining_length))
+        {
+            return false;
+        }
+
+        output_length = consumed / 4 * 3 + remaining_length;
+        return true;
+    }
+
+    void append_base64(std::string& buffer, const uint8_t* data, size_t length)
+    {
+        size_t position = buffer.size();
+        buffer.resize(position + base64_encoded_length(length));
+        base64_encode(data, length, &buffer[position]);
+    }
+
+    utility::string_t to_base64(const uint8_t* data, size_t length)
+    {
+#ifdef _WIN32
+        std::string text(base64_encoded_length(length), '\0');
+        base64_encode(data, length, &text[0]);
+        return utility::string_t(text.cbegin(), text.cend());
+#else
+        utility::string_t text(base64_encoded_length(length), '\0');
+        base64_encode(data, length, &text[0]);
+        return text;
+#endif
+    }
+
+    std::vector<uint8_t> from_base64(const utility::string_t& value)
+    {
+#ifdef _WIN32
+        // Wide characters outside of ASCII are never valid, so they are narrowed to a character that is not in the alphabet either
+        std::string text;
+        text.reserve(value.size());
+        for (auto it = value.cbegin(); it != value.cend(); ++it)
+        {
+            text.push_back(*it < 0x80 ? static_cast<char>(*it) : '\x80');
+        }
+#else
+        const utility::string_t& text = value;
+#endif
+
+        std::vector<uint8_t> result(base64_decoded_max_length(text.size()));
+        size_t length = 0;
+        if (!base64_decode(text.data(), text.size(), result.data(), length))
+        {
+            throw std::runtime_error(protocol::error_invalid_base64);
+        }
+
+        result.resize(length);
+        return result;
+    }
+
+}}} // namespace azure::storage::core
@@ -17,6 +17,7 @@
 
 #include "stdafx.h"
 #include "wascore/protocol.h"
+#include "wascore/base64.h"
 #include "wascore/constants.h"
 #include "wascore/resources.h"
 
@@ -246,7 +247,7 @@ namespace azure { namespace storage { namespace protocol {
         add_optional_header(headers, ms_header_blob_content_type, properties.content_type());
     }
 
-    void add_range(web::http::http_request& request, utility::size64_t offset, utility::size64_t length)
+    void add_range(web::http::http_request& request, const utility::char_t* header_name, utility::size64_t offset, utility::size64_t length)
     {
         if (offset < std::numeric_limits<utility::size64_t>::max())
         {
@@ -258,7 +259,7 @@ namespace azure { namespace storage { namespace protocol {
                 value << length;
             }
 
-            request.headers().add(ms_header_range, value.str());
+            request.headers().add(header_name, value.str());
         }
         else if (length > 0)
         {
@@ -266,13 +267,18 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
+    void add_range(web::http::http_request& request, utility::size64_t offset, utility::size64_t length)
+    {
+        add_range(request, ms_header_range, offset, length);
+    }
+
     void add_encryption_key(web::http::http_request& request, const std::vector<uint8_t>& key)
     {
         if (key.empty())
         {
             return;
         }
-        request.headers().add(ms_header_encryption_key, utility::conversions::to_base64(key));
+        request.headers().add(ms_header_encryption_key, core::to_base64(key));
         auto sha256_hash_provider = core::hash_provider::create_sha256_hash_provider();
         sha256_hash_provider.write(key.data(), key.size());
         sha256_hash_provider.close();
@@ -298,6 +304,27 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
+    web::http::http_request put_block_from_url(const utility::string_t& block_id, const web::http::uri& source, utility::size64_t source_offset, utility::size64_t source_length, const checksum& source_checksum, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    {
+        uri_builder.append_query(core::make_query_parameter(uri_query_component, component_block, /* do_encoding */ false));
+        uri_builder.append_query(core::make_query_parameter(uri_query_block_id, block_id));
+        web::http::http_request request(base_request(web::http::methods::PUT, uri_builder, timeout, context));
+        request.headers().add(ms_header_copy_source, source.to_string());
+        add_range(request, ms_header_source_range, source_offset, source_length);
+        if (source_checksum.is_md5())
+        {
+            request.headers().add(ms_header_source_content_md5, source_checksum.md5());
+        }
+        else if (source_checksum.is_crc64())
+        {
+            request.headers().add(ms_header_source_content_crc64, source_checksum.crc64());
+        }
+        add_source_access_condition(request, source_condition);
+        add_lease_id(request, condition);
+        add_encryption_key(request, options.encryption_key());
+        return request;
+    }
+
     web::http::http_request put_block_list(const cloud_blob_properties& properties, const cloud_metadata& metadata, const checksum& content_checksum, const access_condition& condition, const blob_request_options& options, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_component, component_block_list, /* do_encoding */ false));
@@ -628,6 +655,74 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
+    web::http::http_request blob_batch(const blob_batch_operation& operation, const std::shared_ptr<authentication_handler>& handler, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    {
+        uri_builder.append_query(core::make_query_parameter(uri_query_component, component_batch, /* do_encoding */ false));
+        web::http::http_request request(base_request(web::http::methods::POST, uri_builder, timeout, context));
+
+        utility::string_t boundary_name = core::generate_boundary_name(_XPLATSTR("batch"));
+        request.headers().add(web::http::header_names::content_type, get_multipart_content_type(boundary_name));
+
+        const blob_batch_operation::requests_type& requests = operation.requests();
+
+        std::string body;
+        body.reserve(256 + requests.size() * 768);
+
+        for (size_t i = 0; i < requests.size(); ++i)
+        {
+            const blob_batch_request& item = requests[i];
+            web::http::uri_builder item_uri_builder(item.blob_uri());
+
+            web::http::http_request item_request;
+            if (item.request_type() == blob_batch_request_type::delete_blob)
+            {
+                item_request = delete_blob(item.snapshots_option(), item.snapshot_time(), item.condition(), item_uri_builder, std::chrono::seconds(), context);
+            }
+            else
+            {
+                utility::string_t tier;
+                switch (item.tier())
+                {
+                case standard_blob_tier::archive:
+                    tier = header_value_access_tier_archive;
+                    break;
+
+                case standard_blob_tier::hot:
+                    tier = header_value_access_tier_hot;
+                    break;
+
+                case standard_blob_tier::cool:
+                    tier = header_value_access_tier_cool;
+                    break;
+
+                default:
+                    tier = header_value_access_tier_unknown;
+                    break;
+                }
+
+                item_request = set_blob_tier(tier, item.condition(), blob_request_options(), item_uri_builder, std::chrono::seconds(), context);
+            }
+
+            // The version of the batch applies to its requests, which are signed on their own as if they were sent alone
+            web::http::http_headers& item_headers = item_request.headers();
+            item_headers.remove(web::http::header_names::user_agent);
+            item_headers.remove(ms_header_version);
+            item_headers.set_content_length(0);
+            handler->sign_request(item_request, context);
+
+            core::write_boundary(body, boundary_name);
+            core::write_mime_changeset_headers(body, core::convert_to_string(i));
+            core::write_request_line(body, item_request.method(), item_request.request_uri().resource());
+            core::write_request_headers(body, item_headers);
+        }
+
+        core::write_boundary(body, boundary_name, /* is_closure */ true);
+
+        // The Content-Type header has already been set to the multipart type
+        request.set_body(std::move(body));
+        return request;
+    }
+
     web::http::http_request get_user_delegation_key(web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_resource_type, resource_service), /* do_encoding */ false);
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 
 #include "wascore/protocol.h"
+#include "wascore/protocol_xml.h"
 #include "wascore/constants.h"
 #include "cpprest/asyncrt_utils.h"
 
@@ -207,4 +208,94 @@ namespace azure { namespace storage { namespace protocol {
         return properties;
     }
 
+    std::vector<blob_batch_result> blob_response_parsers::parse_batch_results(const web::http::http_response& response, const concurrency::streams::container_buffer<std::vector<uint8_t>>& response_buffer, size_t batch_size)
+    {
+        std::vector<blob_batch_result> batch_result(batch_size);
+        std::vector<bool> answered(batch_size, false);
+        size_t answered_count = 0;
+
+        // The response is parsed in place. Only the errors of failed requests are copied out of the buffer.
+        core::mime_multipart_reader reader(response_buffer.collection());
+        std::string delimiter = reader.read_opening_delimiter().str();
+
+        core::mime_headers part_headers;
+        core::mime_headers headers;
+        reader.read_part_headers(&part_headers);
+        for (bool has_part = true; has_part; )
+        {
+            int status_code;
+            core::mime_byte_range status_message;
+            core::mime_byte_range body;
+            reader.read_http_response(delimiter, status_code, status_message, headers, body);
+
+            bool succeeded = status_code >= web::http::status_codes::OK && status_code < web::http::status_codes::MultipleChoices;
+            storage_extended_error extended_error;
+            if (!succeeded)
+            {
+                utility::string_t error_code;
+                utility::string_t error_message;
+                std::unordered_map<utility::string_t, utility::string_t> details;
+                if (!body.empty())
+                {
+                    storage_error_reader error_reader(concurrency::streams::bytestream::open_istream(std::vector<uint8_t>(body.begin, body.end)));
+                    error_code = error_reader.move_error_code();
+                    error_message = error_reader.move_error_message();
+                    details = error_reader.move_details();
+                }
+
+                if (error_code.empty())
+                {
+                    error_code = utility::conversions::to_string_t(core::mime_multipart_reader::find_header(headers, "x-ms-error-code").str());
+                }
+
+                extended_error = storage_extended_error(std::move(error_code), std::move(error_message), std::move(details));
+            }
+
+            // Each request is answered in a part with the Content-ID of the request. A failure of the batch as a whole is reported in a part without one.
+            core::mime_byte_range content_id = core::mime_multipart_reader::find_header(part_headers, "Content-ID");
+            size_t index = 0;
+            const uint8_t* it = content_id.begin;
+            for (; it != content_id.end && *it >= '0' && *it <= '9' && index < batch_size; ++it)
+            {
+                index = index * 10 + static_cast<size_t>(*it - '0');
+            }
+
+            if (content_id.empty() || it != content_id.end || index >= batch_size)
+            {
+                if (succeeded)
+                {
+                    throw storage_exception(protocol::error_batch_response_not_valid, false);
+                }
+
+                request_result result(utility::datetime(), storage_location::unspecified, response, static_cast<web::http::status_code>(status_code), std::move(extended_error));
+                throw storage_exception(status_message.str(), result);
+            }
+
+            if (!answered[index])
+            {
+                answered[index] = true;
+                ++answered_count;
+            }
+
+            batch_result[index] = blob_batch_result(status_code, std::move(extended_error));
+
+            has_part = reader.read_next_part(delimiter);
+            if (has_part)
+            {
+                part_headers.clear();
+                reader.read_part_headers(&part_headers);
+            }
+        }
+
+        if (answered_count != batch_size)
+        {
+            std::string str;
+            str.reserve(128);
+            str.append(protocol::error_batch_size_not_match_response).append(" Sent ").append(std::to_string(batch_size)).append(" batch requests and received ").append(std::to_string(answered_count)).append(" batch results.");
+            throw storage_exception(str, false);
+        }
+
+        return batch_result;
+    }
+
 }}} // namespace azure::storage::protocol
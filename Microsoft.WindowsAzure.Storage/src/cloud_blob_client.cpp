@@ -16,6 +16,10 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <algorithm>
+#include <mutex>
+
 #include "was/blob.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
@@ -24,13 +28,16 @@ namespace azure { namespace storage {
 
     container_result_iterator cloud_blob_client::list_containers(const utility::string_t& prefix, container_listing_details::values includes, int max_results, const blob_request_options& options, operation_context context) const
     {
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(default_request_options(), blob_type::unspecified, false);
+
         auto instance = std::make_shared<cloud_blob_client>(*this);
         return container_result_iterator(
             [instance, prefix, includes, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_containers_segmented(prefix, includes, (int)max_results_per_segment, token, options, context);
+            return instance->list_containers_segmented_async(prefix, includes, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, modified_options.listing_prefetch_depth());
     }
 
     pplx::task<container_result_segment> cloud_blob_client::list_containers_segmented_async(const utility::string_t& prefix, container_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
@@ -120,6 +127,179 @@ namespace azure { namespace storage {
         return download_account_properties_base_async(base_uri(), modified_options, context, cancellation_token);
     }
 
+    void blob_batch_operation::delete_blob(const cloud_blob& blob, delete_snapshots_option snapshots_option, const access_condition& condition)
+    {
+        m_requests.push_back(blob_batch_request(blob_batch_request_type::delete_blob, blob.uri().primary_uri(), blob.snapshot_time(), snapshots_option, standard_blob_tier::unknown, condition));
+    }
+
+    void blob_batch_operation::set_standard_blob_tier(const cloud_blob& blob, standard_blob_tier tier, const access_condition& condition)
+    {
+        if (blob.is_snapshot())
+        {
+            throw std::invalid_argument("blob");
+        }
+
+        m_requests.push_back(blob_batch_request(blob_batch_request_type::set_standard_blob_tier, blob.uri().primary_uri(), utility::string_t(), delete_snapshots_option::none, tier, condition));
+    }
+
+    pplx::task<std::vector<blob_batch_result>> cloud_blob_client::execute_batch_async(const blob_batch_operation& operation, const blob_request_options& options, operation_context context) const
+    {
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(default_request_options(), blob_type::unspecified);
+
+        size_t batch_size = operation.size();
+        if (batch_size == 0)
+        {
+            throw std::invalid_argument(protocol::error_empty_batch_operation);
+        }
+
+        if (batch_size > protocol::max_blob_batch_size)
+        {
+            throw std::invalid_argument(protocol::error_blob_batch_too_large);
+        }
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> response_buffer;
+
+        auto command = std::make_shared<core::storage_command<std::vector<blob_batch_result>>>(base_uri(), pplx::cancellation_token::none(), modified_options.is_maximum_execution_time_customized());
+        command->set_build_request(std::bind(protocol::blob_batch, operation, authentication_handler(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(authentication_handler());
+        command->set_destination_stream(response_buffer.create_ostream());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<std::vector<blob_batch_result>>, std::vector<blob_batch_result>(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([response_buffer, batch_size] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) mutable -> pplx::task<std::vector<blob_batch_result>>
+        {
+            UNREFERENCED_PARAMETER(context);
+            return response.content_ready().then([response_buffer, batch_size] (const web::http::http_response& response) mutable -> pplx::task<std::vector<blob_batch_result>>
+            {
+                return pplx::task_from_result(protocol::blob_response_parsers::parse_batch_results(response, response_buffer, batch_size));
+            });
+        });
+        return core::executor<std::vector<blob_batch_result>>::execute_async(command, modified_options, context);
+    }
+
+    namespace
+    {
+        // Splits a blob batch operation into batches of the largest size the service accepts, and sends them with a fixed number of workers that
+        // each take the next batch in turn. Each batch writes its results into its own range of the results, so only taking a batch needs the mutex.
+        class blob_batch_pipeline : public std::enable_shared_from_this<blob_batch_pipeline>
+        {
+        public:
+
+            blob_batch_pipeline(cloud_blob_client client, blob_batch_operation operation, blob_request_options options, operation_context context)
+                : m_client(std::move(client)), m_operation(std::move(operation)), m_options(std::move(options)), m_context(std::move(context)),
+                m_results(m_operation.size()), m_next_request(0)
+            {
+            }
+
+            pplx::task<std::vector<blob_batch_result>> run()
+            {
+                size_t batch_count = (m_operation.size() + protocol::max_blob_batch_size - 1) / protocol::max_blob_batch_size;
+                size_t worker_count = std::min(static_cast<size_t>(std::max(m_options.parallelism_factor(), 1)), batch_count);
+
+                std::vector<pplx::task<void>> workers;
+                workers.reserve(worker_count);
+                for (size_t i = 0; i < worker_count; ++i)
+                {
+                    workers.push_back(execute_next_batch());
+                }
+
+                // Workers record failures instead of failing their tasks, so that every batch in flight has completed before the operation does
+                auto instance = shared_from_this();
+                return pplx::when_all(workers.begin(), workers.end()).then([instance] ()
+                {
+                    std::exception_ptr exception;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        exception = instance->m_exception;
+                    }
+
+                    if (exception != nullptr)
+                    {
+                        std::rethrow_exception(exception);
+                    }
+
+                    return std::move(instance->m_results);
+                });
+            }
+
+        private:
+
+            pplx::task<void> execute_next_batch()
+            {
+                size_t first;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_exception != nullptr || m_next_request == m_operation.size())
+                    {
+                        return pplx::task_from_result();
+                    }
+
+                    first = m_next_request;
+                    m_next_request += std::min(protocol::max_blob_batch_size, m_operation.size() - first);
+                }
+
+                size_t count = std::min(protocol::max_blob_batch_size, m_operation.size() - first);
+                blob_batch_operation batch;
+                batch.requests().assign(m_operation.requests().cbegin() + first, m_operation.requests().cbegin() + first + count);
+
+                pplx::task<std::vector<blob_batch_result>> batch_task;
+                try
+                {
+                    batch_task = m_client.execute_batch_async(batch, m_options, m_context);
+                }
+                catch (const std::exception&)
+                {
+                    batch_task = pplx::task_from_exception<std::vector<blob_batch_result>>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                return batch_task.then([instance, first] (pplx::task<std::vector<blob_batch_result>> batch_task) -> pplx::task<void>
+                {
+                    try
+                    {
+                        std::vector<blob_batch_result> results = batch_task.get();
+                        std::move(results.begin(), results.end(), instance->m_results.begin() + first);
+                    }
+                    catch (const std::exception&)
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        if (instance->m_exception == nullptr)
+                        {
+                            instance->m_exception = std::current_exception();
+                        }
+
+                        return pplx::task_from_result();
+                    }
+
+                    return instance->execute_next_batch();
+                });
+            }
+
+            cloud_blob_client m_client;
+            blob_batch_operation m_operation;
+            blob_request_options m_options;
+            operation_context m_context;
+            std::vector<blob_batch_result> m_results;
+
+            std::mutex m_mutex;
+            size_t m_next_request;
+            std::exception_ptr m_exception;
+        };
+    }
+
+    pplx::task<std::vector<blob_batch_result>> cloud_blob_client::execute_bulk_batch_async(const blob_batch_operation& operation, const blob_request_options& options, operation_context context) const
+    {
+        if (operation.size() == 0)
+        {
+            return pplx::task_from_result(std::vector<blob_batch_result>());
+        }
+
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(default_request_options(), blob_type::unspecified);
+
+        auto pipeline = std::make_shared<blob_batch_pipeline>(*this, operation, modified_options, context);
+        return pipeline->run();
+    }
+
     cloud_blob_container cloud_blob_client::get_root_container_reference() const
     {
         return get_container_reference(protocol::root_container);
@@ -16,12 +16,16 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <mutex>
+
 #include "was/blob.h"
 #include "was/error_code_strings.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
 #include "wascore/util.h"
 #include "wascore/constants.h"
+#include "wascore/async_semaphore.h"
 
 namespace azure { namespace storage {
 
@@ -442,13 +446,30 @@ namespace azure { namespace storage {
 
     list_blob_item_iterator cloud_blob_container::list_blobs(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const blob_request_options& options, operation_context context) const
     {
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified, false);
+
         auto instance = std::make_shared<cloud_blob_container>(*this);
         return list_blob_item_iterator(
             [instance, prefix, use_flat_blob_listing, includes, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_blobs_segmented(prefix, use_flat_blob_listing, includes, (int)max_results_per_segment, token, options, context);
+            return instance->list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, 0, modified_options.listing_prefetch_depth());
+    }
+
+    pplx::task<void> cloud_blob_container::list_blobs_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const std::function<void(const list_blob_item&)>& item_callback, const blob_request_options& options, operation_context context) const
+    {
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified, false);
+
+        auto instance = std::make_shared<cloud_blob_container>(*this);
+        return core::enumerate_segments_async<list_blob_item>(
+            [instance, prefix, use_flat_blob_listing, includes, options, context](const continuation_token& token, size_t max_results_per_segment)
+        {
+            return instance->list_blobs_segmented_async(prefix, use_flat_blob_listing, includes, (int)max_results_per_segment, token, options, context);
+        },
+            max_results, modified_options.listing_prefetch_depth(), item_callback);
     }
 
     pplx::task<list_blob_item_segment> cloud_blob_container::list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
@@ -505,6 +526,483 @@ namespace azure { namespace storage {
         return core::executor<list_blob_item_segment>::execute_async(command, modified_options, context);
     }
 
+    namespace
+    {
+        // The last item a callback listing has delivered, kept across the attempts of one request
+        struct listing_progress
+        {
+            listing_progress()
+                : delivered(false)
+            {
+            }
+
+            bool delivered;
+            utility::string_t name;
+            utility::string_t snapshot_time;
+            utility::string_t version_id;
+            std::exception_ptr callback_exception;
+        };
+    }
+
+    pplx::task<continuation_token> cloud_blob_container::list_blobs_segmented_async(const utility::string_t& prefix, bool use_flat_blob_listing, blob_listing_details::values includes, int max_results, const continuation_token& token, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
+    {
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified);
+
+        auto container = *this;
+        utility::string_t delimiter;
+
+        if (!use_flat_blob_listing)
+        {
+            if ((includes & blob_listing_details::snapshots) != 0)
+            {
+                throw std::invalid_argument("includes");
+            }
+
+            delimiter = service_client().directory_delimiter();
+        }
+
+        auto command = std::make_shared<core::storage_command<continuation_token>>(uri(), cancellation_token, modified_options.is_maximum_execution_time_customized());
+        command->set_build_request(std::bind(protocol::list_blobs, prefix, delimiter, includes, max_results, token, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<continuation_token>, continuation_token(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        // A retried request lists the same segment again, possibly from the other location or after the listing changed, so the items up to
+        // the last one delivered by earlier attempts are skipped by name rather than by position.
+        auto progress = std::make_shared<listing_progress>();
+        command->set_postprocess_response([container, includes, item_callback, progress] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<continuation_token>
+        {
+            protocol::list_blobs_reader reader(response.body());
+            bool resuming = progress->delivered;
+            auto deliver = [&resuming, &progress, &item_callback] (const utility::string_t& name, const utility::string_t& snapshot_time, const utility::string_t& version_id, const std::function<list_blob_item()>& make_item)
+            {
+                if (resuming)
+                {
+                    if (name == progress->name && snapshot_time == progress->snapshot_time && version_id == progress->version_id)
+                    {
+                        resuming = false;
+                        return;
+                    }
+
+                    if (name <= progress->name)
+                    {
+                        return;
+                    }
+
+                    resuming = false;
+                }
+
+                progress->delivered = true;
+                progress->name = name;
+                progress->snapshot_time = snapshot_time;
+                progress->version_id = version_id;
+
+                // An exception from the callback is not a problem with the response, so it ends the operation instead of being retried
+                try
+                {
+                    item_callback(make_item());
+                }
+                catch (...)
+                {
+                    progress->callback_exception = std::current_exception();
+                    throw storage_exception(protocol::error_listing_callback_failed, false);
+                }
+            };
+
+            // Items are handed over in document order as the reader completes them, so only one is alive at a time.
+            utility::string_t next_marker = reader.parse_items([&container, includes, &deliver] (protocol::cloud_blob_list_item& item)
+            {
+                utility::string_t name = item.move_name();
+                utility::string_t snapshot_time = item.move_snapshot_time();
+                auto properties = item.move_properties();
+                utility::string_t version_id = (includes & blob_listing_details::values::versions) ? properties.version_id() : utility::string_t();
+                deliver(name, snapshot_time, version_id, [&container, &item, &name, &snapshot_time, &version_id, &properties] ()
+                {
+                    return list_blob_item(std::move(name), std::move(snapshot_time), std::move(version_id), item.is_current_version(), container, std::move(properties), item.move_metadata(), item.move_copy_state());
+                });
+            },
+            [&container, &deliver] (protocol::cloud_blob_prefix_list_item& item)
+            {
+                utility::string_t name = item.move_name();
+                deliver(name, utility::string_t(), utility::string_t(), [&container, &name] ()
+                {
+                    return list_blob_item(std::move(name), container);
+                });
+            });
+
+            continuation_token next_token(std::move(next_marker));
+            next_token.set_target_location(result.target_location());
+
+            return pplx::task_from_result(next_token);
+        });
+
+        return core::executor<continuation_token>::execute_async(command, modified_options, context).then([progress] (pplx::task<continuation_token> list_task)
+        {
+            try
+            {
+                return list_task.get();
+            }
+            catch (const storage_exception&)
+            {
+                // The exception thrown by the callback is reported as it was thrown
+                if (progress->callback_exception != nullptr)
+                {
+                    std::rethrow_exception(progress->callback_exception);
+                }
+
+                throw;
+            }
+        });
+    }
+
+    namespace
+    {
+        // Drives a breadth-first, prefix-sharded listing. Every virtual directory found is listed as its own shard,
+        // and at most parallelism_factor segment requests are in flight at any time.
+        class parallel_blob_listing : public std::enable_shared_from_this<parallel_blob_listing>
+        {
+        public:
+            parallel_blob_listing(cloud_blob_container container, blob_listing_details::values includes, bool lexical_order, std::function<void(list_blob_item)> item_callback, blob_request_options options, operation_context context, pplx::cancellation_token cancellation_token)
+                : m_container(std::move(container)), m_includes(includes), m_lexical_order(lexical_order), m_item_callback(std::move(item_callback)), m_options(std::move(options)), m_context(std::move(context)), m_cancellation_token(std::move(cancellation_token)),
+                m_semaphore(std::max(m_options.parallelism_factor(), 1)), m_pending(0)
+            {
+            }
+
+            pplx::task<void> run(utility::string_t prefix)
+            {
+                auto root = std::make_shared<shard>(std::move(prefix));
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_lexical_order)
+                    {
+                        m_cursor.push_back(std::make_pair(root, (size_t)0));
+                    }
+
+                    ++m_pending;
+                }
+
+                list_segment(root, continuation_token());
+                return pplx::create_task(m_completion);
+            }
+
+        private:
+            struct shard;
+
+            // An entry in a shard is either a blob or the shard listing a virtual directory, kept in the order the service returned them.
+            struct shard_entry
+            {
+                std::unique_ptr<list_blob_item> item;
+                std::shared_ptr<shard> child;
+            };
+
+            struct shard
+            {
+                explicit shard(utility::string_t prefix)
+                    : prefix(std::move(prefix)), complete(false)
+                {
+                }
+
+                utility::string_t prefix;
+                std::vector<shard_entry> entries;
+                bool complete;
+            };
+
+            typedef std::pair<std::shared_ptr<shard>, continuation_token> pending_segment;
+
+            // The caller must have counted the request in m_pending.
+            void list_segment(std::shared_ptr<shard> target, continuation_token token)
+            {
+                auto instance = shared_from_this();
+                m_semaphore.lock_async().then([instance, target, token] ()
+                {
+                    std::unique_lock<core::async_semaphore> sem_unlocker(instance->m_semaphore, std::adopt_lock);
+                    if (instance->is_failed())
+                    {
+                        sem_unlocker.unlock();
+                        instance->complete_segment();
+                        return;
+                    }
+
+                    // The callback listing keeps the document order of the response, in which blobs and virtual directories are interleaved
+                    // by name, whereas a segment lists all blobs before all directories.
+                    pplx::task<list_blob_item_segment> segment_task;
+                    try
+                    {
+                        auto items = std::make_shared<std::vector<list_blob_item>>();
+                        segment_task = instance->m_container.list_blobs_segmented_async(target->prefix, false, instance->m_includes, 0, token, [items] (list_blob_item item)
+                        {
+                            items->push_back(std::move(item));
+                        }, instance->m_options, instance->m_context, instance->m_cancellation_token).then([items] (continuation_token next_token)
+                        {
+                            return list_blob_item_segment(std::move(*items), std::move(next_token));
+                        });
+                    }
+                    catch (...)
+                    {
+                        segment_task = pplx::task_from_exception<list_blob_item_segment>(std::current_exception());
+                    }
+
+                    sem_unlocker.release();
+                    segment_task.then([instance, target] (pplx::task<list_blob_item_segment> completed_task)
+                    {
+                        instance->m_semaphore.unlock();
+                        try
+                        {
+                            instance->process_segment(target, completed_task.get());
+                        }
+                        catch (...)
+                        {
+                            instance->fail(std::current_exception());
+                        }
+
+                        instance->complete_segment();
+                    });
+                });
+            }
+
+            void process_segment(const std::shared_ptr<shard>& target, list_blob_item_segment segment)
+            {
+                std::vector<pending_segment> next_segments;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_exception != nullptr)
+                    {
+                        return;
+                    }
+
+                    auto& results = segment.results();
+                    for (auto iter = results.begin(); iter != results.end(); ++iter)
+                    {
+                        if (iter->is_blob())
+                        {
+                            if (m_lexical_order)
+                            {
+                                shard_entry entry;
+                                entry.item.reset(new list_blob_item(std::move(*iter)));
+                                target->entries.push_back(std::move(entry));
+                            }
+                            else
+                            {
+                                m_item_callback(std::move(*iter));
+                            }
+                        }
+                        else
+                        {
+                            auto child = std::make_shared<shard>(iter->as_directory().prefix());
+                            if (m_lexical_order)
+                            {
+                                shard_entry entry;
+                                entry.child = child;
+                                target->entries.push_back(std::move(entry));
+                            }
+
+                            next_segments.push_back(pending_segment(std::move(child), continuation_token()));
+                        }
+                    }
+
+                    if (!segment.continuation_token().empty())
+                    {
+                        next_segments.push_back(pending_segment(target, segment.continuation_token()));
+                    }
+                    else
+                    {
+                        target->complete = true;
+                    }
+
+                    m_pending += next_segments.size();
+
+                    if (m_lexical_order)
+                    {
+                        try
+                        {
+                            deliver_ordered_items();
+                        }
+                        catch (...)
+                        {
+                            // The segments counted above still have to run so that the pending count drains; they stop as soon as they see the failure.
+                            m_exception = std::current_exception();
+                        }
+                    }
+                }
+
+                for (auto iter = next_segments.begin(); iter != next_segments.end(); ++iter)
+                {
+                    list_segment(std::move(iter->first), std::move(iter->second));
+                }
+            }
+
+            // Walks the shard tree depth-first from where the previous call stopped, delivering every blob that is known to precede all
+            // blobs not listed yet. Expanding each directory in place yields the same order as a flat listing. Must be called under m_mutex.
+            void deliver_ordered_items()
+            {
+                while (!m_cursor.empty())
+                {
+                    std::shared_ptr<shard> current = m_cursor.back().first;
+                    size_t& index = m_cursor.back().second;
+                    if (index < current->entries.size())
+                    {
+                        shard_entry& entry = current->entries[index++];
+                        if (entry.child != nullptr)
+                        {
+                            m_cursor.push_back(std::make_pair(std::move(entry.child), (size_t)0));
+                        }
+                        else
+                        {
+                            std::unique_ptr<list_blob_item> item(std::move(entry.item));
+                            m_item_callback(std::move(*item));
+                        }
+                    }
+                    else if (current->complete)
+                    {
+                        std::vector<shard_entry>().swap(current->entries);
+                        m_cursor.pop_back();
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+            }
+
+            bool is_failed()
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                return m_exception != nullptr;
+            }
+
+            void fail(std::exception_ptr exception)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (m_exception == nullptr)
+                {
+                    m_exception = exception;
+                }
+            }
+
+            void complete_segment()
+            {
+                std::exception_ptr exception;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (--m_pending != 0)
+                    {
+                        return;
+                    }
+
+                    exception = m_exception;
+                    m_cursor.clear();
+                }
+
+                if (exception != nullptr)
+                {
+                    m_completion.set_exception(exception);
+                }
+                else
+                {
+                    m_completion.set();
+                }
+            }
+
+            cloud_blob_container m_container;
+            blob_listing_details::values m_includes;
+            bool m_lexical_order;
+            std::function<void(list_blob_item)> m_item_callback;
+            blob_request_options m_options;
+            operation_context m_context;
+            pplx::cancellation_token m_cancellation_token;
+            core::async_semaphore m_semaphore;
+
+            std::mutex m_mutex;
+            size_t m_pending;
+            std::exception_ptr m_exception;
+            std::vector<std::pair<std::shared_ptr<shard>, size_t>> m_cursor;
+            pplx::task_completion_event<void> m_completion;
+        };
+    }
+
+    pplx::task<void> cloud_blob_container::list_blobs_parallel_async(const utility::string_t& prefix, blob_listing_details::values includes, bool lexical_order, const std::function<void(list_blob_item)>& item_callback, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
+    {
+        if ((includes & blob_listing_details::snapshots) != 0)
+        {
+            throw std::invalid_argument("includes");
+        }
+
+        if (!item_callback)
+        {
+            throw std::invalid_argument("item_callback");
+        }
+
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified);
+
+        auto listing = std::make_shared<parallel_blob_listing>(*this, includes, lexical_order, item_callback, modified_options, context, cancellation_token);
+        return listing->run(prefix);
+    }
+
+    pplx::task<list_blob_record_segment> cloud_blob_container::list_blob_records_segmented_async(const utility::string_t& prefix, blob_listing_details::values includes, int max_results, const continuation_token& token, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token) const
+    {
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), blob_type::unspecified);
+
+        auto command = std::make_shared<core::storage_command<list_blob_record_segment>>(uri(), cancellation_token, modified_options.is_maximum_execution_time_customized());
+        command->set_build_request(std::bind(protocol::list_blobs, prefix, utility::string_t(), includes, max_results, token, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<list_blob_record_segment>, list_blob_record_segment(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<list_blob_record_segment>
+        {
+            protocol::list_blobs_reader reader(response.body());
+
+            // The reader hands over the fields of each blob as it parses them; they are appended to the segment's buffer, which only
+            // grows by doubling, so the cost of a segment scales with the bytes listed rather than with the number of fields.
+            auto buffer = std::make_shared<list_blob_record::segment_buffer>();
+            auto append = [&buffer] (const utility::string_t& value) -> list_blob_record::text_range
+            {
+                list_blob_record::text_range range;
+                range.offset = buffer->text.size();
+                range.length = value.size();
+                buffer->text.append(value);
+                return range;
+            };
+
+            std::vector<list_blob_record> records;
+            utility::string_t next_marker = reader.parse_records([&records, &buffer, &append] (utility::string_t& name, utility::string_t& snapshot_time, cloud_blob_properties& properties, protocol::list_blobs_reader::metadata_pairs& metadata)
+            {
+                list_blob_record record;
+                record.m_name = append(name);
+                record.m_snapshot_time = append(snapshot_time);
+                record.m_etag = append(properties.m_etag);
+                record.m_content_md5 = append(properties.m_content_md5);
+                record.m_size = properties.size();
+                record.m_last_modified = properties.last_modified();
+                record.m_standard_blob_tier = properties.standard_blob_tier();
+                record.m_metadata_offset = buffer->metadata.size();
+                record.m_metadata_size = metadata.size();
+                for (auto iter = metadata.begin(); iter != metadata.end(); ++iter)
+                {
+                    buffer->metadata.push_back(append(iter->first));
+                    buffer->metadata.push_back(append(iter->second));
+                }
+
+                records.push_back(std::move(record));
+            });
+
+            // The buffer may still move while it grows, so it is attached to the records only once it is complete.
+            std::shared_ptr<const list_blob_record::segment_buffer> shared_buffer(std::move(buffer));
+            for (auto iter = records.begin(); iter != records.end(); ++iter)
+            {
+                iter->m_buffer = shared_buffer;
+            }
+
+            continuation_token next_token(std::move(next_marker));
+            next_token.set_target_location(result.target_location());
+
+            return pplx::task_from_result(list_blob_record_segment(std::move(records), std::move(next_token)));
+        });
+
+        return core::executor<list_blob_record_segment>::execute_async(command, modified_options, context);
+    }
+
     pplx::task<void> cloud_blob_container::upload_permissions_async(const blob_container_permissions& permissions, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token)
     {
         blob_request_options modified_options(options);
@@ -17,6 +17,7 @@
 
 #include "stdafx.h"
 #include "was/error_code_strings.h"
+#include "wascore/base64.h"
 #include "wascore/blobstreams.h"
 #include "wascore/logging.h"
 #include "wascore/resources.h"
@@ -103,8 +104,7 @@ namespace azure { namespace storage { namespace core {
         utility::ostringstream_t str;
         str << m_block_id_prefix << _XPLATSTR('-') << std::setw(6) << std::setfill(_XPLATSTR('0')) << m_block_list.size();
         auto utf8_block_id = utility::conversions::to_utf8string(str.str());
-        std::vector<unsigned char> block_id_as_array(utf8_block_id.cbegin(), utf8_block_id.cend());
-        utility::string_t block_id(utility::conversions::to_base64(block_id_as_array));
+        utility::string_t block_id(core::to_base64(reinterpret_cast<const uint8_t*>(utf8_block_id.data()), utf8_block_id.size()));
         m_block_list.push_back(block_list_item(block_id));
         return block_id;
     }
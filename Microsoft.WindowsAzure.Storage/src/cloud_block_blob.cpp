@@ -16,12 +16,131 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
 #include "wascore/blobstreams.h"
+#include "wascore/base64.h"
 
 namespace azure { namespace storage {
 
+    namespace
+    {
+        // Copies a source blob into a block blob with Put Block From URL, so that the service moves the data. The source is split into blocks
+        // and a fixed number of workers each claim the next block in turn until every block has been copied or one of them has failed.
+        class block_copier : public std::enable_shared_from_this<block_copier>
+        {
+        public:
+
+            block_copier(cloud_block_blob destination, web::http::uri source_uri, utility::size64_t length, utility::size64_t block_size, access_condition source_condition, access_condition condition, blob_request_options options, operation_context context)
+                : m_destination(std::move(destination)), m_source_uri(std::move(source_uri)), m_length(length), m_block_size(block_size),
+                m_source_condition(std::move(source_condition)), m_condition(std::move(condition)), m_options(std::move(options)), m_context(std::move(context)), m_next_block(0), m_failed(false)
+            {
+                size_t block_count = static_cast<size_t>((m_length + m_block_size - 1) / m_block_size);
+                utility::string_t block_id_prefix = utility::uuid_to_string(utility::new_uuid());
+                m_block_list.reserve(block_count);
+                for (size_t i = 0; i < block_count; ++i)
+                {
+                    utility::ostringstream_t str;
+                    str << block_id_prefix << _XPLATSTR('-') << std::setw(6) << std::setfill(_XPLATSTR('0')) << i;
+                    auto utf8_block_id = utility::conversions::to_utf8string(str.str());
+                    m_block_list.push_back(block_list_item(core::to_base64(reinterpret_cast<const uint8_t*>(utf8_block_id.data()), utf8_block_id.size())));
+                }
+            }
+
+            pplx::task<std::vector<block_list_item>> copy_blocks()
+            {
+                // An empty source is copied by committing an empty block list
+                if (m_block_list.empty())
+                {
+                    return pplx::task_from_result(m_block_list);
+                }
+
+                size_t worker_count = std::min(static_cast<size_t>(std::max(m_options.parallelism_factor(), 1)), m_block_list.size());
+
+                std::vector<pplx::task<void>> workers;
+                workers.reserve(worker_count);
+                for (size_t i = 0; i < worker_count; ++i)
+                {
+                    workers.push_back(copy_next_block());
+                }
+
+                auto instance = shared_from_this();
+                return pplx::when_all(workers.begin(), workers.end()).then([instance] ()
+                {
+                    return instance->m_block_list;
+                });
+            }
+
+        private:
+
+            pplx::task<void> copy_next_block()
+            {
+                size_t block;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_failed || m_next_block == m_block_list.size())
+                    {
+                        return pplx::task_from_result();
+                    }
+
+                    block = m_next_block++;
+                }
+
+                utility::size64_t offset = static_cast<utility::size64_t>(block) * m_block_size;
+                utility::size64_t length = std::min(m_block_size, m_length - offset);
+
+                pplx::task<void> copy_task;
+                try
+                {
+                    copy_task = m_destination.upload_block_from_url_async(m_block_list[block].id(), m_source_uri, offset, length, checksum(checksum_none), m_source_condition, m_condition, m_options, m_context);
+                }
+                catch (const std::exception&)
+                {
+                    copy_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                return copy_task.then([instance] (pplx::task<void> copy_task) -> pplx::task<void>
+                {
+                    try
+                    {
+                        copy_task.wait();
+                    }
+                    catch (const std::exception&)
+                    {
+                        {
+                            std::lock_guard<std::mutex> guard(instance->m_mutex);
+                            instance->m_failed = true;
+                        }
+
+                        throw;
+                    }
+
+                    return instance->copy_next_block();
+                });
+            }
+
+            cloud_block_blob m_destination;
+            web::http::uri m_source_uri;
+            utility::size64_t m_length;
+            utility::size64_t m_block_size;
+            access_condition m_source_condition;
+            access_condition m_condition;
+            blob_request_options m_options;
+            operation_context m_context;
+
+            std::mutex m_mutex;
+            std::vector<block_list_item> m_block_list;
+            size_t m_next_block;
+            bool m_failed;
+        };
+    }
+
     pplx::task<void> cloud_block_blob::upload_block_async_impl(const utility::string_t& block_id, concurrency::streams::istream block_data, const checksum& content_checksum, const access_condition& condition, const blob_request_options& options, operation_context context, const pplx::cancellation_token& cancellation_token, bool use_timeout, std::shared_ptr<core::timer_handler> timer_handler) const
     {
         assert_no_snapshot();
@@ -373,4 +492,71 @@ namespace azure { namespace storage {
         return core::executor<void>::execute_async(command, modified_options, context);
     }
 
+    pplx::task<void> cloud_block_blob::upload_block_from_url_async(const utility::string_t& block_id, const web::http::uri& source, utility::size64_t offset, utility::size64_t length, const checksum& source_checksum, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, operation_context context) const
+    {
+        assert_no_snapshot();
+        if (length == 0 || length > protocol::max_block_from_url_size)
+        {
+            throw std::invalid_argument("length");
+        }
+
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), type());
+
+        auto command = std::make_shared<core::storage_command<void>>(uri());
+        command->set_build_request(std::bind(protocol::put_block_from_url, block_id, source, offset, length, source_checksum, source_condition, condition, modified_options, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response_void, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        return core::executor<void>::execute_async(command, modified_options, context);
+    }
+
+    pplx::task<void> cloud_block_blob::copy_from_blob_async(const cloud_blob& source, const access_condition& source_condition, const access_condition& condition, const blob_request_options& options, operation_context context)
+    {
+        assert_no_snapshot();
+        blob_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), type());
+
+        // The attributes are read into a separate reference, so that the caller's source object is left as it was
+        auto source_blob = std::make_shared<cloud_blob>(source.uri(), source.snapshot_time(), source.service_client().credentials());
+        web::http::uri source_uri = source.service_client().credentials().transform_uri(source.snapshot_qualified_uri().primary_uri());
+
+        // The copy shares its properties and metadata with this blob
+        auto instance = std::make_shared<cloud_block_blob>(*this);
+        return source_blob->download_attributes_async(source_condition, modified_options, context).then([instance, source_blob, source_uri, source_condition, condition, modified_options, context] () -> pplx::task<void>
+        {
+            const cloud_blob_properties& source_properties = source_blob->properties();
+            utility::size64_t length = source_properties.size();
+
+            // Blocks are at least the stream write size, and larger when needed to stay within the block count limit
+            utility::size64_t block_size = std::max(static_cast<utility::size64_t>(modified_options.stream_write_size_in_bytes()), (length + protocol::max_block_number - 1) / protocol::max_block_number);
+            if (block_size > protocol::max_block_from_url_size)
+            {
+                throw std::invalid_argument("source");
+            }
+
+            // Every block is read from the version of the source whose attributes were just read
+            access_condition block_source_condition(source_condition);
+            if (block_source_condition.if_match_etag().empty())
+            {
+                block_source_condition.set_if_match_etag(source_properties.etag());
+            }
+
+            cloud_blob_properties& properties = instance->properties();
+            properties.set_cache_control(source_properties.cache_control());
+            properties.set_content_disposition(source_properties.content_disposition());
+            properties.set_content_encoding(source_properties.content_encoding());
+            properties.set_content_language(source_properties.content_language());
+            properties.set_content_md5(source_properties.content_md5());
+            properties.set_content_type(source_properties.content_type());
+            instance->metadata() = source_blob->metadata();
+
+            // Each block carries the destination condition too, so that the blocks of a leased destination are staged under its lease
+            auto copier = std::make_shared<block_copier>(*instance, source_uri, length, block_size, block_source_condition, condition, modified_options, context);
+            return copier->copy_blocks().then([instance, condition, modified_options, context] (std::vector<block_list_item> block_list)
+            {
+                return instance->upload_block_list_async(block_list, condition, modified_options, context);
+            });
+        });
+    }
+
 }} // namespace azure::storage
@@ -0,0 +1,359 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="cloud_copy_orchestrator.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <queue>
+
+#include "was/blob.h"
+#include "was/file.h"
+#include "wascore/util.h"
+
+namespace azure { namespace storage {
+
+    namespace core
+    {
+        // Drives a cloud_copy_orchestrator. Requests waiting to be sent are queued until fewer than the maximum are in flight, with the polls that
+        // are due sent ahead of the copies that have not been started, so that a finished copy is not held up by a long backlog. The pending
+        // copies wait in a heap ordered by when they are next checked, behind a single timer set for the first of them. All state is guarded by
+        // the mutex, while requests are sent after it is released.
+        class copy_orchestrator_engine : public std::enable_shared_from_this<copy_orchestrator_engine>
+        {
+        public:
+
+            copy_orchestrator_engine(size_t max_in_flight, std::chrono::milliseconds minimum_interval, std::chrono::milliseconds maximum_interval)
+                : m_max_in_flight(max_in_flight), m_minimum_interval(minimum_interval), m_maximum_interval(maximum_interval),
+                m_in_flight(0), m_tracked_count(0), m_timer_scheduled(false), m_timer_generation(0)
+            {
+            }
+
+            pplx::task<copy_state> add(std::function<pplx::task<copy_state>()> start, std::function<pplx::task<copy_state>()> poll)
+            {
+                auto copy = std::make_shared<tracked_copy>(std::move(start), std::move(poll), m_minimum_interval);
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    ++m_tracked_count;
+                    m_starts.push_back(copy);
+                }
+
+                auto completed = pplx::create_task(copy->completed);
+                pump();
+                return completed;
+            }
+
+            size_t tracked_count()
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                return m_tracked_count;
+            }
+
+        private:
+
+            struct tracked_copy
+            {
+                tracked_copy(std::function<pplx::task<copy_state>()> start, std::function<pplx::task<copy_state>()> poll, std::chrono::milliseconds interval)
+                    : start(std::move(start)), poll(std::move(poll)), started(false), bytes_copied(0), interval(interval)
+                {
+                }
+
+                std::function<pplx::task<copy_state>()> start;
+                std::function<pplx::task<copy_state>()> poll;
+                pplx::task_completion_event<copy_state> completed;
+
+                bool started;
+                int64_t bytes_copied;
+                std::chrono::steady_clock::time_point checked_time;
+                std::chrono::milliseconds interval;
+            };
+
+            struct poll_entry
+            {
+                poll_entry(std::chrono::steady_clock::time_point due, std::shared_ptr<tracked_copy> copy)
+                    : due(due), copy(std::move(copy))
+                {
+                }
+
+                std::chrono::steady_clock::time_point due;
+                std::shared_ptr<tracked_copy> copy;
+            };
+
+            struct due_later
+            {
+                bool operator()(const poll_entry& left, const poll_entry& right) const
+                {
+                    return left.due > right.due;
+                }
+            };
+
+            // Sends the queued requests while fewer than the maximum are in flight, the due polls first
+            void pump()
+            {
+                std::vector<std::shared_ptr<tracked_copy>> to_send;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    while (m_in_flight < m_max_in_flight && !m_due_polls.empty())
+                    {
+                        ++m_in_flight;
+                        to_send.push_back(std::move(m_due_polls.front()));
+                        m_due_polls.pop_front();
+                    }
+
+                    while (m_in_flight < m_max_in_flight && !m_starts.empty())
+                    {
+                        ++m_in_flight;
+                        to_send.push_back(std::move(m_starts.front()));
+                        m_starts.pop_front();
+                    }
+                }
+
+                for (auto it = to_send.begin(); it != to_send.end(); ++it)
+                {
+                    send(*it);
+                }
+            }
+
+            void send(std::shared_ptr<tracked_copy> copy)
+            {
+                pplx::task<copy_state> state_task;
+                try
+                {
+                    state_task = copy->started ? copy->poll() : copy->start();
+                }
+                catch (const std::exception&)
+                {
+                    state_task = pplx::task_from_exception<copy_state>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                state_task.then([instance, copy] (pplx::task<copy_state> task)
+                {
+                    copy_state state;
+                    std::exception_ptr exception;
+                    try
+                    {
+                        state = task.get();
+                    }
+                    catch (const std::exception&)
+                    {
+                        exception = std::current_exception();
+                    }
+
+                    bool completed = exception != nullptr || state.status() != copy_status::pending;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        --instance->m_in_flight;
+
+                        if (completed)
+                        {
+                            --instance->m_tracked_count;
+                        }
+                        else
+                        {
+                            instance->m_polls.push(poll_entry(instance->next_check(*copy, state), copy));
+                            instance->schedule_timer();
+                        }
+                    }
+
+                    if (exception != nullptr)
+                    {
+                        copy->completed.set_exception(exception);
+                    }
+                    else if (completed)
+                    {
+                        copy->completed.set(std::move(state));
+                    }
+
+                    instance->pump();
+                });
+            }
+
+            // The caller must hold the mutex. Works out when a pending copy is checked next from the progress made since it was last checked.
+            std::chrono::steady_clock::time_point next_check(tracked_copy& copy, const copy_state& state)
+            {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                std::chrono::milliseconds interval = copy.interval;
+
+                // A copy that was just started is first checked after the minimum interval
+                if (copy.started)
+                {
+                    interval *= 2;
+
+                    int64_t progress = state.bytes_copied() - copy.bytes_copied;
+                    int64_t remaining = state.total_bytes() - state.bytes_copied();
+                    int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - copy.checked_time).count();
+                    if (progress > 0 && remaining >= 0 && elapsed > 0)
+                    {
+                        // The copy is expected to complete after the remaining bytes at the rate seen since the last check
+                        double expected = static_cast<double>(remaining) * static_cast<double>(elapsed) / static_cast<double>(progress);
+                        if (expected < static_cast<double>(interval.count()))
+                        {
+                            interval = std::chrono::milliseconds(static_cast<int64_t>(expected));
+                        }
+                    }
+                }
+
+                interval = std::max(m_minimum_interval, std::min(interval, m_maximum_interval));
+
+                copy.started = true;
+                copy.bytes_copied = state.bytes_copied();
+                copy.checked_time = now;
+                copy.interval = interval;
+                return now + interval;
+            }
+
+            // The caller must hold the mutex. A timer is set for the first copy to check, replacing one set for a later time.
+            void schedule_timer()
+            {
+                if (m_polls.empty() || (m_timer_scheduled && m_timer_due <= m_polls.top().due))
+                {
+                    return;
+                }
+
+                m_timer_scheduled = true;
+                m_timer_due = m_polls.top().due;
+                size_t generation = ++m_timer_generation;
+
+                std::chrono::milliseconds delay = std::chrono::duration_cast<std::chrono::milliseconds>(m_timer_due - std::chrono::steady_clock::now());
+                if (delay.count() < 0)
+                {
+                    delay = std::chrono::milliseconds(0);
+                }
+
+                auto instance = shared_from_this();
+                core::complete_after(delay).then([instance, generation] ()
+                {
+                    instance->timer_elapsed(generation);
+                });
+            }
+
+            void timer_elapsed(size_t generation)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (generation != m_timer_generation)
+                    {
+                        return;
+                    }
+
+                    m_timer_scheduled = false;
+
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    while (!m_polls.empty() && m_polls.top().due <= now)
+                    {
+                        m_due_polls.push_back(m_polls.top().copy);
+                        m_polls.pop();
+                    }
+
+                    schedule_timer();
+                }
+
+                pump();
+            }
+
+            size_t m_max_in_flight;
+            std::chrono::milliseconds m_minimum_interval;
+            std::chrono::milliseconds m_maximum_interval;
+
+            std::mutex m_mutex;
+            std::deque<std::shared_ptr<tracked_copy>> m_due_polls;
+            std::deque<std::shared_ptr<tracked_copy>> m_starts;
+            std::priority_queue<poll_entry, std::vector<poll_entry>, due_later> m_polls;
+            size_t m_in_flight;
+            size_t m_tracked_count;
+            bool m_timer_scheduled;
+            std::chrono::steady_clock::time_point m_timer_due;
+            size_t m_timer_generation;
+        };
+    }
+
+    cloud_copy_orchestrator::cloud_copy_orchestrator(int parallelism_factor, std::chrono::milliseconds minimum_poll_interval, std::chrono::milliseconds maximum_poll_interval)
+    {
+        if (parallelism_factor <= 0)
+        {
+            throw std::invalid_argument("parallelism_factor");
+        }
+
+        if (minimum_poll_interval.count() <= 0 || maximum_poll_interval < minimum_poll_interval)
+        {
+            throw std::invalid_argument("minimum_poll_interval");
+        }
+
+        m_engine = std::make_shared<core::copy_orchestrator_engine>(static_cast<size_t>(parallelism_factor), minimum_poll_interval, maximum_poll_interval);
+    }
+
+    pplx::task<copy_state> cloud_copy_orchestrator::start_copy_async(cloud_blob destination, const cloud_blob& source, const blob_request_options& options, operation_context context)
+    {
+        auto target = std::make_shared<cloud_blob>(std::move(destination));
+        auto source_blob = std::make_shared<cloud_blob>(source);
+
+        auto start = [target, source_blob, options, context] ()
+        {
+            return target->start_copy_async(*source_blob, access_condition(), access_condition(), options, context).then([target] (utility::string_t)
+            {
+                return target->copy_state();
+            });
+        };
+
+        auto poll = [target, options, context] ()
+        {
+            return target->download_attributes_async(access_condition(), options, context).then([target] ()
+            {
+                return target->copy_state();
+            });
+        };
+
+        return start_copy_async(start, poll);
+    }
+
+    pplx::task<copy_state> cloud_copy_orchestrator::start_copy_async(cloud_file destination, const cloud_file& source, const file_request_options& options, operation_context context)
+    {
+        auto target = std::make_shared<cloud_file>(std::move(destination));
+        auto source_file = std::make_shared<cloud_file>(source);
+
+        auto start = [target, source_file, options, context] ()
+        {
+            return target->start_copy_async(*source_file, file_access_condition(), file_access_condition(), options, context).then([target] (utility::string_t)
+            {
+                return target->copy_state();
+            });
+        };
+
+        auto poll = [target, options, context] ()
+        {
+            return target->download_attributes_async(file_access_condition(), options, context).then([target] ()
+            {
+                return target->copy_state();
+            });
+        };
+
+        return start_copy_async(start, poll);
+    }
+
+    pplx::task<copy_state> cloud_copy_orchestrator::start_copy_async(std::function<pplx::task<copy_state>()> start, std::function<pplx::task<copy_state>()> poll)
+    {
+        return m_engine->add(std::move(start), std::move(poll));
+    }
+
+    size_t cloud_copy_orchestrator::pending_count() const
+    {
+        return m_engine->tracked_count();
+    }
+
+}} // namespace azure::storage
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 
 #include "wascore/util.h"
+#include "wascore/base64.h"
 #include "wascore/resources.h"
 #include "was/core.h"
 
@@ -62,6 +63,13 @@ namespace azure { namespace storage {
         }
     }
 
+    utility::string_t checksum::crc64() const
+    {
+        uint8_t crc64_bytes[sizeof(m_crc64)];
+        memcpy(crc64_bytes, &m_crc64, sizeof(m_crc64));
+        return core::to_base64(crc64_bytes, sizeof(crc64_bytes));
+    }
+
 #ifdef _WIN32
     void __cdecl set_wastorage_ambient_scheduler(const std::shared_ptr<pplx::scheduler_interface>& scheduler)
     {
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 
 #include <condition_variable>
+#include <mutex>
 
 #include "was/file.h"
 #include "was/error_code_strings.h"
@@ -370,7 +371,7 @@ namespace azure { namespace storage {
         file_range range(start_offset, end_offset);
 
         auto command = std::make_shared<core::storage_command<void>>(uri());
-        command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::clear, utility::string_t(), access_condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::clear, checksum(checksum_none), access_condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response([properties](const web::http::http_response& response, const request_result& result, operation_context context)
         {
@@ -382,13 +383,24 @@ namespace azure { namespace storage {
         return core::executor<void>::execute_async(command, modified_options, context);
     }
 
-    pplx::task<void> cloud_file::write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const utility::string_t& content_md5, const file_access_condition& access_condition, const file_request_options& options, operation_context context) const
+    pplx::task<void> cloud_file::write_range_async(Concurrency::streams::istream stream, int64_t start_offset, const checksum& content_checksum, const file_access_condition& access_condition, const file_request_options& options, operation_context context) const
     {
         file_request_options modified_options(options);
         modified_options.apply_defaults(service_client().default_request_options());
 
+        bool needs_md5 = modified_options.use_transactional_md5() && !content_checksum.is_md5();
+        bool needs_crc64 = modified_options.use_transactional_crc64() && !content_checksum.is_crc64();
+        checksum_type needs_checksum = checksum_type::none;
+        if (needs_md5)
+        {
+            needs_checksum = checksum_type::md5;
+        }
+        else if (needs_crc64)
+        {
+            needs_checksum = checksum_type::crc64;
+        }
+
         auto properties = m_properties;
-        bool needs_md5 = content_md5.empty() && modified_options.use_transactional_md5();
 
         auto command = std::make_shared<core::storage_command<void>>(uri());
         command->set_authentication_handler(service_client().authentication_handler());
@@ -399,12 +411,12 @@ namespace azure { namespace storage {
             properties->update_etag_and_last_modified(modified_properties);
             properties->m_content_md5 = modified_properties.content_md5();
         });
-        return core::istream_descriptor::create(stream, needs_md5 ? checksum_type::md5 : checksum_type::none, std::numeric_limits<utility::size64_t>::max(), protocol::max_range_size).then([command, context, start_offset, content_md5, access_condition, modified_options](core::istream_descriptor request_body)->pplx::task<void>
+        return core::istream_descriptor::create(stream, needs_checksum, std::numeric_limits<utility::size64_t>::max(), protocol::max_range_size).then([command, context, start_offset, content_checksum, access_condition, modified_options](core::istream_descriptor request_body)->pplx::task<void>
         {
-            const utility::string_t& md5 = content_md5.empty() ? request_body.content_checksum().md5() : content_md5;
+            const auto& checksum = content_checksum.empty() ? request_body.content_checksum() : content_checksum;
             auto end_offset = start_offset + request_body.length() - 1;
             file_range range(start_offset, end_offset);
-            command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::update, md5, access_condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+            command->set_build_request(std::bind(protocol::put_file_range, range, file_range_write::update, checksum, access_condition, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
             command->set_request_body(request_body);
             return core::executor<void>::execute_async(command, modified_options, context);
         });
@@ -828,12 +840,170 @@ namespace azure { namespace storage {
         });
     }
 
+    namespace
+    {
+        // Uploads a local file in ranges of up to the maximum range size. Each worker reads through its own stream on the file, so that ranges
+        // are read, checksummed and written independently of one another rather than in turn through a single stream.
+        class parallel_file_uploader : public std::enable_shared_from_this<parallel_file_uploader>
+        {
+        public:
+
+            parallel_file_uploader(std::shared_ptr<cloud_file> file, utility::string_t path, utility::size64_t length, file_access_condition condition, file_request_options options, operation_context context)
+                : m_file(std::move(file)), m_path(std::move(path)), m_length(length), m_next_offset(0),
+                m_condition(std::move(condition)), m_options(std::move(options)), m_context(std::move(context))
+            {
+            }
+
+            pplx::task<void> upload()
+            {
+                utility::size64_t range_count = (m_length + protocol::max_range_size - 1) / protocol::max_range_size;
+                size_t worker_count = static_cast<size_t>(std::min(static_cast<utility::size64_t>(m_options.parallelism_factor()), range_count));
+
+                auto instance = shared_from_this();
+                std::vector<pplx::task<void>> workers;
+                workers.reserve(worker_count);
+                for (size_t i = 0; i < worker_count; ++i)
+                {
+                    workers.push_back(concurrency::streams::file_stream<uint8_t>::open_istream(m_path).then([instance](concurrency::streams::istream stream) -> pplx::task<void>
+                    {
+                        return instance->upload_next_range(stream).then([stream](pplx::task<void> upload_task) -> pplx::task<void>
+                        {
+                            return stream.close().then([upload_task]()
+                            {
+                                upload_task.wait();
+                            });
+                        });
+                    }));
+                }
+
+                return pplx::when_all(workers.begin(), workers.end()).then([instance](pplx::task<void> upload_task)
+                {
+                    upload_task.wait();
+
+                    std::lock_guard<std::mutex> guard(instance->m_mutex);
+                    if (instance->m_exception != nullptr)
+                    {
+                        std::rethrow_exception(instance->m_exception);
+                    }
+                });
+            }
+
+        private:
+
+            pplx::task<void> upload_next_range(concurrency::streams::istream stream)
+            {
+                utility::size64_t offset;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_exception != nullptr || m_next_offset >= m_length)
+                    {
+                        return pplx::task_from_result();
+                    }
+
+                    offset = m_next_offset;
+                    m_next_offset += protocol::max_range_size;
+                }
+
+                utility::size64_t length = std::min(static_cast<utility::size64_t>(protocol::max_range_size), m_length - offset);
+                concurrency::streams::istream::pos_type position = static_cast<concurrency::streams::istream::pos_type>(offset);
+                if (stream.seek(position) != position)
+                {
+                    // The file may have been truncated since its length was read, so the remaining workers stop as well
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_exception == nullptr)
+                    {
+                        m_exception = std::make_exception_ptr(std::runtime_error(protocol::error_stream_seek));
+                    }
+
+                    return pplx::task_from_result();
+                }
+
+                auto instance = shared_from_this();
+                concurrency::streams::container_buffer<std::vector<uint8_t>> buffer;
+                return core::stream_copy_async(stream, buffer.create_ostream(), length, length).then([instance, buffer, offset](utility::size64_t) -> pplx::task<void>
+                {
+                    std::vector<uint8_t> data(std::move(buffer.collection()));
+                    checksum content_checksum = instance->range_checksum(data);
+                    auto range_stream = concurrency::streams::container_stream<std::vector<uint8_t>>::open_istream(std::move(data));
+                    return instance->m_file->write_range_async(range_stream, static_cast<int64_t>(offset), content_checksum, instance->m_condition, instance->m_options, instance->m_context);
+                }).then([instance, stream](pplx::task<void> upload_task) -> pplx::task<void>
+                {
+                    try
+                    {
+                        upload_task.wait();
+                    }
+                    catch (const std::exception&)
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        if (instance->m_exception == nullptr)
+                        {
+                            instance->m_exception = std::current_exception();
+                        }
+
+                        return pplx::task_from_result();
+                    }
+
+                    return instance->upload_next_range(stream);
+                });
+            }
+
+            checksum range_checksum(const std::vector<uint8_t>& data) const
+            {
+                core::hash_provider provider;
+                if (m_options.use_transactional_md5())
+                {
+                    provider = core::hash_provider::create_md5_hash_provider();
+                }
+                else if (m_options.use_transactional_crc64())
+                {
+                    provider = core::hash_provider::create_crc64_hash_provider();
+                }
+                else
+                {
+                    return checksum(checksum_none);
+                }
+
+                provider.write(data.data(), data.size());
+                provider.close();
+                return provider.hash();
+            }
+
+            std::shared_ptr<cloud_file> m_file;
+            utility::string_t m_path;
+            utility::size64_t m_length;
+            utility::size64_t m_next_offset;
+            file_access_condition m_condition;
+            file_request_options m_options;
+            operation_context m_context;
+            std::mutex m_mutex;
+            std::exception_ptr m_exception;
+        };
+    }
+
     pplx::task<void> cloud_file::upload_from_file_async(const utility::string_t& path, const file_access_condition& access_condition, const file_request_options& options, operation_context context) const
     {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options());
+
         auto instance = std::make_shared<cloud_file>(*this);
-        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, access_condition, options, context](concurrency::streams::istream stream) -> pplx::task<void>
+        return concurrency::streams::file_stream<uint8_t>::open_istream(path).then([instance, path, access_condition, modified_options, context](concurrency::streams::istream stream) -> pplx::task<void>
         {
-            return instance->upload_from_stream_async(stream, access_condition, options, context).then([stream](pplx::task<void> upload_task) -> pplx::task<void>
+            // A file larger than one range is written range by range in parallel, unless its content MD5 has to be computed over the whole file in order
+            utility::size64_t length = core::get_remaining_stream_length(stream);
+            if (modified_options.parallelism_factor() > 1 && !modified_options.store_file_content_md5()
+                && length != std::numeric_limits<utility::size64_t>::max() && length > protocol::max_range_size)
+            {
+                return stream.close().then([instance, path, length, access_condition, modified_options, context]()
+                {
+                    return instance->create_async(length, access_condition, modified_options, context);
+                }).then([instance, path, length, access_condition, modified_options, context]()
+                {
+                    auto uploader = std::make_shared<parallel_file_uploader>(instance, path, length, access_condition, modified_options, context);
+                    return uploader->upload();
+                });
+            }
+
+            return instance->upload_from_stream_async(stream, length, access_condition, modified_options, context).then([stream](pplx::task<void> upload_task) -> pplx::task<void>
             {
                 return stream.close().then([upload_task]()
                 {
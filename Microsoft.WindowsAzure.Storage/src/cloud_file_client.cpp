@@ -19,18 +19,36 @@
 #include "was/file.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
+#include "wascore/util.h"
 
 namespace azure { namespace storage {
 
     share_result_iterator cloud_file_client::list_shares(const utility::string_t& prefix, bool get_metadata, int max_results, const file_request_options& options, operation_context context)
     {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(default_request_options(), false);
+
         auto instance = std::make_shared<cloud_file_client>(*this);
         return share_result_iterator(
             [instance, prefix, get_metadata, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_shares_segmented(prefix, get_metadata, static_cast<int>(max_results_per_segment), token, options, context);
+            return instance->list_shares_segmented_async(prefix, get_metadata, static_cast<int>(max_results_per_segment), token, options, context);
+        },
+            max_results, 0, modified_options.listing_prefetch_depth());
+    }
+
+    pplx::task<void> cloud_file_client::list_shares_async(const utility::string_t& prefix, bool get_metadata, int max_results, const std::function<void(const cloud_file_share&)>& item_callback, const file_request_options& options, operation_context context)
+    {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(default_request_options(), false);
+
+        auto instance = std::make_shared<cloud_file_client>(*this);
+        return core::enumerate_segments_async<cloud_file_share>(
+            [instance, prefix, get_metadata, options, context](const continuation_token& token, size_t max_results_per_segment)
+        {
+            return instance->list_shares_segmented_async(prefix, get_metadata, static_cast<int>(max_results_per_segment), token, options, context);
         },
-            max_results, 0);
+            max_results, modified_options.listing_prefetch_depth(), item_callback);
     }
 
     pplx::task<share_result_segment> cloud_file_client::list_shares_segmented_async(const utility::string_t& prefix, bool get_metadata, int max_results, const continuation_token& token, const file_request_options& options, operation_context context)
@@ -83,13 +83,30 @@ namespace azure { namespace storage {
 
     list_file_and_diretory_result_iterator cloud_file_directory::list_files_and_directories(const utility::string_t& prefix, int64_t max_results, const file_request_options& options, operation_context context) const
     {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), false);
+
         auto instance = std::make_shared<cloud_file_directory>(*this);
         return list_file_and_diretory_result_iterator(
             [instance, prefix, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_files_and_directories_segmented(prefix, max_results_per_segment, token, options, context);
+            return instance->list_files_and_directories_segmented_async(prefix, max_results_per_segment, token, options, context);
+        },
+            max_results, 0, modified_options.listing_prefetch_depth());
+    }
+
+    pplx::task<void> cloud_file_directory::list_files_and_directories_async(const utility::string_t& prefix, int64_t max_results, const std::function<void(const list_file_and_directory_item&)>& item_callback, const file_request_options& options, operation_context context) const
+    {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options(), false);
+
+        auto instance = std::make_shared<cloud_file_directory>(*this);
+        return core::enumerate_segments_async<list_file_and_directory_item>(
+            [instance, prefix, options, context](const continuation_token& token, size_t max_results_per_segment)
+        {
+            return instance->list_files_and_directories_segmented_async(prefix, max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, modified_options.listing_prefetch_depth(), item_callback);
     }
 
     pplx::task<list_file_and_directory_result_segment> cloud_file_directory::list_files_and_directories_segmented_async(const utility::string_t& prefix, int64_t max_results, const continuation_token& token, const file_request_options& options, operation_context context) const
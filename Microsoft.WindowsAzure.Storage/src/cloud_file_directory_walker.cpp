@@ -0,0 +1,455 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="cloud_file_directory_walker.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+#include "was/file.h"
+
+namespace azure { namespace storage {
+
+    namespace
+    {
+        // Walks a directory tree with a fixed number of workers. Each worker owns a queue of work and takes the newest item from it, so that a
+        // worker goes deeper into the part of the tree it is listing and its queue stays short. A worker whose queue is empty takes the oldest
+        // item from another worker's queue, which is usually a directory high in the tree with a lot of work beneath it. Workers that find no
+        // work anywhere wait until another worker queues some, and the walk completes when every worker is waiting. The queues are bounded: once
+        // they hold a few listing segments per worker, a listing stops fetching pages and is resumed when the queued work has drained.
+        class directory_walker : public std::enable_shared_from_this<directory_walker>
+        {
+        public:
+
+            directory_walker(std::function<void(const list_file_and_directory_item&)> handler, bool delete_items, file_request_options options, operation_context context)
+                : m_handler(std::move(handler)), m_delete_items(delete_items), m_options(std::move(options)), m_context(std::move(context)),
+                m_workers(static_cast<size_t>(std::max(m_options.parallelism_factor(), 1))), m_queued_count(0), m_active_count(0), m_completed(false)
+            {
+            }
+
+            pplx::task<void> walk(const cloud_file_directory& root)
+            {
+                // The root directory of a share has no name and cannot be deleted
+                auto root_node = std::make_shared<directory_node>(root, nullptr, !root.name().empty());
+                m_workers[0].items.push_back(work_item(work_type::list_directory, root_node));
+                m_workers[0].waiting = false;
+                m_queued_count = 1;
+
+                auto completed = pplx::create_task(m_completed_event);
+                run(0);
+                return completed;
+            }
+
+        private:
+
+            enum class work_type
+            {
+                list_directory,
+                delete_file,
+                delete_directory
+            };
+
+            // A directory being walked. While deleting, pending_count counts the listing of the directory and each file and sub-directory in it
+            // that has not been deleted yet, and the directory is deleted when the count drops to zero.
+            struct directory_node
+            {
+                directory_node(cloud_file_directory directory, std::shared_ptr<directory_node> parent, bool can_delete)
+                    : directory(std::move(directory)), parent(std::move(parent)), can_delete(can_delete), pending_count(1)
+                {
+                }
+
+                cloud_file_directory directory;
+                std::shared_ptr<directory_node> parent;
+                bool can_delete;
+                size_t pending_count;
+            };
+
+            struct work_item
+            {
+                work_item()
+                    : type(work_type::list_directory)
+                {
+                }
+
+                work_item(work_type type, std::shared_ptr<directory_node> node)
+                    : type(type), node(std::move(node))
+                {
+                }
+
+                work_item(std::shared_ptr<directory_node> node, cloud_file file)
+                    : type(work_type::delete_file), node(std::move(node)), file(std::move(file))
+                {
+                }
+
+                work_item(std::shared_ptr<directory_node> node, continuation_token token)
+                    : type(work_type::list_directory), node(std::move(node)), token(std::move(token))
+                {
+                }
+
+                work_type type;
+                std::shared_ptr<directory_node> node;
+                cloud_file file;
+                continuation_token token;
+            };
+
+            struct worker_state
+            {
+                worker_state()
+                    : waiting(true)
+                {
+                }
+
+                std::deque<work_item> items;
+                bool waiting;
+            };
+
+            // Takes the next item for a worker from its own queue, or else from another worker's. Must be called with the mutex held.
+            bool take_item(size_t worker, work_item& item)
+            {
+                if (m_exception != nullptr)
+                {
+                    return false;
+                }
+
+                // A paused listing is resumed as soon as there is room in the queues again
+                if (!m_paused_listings.empty() && m_queued_count < max_queued_count())
+                {
+                    item = std::move(m_paused_listings.front());
+                    m_paused_listings.pop_front();
+                    return true;
+                }
+
+                std::deque<work_item>& own_items = m_workers[worker].items;
+                if (!own_items.empty())
+                {
+                    item = std::move(own_items.back());
+                    own_items.pop_back();
+                    --m_queued_count;
+                    return true;
+                }
+
+                for (size_t i = 1; i < m_workers.size(); ++i)
+                {
+                    std::deque<work_item>& other_items = m_workers[(worker + i) % m_workers.size()].items;
+                    if (!other_items.empty())
+                    {
+                        item = std::move(other_items.front());
+                        other_items.pop_front();
+                        --m_queued_count;
+                        return true;
+                    }
+                }
+
+                // Nothing else is left, so the paused listings go on regardless of the bound
+                if (!m_paused_listings.empty())
+                {
+                    item = std::move(m_paused_listings.front());
+                    m_paused_listings.pop_front();
+                    return true;
+                }
+
+                return false;
+            }
+
+            // Queues items for a worker and returns the waiting workers that now have work to take. Must be called with the mutex held.
+            std::vector<size_t> queue_items(size_t worker, std::vector<work_item>& items)
+            {
+                std::vector<size_t> woken;
+                for (auto it = items.begin(); it != items.end(); ++it)
+                {
+                    m_workers[worker].items.push_back(std::move(*it));
+                }
+
+                m_queued_count += items.size();
+
+                for (size_t i = 0; i < m_workers.size() && woken.size() < items.size(); ++i)
+                {
+                    if (m_workers[i].waiting)
+                    {
+                        m_workers[i].waiting = false;
+                        woken.push_back(i);
+                    }
+                }
+
+                items.clear();
+                return woken;
+            }
+
+            void run(size_t worker)
+            {
+                work_item item;
+                bool has_item = false;
+                bool complete = false;
+                std::exception_ptr exception;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    has_item = take_item(worker, item);
+                    if (has_item)
+                    {
+                        ++m_active_count;
+                    }
+                    else
+                    {
+                        m_workers[worker].waiting = true;
+                        if (m_active_count == 0 && !m_completed)
+                        {
+                            m_completed = true;
+                            complete = true;
+                            exception = m_exception;
+                        }
+                    }
+                }
+
+                if (complete)
+                {
+                    if (exception != nullptr)
+                    {
+                        m_completed_event.set_exception(exception);
+                    }
+                    else
+                    {
+                        m_completed_event.set();
+                    }
+                }
+
+                if (!has_item)
+                {
+                    return;
+                }
+
+                pplx::task<void> work_task;
+                try
+                {
+                    work_task = execute(worker, std::move(item));
+                }
+                catch (const std::exception&)
+                {
+                    work_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                work_task.then([instance, worker] (pplx::task<void> work_task)
+                {
+                    try
+                    {
+                        work_task.wait();
+                    }
+                    catch (const std::exception&)
+                    {
+                        instance->record_exception(std::current_exception());
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        --instance->m_active_count;
+                    }
+
+                    instance->run(worker);
+                });
+            }
+
+            pplx::task<void> execute(size_t worker, work_item item)
+            {
+                auto instance = shared_from_this();
+                std::shared_ptr<directory_node> node = item.node;
+                switch (item.type)
+                {
+                case work_type::list_directory:
+                    return list_directory(worker, node, item.token);
+
+                case work_type::delete_file:
+                    return item.file.delete_file_async(file_access_condition(), m_options, m_context).then([instance, worker, node] (pplx::task<void> delete_task)
+                    {
+                        ignore_not_found(delete_task);
+                        instance->release(worker, node);
+                    });
+
+                case work_type::delete_directory:
+                default:
+                    return node->directory.delete_directory_async(file_access_condition(), m_options, m_context).then([instance, worker, node] (pplx::task<void> delete_task)
+                    {
+                        ignore_not_found(delete_task);
+                        if (node->parent != nullptr)
+                        {
+                            instance->release(worker, node->parent);
+                        }
+                    });
+                }
+            }
+
+            // An item that is already gone counts as deleted, as happens when a delete is retried after the service has carried it out
+            static void ignore_not_found(pplx::task<void> delete_task)
+            {
+                try
+                {
+                    delete_task.wait();
+                }
+                catch (const storage_exception& e)
+                {
+                    if (e.result().http_status_code() != web::http::status_codes::NotFound)
+                    {
+                        throw;
+                    }
+                }
+            }
+
+            // A listing segment holds up to 5000 items, and a few of them per worker keep every worker busy
+            size_t max_queued_count() const
+            {
+                return m_workers.size() * 4 * 5000;
+            }
+
+            pplx::task<void> list_directory(size_t worker, std::shared_ptr<directory_node> node, const continuation_token& token)
+            {
+                auto instance = shared_from_this();
+                return node->directory.list_files_and_directories_segmented_async(utility::string_t(), 0, token, m_options, m_context).then([instance, worker, node] (list_file_and_directory_result_segment segment) -> pplx::task<void>
+                {
+                    std::vector<work_item> items;
+                    for (auto it = segment.results().cbegin(); it != segment.results().cend(); ++it)
+                    {
+                        if (instance->m_handler)
+                        {
+                            std::lock_guard<std::mutex> guard(instance->m_handler_mutex);
+                            instance->m_handler(*it);
+                        }
+
+                        if (it->is_directory())
+                        {
+                            items.push_back(work_item(work_type::list_directory, std::make_shared<directory_node>(it->as_directory(), instance->m_delete_items ? node : nullptr, true)));
+                        }
+                        else if (instance->m_delete_items)
+                        {
+                            items.push_back(work_item(node, it->as_file()));
+                        }
+                    }
+
+                    std::vector<size_t> woken;
+                    bool paused = false;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        if (instance->m_delete_items)
+                        {
+                            node->pending_count += items.size();
+                        }
+                        woken = instance->queue_items(worker, items);
+
+                        // The listing keeps its pending count while it is paused, so the directory is not deleted before it has been fully listed
+                        if (!segment.continuation_token().empty() && instance->m_queued_count >= instance->max_queued_count())
+                        {
+                            instance->m_paused_listings.push_back(work_item(node, segment.continuation_token()));
+                            paused = true;
+                        }
+                    }
+
+                    for (auto it = woken.cbegin(); it != woken.cend(); ++it)
+                    {
+                        instance->run(*it);
+                    }
+
+                    if (paused)
+                    {
+                        return pplx::task_from_result();
+                    }
+
+                    if (!segment.continuation_token().empty() && !instance->has_failed())
+                    {
+                        return instance->list_directory(worker, node, segment.continuation_token());
+                    }
+
+                    if (instance->m_delete_items)
+                    {
+                        instance->release(worker, node);
+                    }
+
+                    return pplx::task_from_result();
+                });
+            }
+
+            // Counts off one pending item of a directory, and queues the deletion of the directory once nothing is left in it
+            void release(size_t worker, const std::shared_ptr<directory_node>& node)
+            {
+                std::vector<size_t> woken;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (--node->pending_count != 0 || !node->can_delete)
+                    {
+                        return;
+                    }
+
+                    std::vector<work_item> items;
+                    items.push_back(work_item(work_type::delete_directory, node));
+                    woken = queue_items(worker, items);
+                }
+
+                for (auto it = woken.cbegin(); it != woken.cend(); ++it)
+                {
+                    run(*it);
+                }
+            }
+
+            bool has_failed()
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                return m_exception != nullptr;
+            }
+
+            void record_exception(std::exception_ptr exception)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (m_exception == nullptr)
+                {
+                    m_exception = exception;
+                }
+            }
+
+            std::function<void(const list_file_and_directory_item&)> m_handler;
+            bool m_delete_items;
+            file_request_options m_options;
+            operation_context m_context;
+
+            std::mutex m_mutex;
+            std::mutex m_handler_mutex;
+            std::vector<worker_state> m_workers;
+            std::deque<work_item> m_paused_listings;
+            size_t m_queued_count;
+            size_t m_active_count;
+            bool m_completed;
+            std::exception_ptr m_exception;
+            pplx::task_completion_event<void> m_completed_event;
+        };
+    }
+
+    pplx::task<void> cloud_file_directory::list_files_and_directories_recursively_async(std::function<void(const list_file_and_directory_item&)> handler, const file_request_options& options, operation_context context) const
+    {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options());
+
+        auto walker = std::make_shared<directory_walker>(std::move(handler), false, modified_options, context);
+        return walker->walk(*this);
+    }
+
+    pplx::task<void> cloud_file_directory::delete_directory_recursively_async(const file_request_options& options, operation_context context)
+    {
+        file_request_options modified_options(options);
+        modified_options.apply_defaults(service_client().default_request_options());
+
+        auto walker = std::make_shared<directory_walker>(std::function<void(const list_file_and_directory_item&)>(), true, modified_options, context);
+        return walker->walk(*this);
+    }
+
+}} // namespace azure::storage
@@ -74,7 +74,7 @@ namespace azure { namespace storage { namespace core {
             {
                 try
                 {
-                    this_pointer->m_file->write_range_async(buffer->stream(), offset, buffer->content_checksum().md5(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context).then([this_pointer](pplx::task<void> upload_task)
+                    this_pointer->m_file->write_range_async(buffer->stream(), offset, buffer->content_checksum(), this_pointer->m_condition, this_pointer->m_options, this_pointer->m_context).then([this_pointer](pplx::task<void> upload_task)
                     {
                         std::lock_guard<async_semaphore> guard(this_pointer->m_semaphore, std::adopt_lock);
                         try
@@ -16,10 +16,18 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <queue>
+
 #include "wascore/executor.h"
+#include "wascore/logging.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
 #include "wascore/resources.h"
+#include "wascore/util.h"
 #include "was/queue.h"
 
 namespace azure { namespace storage {
@@ -86,47 +94,209 @@ namespace azure { namespace storage {
         return exists_async_impl(options, context, /* allow_secondary */ true);
     }
 
-    pplx::task<void> cloud_queue::add_message_async(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context)
+    namespace
     {
-        if ((time_to_live.count() <= 0LL) && (time_to_live.count() != -1LL))
+        void validate_add_message_arguments(std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout)
         {
-            throw std::invalid_argument(protocol::error_invalid_value_time_to_live);
+            if ((time_to_live.count() <= 0LL) && (time_to_live.count() != -1LL))
+            {
+                throw std::invalid_argument(protocol::error_invalid_value_time_to_live);
+            }
+
+            if (initial_visibility_timeout.count() < 0LL)
+            {
+                throw std::invalid_argument(protocol::error_negative_initial_visibility_timeout);
+            }
+
+            if (initial_visibility_timeout.count() > 604800LL)
+            {
+                throw std::invalid_argument(protocol::error_large_initial_visibility_timeout);
+            }
         }
 
-        if (initial_visibility_timeout.count() < 0LL)
+        void update_added_message(const web::http::http_response& response, cloud_queue_message& message)
         {
-            throw std::invalid_argument(protocol::error_negative_initial_visibility_timeout);
+            protocol::message_reader reader(response.body());
+            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
+
+            if (!queue_items.empty())
+            {
+                protocol::cloud_message_list_item& item = queue_items.front();
+                cloud_queue_message message_info(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
+                message.update_message_info(message_info);
+            }
         }
 
-        if (initial_visibility_timeout.count() > 604800LL)
+        // Adds a sequence of messages to a queue through a fixed number of slots, each of which keeps one request in flight. A slot writes the
+        // request body of every message it sends into the same buffer, so the buffer is only allocated again when a message is larger than before.
+        class queue_message_pipeline : public std::enable_shared_from_this<queue_message_pipeline>
         {
-            throw std::invalid_argument(protocol::error_large_initial_visibility_timeout);
-        }
+        public:
+            queue_message_pipeline(storage_uri uri, std::shared_ptr<protocol::authentication_handler> authentication_handler, std::vector<cloud_queue_message>& messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, bool update_messages, queue_request_options options, operation_context context)
+                : m_uri(std::move(uri)), m_authentication_handler(std::move(authentication_handler)), m_messages(messages), m_time_to_live(time_to_live), m_initial_visibility_timeout(initial_visibility_timeout),
+                m_update_messages(update_messages), m_options(std::move(options)), m_context(std::move(context)), m_next(0), m_running(0)
+            {
+            }
+
+            pplx::task<void> run()
+            {
+                size_t slot_count = std::min(static_cast<size_t>(std::max(m_options.parallelism_factor(), 1)), m_messages.size());
+                if (slot_count == 0)
+                {
+                    return pplx::task_from_result();
+                }
+
+                m_running = slot_count;
+                for (size_t i = 0; i < slot_count; ++i)
+                {
+                    send_next(std::make_shared<std::string>());
+                }
+
+                return pplx::create_task(m_completed);
+            }
+
+        private:
+            void send_next(std::shared_ptr<std::string> body)
+            {
+                size_t index;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    // After a failure, the messages not yet sent are left alone
+                    if (m_next == m_messages.size() || m_exception)
+                    {
+                        if (--m_running == 0)
+                        {
+                            if (m_exception)
+                            {
+                                m_completed.set_exception(m_exception);
+                            }
+                            else
+                            {
+                                m_completed.set();
+                            }
+                        }
+
+                        return;
+                    }
+
+                    index = m_next++;
+                }
+
+                pplx::task<void> send_task;
+                try
+                {
+                    send_task = send(index, body);
+                }
+                catch (...)
+                {
+                    send_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                send_task.then([instance, body] (pplx::task<void> task)
+                {
+                    try
+                    {
+                        task.get();
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        if (!instance->m_exception)
+                        {
+                            instance->m_exception = std::current_exception();
+                        }
+                    }
+
+                    instance->send_next(body);
+                });
+            }
+
+            pplx::task<void> send(size_t index, std::shared_ptr<std::string> body)
+            {
+                protocol::message_writer::write(m_messages[index], *body);
+
+                std::chrono::seconds time_to_live = m_time_to_live;
+                std::chrono::seconds initial_visibility_timeout = m_initial_visibility_timeout;
+
+                // The body is written once and read by every attempt of the request, and the slot does not reuse it until the request completes
+                std::shared_ptr<core::storage_command<void>> command = std::make_shared<core::storage_command<void>>(m_uri);
+                command->set_build_request([body, time_to_live, initial_visibility_timeout] (web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+                {
+                    return protocol::add_message_with_body(*body, time_to_live, initial_visibility_timeout, uri_builder, timeout, context);
+                });
+                command->set_authentication_handler(m_authentication_handler);
+                command->set_preprocess_response(std::bind(protocol::preprocess_response_void, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+
+                // Without a postprocessing step the response body, which only holds the pop receipt and times of the message, is not parsed
+                if (m_update_messages)
+                {
+                    cloud_queue_message* message = &m_messages[index];
+                    command->set_postprocess_response([message] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<void>
+                    {
+                        UNREFERENCED_PARAMETER(context);
+                        update_added_message(response, *message);
+                        return pplx::task_from_result();
+                    });
+                }
+
+                return core::executor<void>::execute_async(command, m_options, m_context);
+            }
+
+            storage_uri m_uri;
+            std::shared_ptr<protocol::authentication_handler> m_authentication_handler;
+            std::vector<cloud_queue_message>& m_messages;
+            std::chrono::seconds m_time_to_live;
+            std::chrono::seconds m_initial_visibility_timeout;
+            bool m_update_messages;
+            queue_request_options m_options;
+            operation_context m_context;
+
+            std::mutex m_mutex;
+            size_t m_next;
+            size_t m_running;
+            std::exception_ptr m_exception;
+            pplx::task_completion_event<void> m_completed;
+        };
+    }
+
+    pplx::task<void> cloud_queue::add_message_async(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context)
+    {
+        validate_add_message_arguments(time_to_live, initial_visibility_timeout);
 
         queue_request_options modified_options = get_modified_options(options);
 
+        // The body is written once, rather than copying the message into the request builder and writing it again for every attempt
+        auto body = std::make_shared<std::string>();
+        protocol::message_writer::write(message, *body);
+
         std::shared_ptr<core::storage_command<void>> command = std::make_shared<core::storage_command<void>>(queue_message_uri());
-        command->set_build_request(std::bind(protocol::add_message, message, time_to_live, initial_visibility_timeout, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_build_request([body, time_to_live, initial_visibility_timeout] (web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+        {
+            return protocol::add_message_with_body(*body, time_to_live, initial_visibility_timeout, uri_builder, timeout, context);
+        });
         command->set_authentication_handler(service_client().authentication_handler());
         command->set_preprocess_response(std::bind(protocol::preprocess_response_void, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
         command->set_postprocess_response([&message](const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<void>
         {
             UNREFERENCED_PARAMETER(context);
-            protocol::message_reader reader(response.body());
-            std::vector<protocol::cloud_message_list_item> queue_items = reader.move_items();
-            
-            if (!queue_items.empty())
-            {
-                protocol::cloud_message_list_item& item = queue_items.front();
-                cloud_queue_message message_info(item.move_content(), item.move_id(), item.move_pop_receipt(), item.insertion_time(), item.expiration_time(), item.next_visible_time(), item.dequeue_count());
-                message.update_message_info(message_info);
-            }
-            
+            update_added_message(response, message);
             return pplx::task_from_result();
         });
         return core::executor<void>::execute_async(command, modified_options, context);
     }
 
+    pplx::task<void> cloud_queue::add_messages_async(std::vector<cloud_queue_message>& messages, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, bool update_messages, queue_request_options& options, operation_context context)
+    {
+        validate_add_message_arguments(time_to_live, initial_visibility_timeout);
+
+        queue_request_options modified_options = get_modified_options(options);
+
+        auto pipeline = std::make_shared<queue_message_pipeline>(queue_message_uri(), service_client().authentication_handler(), messages, time_to_live, initial_visibility_timeout, update_messages, std::move(modified_options), std::move(context));
+        return pipeline->run();
+    }
+
     pplx::task<cloud_queue_message> cloud_queue::get_message_async(std::chrono::seconds visibility_timeout, queue_request_options& options, operation_context context)
     {
         if (visibility_timeout.count() < 0LL)
@@ -500,4 +670,620 @@ namespace azure { namespace storage {
         return core::executor<bool>::execute_async(command, modified_options, context);
     }
 
+    namespace core
+    {
+        // Drives a cloud_queue_consumer. All state is guarded by the mutex, while requests and handlers are started after it is released.
+        class queue_consumer_engine : public std::enable_shared_from_this<queue_consumer_engine>
+        {
+        public:
+
+            queue_consumer_engine(cloud_queue queue, std::function<void(cloud_queue_message)> handler, std::function<void(const cloud_queue_message&, std::exception_ptr)> error_handler,
+                std::chrono::seconds visibility_timeout, queue_request_options options, operation_context context)
+                : m_queue(std::move(queue)), m_handler(std::move(handler)), m_error_handler(std::move(error_handler)), m_visibility_timeout(visibility_timeout), m_options(std::move(options)), m_context(std::move(context)),
+                m_worker_count(static_cast<size_t>(std::max(m_options.parallelism_factor(), 1))), m_buffer_capacity(std::max(max_messages_per_get(), 2 * m_worker_count)),
+                m_running(false), m_stopping(false), m_stopped(false), m_fetching(0), m_requested(0), m_active(0), m_extending(0), m_deleting(0),
+                m_backing_off(false), m_backoff(0), m_timer_scheduled(false)
+            {
+            }
+
+            void start()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_running || m_stopping)
+                    {
+                        return;
+                    }
+
+                    m_running = true;
+                }
+
+                pump();
+            }
+
+            void request_stop()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_running = false;
+                    if (!m_stopping)
+                    {
+                        m_stopping = true;
+
+                        // Buffered messages are no longer handed to workers, and their leases are left to run out
+                        for (auto it = m_buffer.begin(); it != m_buffer.end(); ++it)
+                        {
+                            (*it)->released = true;
+                        }
+
+                        m_buffer.clear();
+                    }
+                }
+
+                pump();
+            }
+
+            pplx::task<void> stop()
+            {
+                request_stop();
+
+                auto instance = shared_from_this();
+                return pplx::create_task(m_stopped_event).then([instance] ()
+                {
+                    std::exception_ptr exception;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        exception = instance->m_exception;
+                    }
+
+                    if (exception)
+                    {
+                        std::rethrow_exception(exception);
+                    }
+                });
+            }
+
+        private:
+
+            struct leased_message
+            {
+                explicit leased_message(const cloud_queue_message& message)
+                    : message(message), received(message), extending(false), handled(false), released(false)
+                {
+                }
+
+                // The copy whose pop receipt is kept current as the lease is extended, and the copy handed to the handler
+                cloud_queue_message message;
+                cloud_queue_message received;
+
+                bool extending;
+                bool handled;
+                bool released;
+            };
+
+            struct lease_entry
+            {
+                lease_entry(std::chrono::steady_clock::time_point due, std::shared_ptr<leased_message> message)
+                    : due(due), message(std::move(message))
+                {
+                }
+
+                std::chrono::steady_clock::time_point due;
+                std::shared_ptr<leased_message> message;
+            };
+
+            struct due_later
+            {
+                bool operator()(const lease_entry& left, const lease_entry& right) const
+                {
+                    return left.due > right.due;
+                }
+            };
+
+            // A lease is extended once two thirds of the visibility timeout have passed
+            std::chrono::steady_clock::time_point next_renewal() const
+            {
+                return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::milliseconds>(m_visibility_timeout) * 2 / 3;
+            }
+
+            // The caller must hold the mutex.
+            void record_exception(std::exception_ptr exception)
+            {
+                if (!m_exception)
+                {
+                    m_exception = exception;
+                }
+            }
+
+            // Hands buffered messages to idle workers, requests more messages while the buffer has room, and completes the stop once nothing is outstanding
+            void pump()
+            {
+                std::vector<std::shared_ptr<leased_message>> to_handle;
+                std::vector<size_t> to_fetch;
+                bool stopped = false;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    while (!m_stopping && m_active < m_worker_count && !m_buffer.empty())
+                    {
+                        std::shared_ptr<leased_message> leased = m_buffer.front();
+                        m_buffer.pop_front();
+
+                        // A message whose lease could not be extended is dropped, since another consumer may already have received it
+                        if (leased->released)
+                        {
+                            continue;
+                        }
+
+                        to_handle.push_back(std::move(leased));
+                        ++m_active;
+                    }
+
+                    while (m_running && !m_backing_off && m_buffer.size() + m_requested < m_buffer_capacity)
+                    {
+                        size_t count = std::min(max_messages_per_get(), m_buffer_capacity - m_buffer.size() - m_requested);
+                        to_fetch.push_back(count);
+                        m_requested += count;
+                        ++m_fetching;
+                    }
+
+                    if (m_stopping && !m_stopped && m_active == 0 && m_fetching == 0 && m_extending == 0 && m_deleting == 0)
+                    {
+                        m_stopped = true;
+                        stopped = true;
+                    }
+                }
+
+                for (auto it = to_fetch.begin(); it != to_fetch.end(); ++it)
+                {
+                    fetch(*it);
+                }
+
+                for (auto it = to_handle.begin(); it != to_handle.end(); ++it)
+                {
+                    handle(*it);
+                }
+
+                if (stopped)
+                {
+                    m_stopped_event.set();
+                }
+            }
+
+            void fetch(size_t count)
+            {
+                pplx::task<std::vector<cloud_queue_message>> get_task;
+                try
+                {
+                    get_task = m_queue.get_messages_async(count, m_visibility_timeout, m_options, m_context);
+                }
+                catch (...)
+                {
+                    get_task = pplx::task_from_exception<std::vector<cloud_queue_message>>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                get_task.then([instance, count] (pplx::task<std::vector<cloud_queue_message>> task)
+                {
+                    std::vector<cloud_queue_message> messages;
+                    std::exception_ptr exception;
+                    try
+                    {
+                        messages = task.get();
+                    }
+                    catch (...)
+                    {
+                        exception = std::current_exception();
+                    }
+
+                    instance->messages_received(count, std::move(messages), exception);
+                });
+            }
+
+            void messages_received(size_t count, std::vector<cloud_queue_message> messages, std::exception_ptr exception)
+            {
+                std::chrono::milliseconds backoff(0);
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    --m_fetching;
+                    m_requested -= count;
+
+                    if (exception)
+                    {
+                        record_exception(exception);
+                    }
+
+                    if (messages.empty())
+                    {
+                        // Each empty response doubles the wait before the queue is polled again, up to a limit, and receiving a message resets it
+                        if (m_running && !m_backing_off)
+                        {
+                            m_backoff = m_backoff.count() == 0 ? initial_backoff() : std::min(m_backoff * 2, maximum_backoff());
+                            m_backing_off = true;
+                            backoff = m_backoff;
+                        }
+                    }
+                    else if (!m_stopping)
+                    {
+                        m_backoff = std::chrono::milliseconds(0);
+
+                        std::chrono::steady_clock::time_point due = next_renewal();
+                        for (auto it = messages.begin(); it != messages.end(); ++it)
+                        {
+                            auto leased = std::make_shared<leased_message>(*it);
+                            m_buffer.push_back(leased);
+                            m_leases.push(lease_entry(due, std::move(leased)));
+                        }
+
+                        schedule_renewal();
+                    }
+                }
+
+                if (backoff.count() != 0)
+                {
+                    auto instance = shared_from_this();
+                    core::complete_after(backoff).then([instance] ()
+                    {
+                        {
+                            std::lock_guard<std::mutex> guard(instance->m_mutex);
+                            instance->m_backing_off = false;
+                        }
+
+                        instance->pump();
+                    });
+                }
+
+                pump();
+            }
+
+            void handle(std::shared_ptr<leased_message> leased)
+            {
+                auto instance = shared_from_this();
+                pplx::create_task([instance, leased] ()
+                {
+                    instance->m_handler(std::move(leased->received));
+                }).then([instance, leased] (pplx::task<void> task)
+                {
+                    std::exception_ptr handler_exception;
+                    try
+                    {
+                        task.get();
+                    }
+                    catch (...)
+                    {
+                        // The message becomes visible again when its lease runs out, so that it can be retried
+                        handler_exception = std::current_exception();
+                    }
+
+                    bool must_delete = false;
+                    cloud_queue_message failed_message;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        --instance->m_active;
+
+                        if (handler_exception)
+                        {
+                            // An extension that is still in flight may rewrite the pop receipt, so the message is copied under the mutex
+                            failed_message = leased->message;
+                            leased->released = true;
+                        }
+                        else if (!leased->released)
+                        {
+                            leased->handled = true;
+
+                            // A message whose lease is being extended is deleted once the new pop receipt is known
+                            must_delete = !leased->extending && instance->enqueue_delete(leased);
+                        }
+                    }
+
+                    if (handler_exception)
+                    {
+                        instance->report_handler_exception(failed_message, handler_exception);
+                    }
+
+                    if (must_delete)
+                    {
+                        instance->delete_message(leased);
+                    }
+
+                    instance->pump();
+                });
+            }
+
+            // The caller must hold the mutex. The heap is ordered by due time, and every entry added is due no earlier than those before it, so a
+            // single timer, set for the first entry, is enough.
+            void schedule_renewal()
+            {
+                if (m_timer_scheduled || m_leases.empty() || m_stopped)
+                {
+                    return;
+                }
+
+                m_timer_scheduled = true;
+                std::chrono::milliseconds delay = std::chrono::duration_cast<std::chrono::milliseconds>(m_leases.top().due - std::chrono::steady_clock::now());
+                if (delay.count() < 0)
+                {
+                    delay = std::chrono::milliseconds(0);
+                }
+
+                auto instance = shared_from_this();
+                core::complete_after(delay).then([instance] ()
+                {
+                    instance->renew_leases();
+                });
+            }
+
+            void renew_leases()
+            {
+                std::vector<std::shared_ptr<leased_message>> to_extend;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_timer_scheduled = false;
+
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    while (!m_leases.empty() && (m_stopped || m_leases.top().due <= now))
+                    {
+                        std::shared_ptr<leased_message> leased = m_leases.top().message;
+                        m_leases.pop();
+
+                        if (!m_stopped && !leased->released && !leased->handled)
+                        {
+                            leased->extending = true;
+                            ++m_extending;
+                            to_extend.push_back(std::move(leased));
+                        }
+                    }
+
+                    schedule_renewal();
+                }
+
+                for (auto it = to_extend.begin(); it != to_extend.end(); ++it)
+                {
+                    extend(*it);
+                }
+            }
+
+            void extend(std::shared_ptr<leased_message> leased)
+            {
+                pplx::task<void> update_task;
+                try
+                {
+                    update_task = m_queue.update_message_async(leased->message, m_visibility_timeout, false, m_options, m_context);
+                }
+                catch (...)
+                {
+                    update_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                update_task.then([instance, leased] (pplx::task<void> task)
+                {
+                    std::exception_ptr exception;
+                    try
+                    {
+                        task.get();
+                    }
+                    catch (...)
+                    {
+                        exception = std::current_exception();
+                    }
+
+                    bool must_delete = false;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        --instance->m_extending;
+                        leased->extending = false;
+
+                        if (exception)
+                        {
+                            // The lease may have been lost, in which case another consumer can receive the message, so it is neither handled nor
+                            // deleted with the pop receipt it had
+                            instance->record_exception(exception);
+                            leased->released = true;
+                        }
+                        else if (leased->handled)
+                        {
+                            must_delete = instance->enqueue_delete(leased);
+                        }
+                        else if (!leased->released)
+                        {
+                            instance->m_leases.push(lease_entry(instance->next_renewal(), leased));
+                            instance->schedule_renewal();
+                        }
+                    }
+
+                    if (must_delete)
+                    {
+                        instance->delete_message(leased);
+                    }
+
+                    instance->pump();
+                });
+            }
+
+            // Passes the exception thrown by the handler to the error handler, if any, and logs it. The caller must not hold the mutex.
+            void report_handler_exception(const cloud_queue_message& message, std::exception_ptr exception)
+            {
+                if (logger::instance().should_log(m_context, client_log_level::log_level_warning))
+                {
+                    std::string what;
+                    try
+                    {
+                        std::rethrow_exception(exception);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        what = e.what();
+                    }
+                    catch (...)
+                    {
+                    }
+
+                    logger::instance().log(m_context, client_log_level::log_level_warning, protocol::error_queue_message_handler_failed + what);
+                }
+
+                if (m_error_handler)
+                {
+                    try
+                    {
+                        m_error_handler(message, exception);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> guard(m_mutex);
+                        record_exception(std::current_exception());
+                    }
+                }
+            }
+
+            // The caller must hold the mutex. Returns whether the delete can be sent now, and queues it otherwise.
+            bool enqueue_delete(std::shared_ptr<leased_message> leased)
+            {
+                leased->released = true;
+                if (m_deleting < m_worker_count)
+                {
+                    ++m_deleting;
+                    return true;
+                }
+
+                m_delete_queue.push_back(std::move(leased));
+                return false;
+            }
+
+            void delete_message(std::shared_ptr<leased_message> leased)
+            {
+                pplx::task<void> delete_task;
+                try
+                {
+                    delete_task = m_queue.delete_message_async(leased->message, m_options, m_context);
+                }
+                catch (...)
+                {
+                    delete_task = pplx::task_from_exception<void>(std::current_exception());
+                }
+
+                auto instance = shared_from_this();
+                delete_task.then([instance, leased] (pplx::task<void> task)
+                {
+                    std::shared_ptr<leased_message> next;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        try
+                        {
+                            task.get();
+                        }
+                        catch (...)
+                        {
+                            instance->record_exception(std::current_exception());
+                        }
+
+                        // The slot passes straight to the next queued delete
+                        if (instance->m_delete_queue.empty())
+                        {
+                            --instance->m_deleting;
+                        }
+                        else
+                        {
+                            next = instance->m_delete_queue.front();
+                            instance->m_delete_queue.pop_front();
+                        }
+                    }
+
+                    if (next)
+                    {
+                        instance->delete_message(next);
+                    }
+
+                    instance->pump();
+                });
+            }
+
+            static size_t max_messages_per_get()
+            {
+                return 32;
+            }
+
+            static std::chrono::milliseconds initial_backoff()
+            {
+                return std::chrono::milliseconds(200);
+            }
+
+            static std::chrono::milliseconds maximum_backoff()
+            {
+                return std::chrono::milliseconds(30000);
+            }
+
+            cloud_queue m_queue;
+            std::function<void(cloud_queue_message)> m_handler;
+            std::function<void(const cloud_queue_message&, std::exception_ptr)> m_error_handler;
+            std::chrono::seconds m_visibility_timeout;
+            queue_request_options m_options;
+            operation_context m_context;
+            size_t m_worker_count;
+            size_t m_buffer_capacity;
+
+            std::mutex m_mutex;
+            bool m_running;
+            bool m_stopping;
+            bool m_stopped;
+            size_t m_fetching;
+            size_t m_requested;
+            size_t m_active;
+            size_t m_extending;
+            size_t m_deleting;
+            bool m_backing_off;
+            std::chrono::milliseconds m_backoff;
+            bool m_timer_scheduled;
+            std::deque<std::shared_ptr<leased_message>> m_buffer;
+            std::deque<std::shared_ptr<leased_message>> m_delete_queue;
+            std::priority_queue<lease_entry, std::vector<lease_entry>, due_later> m_leases;
+            std::exception_ptr m_exception;
+            pplx::task_completion_event<void> m_stopped_event;
+        };
+    }
+
+    cloud_queue_consumer::cloud_queue_consumer(cloud_queue queue, std::function<void(cloud_queue_message)> handler, std::chrono::seconds visibility_timeout, const queue_request_options& options, operation_context context)
+        : cloud_queue_consumer(std::move(queue), std::move(handler), std::function<void(const cloud_queue_message&, std::exception_ptr)>(), visibility_timeout, options, std::move(context))
+    {
+    }
+
+    cloud_queue_consumer::cloud_queue_consumer(cloud_queue queue, std::function<void(cloud_queue_message)> handler, std::function<void(const cloud_queue_message&, std::exception_ptr)> error_handler,
+        std::chrono::seconds visibility_timeout, const queue_request_options& options, operation_context context)
+    {
+        if (!handler)
+        {
+            throw std::invalid_argument("handler");
+        }
+
+        if (visibility_timeout.count() <= 0LL)
+        {
+            throw std::invalid_argument("visibility_timeout");
+        }
+
+        if (visibility_timeout.count() > 604800LL)
+        {
+            throw std::invalid_argument(protocol::error_large_visibility_timeout);
+        }
+
+        queue_request_options modified_options(options);
+        modified_options.apply_defaults(queue.service_client().default_request_options());
+
+        m_engine = std::make_shared<core::queue_consumer_engine>(std::move(queue), std::move(handler), std::move(error_handler), visibility_timeout, std::move(modified_options), std::move(context));
+    }
+
+    cloud_queue_consumer::~cloud_queue_consumer()
+    {
+        m_engine->request_stop();
+    }
+
+    void cloud_queue_consumer::start()
+    {
+        m_engine->start();
+    }
+
+    pplx::task<void> cloud_queue_consumer::stop_async()
+    {
+        return m_engine->stop();
+    }
+
 }} // namespace azure::storage
@@ -32,13 +32,28 @@ namespace azure { namespace storage {
 
     queue_result_iterator cloud_queue_client::list_queues(const utility::string_t& prefix, bool get_metadata, utility::size64_t max_results, const queue_request_options& options, operation_context context) const
     {
+        queue_request_options modified_options = get_modified_options(options);
+
         auto instance = std::make_shared<cloud_queue_client>(*this);
         return queue_result_iterator(
             [instance, prefix, get_metadata, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_queues_segmented(prefix, get_metadata, (int)max_results_per_segment, token, options, context);
+            return instance->list_queues_segmented_async(prefix, get_metadata, (int)max_results_per_segment, token, options, context);
+        },
+            max_results, 0, modified_options.listing_prefetch_depth());
+    }
+
+    pplx::task<void> cloud_queue_client::list_queues_async(const utility::string_t& prefix, bool get_metadata, utility::size64_t max_results, const std::function<void(const cloud_queue&)>& item_callback, const queue_request_options& options, operation_context context) const
+    {
+        queue_request_options modified_options = get_modified_options(options);
+
+        auto instance = std::make_shared<cloud_queue_client>(*this);
+        return core::enumerate_segments_async<cloud_queue>(
+            [instance, prefix, get_metadata, options, context](const continuation_token& token, size_t max_results_per_segment)
+        {
+            return instance->list_queues_segmented_async(prefix, get_metadata, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, modified_options.listing_prefetch_depth(), item_callback);
     }
 
     pplx::task<queue_result_segment> cloud_queue_client::list_queues_segmented_async(const utility::string_t& prefix, bool get_metadata, int max_results, const continuation_token& token, const queue_request_options& options, operation_context context) const
@@ -117,6 +132,11 @@ namespace azure { namespace storage {
         return queue;
     }
 
+    cloud_sharded_queue cloud_queue_client::get_sharded_queue_reference(const utility::string_t& name_prefix, size_t shard_count) const
+    {
+        return cloud_sharded_queue(*this, name_prefix, shard_count);
+    }
+
     void cloud_queue_client::set_authentication_scheme(azure::storage::authentication_scheme value)
     {
         cloud_client::set_authentication_scheme(value);
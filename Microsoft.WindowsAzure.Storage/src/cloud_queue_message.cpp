@@ -17,6 +17,7 @@
 
 #include "stdafx.h"
 #include "was/queue.h"
+#include "wascore/base64.h"
 
 namespace azure { namespace storage {
 
@@ -31,4 +32,80 @@ namespace azure { namespace storage {
         m_next_visible_time = message_metadata.m_next_visible_time;
     }
 
+    const utility::string_t cloud_queue_message::content_as_string() const
+    {
+        if (m_is_binary)
+        {
+            converted_content& converted = *m_converted;
+            std::call_once(converted.once, [this, &converted] ()
+            {
+                converted.text = core::to_base64(*m_binary_content);
+            });
+
+            return converted.text;
+        }
+
+        return m_content;
+    }
+
+    std::shared_ptr<const std::vector<uint8_t>> cloud_queue_message::shared_content_as_binary() const
+    {
+        if (m_is_binary)
+        {
+            return m_binary_content;
+        }
+
+        // Messages created without content have nothing to decode
+        if (!m_converted)
+        {
+            return std::make_shared<std::vector<uint8_t>>();
+        }
+
+        // If decoding throws, the flag is left unset, so that a later request fails the same way
+        converted_content& converted = *m_converted;
+        std::call_once(converted.once, [this, &converted] ()
+        {
+            converted.binary = std::make_shared<std::vector<uint8_t>>(core::from_base64(m_content));
+        });
+
+        return converted.binary;
+    }
+
+    utility::string_t cloud_queue_message::release_content_as_string()
+    {
+        utility::string_t content;
+        if (m_is_binary)
+        {
+            // The encoded text can only be moved out when no copy of the message shares it. A count of one cannot change while this message is
+            // being modified, because no other thread holds a reference.
+            content_as_string();
+            content = m_converted.use_count() == 1 ? std::move(m_converted->text) : m_converted->text;
+        }
+        else
+        {
+            content = std::move(m_content);
+        }
+
+        set_content(utility::string_t());
+        return content;
+    }
+
+    std::vector<uint8_t> cloud_queue_message::release_content_as_binary()
+    {
+        std::vector<uint8_t> content;
+        if (m_is_binary)
+        {
+            content = m_binary_content.use_count() == 1 ? std::move(*m_binary_content) : *m_binary_content;
+        }
+        else if (m_converted)
+        {
+            shared_content_as_binary();
+            std::shared_ptr<std::vector<uint8_t>>& decoded = m_converted->binary;
+            content = m_converted.use_count() == 1 && decoded.use_count() == 1 ? std::move(*decoded) : *decoded;
+        }
+
+        set_content(utility::string_t());
+        return content;
+    }
+
 }} // namespace azure::storage
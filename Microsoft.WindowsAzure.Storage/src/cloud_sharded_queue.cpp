@@ -0,0 +1,361 @@
+// -----------------------------------------------------------------------------------------
+// <copyright file="cloud_sharded_queue.cpp" company="Microsoft">
+//    Copyright 2019 Microsoft Corporation
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+// </copyright>
+// -----------------------------------------------------------------------------------------
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+#include "wascore/resources.h"
+#include "wascore/util.h"
+#include "was/queue.h"
+
+namespace azure { namespace storage {
+
+    namespace core
+    {
+        // The producer and consumer state shared by copies of a sharded queue: the next shard in turn for each, and how recently each shard was
+        // found empty.
+        class sharded_queue_state
+        {
+        public:
+
+            explicit sharded_queue_state(size_t shard_count)
+                : m_next_add(0), m_next_poll(0), m_shards(shard_count)
+            {
+            }
+
+            size_t next_add_shard()
+            {
+                return m_next_add++ % m_shards.size();
+            }
+
+            // Returns the shards to poll: those that are due, starting with the next shard in turn, or when none is due, only the shard that
+            // becomes due first, so that an idle consumer sends one request per call.
+            std::vector<size_t> shards_to_poll()
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                size_t start = m_next_poll++ % m_shards.size();
+
+                std::vector<size_t> due;
+                size_t first_waiting = start;
+                for (size_t i = 0; i < m_shards.size(); ++i)
+                {
+                    size_t shard = (start + i) % m_shards.size();
+                    if (m_shards[shard].retry_after <= now)
+                    {
+                        due.push_back(shard);
+                    }
+                    else if (m_shards[shard].retry_after < m_shards[first_waiting].retry_after)
+                    {
+                        first_waiting = shard;
+                    }
+                }
+
+                if (due.empty())
+                {
+                    due.push_back(first_waiting);
+                }
+
+                return due;
+            }
+
+            // A shard found empty is skipped for a while, twice as long each time in a row up to a limit, and a shard with messages is due at once
+            void record_poll(size_t shard, bool empty)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+
+                shard_state& state = m_shards[shard];
+                if (!empty)
+                {
+                    state.empty_polls = 0;
+                    state.retry_after = std::chrono::steady_clock::time_point();
+                    return;
+                }
+
+                std::chrono::milliseconds delay = initial_delay();
+                for (int i = 0; i < state.empty_polls && delay < maximum_delay(); ++i)
+                {
+                    delay *= 2;
+                }
+
+                ++state.empty_polls;
+                state.retry_after = std::chrono::steady_clock::now() + std::min(delay, maximum_delay());
+            }
+
+        private:
+
+            struct shard_state
+            {
+                shard_state()
+                    : empty_polls(0)
+                {
+                }
+
+                int empty_polls;
+                std::chrono::steady_clock::time_point retry_after;
+            };
+
+            static std::chrono::milliseconds initial_delay()
+            {
+                return std::chrono::milliseconds(500);
+            }
+
+            static std::chrono::milliseconds maximum_delay()
+            {
+                return std::chrono::milliseconds(30000);
+            }
+
+            std::atomic<size_t> m_next_add;
+            std::mutex m_mutex;
+            size_t m_next_poll;
+            std::vector<shard_state> m_shards;
+        };
+    }
+
+    namespace
+    {
+        // Polls the given shards in parallel until enough messages have been retrieved. Each round polls as many shards as there are messages
+        // left to retrieve, and divides the count among them, so that no more messages are retrieved than were asked for.
+        class sharded_queue_receiver : public std::enable_shared_from_this<sharded_queue_receiver>
+        {
+        public:
+
+            sharded_queue_receiver(std::vector<cloud_queue> shards, std::shared_ptr<core::sharded_queue_state> state, std::vector<size_t> order, size_t message_count, std::chrono::seconds visibility_timeout, queue_request_options options, operation_context context)
+                : m_shards(std::move(shards)), m_state(std::move(state)), m_order(std::move(order)), m_next(0), m_message_count(message_count),
+                m_visibility_timeout(visibility_timeout), m_options(std::move(options)), m_context(std::move(context))
+            {
+            }
+
+            pplx::task<std::vector<cloud_sharded_queue_message>> poll()
+            {
+                size_t remaining = m_message_count - m_results.size();
+                size_t round = std::min(m_order.size() - m_next, remaining);
+                if (round == 0)
+                {
+                    // Messages retrieved from other shards are already invisible to other consumers, so they are returned rather than lost to
+                    // a failure, which is only reported when there is nothing else to return
+                    if (m_results.empty() && m_failure != nullptr)
+                    {
+                        std::rethrow_exception(m_failure);
+                    }
+
+                    return pplx::task_from_result(std::move(m_results));
+                }
+
+                auto instance = shared_from_this();
+                std::vector<pplx::task<void>> tasks;
+                tasks.reserve(round);
+                for (size_t i = 0; i < round; ++i)
+                {
+                    size_t shard = m_order[m_next++];
+                    size_t request_count = std::min(remaining / round + (i < remaining % round ? 1U : 0U), static_cast<size_t>(32U));
+
+                    tasks.push_back(m_shards[shard].get_messages_async(request_count, m_visibility_timeout, m_options, m_context).then([instance, shard] (pplx::task<std::vector<cloud_queue_message>> get_task)
+                    {
+                        std::vector<cloud_queue_message> messages;
+                        try
+                        {
+                            messages = get_task.get();
+                        }
+                        catch (...)
+                        {
+                            std::lock_guard<std::mutex> guard(instance->m_mutex);
+                            if (instance->m_failure == nullptr)
+                            {
+                                instance->m_failure = std::current_exception();
+                            }
+
+                            return;
+                        }
+
+                        instance->m_state->record_poll(shard, messages.empty());
+
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        for (auto it = messages.begin(); it != messages.end(); ++it)
+                        {
+                            instance->m_results.push_back(cloud_sharded_queue_message(shard, std::move(*it)));
+                        }
+                    }));
+                }
+
+                return pplx::when_all(tasks.begin(), tasks.end()).then([instance] ()
+                {
+                    return instance->poll();
+                });
+            }
+
+        private:
+
+            std::vector<cloud_queue> m_shards;
+            std::shared_ptr<core::sharded_queue_state> m_state;
+            std::vector<size_t> m_order;
+            size_t m_next;
+            size_t m_message_count;
+            std::chrono::seconds m_visibility_timeout;
+            queue_request_options m_options;
+            operation_context m_context;
+            std::mutex m_mutex;
+            std::vector<cloud_sharded_queue_message> m_results;
+            std::exception_ptr m_failure;
+        };
+    }
+
+    cloud_sharded_queue::cloud_sharded_queue(const cloud_queue_client& client, const utility::string_t& name_prefix, size_t shard_count)
+    {
+        if (shard_count == 0)
+        {
+            throw std::invalid_argument("shard_count");
+        }
+
+        m_shards.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            m_shards.push_back(client.get_queue_reference(name_prefix + core::convert_to_string(i)));
+        }
+
+        m_state = std::make_shared<core::sharded_queue_state>(shard_count);
+    }
+
+    void cloud_sharded_queue::assert_has_shards() const
+    {
+        if (m_shards.empty())
+        {
+            throw std::logic_error(protocol::error_sharded_queue_no_shards);
+        }
+    }
+
+    size_t cloud_sharded_queue::shard_for_key(const utility::string_t& key) const
+    {
+        assert_has_shards();
+
+        // FNV-1a over the UTF-8 bytes of the key, which unlike std::hash is the same on every platform and in every process
+        std::string utf8_key;
+        core::append_utf8(utf8_key, key);
+
+        uint64_t hash = 14695981039346656037ULL;
+        for (auto it = utf8_key.cbegin(); it != utf8_key.cend(); ++it)
+        {
+            hash ^= static_cast<uint8_t>(*it);
+            hash *= 1099511628211ULL;
+        }
+
+        return static_cast<size_t>(hash % m_shards.size());
+    }
+
+    pplx::task<void> cloud_sharded_queue::create_if_not_exists_async(const queue_request_options& options, operation_context context)
+    {
+        auto shards = std::make_shared<std::vector<cloud_queue>>(m_shards);
+
+        std::vector<pplx::task<bool>> tasks;
+        tasks.reserve(shards->size());
+        for (auto it = shards->begin(); it != shards->end(); ++it)
+        {
+            tasks.push_back(it->create_if_not_exists_async(options, context));
+        }
+
+        return pplx::when_all(tasks.begin(), tasks.end()).then([shards] (std::vector<bool>)
+        {
+        });
+    }
+
+    pplx::task<void> cloud_sharded_queue::delete_if_exists_async(const queue_request_options& options, operation_context context)
+    {
+        auto shards = std::make_shared<std::vector<cloud_queue>>(m_shards);
+
+        std::vector<pplx::task<bool>> tasks;
+        tasks.reserve(shards->size());
+        for (auto it = shards->begin(); it != shards->end(); ++it)
+        {
+            tasks.push_back(it->delete_queue_if_exists_async(options, context));
+        }
+
+        return pplx::when_all(tasks.begin(), tasks.end()).then([shards] (std::vector<bool>)
+        {
+        });
+    }
+
+    pplx::task<size_t> cloud_sharded_queue::add_message_async(cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context)
+    {
+        assert_has_shards();
+
+        size_t shard = m_state->next_add_shard();
+        return m_shards[shard].add_message_async(message, time_to_live, initial_visibility_timeout, options, context).then([shard] ()
+        {
+            return shard;
+        });
+    }
+
+    pplx::task<size_t> cloud_sharded_queue::add_message_async(const utility::string_t& key, cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, queue_request_options& options, operation_context context)
+    {
+        size_t shard = shard_for_key(key);
+        return m_shards[shard].add_message_async(message, time_to_live, initial_visibility_timeout, options, context).then([shard] ()
+        {
+            return shard;
+        });
+    }
+
+    pplx::task<std::vector<cloud_sharded_queue_message>> cloud_sharded_queue::get_messages_async(size_t message_count, std::chrono::seconds visibility_timeout, queue_request_options& options, operation_context context)
+    {
+        assert_has_shards();
+
+        if (message_count == 0)
+        {
+            return pplx::task_from_result(std::vector<cloud_sharded_queue_message>());
+        }
+
+        std::vector<size_t> order = m_state->shards_to_poll();
+
+        auto receiver = std::make_shared<sharded_queue_receiver>(m_shards, m_state, std::move(order), message_count, visibility_timeout, options, std::move(context));
+        return receiver->poll();
+    }
+
+    pplx::task<std::vector<int>> cloud_sharded_queue::download_shard_depths_async(const queue_request_options& options, operation_context context) const
+    {
+        // The shards are copied so that the approximate message counts are read into queues the caller does not see
+        auto shards = std::make_shared<std::vector<cloud_queue>>();
+        shards->reserve(m_shards.size());
+        for (auto it = m_shards.cbegin(); it != m_shards.cend(); ++it)
+        {
+            shards->push_back(it->service_client().get_queue_reference(it->name()));
+        }
+
+        std::vector<pplx::task<void>> tasks;
+        tasks.reserve(shards->size());
+        for (auto it = shards->begin(); it != shards->end(); ++it)
+        {
+            tasks.push_back(it->download_attributes_async(options, context));
+        }
+
+        return pplx::when_all(tasks.begin(), tasks.end()).then([shards] ()
+        {
+            std::vector<int> depths;
+            depths.reserve(shards->size());
+            for (auto it = shards->cbegin(); it != shards->cend(); ++it)
+            {
+                depths.push_back(it->approximate_message_count());
+            }
+
+            return depths;
+        });
+    }
+
+}} // namespace azure::storage
@@ -16,6 +16,16 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+#include "wascore/async_semaphore.h"
 #include "wascore/executor.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
@@ -134,9 +144,10 @@ namespace azure { namespace storage {
             }
             else
             {
-                return response.extract_json().then([status_code, etag] (const web::json::value& obj) -> table_result
+                return response.extract_vector().then([status_code, etag] (const std::vector<unsigned char>& body) -> table_result
                 {
-                    table_entity entity = protocol::parse_table_entity(obj);
+                    protocol::table_entity_json_reader reader(body);
+                    table_entity entity = reader.read_entity();
                     if (entity.etag().empty())
                     {
                         entity.set_etag(etag);
@@ -158,7 +169,7 @@ namespace azure { namespace storage {
         table_request_options modified_options = get_modified_options(options);
         storage_uri uri = protocol::generate_table_uri(service_client(), *this, operation);
 
-        std::vector<table_operation> operations = operation.operations();
+        const std::vector<table_operation>& operations = operation.operations();
         if (operations.size() == 0U)
         {
             throw std::invalid_argument(protocol::error_empty_batch_operation);
@@ -193,6 +204,7 @@ namespace azure { namespace storage {
         }
 
         concurrency::streams::container_buffer<std::vector<uint8_t>> response_buffer;
+        size_t operation_count = operations.size();
 
         std::shared_ptr<core::storage_command<std::vector<table_result>>> command = std::make_shared<core::storage_command<std::vector<table_result>>>(uri);
         command->set_build_request(std::bind(protocol::execute_batch_operation, *this, operation, options.payload_format(), is_query, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -200,12 +212,12 @@ namespace azure { namespace storage {
         command->set_location_mode(is_query ? core::command_location_mode::primary_or_secondary : core::command_location_mode::primary_only);
         command->set_destination_stream(response_buffer.create_ostream());
         command->set_preprocess_response(std::bind(protocol::preprocess_response<std::vector<table_result>>, std::vector<table_result>(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-        command->set_postprocess_response([response_buffer, operations, is_query] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) mutable -> pplx::task<std::vector<table_result>>
+        command->set_postprocess_response([response_buffer, operation_count, is_query] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) mutable -> pplx::task<std::vector<table_result>>
         {
             UNREFERENCED_PARAMETER(context);
-            return response.content_ready().then([response_buffer, operations, is_query](const web::http::http_response& response) mutable -> pplx::task<std::vector<table_result>>
+            return response.content_ready().then([response_buffer, operation_count, is_query](const web::http::http_response& response) mutable -> pplx::task<std::vector<table_result>>
             {
-                std::vector<table_result> batch_result = protocol::table_response_parsers::parse_batch_results(response, response_buffer, is_query, operations.size());
+                std::vector<table_result> batch_result = protocol::table_response_parsers::parse_batch_results(response, response_buffer, is_query, operation_count);
                 return pplx::task_from_result(batch_result);
             });
         });
@@ -214,13 +226,29 @@ namespace azure { namespace storage {
 
     table_query_iterator cloud_table::execute_query(const table_query& query, const table_request_options& options, operation_context context) const
     {
+        table_request_options modified_options = get_modified_options(options);
+
+        // The query is captured by value, since prefetched segments may be requested after the caller's query has gone away.
         auto instance = std::make_shared<cloud_table>(*this);
         return table_query_iterator(
-            [instance, &query, options, context](const continuation_token& token, size_t)
+            [instance, query, options, context](const continuation_token& token, size_t)
+        {
+            return instance->execute_query_segmented_async(query, token, options, context);
+        },
+            query.take_count() <= 0 ? 0 : query.take_count(), 0, modified_options.listing_prefetch_depth());
+    }
+
+    pplx::task<void> cloud_table::execute_query_async(const table_query& query, const std::function<void(const table_entity&)>& item_callback, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+
+        auto instance = std::make_shared<cloud_table>(*this);
+        return core::enumerate_segments_async<table_entity>(
+            [instance, query, options, context](const continuation_token& token, size_t)
         {
-            return instance->execute_query_segmented(query, token, options, context);
+            return instance->execute_query_segmented_async(query, token, options, context);
         },
-            query.take_count() <= 0 ? 0 : query.take_count(), 0);
+            query.take_count() <= 0 ? 0 : query.take_count(), modified_options.listing_prefetch_depth(), item_callback);
     }
 
     pplx::task<table_query_segment> cloud_table::execute_query_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const
@@ -238,15 +266,431 @@ namespace azure { namespace storage {
             UNREFERENCED_PARAMETER(context);
             continuation_token next_token = protocol::table_response_parsers::parse_continuation_token(response, result);
 
-            return response.extract_json().then([next_token] (const web::json::value& obj) -> table_query_segment
+            return response.extract_vector().then([next_token] (const std::vector<unsigned char>& body) -> table_query_segment
             {
-                table_query_segment query_segment(protocol::table_response_parsers::parse_query_results(obj), std::move(next_token));
+                protocol::table_entity_json_reader reader(body);
+                table_query_segment query_segment(reader.read_query_results(), std::move(next_token));
                 return query_segment;
             });
         });
         return core::executor<table_query_segment>::execute_async(command, modified_options, context);
     }
 
+    pplx::task<table_entity_record_segment> cloud_table::execute_query_records_segmented_async(const table_query& query, const continuation_token& token, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+        storage_uri uri = protocol::generate_table_uri(service_client(), *this, query, token);
+
+        std::shared_ptr<core::storage_command<table_entity_record_segment>> command = std::make_shared<core::storage_command<table_entity_record_segment>>(uri);
+        command->set_build_request(std::bind(protocol::execute_query, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<table_entity_record_segment>, table_entity_record_segment(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<table_entity_record_segment>
+        {
+            UNREFERENCED_PARAMETER(context);
+            continuation_token next_token = protocol::table_response_parsers::parse_continuation_token(response, result);
+
+            return response.extract_vector().then([next_token] (const std::vector<unsigned char>& body) -> table_entity_record_segment
+            {
+                protocol::table_entity_json_reader reader(body);
+                table_entity_record_segment record_segment(reader.read_query_records(), std::move(next_token));
+                return record_segment;
+            });
+        });
+        return core::executor<table_entity_record_segment>::execute_async(command, modified_options, context);
+    }
+
+    std::vector<table_partition_key_range> table_partition_key_range::split(std::vector<utility::string_t> split_points)
+    {
+        split_points.erase(std::remove(split_points.begin(), split_points.end(), utility::string_t()), split_points.end());
+        std::sort(split_points.begin(), split_points.end());
+        split_points.erase(std::unique(split_points.begin(), split_points.end()), split_points.end());
+
+        std::vector<table_partition_key_range> ranges;
+        ranges.reserve(split_points.size() + 1);
+
+        utility::string_t lower_bound;
+        for (auto it = split_points.begin(); it != split_points.end(); ++it)
+        {
+            ranges.push_back(table_partition_key_range(std::move(lower_bound), *it));
+            lower_bound = std::move(*it);
+        }
+
+        ranges.push_back(table_partition_key_range(std::move(lower_bound), utility::string_t()));
+        return ranges;
+    }
+
+    namespace
+    {
+        // Queries a set of partition key ranges in parallel. Each range follows its own continuation tokens, so its segments are requested one after another.
+        class parallel_table_scan : public std::enable_shared_from_this<parallel_table_scan>
+        {
+        public:
+            parallel_table_scan(cloud_table table, std::vector<table_query> range_queries, bool key_order, std::function<void(table_entity)> entity_callback, table_request_options options, operation_context context)
+                : m_table(std::move(table)), m_key_order(key_order), m_entity_callback(std::move(entity_callback)), m_options(std::move(options)), m_context(std::move(context)),
+                m_semaphore(std::max(m_options.parallelism_factor(), 1)), m_pending(0), m_cursor(0)
+            {
+                m_ranges.reserve(range_queries.size());
+                for (auto it = range_queries.begin(); it != range_queries.end(); ++it)
+                {
+                    m_ranges.push_back(range(std::move(*it)));
+                }
+            }
+
+            pplx::task<void> run()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_pending = m_ranges.size();
+                }
+
+                for (size_t i = 0; i < m_ranges.size(); ++i)
+                {
+                    query_segment(i, continuation_token());
+                }
+
+                return pplx::create_task(m_completion);
+            }
+
+        private:
+
+            struct range
+            {
+                explicit range(table_query query)
+                    : query(std::move(query)), complete(false)
+                {
+                }
+
+                table_query query;
+
+                // Entities received while an earlier range is still incomplete, when delivering in key order
+                std::vector<table_entity> buffered;
+                bool complete;
+            };
+
+            // The caller must have counted the request in m_pending.
+            void query_segment(size_t index, continuation_token token)
+            {
+                auto instance = shared_from_this();
+                m_semaphore.lock_async().then([instance, index, token] ()
+                {
+                    std::unique_lock<core::async_semaphore> sem_unlocker(instance->m_semaphore, std::adopt_lock);
+                    if (instance->is_failed())
+                    {
+                        sem_unlocker.unlock();
+                        instance->complete_segment();
+                        return;
+                    }
+
+                    pplx::task<table_query_segment> segment_task;
+                    try
+                    {
+                        segment_task = instance->m_table.execute_query_segmented_async(instance->m_ranges[index].query, token, instance->m_options, instance->m_context);
+                    }
+                    catch (...)
+                    {
+                        segment_task = pplx::task_from_exception<table_query_segment>(std::current_exception());
+                    }
+
+                    sem_unlocker.release();
+                    segment_task.then([instance, index] (pplx::task<table_query_segment> completed_task)
+                    {
+                        instance->m_semaphore.unlock();
+                        try
+                        {
+                            instance->process_segment(index, completed_task.get());
+                        }
+                        catch (...)
+                        {
+                            instance->fail(std::current_exception());
+                        }
+
+                        instance->complete_segment();
+                    });
+                });
+            }
+
+            void process_segment(size_t index, table_query_segment segment)
+            {
+                bool has_next = false;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (m_exception != nullptr)
+                    {
+                        return;
+                    }
+
+                    range& target = m_ranges[index];
+                    auto& results = segment.results();
+                    if (m_key_order)
+                    {
+                        target.buffered.reserve(target.buffered.size() + results.size());
+                        std::move(results.begin(), results.end(), std::back_inserter(target.buffered));
+                    }
+                    else
+                    {
+                        for (auto it = results.begin(); it != results.end(); ++it)
+                        {
+                            m_entity_callback(std::move(*it));
+                        }
+                    }
+
+                    has_next = !segment.continuation_token().empty();
+                    if (has_next)
+                    {
+                        ++m_pending;
+                    }
+                    else
+                    {
+                        target.complete = true;
+                    }
+
+                    if (m_key_order)
+                    {
+                        try
+                        {
+                            deliver_ordered_entities();
+                        }
+                        catch (...)
+                        {
+                            // The segment counted above still has to run so that the pending count drains; it stops as soon as it sees the failure.
+                            m_exception = std::current_exception();
+                        }
+                    }
+                }
+
+                if (has_next)
+                {
+                    query_segment(index, segment.continuation_token());
+                }
+            }
+
+            // Delivers the entities of the first incomplete range, and of every range before it. Must be called under m_mutex.
+            void deliver_ordered_entities()
+            {
+                while (m_cursor < m_ranges.size())
+                {
+                    range& current = m_ranges[m_cursor];
+                    for (auto it = current.buffered.begin(); it != current.buffered.end(); ++it)
+                    {
+                        m_entity_callback(std::move(*it));
+                    }
+
+                    std::vector<table_entity>().swap(current.buffered);
+                    if (!current.complete)
+                    {
+                        break;
+                    }
+
+                    ++m_cursor;
+                }
+            }
+
+            bool is_failed()
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                return m_exception != nullptr;
+            }
+
+            void fail(std::exception_ptr exception)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (m_exception == nullptr)
+                {
+                    m_exception = exception;
+                }
+            }
+
+            void complete_segment()
+            {
+                std::exception_ptr exception;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    if (--m_pending != 0)
+                    {
+                        return;
+                    }
+
+                    exception = m_exception;
+                    m_ranges.clear();
+                }
+
+                if (exception != nullptr)
+                {
+                    m_completion.set_exception(exception);
+                }
+                else
+                {
+                    m_completion.set();
+                }
+            }
+
+            cloud_table m_table;
+            bool m_key_order;
+            std::function<void(table_entity)> m_entity_callback;
+            table_request_options m_options;
+            operation_context m_context;
+            core::async_semaphore m_semaphore;
+
+            std::mutex m_mutex;
+            std::vector<range> m_ranges;
+            size_t m_pending;
+            size_t m_cursor;
+            std::exception_ptr m_exception;
+            pplx::task_completion_event<void> m_completion;
+        };
+    }
+
+    pplx::task<void> cloud_table::execute_query_parallel_async(const table_query& query, const std::vector<table_partition_key_range>& ranges, bool key_order, const std::function<void(table_entity)>& entity_callback, const table_request_options& options, operation_context context) const
+    {
+        if (!entity_callback)
+        {
+            throw std::invalid_argument("entity_callback");
+        }
+
+        std::vector<table_partition_key_range> sorted_ranges(ranges);
+        std::sort(sorted_ranges.begin(), sorted_ranges.end(), [] (const table_partition_key_range& left, const table_partition_key_range& right)
+        {
+            return left.lower_bound() < right.lower_bound();
+        });
+
+        std::vector<table_query> range_queries;
+        range_queries.reserve(sorted_ranges.size());
+        for (size_t i = 0; i < sorted_ranges.size(); ++i)
+        {
+            const table_partition_key_range& current = sorted_ranges[i];
+            if (!current.upper_bound().empty() && current.upper_bound() <= current.lower_bound())
+            {
+                throw std::invalid_argument("ranges");
+            }
+
+            // Ranges must not overlap, or entities would be returned more than once
+            if (i + 1 < sorted_ranges.size() && (current.upper_bound().empty() || current.upper_bound() > sorted_ranges[i + 1].lower_bound()))
+            {
+                throw std::invalid_argument("ranges");
+            }
+
+            utility::string_t filter = query.filter_string();
+            if (!current.lower_bound().empty())
+            {
+                utility::string_t condition = table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), query_comparison_operator::greater_than_or_equal, current.lower_bound());
+                filter = filter.empty() ? condition : table_query::combine_filter_conditions(filter, query_logical_operator::op_and, condition);
+            }
+
+            if (!current.upper_bound().empty())
+            {
+                utility::string_t condition = table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), query_comparison_operator::less_than, current.upper_bound());
+                filter = filter.empty() ? condition : table_query::combine_filter_conditions(filter, query_logical_operator::op_and, condition);
+            }
+
+            table_query range_query(query);
+            range_query.set_filter_string(filter);
+            range_queries.push_back(std::move(range_query));
+        }
+
+        if (range_queries.empty())
+        {
+            return pplx::task_from_result();
+        }
+
+        auto scan = std::make_shared<parallel_table_scan>(*this, std::move(range_queries), key_order, entity_callback, get_modified_options(options), context);
+        return scan->run();
+    }
+
+    pplx::task<table_result> cloud_table::execute_async_impl(table_operation_type operation_type, void* entity, std::shared_ptr<const table_entity_schema> schema, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+        storage_uri uri = protocol::generate_table_uri(service_client(), *this, operation_type, *schema->partition_key(entity), *schema->row_key(entity));
+
+        utility::string_t* etag_member = schema->etag(entity);
+        utility::string_t etag = etag_member != nullptr ? *etag_member : utility::string_t();
+        std::string body = protocol::generate_json_body(operation_type, *schema, entity);
+
+        // Do not throw an exception when the retrieve fails because the entity does not exist
+        bool allow_not_found = operation_type == table_operation_type::retrieve_operation;
+
+        std::shared_ptr<core::storage_command<table_result>> command = std::make_shared<core::storage_command<table_result>>(uri);
+        command->set_build_request([operation_type, etag, body, modified_options] (web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context) -> web::http::http_request
+        {
+            return protocol::execute_operation(operation_type, etag, body, modified_options.payload_format(), uri_builder, timeout, context);
+        });
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(operation_type == azure::storage::table_operation_type::retrieve_operation ? core::command_location_mode::primary_or_secondary : core::command_location_mode::primary_only);
+        command->set_preprocess_response([allow_not_found] (const web::http::http_response& response, const request_result& result, operation_context context) -> table_result
+        {
+            if (!allow_not_found || response.status_code() != web::http::status_codes::NotFound)
+            {
+                protocol::preprocess_response_void(response, result, context);
+            }
+            return table_result();
+        });
+        command->set_postprocess_response([entity, schema] (const web::http::http_response& response, const request_result&, const core::ostream_descriptor&, operation_context context) -> pplx::task<table_result>
+        {
+            UNREFERENCED_PARAMETER(context);
+            int status_code = response.status_code();
+            utility::string_t etag = protocol::table_response_parsers::parse_etag(response);
+
+            table_result result;
+            result.set_http_status_code(status_code);
+            result.set_etag(etag);
+
+            if (status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::NotFound)
+            {
+                utility::string_t* etag_member = schema->etag(entity);
+                if (etag_member != nullptr && status_code == web::http::status_codes::NoContent)
+                {
+                    *etag_member = std::move(etag);
+                }
+
+                return pplx::task_from_result(result);
+            }
+
+            return response.extract_vector().then([entity, schema, etag, result] (const std::vector<unsigned char>& body) -> table_result
+            {
+                protocol::table_entity_json_reader reader(body);
+                reader.read_entity(*schema, entity);
+
+                utility::string_t* etag_member = schema->etag(entity);
+                if (etag_member != nullptr && !etag.empty())
+                {
+                    *etag_member = etag;
+                }
+
+                return result;
+            });
+        });
+        return core::executor<table_result>::execute_async(command, modified_options, context);
+    }
+
+    pplx::task<continuation_token> cloud_table::execute_query_segmented_async_impl(const table_query& query, const continuation_token& token, std::shared_ptr<const table_entity_schema> schema, std::function<void*()> add_entity, std::function<void()> clear_entities, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+        storage_uri uri = protocol::generate_table_uri(service_client(), *this, query, token);
+
+        std::shared_ptr<core::storage_command<continuation_token>> command = std::make_shared<core::storage_command<continuation_token>>(uri);
+        command->set_build_request(std::bind(protocol::execute_query, modified_options.payload_format(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_authentication_handler(service_client().authentication_handler());
+        command->set_location_mode(core::command_location_mode::primary_or_secondary, token.target_location());
+        command->set_preprocess_response(std::bind(protocol::preprocess_response<continuation_token>, continuation_token(), std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+        command->set_postprocess_response([schema, add_entity, clear_entities] (const web::http::http_response& response, const request_result& result, const core::ostream_descriptor&, operation_context context) -> pplx::task<continuation_token>
+        {
+            UNREFERENCED_PARAMETER(context);
+            continuation_token next_token = protocol::table_response_parsers::parse_continuation_token(response, result);
+
+            return response.extract_vector().then([schema, add_entity, clear_entities, next_token] (const std::vector<unsigned char>& body) -> continuation_token
+            {
+                // Entities read from an earlier attempt of this request are discarded before reading the response again
+                clear_entities();
+
+                protocol::table_entity_json_reader reader(body);
+                reader.read_query_results(*schema, add_entity);
+                return next_token;
+            });
+        });
+        return core::executor<continuation_token>::execute_async(command, modified_options, context);
+    }
+
     utility::string_t cloud_table::get_shared_access_signature(const table_shared_access_policy& policy, const utility::string_t& stored_policy_identifier, const utility::string_t& start_partition_key, const utility::string_t& start_row_key, const utility::string_t& end_partition_key, const utility::string_t& end_row_key) const
     {
         if (!service_client().credentials().is_shared_key())
@@ -405,4 +849,757 @@ namespace azure { namespace storage {
         });
     }
 
+    namespace core
+    {
+        // Groups the operations of a table_batch_writer into batches per partition key. The batches of a partition are sent one at a time, in the order
+        // they were sealed, while different partitions are sent in parallel. When too many operations are waiting in batches that are not full yet,
+        // as happens when operations are spread over many partitions, the batch that was opened first is sealed, so the buffered operations stay bounded.
+        class table_batch_dispatcher : public std::enable_shared_from_this<table_batch_dispatcher>
+        {
+        public:
+
+            table_batch_dispatcher(cloud_table table, table_request_options options, operation_context context)
+                : m_table(std::move(table)), m_options(std::move(options)), m_context(std::move(context)),
+                m_semaphore(std::max(m_options.parallelism_factor(), 1)), m_max_outstanding(2 * static_cast<size_t>(std::max(m_options.parallelism_factor(), 1))), m_open_operations(0), m_outstanding(0)
+            {
+            }
+
+            pplx::task<void> add(table_operation operation)
+            {
+                if (operation.operation_type() == table_operation_type::retrieve_operation)
+                {
+                    throw std::invalid_argument("operation");
+                }
+
+                size_t operation_size = batch_operation_overhead + protocol::table_entity_json_writer::estimate_size(operation.entity());
+                utility::string_t partition_key = operation.entity().partition_key();
+
+                std::vector<utility::string_t> partitions_to_run;
+                pplx::task_completion_event<void> waiter;
+                bool must_wait;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    auto target_it = m_partitions.insert(std::make_pair(std::move(partition_key), partition())).first;
+                    partition& target = target_it->second;
+
+                    // A batch cannot contain more than one operation on the same entity
+                    if (!target.open.empty() && (target.open.size() == max_batch_operations || target.open_size + operation_size > max_batch_size || target.open_rows.count(operation.entity().row_key()) != 0))
+                    {
+                        seal(target_it->first, target, partitions_to_run);
+                    }
+
+                    if (target.open.empty())
+                    {
+                        target.open_order = m_open_order.insert(m_open_order.end(), target_it->first);
+                    }
+
+                    target.open_rows.insert(operation.entity().row_key());
+                    target.open_size += operation_size;
+                    target.open.push_back(std::move(operation));
+                    ++m_open_operations;
+
+                    if (target.open.size() == max_batch_operations)
+                    {
+                        seal(target_it->first, target, partitions_to_run);
+                    }
+
+                    while (m_open_operations > max_open_operations)
+                    {
+                        const utility::string_t& oldest_key = m_open_order.front();
+                        seal(oldest_key, m_partitions[oldest_key], partitions_to_run);
+                    }
+
+                    must_wait = m_outstanding > m_max_outstanding;
+                    if (must_wait)
+                    {
+                        m_waiters.push_back(waiter);
+                    }
+                }
+
+                run_partitions(partitions_to_run);
+                return must_wait ? pplx::create_task(waiter) : pplx::task_from_result();
+            }
+
+            // Sends the batches that are not full yet, without waiting for them
+            void send()
+            {
+                std::vector<utility::string_t> partitions_to_run;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    seal_open_batches(partitions_to_run);
+                }
+
+                run_partitions(partitions_to_run);
+            }
+
+            pplx::task<void> flush()
+            {
+                std::vector<utility::string_t> partitions_to_run;
+                pplx::task_completion_event<void> flushed;
+                bool must_wait;
+                std::exception_ptr exception;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    seal_open_batches(partitions_to_run);
+
+                    must_wait = m_outstanding > 0;
+                    if (must_wait)
+                    {
+                        m_flush_events.push_back(flushed);
+                    }
+                    else
+                    {
+                        exception = take_exception();
+                    }
+                }
+
+                run_partitions(partitions_to_run);
+
+                if (!must_wait)
+                {
+                    return exception ? pplx::task_from_exception<void>(exception) : pplx::task_from_result();
+                }
+
+                auto instance = shared_from_this();
+                return pplx::create_task(flushed).then([instance] ()
+                {
+                    std::exception_ptr exception;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        exception = instance->take_exception();
+                    }
+
+                    if (exception)
+                    {
+                        std::rethrow_exception(exception);
+                    }
+                });
+            }
+
+        private:
+
+            // The request line, headers and boundaries that accompany every operation in a batch request body
+            static const size_t batch_operation_overhead = 512;
+            static const size_t max_batch_operations = 100;
+
+            // The service limit on the request body of a batch is 4 MB. Part of it is kept in reserve because entity sizes are estimated.
+            static const size_t max_batch_size = 4 * 1024 * 1024 - 256 * 1024;
+
+            // The number of operations that may wait in batches that are not full yet, across all partitions
+            static const size_t max_open_operations = 10 * max_batch_operations;
+
+            struct partition
+            {
+                partition()
+                    : open_size(0), running(false)
+                {
+                }
+
+                // The batch that operations are currently added to, and its place in the order in which the open batches were started
+                std::vector<table_operation> open;
+                size_t open_size;
+                std::unordered_set<utility::string_t> open_rows;
+                std::list<utility::string_t>::iterator open_order;
+
+                // Full batches waiting for the previous batch of the partition to finish
+                std::deque<std::vector<table_operation>> sealed;
+                bool running;
+            };
+
+            // The caller must hold the mutex.
+            void seal_open_batches(std::vector<utility::string_t>& partitions_to_run)
+            {
+                for (auto it = m_partitions.begin(); it != m_partitions.end(); ++it)
+                {
+                    if (!it->second.open.empty())
+                    {
+                        seal(it->first, it->second, partitions_to_run);
+                    }
+                }
+            }
+
+            // The caller must hold the mutex.
+            void seal(const utility::string_t& partition_key, partition& target, std::vector<utility::string_t>& partitions_to_run)
+            {
+                // The key may belong to the order list, so it is used before the entry is erased
+                if (!target.running)
+                {
+                    target.running = true;
+                    partitions_to_run.push_back(partition_key);
+                }
+
+                m_open_operations -= target.open.size();
+                m_open_order.erase(target.open_order);
+                target.sealed.push_back(std::move(target.open));
+                target.open.clear();
+                target.open_size = 0;
+                target.open_rows.clear();
+                ++m_outstanding;
+            }
+
+            // The caller must hold the mutex.
+            std::exception_ptr take_exception()
+            {
+                std::exception_ptr exception = m_exception;
+                m_exception = nullptr;
+                return exception;
+            }
+
+            void run_partitions(const std::vector<utility::string_t>& partition_keys)
+            {
+                for (auto it = partition_keys.cbegin(); it != partition_keys.cend(); ++it)
+                {
+                    run_partition(*it);
+                }
+            }
+
+            // Sends the next sealed batch of a partition. The partition must be marked as running and have a sealed batch.
+            void run_partition(utility::string_t partition_key)
+            {
+                auto instance = shared_from_this();
+                m_semaphore.lock_async().then([instance, partition_key] () -> pplx::task<void>
+                {
+                    std::vector<table_operation> operations;
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        partition& target = instance->m_partitions[partition_key];
+                        operations = std::move(target.sealed.front());
+                        target.sealed.pop_front();
+                    }
+
+                    return instance->execute_batch(std::move(operations));
+                }).then([instance, partition_key] (pplx::task<void> batch_task)
+                {
+                    instance->m_semaphore.unlock();
+
+                    try
+                    {
+                        batch_task.get();
+                    }
+                    catch (...)
+                    {
+                        instance->fail(std::current_exception());
+                    }
+
+                    instance->complete_batch(partition_key);
+                });
+            }
+
+            // Executes a batch, splitting it when the service rejects it because of one of its operations. Failures are recorded, so the task always succeeds.
+            pplx::task<void> execute_batch(std::vector<table_operation> operations)
+            {
+                // The batch keeps the only copy of the operations, which are needed again if the batch has to be split
+                auto batch = std::make_shared<table_batch_operation>();
+                batch->operations() = std::move(operations);
+
+                pplx::task<std::vector<table_result>> batch_task;
+                try
+                {
+                    batch_task = m_table.execute_batch_async(*batch, m_options, m_context);
+                }
+                catch (...)
+                {
+                    fail(std::current_exception());
+                    return pplx::task_from_result();
+                }
+
+                auto instance = shared_from_this();
+                return batch_task.then([instance, batch] (pplx::task<std::vector<table_result>> result) -> pplx::task<void>
+                {
+                    try
+                    {
+                        result.get();
+                    }
+                    catch (const storage_exception& e)
+                    {
+                        auto parts = std::make_shared<std::vector<std::vector<table_operation>>>();
+                        bool operation_failed = false;
+                        if (split_batch(e, batch->operations(), *parts, operation_failed))
+                        {
+                            if (operation_failed)
+                            {
+                                instance->fail(std::current_exception());
+                            }
+
+                            return instance->execute_batches(parts, 0);
+                        }
+
+                        instance->fail(std::current_exception());
+                    }
+                    catch (...)
+                    {
+                        instance->fail(std::current_exception());
+                    }
+
+                    return pplx::task_from_result();
+                });
+            }
+
+            // Executes the parts of a split batch one after another, so that the operations of the partition stay in order.
+            pplx::task<void> execute_batches(std::shared_ptr<std::vector<std::vector<table_operation>>> batches, size_t index)
+            {
+                if (index == batches->size())
+                {
+                    return pplx::task_from_result();
+                }
+
+                auto instance = shared_from_this();
+                return execute_batch(std::move((*batches)[index])).then([instance, batches, index] ()
+                {
+                    return instance->execute_batches(batches, index + 1);
+                });
+            }
+
+            // Splits a failed batch around the operation that caused the failure, or in halves if the request body was too large. The operation that
+            // caused the failure is not sent again, because the service has already reported its result, and operation_failed is set. Returns false if
+            // the batch holds a single operation or the failure cannot be attributed to part of the batch.
+            static bool split_batch(const storage_exception& e, std::vector<table_operation>& operations, std::vector<std::vector<table_operation>>& parts, bool& operation_failed)
+            {
+                if (operations.size() < 2)
+                {
+                    return false;
+                }
+
+                if (e.result().http_status_code() == web::http::status_codes::RequestEntityTooLarge)
+                {
+                    auto middle = operations.begin() + operations.size() / 2;
+                    parts.push_back(std::vector<table_operation>(std::make_move_iterator(operations.begin()), std::make_move_iterator(middle)));
+                    parts.push_back(std::vector<table_operation>(std::make_move_iterator(middle), std::make_move_iterator(operations.end())));
+                    return true;
+                }
+
+                // The service identifies the failed operation by prefixing the error message with its index, as in "1:The specified entity already exists."
+                const utility::string_t& message = e.result().extended_error().message();
+                size_t index = 0;
+                size_t position = 0;
+                for (; position < message.size() && message[position] >= _XPLATSTR('0') && message[position] <= _XPLATSTR('9') && position < 4; ++position)
+                {
+                    index = index * 10 + static_cast<size_t>(message[position] - _XPLATSTR('0'));
+                }
+
+                if (position == 0 || position == message.size() || message[position] != _XPLATSTR(':') || index >= operations.size())
+                {
+                    return false;
+                }
+
+                auto failed = operations.begin() + index;
+                if (failed != operations.begin())
+                {
+                    parts.push_back(std::vector<table_operation>(std::make_move_iterator(operations.begin()), std::make_move_iterator(failed)));
+                }
+
+                if (failed + 1 != operations.end())
+                {
+                    parts.push_back(std::vector<table_operation>(std::make_move_iterator(failed + 1), std::make_move_iterator(operations.end())));
+                }
+
+                operation_failed = true;
+                return true;
+            }
+
+            void fail(std::exception_ptr exception)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                if (!m_exception)
+                {
+                    m_exception = exception;
+                }
+            }
+
+            void complete_batch(const utility::string_t& partition_key)
+            {
+                bool run_next = false;
+                std::vector<pplx::task_completion_event<void>> waiters;
+                std::vector<pplx::task_completion_event<void>> flush_events;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    --m_outstanding;
+
+                    auto it = m_partitions.find(partition_key);
+                    if (!it->second.sealed.empty())
+                    {
+                        run_next = true;
+                    }
+                    else
+                    {
+                        it->second.running = false;
+                        if (it->second.open.empty())
+                        {
+                            m_partitions.erase(it);
+                        }
+                    }
+
+                    if (m_outstanding <= m_max_outstanding)
+                    {
+                        waiters.swap(m_waiters);
+                    }
+
+                    if (m_outstanding == 0)
+                    {
+                        flush_events.swap(m_flush_events);
+                    }
+                }
+
+                for (auto it = waiters.begin(); it != waiters.end(); ++it)
+                {
+                    it->set();
+                }
+
+                for (auto it = flush_events.begin(); it != flush_events.end(); ++it)
+                {
+                    it->set();
+                }
+
+                if (run_next)
+                {
+                    run_partition(partition_key);
+                }
+            }
+
+            cloud_table m_table;
+            table_request_options m_options;
+            operation_context m_context;
+            async_semaphore m_semaphore;
+            size_t m_max_outstanding;
+
+            std::mutex m_mutex;
+            std::unordered_map<utility::string_t, partition> m_partitions;
+            std::list<utility::string_t> m_open_order;
+            size_t m_open_operations;
+            size_t m_outstanding;
+            std::vector<pplx::task_completion_event<void>> m_waiters;
+            std::vector<pplx::task_completion_event<void>> m_flush_events;
+            std::exception_ptr m_exception;
+        };
+
+        // Combines the writes of a table_write_cache to each entity while its window is open, and hands them to a table_batch_dispatcher when it ends.
+        // Writes are handed over while the mutex is held, so the dispatcher receives the operations on each entity in the order they were made.
+        class table_write_coalescer : public std::enable_shared_from_this<table_write_coalescer>
+        {
+        public:
+
+            table_write_coalescer(std::shared_ptr<table_batch_dispatcher> dispatcher, std::chrono::milliseconds window)
+                : m_dispatcher(std::move(dispatcher)), m_window(window), m_window_open(false)
+            {
+            }
+
+            pplx::task<void> write(table_operation operation)
+            {
+                if (operation.operation_type() == table_operation_type::retrieve_operation)
+                {
+                    throw std::invalid_argument("operation");
+                }
+
+                std::vector<pplx::task<void>> added;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+
+                    entity_key key(operation.entity().partition_key(), operation.entity().row_key());
+                    auto index_it = m_index.find(key);
+                    if (index_it != m_index.end())
+                    {
+                        if (is_combinable(operation) && combine(*index_it->second, operation))
+                        {
+                            return pplx::task_from_result();
+                        }
+
+                        // The buffered write must reach the service before the operation that could not be combined with it
+                        added.push_back(m_dispatcher->add(to_operation(std::move(*index_it->second))));
+                        m_pending.erase(index_it->second);
+                        m_index.erase(index_it);
+                    }
+
+                    if (is_combinable(operation))
+                    {
+                        m_pending.push_back(pending_write(operation.operation_type(), operation.entity()));
+                        m_index.insert(std::make_pair(std::move(key), std::prev(m_pending.end())));
+                    }
+                    else
+                    {
+                        added.push_back(m_dispatcher->add(std::move(operation)));
+                    }
+
+                    // Operations handed to the dispatcher wait in a batch that is not full yet, so the window also ends by sending them
+                    open_window();
+                }
+
+                return added.empty() ? pplx::task_from_result() : pplx::when_all(added.begin(), added.end());
+            }
+
+            pplx::task<void> flush()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    send_pending();
+                }
+
+                return m_dispatcher->flush();
+            }
+
+        private:
+
+            typedef std::pair<utility::string_t, utility::string_t> entity_key;
+
+            struct pending_write
+            {
+                pending_write(table_operation_type type, table_entity entity)
+                    : type(type), entity(std::move(entity))
+                {
+                }
+
+                table_operation_type type;
+                table_entity entity;
+            };
+
+            // Merge and replace operations only take part when they are not conditional on a specific version of the entity
+            static bool is_combinable(const table_operation& operation)
+            {
+                switch (operation.operation_type())
+                {
+                case table_operation_type::insert_or_merge_operation:
+                case table_operation_type::insert_or_replace_operation:
+                    return true;
+
+                case table_operation_type::merge_operation:
+                case table_operation_type::replace_operation:
+                    return operation.entity().etag().empty() || operation.entity().etag() == _XPLATSTR("*");
+
+                default:
+                    return false;
+                }
+            }
+
+            // Combines the next operation into the buffered write, if the result has the same effect as executing both of them in order
+            static bool combine(pending_write& write, const table_operation& next)
+            {
+                bool write_is_upsert = write.type == table_operation_type::insert_or_merge_operation || write.type == table_operation_type::insert_or_replace_operation;
+
+                if (next.operation_type() == table_operation_type::insert_or_replace_operation || next.operation_type() == table_operation_type::replace_operation)
+                {
+                    // A replacement determines the whole entity. It still requires the entity to exist unless the buffered write could have created it.
+                    write.type = write_is_upsert ? table_operation_type::insert_or_replace_operation : next.operation_type();
+                    write.entity = next.entity();
+                    return true;
+                }
+
+                if (next.operation_type() == table_operation_type::insert_or_merge_operation && !write_is_upsert)
+                {
+                    // The insert could create an entity that the buffered merge or replace would not find
+                    return false;
+                }
+
+                table_entity::properties_type& properties = write.entity.properties();
+                for (auto it = next.entity().properties().cbegin(); it != next.entity().properties().cend(); ++it)
+                {
+                    properties[it->first] = it->second;
+                }
+
+                return true;
+            }
+
+            static table_operation to_operation(pending_write write)
+            {
+                switch (write.type)
+                {
+                case table_operation_type::insert_or_merge_operation:
+                    return table_operation::insert_or_merge_entity(std::move(write.entity));
+
+                case table_operation_type::insert_or_replace_operation:
+                    return table_operation::insert_or_replace_entity(std::move(write.entity));
+
+                case table_operation_type::merge_operation:
+                    return table_operation::merge_entity(std::move(write.entity));
+
+                default:
+                    return table_operation::replace_entity(std::move(write.entity));
+                }
+            }
+
+            // The caller must hold the mutex.
+            void open_window()
+            {
+                if (m_window_open)
+                {
+                    return;
+                }
+
+                m_window_open = true;
+
+                // The window keeps the coalescer alive, so that writes buffered when the cache is destroyed are still sent
+                auto instance = shared_from_this();
+                core::complete_after(m_window).then([instance] ()
+                {
+                    {
+                        std::lock_guard<std::mutex> guard(instance->m_mutex);
+                        instance->m_window_open = false;
+                        instance->send_pending();
+                    }
+
+                    instance->m_dispatcher->send();
+                });
+            }
+
+            // The caller must hold the mutex. Failures are reported by the next flush, so the tasks of the dispatcher are not waited for.
+            void send_pending()
+            {
+                for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+                {
+                    m_dispatcher->add(to_operation(std::move(*it)));
+                }
+
+                m_pending.clear();
+                m_index.clear();
+            }
+
+            std::shared_ptr<table_batch_dispatcher> m_dispatcher;
+            std::chrono::milliseconds m_window;
+
+            std::mutex m_mutex;
+            std::list<pending_write> m_pending;
+            std::map<entity_key, std::list<pending_write>::iterator> m_index;
+            bool m_window_open;
+        };
+    }
+
+    table_batch_writer::table_batch_writer(cloud_table table, const table_request_options& options, operation_context context)
+    {
+        table_request_options modified_options(options);
+        modified_options.apply_defaults(table.service_client().default_request_options());
+
+        m_dispatcher = std::make_shared<core::table_batch_dispatcher>(std::move(table), std::move(modified_options), std::move(context));
+    }
+
+    table_batch_writer::~table_batch_writer()
+    {
+        // The batches keep the dispatcher alive until they finish, so the operations are still sent after the writer is gone
+        m_dispatcher->send();
+    }
+
+    pplx::task<void> table_batch_writer::add_async(table_operation operation)
+    {
+        return m_dispatcher->add(std::move(operation));
+    }
+
+    pplx::task<void> table_batch_writer::flush_async()
+    {
+        return m_dispatcher->flush();
+    }
+
+    table_write_cache::table_write_cache(cloud_table table, std::chrono::milliseconds window, const table_request_options& options, operation_context context)
+    {
+        if (window.count() <= 0)
+        {
+            throw std::invalid_argument("window");
+        }
+
+        table_request_options modified_options(options);
+        modified_options.apply_defaults(table.service_client().default_request_options());
+
+        auto dispatcher = std::make_shared<core::table_batch_dispatcher>(std::move(table), std::move(modified_options), std::move(context));
+        m_coalescer = std::make_shared<core::table_write_coalescer>(std::move(dispatcher), window);
+    }
+
+    pplx::task<void> table_write_cache::write_async(table_operation operation)
+    {
+        return m_coalescer->write(std::move(operation));
+    }
+
+    pplx::task<void> table_write_cache::flush_async()
+    {
+        return m_coalescer->flush();
+    }
+
+    namespace
+    {
+        // Deletes the entities a query returns. The next segment is requested as soon as the deletes of the previous one have been handed to the
+        // dispatcher, so queries overlap with the batches still being sent.
+        class table_bulk_delete : public std::enable_shared_from_this<table_bulk_delete>
+        {
+        public:
+            table_bulk_delete(cloud_table table, table_query query, table_request_options options, operation_context context)
+                : m_table(table), m_query(std::move(query)), m_options(options), m_context(context), m_count(0)
+            {
+                m_dispatcher = std::make_shared<core::table_batch_dispatcher>(std::move(table), std::move(options), std::move(context));
+            }
+
+            pplx::task<size_t> run()
+            {
+                auto instance = shared_from_this();
+                return next_segment(continuation_token()).then([instance] (pplx::task<void> query_task)
+                {
+                    // The deletes already handed over are waited for even when a query failed, so that no batch outlives the operation
+                    return instance->m_dispatcher->flush().then([instance, query_task] (pplx::task<void> flush_task) -> size_t
+                    {
+                        query_task.get();
+                        flush_task.get();
+                        return instance->m_count;
+                    });
+                });
+            }
+
+        private:
+            pplx::task<void> next_segment(const continuation_token& token)
+            {
+                auto instance = shared_from_this();
+                return m_table.execute_query_records_segmented_async(m_query, token, m_options, m_context).then([instance] (table_entity_record_segment segment) -> pplx::task<void>
+                {
+                    const std::vector<table_entity_record>& records = segment.results();
+
+                    std::vector<pplx::task<void>> added;
+                    added.reserve(records.size());
+                    for (auto it = records.cbegin(); it != records.cend(); ++it)
+                    {
+                        table_entity entity(it->partition_key(), it->row_key());
+                        entity.set_etag(it->etag());
+                        added.push_back(instance->m_dispatcher->add(table_operation::delete_entity(std::move(entity))));
+                    }
+
+                    instance->m_count += records.size();
+
+                    if (segment.continuation_token().empty())
+                    {
+                        return pplx::when_all(added.begin(), added.end());
+                    }
+
+                    // Waiting for the dispatcher to accept the deletes keeps a fast query from buffering an unbounded number of them
+                    continuation_token next_token = segment.continuation_token();
+                    return pplx::when_all(added.begin(), added.end()).then([instance, next_token] ()
+                    {
+                        return instance->next_segment(next_token);
+                    });
+                });
+            }
+
+            cloud_table m_table;
+            table_query m_query;
+            table_request_options m_options;
+            operation_context m_context;
+            std::shared_ptr<core::table_batch_dispatcher> m_dispatcher;
+            size_t m_count;
+        };
+    }
+
+    pplx::task<size_t> cloud_table::delete_entities_async(const table_query& query, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+
+        // Without metadata the response has no ETags, and a delete with an empty ETag would remove the entity unconditionally
+        if (modified_options.payload_format() == table_payload_format::json_no_metadata)
+        {
+            modified_options.set_payload_format(table_payload_format::json);
+        }
+
+        // Only the keys are needed, and the ETag that comes with every entity
+        table_query key_query(query);
+        std::vector<utility::string_t> select_columns;
+        select_columns.push_back(_XPLATSTR("PartitionKey"));
+        select_columns.push_back(_XPLATSTR("RowKey"));
+        key_query.set_select_columns(std::move(select_columns));
+
+        auto instance = std::make_shared<table_bulk_delete>(*this, std::move(key_query), std::move(modified_options), std::move(context));
+        return instance->run();
+    }
+
 }} // namespace azure::storage
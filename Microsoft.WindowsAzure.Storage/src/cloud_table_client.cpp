@@ -30,13 +30,28 @@ namespace azure { namespace storage {
 
     table_result_iterator cloud_table_client::list_tables(const utility::string_t& prefix, utility::size64_t max_results, const table_request_options& options, operation_context context) const
     {
+        table_request_options modified_options = get_modified_options(options);
+
         auto instance = std::make_shared<cloud_table_client>(*this);
         return table_result_iterator(
             [instance, prefix, options, context](const continuation_token& token, size_t max_results_per_segment)
         {
-            return instance->list_tables_segmented(prefix, (int)max_results_per_segment, token, options, context);
+            return instance->list_tables_segmented_async(prefix, (int)max_results_per_segment, token, options, context);
+        },
+            max_results, 0, modified_options.listing_prefetch_depth());
+    }
+
+    pplx::task<void> cloud_table_client::list_tables_async(const utility::string_t& prefix, utility::size64_t max_results, const std::function<void(const cloud_table&)>& item_callback, const table_request_options& options, operation_context context) const
+    {
+        table_request_options modified_options = get_modified_options(options);
+
+        auto instance = std::make_shared<cloud_table_client>(*this);
+        return core::enumerate_segments_async<cloud_table>(
+            [instance, prefix, options, context](const continuation_token& token, size_t max_results_per_segment)
+        {
+            return instance->list_tables_segmented_async(prefix, (int)max_results_per_segment, token, options, context);
         },
-            max_results, 0);
+            max_results, modified_options.listing_prefetch_depth(), item_callback);
     }
 
     pplx::task<table_result_segment> cloud_table_client::list_tables_segmented_async(const utility::string_t& prefix, int max_results, const continuation_token& token, const table_request_options& options, operation_context context) const
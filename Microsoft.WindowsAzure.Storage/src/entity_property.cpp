@@ -16,12 +16,98 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <thread>
+
 #include "was/table.h"
 #include "wascore/util.h"
+#include "wascore/base64.h"
 #include "wascore/resources.h"
 
 namespace azure { namespace storage {
 
+    namespace
+    {
+        // These parse the text of a value without throwing, so that text which does not parse costs no more than text which does.
+
+        bool try_parse_boolean(const utility::string_t& value, bool& result)
+        {
+            if (value.compare(_XPLATSTR("false")) == 0)
+            {
+                result = false;
+                return true;
+            }
+            else if (value.compare(_XPLATSTR("true")) == 0)
+            {
+                result = true;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool try_parse_datetime(const utility::string_t& value, utility::datetime& result)
+        {
+            result = utility::datetime::from_string(value, utility::datetime::ISO_8601);
+            return result.is_initialized();
+        }
+
+        bool try_parse_double(const utility::string_t& value, double& result)
+        {
+            if (value.compare(protocol::double_not_a_number) == 0)
+            {
+                result = std::numeric_limits<double>::quiet_NaN();
+                return true;
+            }
+            else if (value.compare(protocol::double_infinity) == 0)
+            {
+                result = std::numeric_limits<double>::infinity();
+                return true;
+            }
+            else if (value.compare(protocol::double_negative_infinity) == 0)
+            {
+                result = -std::numeric_limits<double>::infinity();
+                return true;
+            }
+
+            utility::istringstream_t buffer(value);
+            buffer >> result;
+            return !buffer.fail() && buffer.eof();
+        }
+
+        template<typename T>
+        bool try_parse_integer(const utility::string_t& value, T& result)
+        {
+            utility::istringstream_t buffer(value);
+            buffer >> result;
+            return !buffer.fail() && buffer.eof();
+        }
+
+        bool try_parse_uuid(const utility::string_t& value, utility::uuid& result)
+        {
+            // The only form both UuidFromString and uuid_parse accept is 8-4-4-4-12 hexadecimal digits, so anything else is rejected
+            // here instead of by an exception from string_to_uuid.
+            if (value.size() != 36)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < value.size(); ++i)
+            {
+                utility::char_t c = value[i];
+                bool valid = (i == 8 || i == 13 || i == 18 || i == 23) ? c == _XPLATSTR('-') :
+                    (c >= _XPLATSTR('0') && c <= _XPLATSTR('9')) || (c >= _XPLATSTR('a') && c <= _XPLATSTR('f')) || (c >= _XPLATSTR('A') && c <= _XPLATSTR('F'));
+                if (!valid)
+                {
+                    return false;
+                }
+            }
+
+            result = utility::string_to_uuid(value);
+            return true;
+        }
+    }
+
     std::vector<uint8_t> entity_property::binary_value() const
     {
         if (m_property_type != edm_type::binary)
@@ -29,7 +115,12 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_binary);
         }
 
-        return std::vector<uint8_t>(utility::conversions::from_base64(m_value));
+        return core::from_base64(m_value);
+    }
+
+    void entity_property::set_value_impl(const std::vector<uint8_t>& value)
+    {
+        set_text(core::to_base64(value));
     }
 
     bool entity_property::boolean_value() const
@@ -39,18 +130,18 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_boolean);
         }
 
-        if (m_value.compare(_XPLATSTR("false")) == 0)
+        if (m_has_native)
         {
-            return false;
-        }
-        else if (m_value.compare(_XPLATSTR("true")) == 0)
-        {
-            return true;
+            return m_native.boolean;
         }
-        else
+
+        bool result;
+        if (!try_parse_boolean(m_value, result))
         {
             throw std::runtime_error(protocol::error_parse_boolean);
         }
+
+        return result;
     }
 
     utility::datetime entity_property::datetime_value() const
@@ -60,8 +151,13 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_datetime);
         }
 
-        utility::datetime result = utility::datetime::from_string(m_value, utility::datetime::ISO_8601);
-        if (!result.is_initialized())
+        if (m_has_native)
+        {
+            return utility::datetime() + m_native.datetime_interval;
+        }
+
+        utility::datetime result;
+        if (!try_parse_datetime(m_value, result))
         {
             throw std::runtime_error(protocol::error_parse_datetime);
         }
@@ -76,24 +172,13 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_double);
         }
 
-        if (m_value.compare(protocol::double_not_a_number) == 0)
-        {
-            return std::numeric_limits<double>::quiet_NaN();
-        }
-        else if (m_value.compare(protocol::double_infinity) == 0)
+        if (m_has_native)
         {
-            return std::numeric_limits<double>::infinity();
-        }
-        else if (m_value.compare(protocol::double_negative_infinity) == 0)
-        {
-            return -std::numeric_limits<double>::infinity();
+            return m_native.double_floating_point;
         }
 
         double result;
-        utility::istringstream_t buffer(m_value);
-        buffer >> result;
-
-        if (buffer.fail() || !buffer.eof())
+        if (!try_parse_double(m_value, result))
         {
             throw std::runtime_error(protocol::error_parse_double);
         }
@@ -108,6 +193,11 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_guid);
         }
 
+        if (m_has_native)
+        {
+            return m_native.guid;
+        }
+
         utility::uuid result = utility::string_to_uuid(m_value);
         return result;
     }
@@ -119,11 +209,13 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_int32);
         }
 
-        int32_t result;
-        utility::istringstream_t buffer(m_value);
-        buffer >> result;
+        if (m_has_native)
+        {
+            return m_native.int32;
+        }
 
-        if (buffer.fail() || !buffer.eof())
+        int32_t result;
+        if (!try_parse_integer(m_value, result))
         {
             throw std::runtime_error(protocol::error_parse_int32);
         }
@@ -138,6 +230,11 @@ namespace azure { namespace storage {
             throw std::runtime_error(protocol::error_entity_property_not_int64);
         }
 
+        if (m_has_native)
+        {
+            return m_native.int64;
+        }
+
         int64_t result;
         utility::istringstream_t buffer(m_value);
         buffer >> result;
@@ -154,34 +251,203 @@ namespace azure { namespace storage {
         return m_value;
     }
 
+    void entity_property::set_property_type(azure::storage::edm_type property_type)
+    {
+        if (property_type == m_property_type)
+        {
+            return;
+        }
+
+        // The native value is only meaningful for the type it was set as, so the new type starts from the text form
+        str();
+        m_has_native = false;
+        m_property_type = property_type;
+        parse_native_value();
+    }
+
     void entity_property::set_value_impl(double value)
     {
-        if (core::is_nan(value))
+        m_native.double_floating_point = value;
+        set_native();
+    }
+
+    void entity_property::set_value_impl(int32_t value)
+    {
+        m_native.int32 = value;
+        set_native();
+    }
+
+    void entity_property::set_value_impl(int64_t value)
+    {
+        m_native.int64 = value;
+        set_native();
+    }
+
+    void entity_property::format_native_value() const
+    {
+        // The first caller formats the text; any other caller waits for it, which only happens while a shared object is read concurrently.
+        int state = text_missing;
+        if (!m_text_state.compare_exchange_strong(state, text_formatting, std::memory_order_acquire))
         {
-            m_value = protocol::double_not_a_number;
+            while (m_text_state.load(std::memory_order_acquire) != text_ready)
+            {
+                std::this_thread::yield();
+            }
+
+            return;
+        }
+
+        switch (m_property_type)
+        {
+        case edm_type::boolean:
+            m_value = m_native.boolean ? _XPLATSTR("true") : _XPLATSTR("false");
+            break;
+
+        case edm_type::datetime:
+            m_value = (utility::datetime() + m_native.datetime_interval).to_string(utility::datetime::ISO_8601);
+            break;
+
+        case edm_type::double_floating_point:
+            if (core::is_nan(m_native.double_floating_point))
+            {
+                m_value = protocol::double_not_a_number;
+            }
+            else if (m_native.double_floating_point == std::numeric_limits<double>::infinity())
+            {
+                m_value = protocol::double_infinity;
+            }
+            else if (m_native.double_floating_point == -std::numeric_limits<double>::infinity())
+            {
+                m_value = protocol::double_negative_infinity;
+            }
+            else
+            {
+                m_value = core::convert_to_string(m_native.double_floating_point);
+            }
+            break;
+
+        case edm_type::guid:
+            m_value = utility::uuid_to_string(m_native.guid);
+            break;
+
+        case edm_type::int32:
+            m_value = core::convert_to_string(m_native.int32);
+            break;
+
+        case edm_type::int64:
+            m_value = core::convert_to_string(m_native.int64);
+            break;
+
+        default:
+            break;
         }
-        else if (value == std::numeric_limits<double>::infinity())
+
+        m_text_state.store(text_ready, std::memory_order_release);
+    }
+
+    void entity_property::parse_native_value()
+    {
+        // Values read from the service arrive as text with a separate type annotation, so they are parsed once here rather than on
+        // every access. Text that does not parse stays as it is and the accessor reports the error when it is called.
+        switch (m_property_type)
+        {
+        case edm_type::boolean:
+            m_has_native = try_parse_boolean(m_value, m_native.boolean);
+            break;
+
+        case edm_type::datetime:
         {
-            m_value = protocol::double_infinity;
+            utility::datetime value;
+            m_has_native = try_parse_datetime(m_value, value);
+            m_native.datetime_interval = value.to_interval();
+            break;
         }
-        else if (value == -std::numeric_limits<double>::infinity())
+
+        case edm_type::double_floating_point:
+            m_has_native = try_parse_double(m_value, m_native.double_floating_point);
+            break;
+
+        case edm_type::guid:
+            m_has_native = try_parse_uuid(m_value, m_native.guid);
+            break;
+
+        case edm_type::int32:
+            m_has_native = try_parse_integer(m_value, m_native.int32);
+            break;
+
+        case edm_type::int64:
+            m_has_native = try_parse_integer(m_value, m_native.int64);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    entity_property table_entity_record::property_value(size_t index) const
+    {
+        const property_data& property = m_arena->properties[m_first_property + index];
+        if (property.is_null)
         {
-            m_value = protocol::double_negative_infinity;
+            return entity_property();
         }
-        else
+
+        if (property.has_native)
         {
-            m_value = core::convert_to_string(value);
+            switch (property.type)
+            {
+            case edm_type::boolean:
+                return entity_property(property.native.boolean);
+
+            case edm_type::datetime:
+                return entity_property(utility::datetime() + property.native.datetime_interval);
+
+            case edm_type::double_floating_point:
+                return entity_property(property.native.double_floating_point);
+
+            case edm_type::int32:
+                return entity_property(property.native.int32);
+
+            case edm_type::int64:
+                return entity_property(property.native.int64);
+
+            default:
+                break;
+            }
         }
+
+        entity_property value(text(property.value).str());
+        value.set_property_type(property.type);
+        return value;
     }
 
-    void entity_property::set_value_impl(int32_t value)
+    size_t table_entity_record::find_property(const utility::string_t& name) const
     {
-        m_value = core::convert_to_string(value);
+        for (size_t i = 0; i < m_property_count; ++i)
+        {
+            if (property_name(i) == name)
+            {
+                return i;
+            }
+        }
+
+        return m_property_count;
     }
 
-    void entity_property::set_value_impl(int64_t value)
+    table_entity table_entity_record::to_entity() const
     {
-        m_value = core::convert_to_string(value);
+        table_entity entity(partition_key().str(), row_key().str());
+        entity.set_etag(etag().str());
+        entity.set_timestamp(m_timestamp);
+
+        table_entity::properties_type& properties = entity.properties();
+        properties.reserve(m_property_count);
+        for (size_t i = 0; i < m_property_count; ++i)
+        {
+            properties.insert(table_entity::property_type(property_name(i).str(), property_value(i)));
+        }
+
+        return entity;
     }
 
 }} // namespace azure::storage
@@ -503,7 +503,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request put_file_range(file_range range, file_range_write write, utility::string_t content_md5, const file_access_condition& condition, web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    web::http::http_request put_file_range(file_range range, file_range_write write, const checksum& content_checksum, const file_access_condition& condition, web::http::uri_builder uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         uri_builder.append_query(core::make_query_parameter(uri_query_component, component_range, /* do_encoding */ false));
         web::http::http_request request(base_request(web::http::methods::PUT, uri_builder, timeout, context));
@@ -515,7 +515,14 @@ namespace azure { namespace storage { namespace protocol {
         {
         case file_range_write::update:
             headers.add(_XPLATSTR("x-ms-write"), _XPLATSTR("update"));
-            add_optional_header(headers, web::http::header_names::content_md5, content_md5);
+            if (content_checksum.is_md5())
+            {
+                add_optional_header(headers, web::http::header_names::content_md5, content_checksum.md5());
+            }
+            else if (content_checksum.is_crc64())
+            {
+                add_optional_header(headers, ms_header_content_crc64, content_checksum.crc64());
+            }
             break;
 
         case file_range_write::clear:
@@ -19,6 +19,8 @@
 #include "wascore/util.h"
 #include "was/table.h"
 
+#include <cctype>
+
 namespace azure { namespace storage {  namespace core {
 
     utility::string_t generate_boundary_name(const utility::string_t& prefix)
@@ -107,4 +109,267 @@ namespace azure { namespace storage {  namespace core {
         write_line_break(body_text);
     }
 
+    // The overloads below write the same framing as UTF-8, so that a request body can be assembled in a single byte buffer
+
+    void write_line_break(std::string& body)
+    {
+        body.append("\r\n");
+    }
+
+    void write_boundary(std::string& body, const utility::string_t& boundary_name, bool is_closure)
+    {
+        body.append("--");
+        append_utf8(body, boundary_name);
+        if (is_closure)
+        {
+            body.append("--");
+        }
+
+        write_line_break(body);
+    }
+
+    void write_mime_changeset_headers(std::string& body)
+    {
+        write_mime_changeset_headers(body, utility::string_t());
+    }
+
+    void write_mime_changeset_headers(std::string& body, const utility::string_t& content_id)
+    {
+        append_utf8(body, web::http::header_names::content_type);
+        body.append(": ");
+        append_utf8(body, protocol::header_value_content_type_http);
+        write_line_break(body);
+
+        append_utf8(body, protocol::header_content_transfer_encoding);
+        body.append(": ");
+        append_utf8(body, protocol::header_value_content_transfer_encoding_binary);
+        write_line_break(body);
+
+        // A Content-ID identifies the part, so that the part of the response answering it can be matched to it
+        if (!content_id.empty())
+        {
+            append_utf8(body, protocol::header_content_id);
+            body.append(": ");
+            append_utf8(body, content_id);
+            write_line_break(body);
+        }
+
+        write_line_break(body);
+    }
+
+    void write_request_line(std::string& body, const web::http::method& method, const web::http::uri& uri)
+    {
+        append_utf8(body, method);
+        body.push_back(' ');
+        append_utf8(body, uri.to_string());
+        body.push_back(' ');
+        append_utf8(body, protocol::http_version);
+        write_line_break(body);
+    }
+
+    void write_request_headers(std::string& body, const web::http::http_headers& headers)
+    {
+        for (web::http::http_headers::const_iterator it = headers.begin(); it != headers.end(); ++it)
+        {
+            append_utf8(body, it->first);
+            body.append(": ");
+            append_utf8(body, it->second);
+            write_line_break(body);
+        }
+
+        write_line_break(body);
+    }
+
+    namespace
+    {
+        const char line_break[] = "\r\n";
+    }
+
+    mime_byte_range mime_multipart_reader::read_opening_delimiter()
+    {
+        mime_byte_range line = read_line();
+        if (!line.starts_with("--", 2))
+        {
+            throw storage_exception(protocol::error_batch_response_not_valid, false);
+        }
+
+        return trim(line);
+    }
+
+    mime_byte_range mime_multipart_reader::read_part_headers(mime_headers* headers)
+    {
+        static const char boundary_parameter[] = "boundary=";
+        const size_t boundary_parameter_size = sizeof(boundary_parameter) - 1;
+
+        mime_byte_range boundary;
+        for (mime_byte_range line = read_line(); !line.empty(); line = read_line())
+        {
+            mime_byte_range name;
+            mime_byte_range value;
+            if (!split_header(line, name, value))
+            {
+                continue;
+            }
+
+            if (headers != nullptr)
+            {
+                headers->push_back(std::make_pair(name, value));
+            }
+
+            if (equals_ignore_case(name, "Content-Type"))
+            {
+                const uint8_t* parameter = std::search(value.begin, value.end, boundary_parameter, boundary_parameter + boundary_parameter_size);
+                if (parameter != value.end)
+                {
+                    boundary.begin = parameter + boundary_parameter_size;
+                    boundary.end = std::find(boundary.begin, value.end, ';');
+                    boundary = trim(boundary);
+                }
+            }
+        }
+
+        return boundary;
+    }
+
+    void mime_multipart_reader::read_http_response(const std::string& delimiter, int& status_code, mime_byte_range& status_message, mime_headers& headers, mime_byte_range& body)
+    {
+        // The status line has the form "HTTP/1.1 201 Created"
+        mime_byte_range status_line = read_line();
+        if (!status_line.starts_with("HTTP/", 5))
+        {
+            throw storage_exception(protocol::error_batch_response_not_valid, false);
+        }
+
+        const uint8_t* it = std::find(status_line.begin, status_line.end, ' ');
+        if (it != status_line.end)
+        {
+            ++it;
+        }
+
+        status_code = 0;
+        const uint8_t* status_code_begin = it;
+        for (; it != status_line.end && *it >= '0' && *it <= '9'; ++it)
+        {
+            status_code = status_code * 10 + (*it - '0');
+        }
+
+        if (it == status_code_begin)
+        {
+            throw storage_exception(protocol::error_batch_response_not_valid, false);
+        }
+
+        status_message = trim(mime_byte_range(it, status_line.end));
+
+        headers.clear();
+        for (mime_byte_range line = read_line(); !line.empty(); line = read_line())
+        {
+            mime_byte_range name;
+            mime_byte_range value;
+            if (split_header(line, name, value))
+            {
+                headers.push_back(std::make_pair(name, value));
+            }
+        }
+
+        // The line break ending the blank line is searched too, because an empty body is followed straight by the delimiter
+        const uint8_t* search_begin = m_current - 2;
+        const uint8_t* body_end = m_end;
+        for (;;)
+        {
+            const uint8_t* found = std::search(search_begin, m_end, line_break, line_break + 2);
+            if (found == m_end)
+            {
+                break;
+            }
+
+            if (mime_byte_range(found + 2, m_end).starts_with(delimiter.data(), delimiter.size()))
+            {
+                body_end = found;
+                break;
+            }
+
+            search_begin = found + 2;
+        }
+
+        body = mime_byte_range(m_current, std::max(m_current, body_end));
+        m_current = body_end == m_end ? m_end : body_end + 2;
+    }
+
+    bool mime_multipart_reader::read_next_part(const std::string& delimiter)
+    {
+        while (m_current != m_end)
+        {
+            mime_byte_range line = read_line();
+            if (line.starts_with(delimiter.data(), delimiter.size()))
+            {
+                return !mime_byte_range(line.begin + delimiter.size(), line.end).starts_with("--", 2);
+            }
+        }
+
+        return false;
+    }
+
+    mime_byte_range mime_multipart_reader::find_header(const mime_headers& headers, const char* name)
+    {
+        for (auto it = headers.cbegin(); it != headers.cend(); ++it)
+        {
+            if (equals_ignore_case(it->first, name))
+            {
+                return it->second;
+            }
+        }
+
+        return mime_byte_range();
+    }
+
+    bool mime_multipart_reader::equals_ignore_case(mime_byte_range range, const char* value)
+    {
+        const uint8_t* it = range.begin;
+        for (; it != range.end && *value != '\0'; ++it, ++value)
+        {
+            if (std::tolower(*it) != std::tolower(static_cast<unsigned char>(*value)))
+            {
+                return false;
+            }
+        }
+
+        return it == range.end && *value == '\0';
+    }
+
+    mime_byte_range mime_multipart_reader::trim(mime_byte_range range)
+    {
+        while (range.begin != range.end && (*range.begin == ' ' || *range.begin == '\t'))
+        {
+            ++range.begin;
+        }
+
+        while (range.begin != range.end && (*(range.end - 1) == ' ' || *(range.end - 1) == '\t'))
+        {
+            --range.end;
+        }
+
+        return range;
+    }
+
+    mime_byte_range mime_multipart_reader::read_line()
+    {
+        const uint8_t* line_end = std::search(m_current, m_end, line_break, line_break + 2);
+        mime_byte_range line(m_current, line_end);
+        m_current = line_end == m_end ? m_end : line_end + 2;
+        return line;
+    }
+
+    bool mime_multipart_reader::split_header(mime_byte_range line, mime_byte_range& name, mime_byte_range& value)
+    {
+        const uint8_t* colon = std::find(line.begin, line.end, ':');
+        if (colon == line.end)
+        {
+            return false;
+        }
+
+        name = trim(mime_byte_range(line.begin, colon));
+        value = trim(mime_byte_range(colon + 1, line.end));
+        return true;
+    }
+
 }}} // namespace azure::storage::core
@@ -16,8 +16,21 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include <clocale>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+#include "wascore/base64.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_json.h"
+#include "wascore/resources.h"
+#include "wascore/util.h"
 
 namespace azure { namespace storage { namespace protocol {
 
@@ -190,6 +203,1525 @@ namespace azure { namespace storage { namespace protocol {
         return entity;
     }
 
+    namespace
+    {
+        enum class integer_parse_result
+        {
+            valid,
+            overflow,
+            not_valid
+        };
+
+        // Parses an optionally negative run of decimal digits into a 64-bit integer.
+        integer_parse_result parse_integer(const std::string& text, int64_t& result)
+        {
+            bool negative = !text.empty() && text[0] == '-';
+            size_t i = negative ? 1 : 0;
+            if (i == text.size())
+            {
+                return integer_parse_result::not_valid;
+            }
+
+            const uint64_t limit = negative ? static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1 : static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+            uint64_t magnitude = 0;
+            bool overflow = false;
+            for (; i < text.size(); ++i)
+            {
+                if (text[i] < '0' || text[i] > '9')
+                {
+                    return integer_parse_result::not_valid;
+                }
+
+                unsigned int digit = text[i] - '0';
+                if (overflow || magnitude > (limit - digit) / 10)
+                {
+                    overflow = true;
+                    continue;
+                }
+
+                magnitude = magnitude * 10 + digit;
+            }
+
+            if (overflow)
+            {
+                return integer_parse_result::overflow;
+            }
+
+            result = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+            return integer_parse_result::valid;
+        }
+
+        bool parse_double(const std::string& text, double& result)
+        {
+            // The C locale is used so that the decimal point does not depend on the application's global locale
+            std::istringstream buffer(text);
+            buffer.imbue(std::locale::classic());
+            buffer >> result;
+            return !buffer.fail() && buffer.eof();
+        }
+
+        const char* get_type_mismatch_error(edm_type type)
+        {
+            switch (type)
+            {
+            case edm_type::binary:
+                return protocol::error_entity_property_not_binary;
+
+            case edm_type::boolean:
+                return protocol::error_entity_property_not_boolean;
+
+            case edm_type::datetime:
+                return protocol::error_entity_property_not_datetime;
+
+            case edm_type::double_floating_point:
+                return protocol::error_entity_property_not_double;
+
+            case edm_type::guid:
+                return protocol::error_entity_property_not_guid;
+
+            case edm_type::int32:
+                return protocol::error_entity_property_not_int32;
+
+            case edm_type::int64:
+                return protocol::error_entity_property_not_int64;
+
+            default:
+                return protocol::error_entity_property_not_string;
+            }
+        }
+
+        // Stores a value that arrived as a JSON string into a mapped member, parsing it as the type of the member.
+        void read_mapped_text(edm_type type, const std::string& text, void* member)
+        {
+            switch (type)
+            {
+            case edm_type::binary:
+                *static_cast<std::vector<uint8_t>*>(member) = core::from_base64(utility::conversions::to_string_t(text));
+                break;
+
+            case edm_type::boolean:
+                if (text == "true" || text == "false")
+                {
+                    *static_cast<bool*>(member) = text == "true";
+                    break;
+                }
+
+                throw std::runtime_error(protocol::error_parse_boolean);
+
+            case edm_type::datetime:
+            {
+                utility::datetime value = utility::datetime::from_string(utility::conversions::to_string_t(text), utility::datetime::ISO_8601);
+                if (!value.is_initialized())
+                {
+                    throw std::runtime_error(protocol::error_parse_datetime);
+                }
+
+                *static_cast<utility::datetime*>(member) = value;
+                break;
+            }
+
+            case edm_type::double_floating_point:
+            {
+                // Whole numbers may be written as strings, and special values always are
+                double& value = *static_cast<double*>(member);
+                if (parse_double(text, value))
+                {
+                    break;
+                }
+
+                utility::string_t value_text = utility::conversions::to_string_t(text);
+                if (value_text == protocol::double_not_a_number)
+                {
+                    value = std::numeric_limits<double>::quiet_NaN();
+                }
+                else if (value_text == protocol::double_infinity)
+                {
+                    value = std::numeric_limits<double>::infinity();
+                }
+                else if (value_text == protocol::double_negative_infinity)
+                {
+                    value = -std::numeric_limits<double>::infinity();
+                }
+                else
+                {
+                    throw std::runtime_error(protocol::error_parse_double);
+                }
+                break;
+            }
+
+            case edm_type::guid:
+                *static_cast<utility::uuid*>(member) = utility::string_to_uuid(utility::conversions::to_string_t(text));
+                break;
+
+            case edm_type::int32:
+            {
+                int64_t value;
+                if (parse_integer(text, value) != integer_parse_result::valid || value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max())
+                {
+                    throw std::runtime_error(protocol::error_parse_int32);
+                }
+
+                *static_cast<int32_t*>(member) = static_cast<int32_t>(value);
+                break;
+            }
+
+            case edm_type::int64:
+                if (parse_integer(text, *static_cast<int64_t*>(member)) != integer_parse_result::valid)
+                {
+                    throw std::runtime_error(protocol::error_parse_int64);
+                }
+                break;
+
+            default:
+                *static_cast<utility::string_t*>(member) = utility::conversions::to_string_t(text);
+                break;
+            }
+        }
+    }
+
+    std::vector<table_entity> table_entity_json_reader::read_query_results()
+    {
+        std::vector<table_entity> result;
+        read_query_envelope([this, &result] ()
+        {
+            table_entity entity;
+            if (read_entity_object(entity))
+            {
+                result.push_back(std::move(entity));
+            }
+        });
+
+        return result;
+    }
+
+    std::vector<table_entity_record> table_entity_json_reader::read_query_records()
+    {
+        typedef table_entity_record::property_data property_data;
+        typedef table_entity_record::text_range text_range;
+
+        std::shared_ptr<table_entity_record::arena> arena = std::make_shared<table_entity_record::arena>();
+        std::unordered_map<std::string, size_t> name_indexes;
+        std::vector<table_entity_record> records;
+        std::vector<std::pair<size_t, edm_type>> pending_types;
+        std::string name;
+        std::string value;
+        utility::string_t timestamp_str;
+        entity_property scalar;
+
+        // Every string of the segment is appended to the one buffer of the arena, so the cost of a segment scales with its bytes
+        // rather than with the number of fields in it.
+        auto append_text = [&arena] (const std::string& value) -> text_range
+        {
+            text_range range;
+            range.offset = arena->text.size();
+            core::append_from_utf8(arena->text, value);
+            range.length = arena->text.size() - range.offset;
+            return range;
+        };
+
+        auto intern_name = [&arena, &name_indexes, &append_text] (const std::string& name) -> size_t
+        {
+            std::unordered_map<std::string, size_t>::const_iterator it = name_indexes.find(name);
+            if (it != name_indexes.cend())
+            {
+                return it->second;
+            }
+
+            size_t index = arena->names.size();
+            arena->names.push_back(append_text(name));
+            name_indexes.insert(std::make_pair(name, index));
+            return index;
+        };
+
+        auto find_property = [&arena] (size_t first_property, size_t name_index) -> property_data*
+        {
+            for (size_t i = first_property; i < arena->properties.size(); ++i)
+            {
+                if (arena->properties[i].name == name_index)
+                {
+                    return &arena->properties[i];
+                }
+            }
+
+            return nullptr;
+        };
+
+        // A typed value arrives as text and is converted to its native form once, here. Text that does not parse is kept, and copying
+        // the value out of the record reports the error when the accessor is called, as it does for a table_entity.
+        auto apply_type = [&arena] (property_data& property, edm_type type, const std::string& text)
+        {
+            property.type = type;
+            switch (type)
+            {
+            case edm_type::boolean:
+                property.has_native = text == "true" || text == "false";
+                property.native.boolean = text == "true";
+                break;
+
+            case edm_type::datetime:
+            {
+                utility::datetime value = utility::datetime::from_string(utility::conversions::to_string_t(text), utility::datetime::ISO_8601);
+                property.has_native = value.is_initialized();
+                property.native.datetime_interval = value.to_interval();
+                break;
+            }
+
+            case edm_type::double_floating_point:
+                property.has_native = parse_double(text, property.native.double_floating_point);
+                break;
+
+            case edm_type::int32:
+            {
+                int64_t value = 0;
+                property.has_native = parse_integer(text, value) == integer_parse_result::valid && value >= std::numeric_limits<int32_t>::min() && value <= std::numeric_limits<int32_t>::max();
+                property.native.int32 = static_cast<int32_t>(value);
+                break;
+            }
+
+            case edm_type::int64:
+                property.has_native = parse_integer(text, property.native.int64) == integer_parse_result::valid;
+                break;
+
+            default:
+                break;
+            }
+
+            // The text is no longer needed, and can be given back when nothing has been appended after it
+            if (property.has_native)
+            {
+                if (property.value.offset + property.value.length == arena->text.size())
+                {
+                    arena->text.resize(property.value.offset);
+                }
+
+                property.value = text_range();
+            }
+        };
+
+        read_query_envelope([&] ()
+        {
+            expect('{');
+            if (try_consume('}'))
+            {
+                // Empty objects are not entities
+                return;
+            }
+
+            table_entity_record record;
+            record.m_first_property = arena->properties.size();
+            pending_types.clear();
+            timestamp_str.clear();
+
+            // An empty key is still a key, so presence is tracked apart from the text
+            bool has_partition_key = false;
+            bool has_row_key = false;
+            bool has_etag = false;
+
+            do
+            {
+                read_string(name);
+                expect(':');
+
+                member_kind kind = classify_member(name);
+                if (kind != member_kind::property && kind != member_kind::ignored && peek() != '"')
+                {
+                    skip_value();
+                    continue;
+                }
+
+                switch (kind)
+                {
+                case member_kind::etag:
+                    read_string(value);
+                    if (!has_etag)
+                    {
+                        record.m_etag = append_text(value);
+                        has_etag = true;
+                    }
+                    break;
+
+                case member_kind::type_annotation:
+                {
+                    read_string(value);
+                    edm_type property_type = get_property_type(utility::conversions::to_string_t(value));
+                    size_t name_index = intern_name(name);
+
+                    property_data* property = find_property(record.m_first_property, name_index);
+                    if (property == nullptr)
+                    {
+                        pending_types.push_back(std::make_pair(name_index, property_type));
+                    }
+                    else if (property->type == edm_type::string && !property->is_null)
+                    {
+                        std::string text = utility::conversions::to_utf8string(arena->text.substr(property->value.offset, property->value.length));
+                        apply_type(*property, property_type, text);
+                    }
+                    break;
+                }
+
+                case member_kind::partition_key:
+                case member_kind::row_key:
+                {
+                    // Only the first occurrence of each key is kept
+                    read_string(value);
+                    bool& has_key = kind == member_kind::partition_key ? has_partition_key : has_row_key;
+                    if (!has_key)
+                    {
+                        (kind == member_kind::partition_key ? record.m_partition_key : record.m_row_key) = append_text(value);
+                        has_key = true;
+                    }
+                    break;
+                }
+
+                case member_kind::timestamp:
+                    read_string(value);
+                    timestamp_str = utility::conversions::to_string_t(value);
+                    record.m_timestamp = utility::datetime::from_string(timestamp_str, utility::datetime::ISO_8601);
+                    break;
+
+                case member_kind::property:
+                {
+                    // The object is a regular property, whose type is String unless a specific EDM type was specified
+                    property_data property;
+                    property.name = intern_name(name);
+                    property.type = edm_type::string;
+                    property.is_null = false;
+                    property.has_native = false;
+
+                    switch (read_value(value, scalar))
+                    {
+                    case value_kind::boolean:
+                        property.type = edm_type::boolean;
+                        property.native.boolean = scalar.boolean_value();
+                        property.has_native = true;
+                        break;
+
+                    case value_kind::string:
+                        property.value = append_text(value);
+                        break;
+
+                    case value_kind::number:
+                        property.type = scalar.property_type();
+                        if (property.type == edm_type::int32)
+                        {
+                            property.native.int32 = scalar.int32_value();
+                        }
+                        else if (property.type == edm_type::int64)
+                        {
+                            property.native.int64 = scalar.int64_value();
+                        }
+                        else
+                        {
+                            property.native.double_floating_point = scalar.double_value();
+                        }
+
+                        property.has_native = true;
+                        break;
+
+                    default:
+                        property.is_null = true;
+                        break;
+                    }
+
+                    if (property.type == edm_type::string && !property.is_null)
+                    {
+                        for (auto it = pending_types.begin(); it != pending_types.end(); ++it)
+                        {
+                            if (it->first == property.name)
+                            {
+                                apply_type(property, it->second, value);
+                                pending_types.erase(it);
+                                break;
+                            }
+                        }
+                    }
+
+                    arena->properties.push_back(property);
+                    break;
+                }
+
+                default:
+                    skip_value();
+                    break;
+                }
+            } while (try_consume(','));
+
+            expect('}');
+            record.m_property_count = arena->properties.size() - record.m_first_property;
+
+            // Generate the ETag from the Timestamp if it was not in the response body
+            if (!has_etag && !timestamp_str.empty())
+            {
+                record.m_etag.offset = arena->text.size();
+                arena->text.append(get_etag_from_timestamp(timestamp_str));
+                record.m_etag.length = arena->text.size() - record.m_etag.offset;
+            }
+
+            records.push_back(record);
+        });
+
+        // The arena is shared with the records once nothing more is appended to it
+        for (auto it = records.begin(); it != records.end(); ++it)
+        {
+            it->m_arena = arena;
+        }
+
+        return records;
+    }
+
+    void table_entity_json_reader::read_query_results(const table_entity_schema& schema, const std::function<void*()>& add_entity)
+    {
+        read_query_envelope([this, &schema, &add_entity] ()
+        {
+            read_mapped_entity_object(schema, add_entity);
+        });
+    }
+
+    void table_entity_json_reader::read_query_envelope(const std::function<void()>& read_element)
+    {
+        if (peek() != '{')
+        {
+            // Anything other than an object, including an empty body, holds no entities
+            if (m_current != m_end)
+            {
+                skip_value();
+            }
+
+            return;
+        }
+
+        expect('{');
+        if (try_consume('}'))
+        {
+            return;
+        }
+
+        std::string name;
+        do
+        {
+            read_string(name);
+            expect(':');
+
+            if (name == "value" && peek() == '[')
+            {
+                expect('[');
+                if (!try_consume(']'))
+                {
+                    do
+                    {
+                        if (peek() == '{')
+                        {
+                            read_element();
+                        }
+                        else
+                        {
+                            skip_value();
+                        }
+                    } while (try_consume(','));
+
+                    expect(']');
+                }
+            }
+            else
+            {
+                skip_value();
+            }
+        } while (try_consume(','));
+
+        expect('}');
+    }
+
+    table_entity table_entity_json_reader::read_entity()
+    {
+        table_entity entity;
+
+        if (peek() == '{')
+        {
+            read_entity_object(entity);
+        }
+        else if (m_current != m_end)
+        {
+            skip_value();
+        }
+
+        return entity;
+    }
+
+    bool table_entity_json_reader::read_entity_object(table_entity& entity)
+    {
+        expect('{');
+        if (try_consume('}'))
+        {
+            return false;
+        }
+
+        // Type annotations normally precede their values, but either order is accepted
+        std::vector<std::pair<utility::string_t, edm_type>> pending_types;
+        utility::string_t timestamp_str;
+        std::string name;
+        do
+        {
+            read_string(name);
+            expect(':');
+            read_entity_member(entity, name, pending_types, timestamp_str);
+        } while (try_consume(','));
+
+        expect('}');
+
+        // Generate the ETag from the Timestamp if it was not in the response header or the response body
+        if (entity.etag().empty() && !timestamp_str.empty())
+        {
+            entity.set_etag(get_etag_from_timestamp(timestamp_str));
+        }
+
+        return true;
+    }
+
+    void table_entity_json_reader::read_entity_member(table_entity& entity, std::string& name, std::vector<std::pair<utility::string_t, edm_type>>& pending_types, utility::string_t& timestamp_str)
+    {
+        member_kind kind = classify_member(name);
+        if (kind != member_kind::property && kind != member_kind::ignored && peek() != '"')
+        {
+            skip_value();
+            return;
+        }
+
+        switch (kind)
+        {
+        case member_kind::etag:
+        {
+            utility::string_t etag = read_string();
+            if (entity.etag().empty())
+            {
+                entity.set_etag(std::move(etag));
+            }
+            break;
+        }
+
+        case member_kind::type_annotation:
+        {
+            // The object is the type of a property, which only applies to values transmitted as strings
+            edm_type property_type = get_property_type(read_string());
+            utility::string_t property_name = utility::conversions::to_string_t(name);
+
+            table_entity::properties_type::iterator property_it = entity.properties().find(property_name);
+            if (property_it == entity.properties().end())
+            {
+                pending_types.push_back(std::make_pair(std::move(property_name), property_type));
+            }
+            else if (property_it->second.property_type() == edm_type::string && !property_it->second.is_null())
+            {
+                property_it->second.set_property_type(property_type);
+            }
+            break;
+        }
+
+        case member_kind::partition_key:
+        {
+            utility::string_t value = read_string();
+            if (entity.partition_key().empty())
+            {
+                entity.set_partition_key(std::move(value));
+            }
+            break;
+        }
+
+        case member_kind::row_key:
+        {
+            utility::string_t value = read_string();
+            if (entity.row_key().empty())
+            {
+                entity.set_row_key(std::move(value));
+            }
+            break;
+        }
+
+        case member_kind::timestamp:
+            timestamp_str = read_string();
+            if (!entity.timestamp().is_initialized())
+            {
+                entity.set_timestamp(utility::datetime::from_string(timestamp_str, utility::datetime::ISO_8601));
+            }
+            break;
+
+        case member_kind::property:
+        {
+            // The object is a regular property, whose type is set to String for consistency unless a specific EDM type was specified
+            utility::string_t property_name = utility::conversions::to_string_t(name);
+            entity_property property;
+            read_property_value(property);
+
+            if (property.property_type() == edm_type::string && !property.is_null())
+            {
+                for (auto it = pending_types.begin(); it != pending_types.end(); ++it)
+                {
+                    if (it->first == property_name)
+                    {
+                        property.set_property_type(it->second);
+                        pending_types.erase(it);
+                        break;
+                    }
+                }
+            }
+
+            entity.properties().insert(table_entity::property_type(std::move(property_name), std::move(property)));
+            break;
+        }
+
+        default:
+            skip_value();
+            break;
+        }
+    }
+
+    void table_entity_json_reader::read_entity(const table_entity_schema& schema, void* entity)
+    {
+        if (peek() == '{')
+        {
+            read_mapped_entity_object(schema, [entity] () { return entity; });
+        }
+        else if (m_current != m_end)
+        {
+            skip_value();
+        }
+    }
+
+    void table_entity_json_reader::read_mapped_entity_object(const table_entity_schema& schema, const std::function<void*()>& add_entity)
+    {
+        expect('{');
+        if (try_consume('}'))
+        {
+            // Empty objects are not entities
+            return;
+        }
+
+        void* entity = add_entity();
+        std::string name;
+        size_t position = 0;
+        do
+        {
+            read_string(name);
+            expect(':');
+            read_mapped_entity_member(schema, entity, name, position);
+        } while (try_consume(','));
+
+        expect('}');
+    }
+
+    void table_entity_json_reader::read_mapped_entity_member(const table_entity_schema& schema, void* entity, std::string& name, size_t& position)
+    {
+        member_kind kind = classify_member(name);
+        if (kind != member_kind::property && kind != member_kind::ignored && peek() != '"')
+        {
+            skip_value();
+            return;
+        }
+
+        switch (kind)
+        {
+        case member_kind::etag:
+        {
+            utility::string_t* etag = schema.etag(entity);
+            if (etag != nullptr)
+            {
+                *etag = read_string();
+            }
+            else
+            {
+                skip_value();
+            }
+            break;
+        }
+
+        case member_kind::partition_key:
+            *schema.partition_key(entity) = read_string();
+            break;
+
+        case member_kind::row_key:
+            *schema.row_key(entity) = read_string();
+            break;
+
+        case member_kind::timestamp:
+        {
+            utility::datetime* timestamp = schema.timestamp(entity);
+            if (timestamp != nullptr)
+            {
+                *timestamp = utility::datetime::from_string(read_string(), utility::datetime::ISO_8601);
+            }
+            else
+            {
+                skip_value();
+            }
+            break;
+        }
+
+        case member_kind::property:
+        {
+            const table_entity_schema::property_field* field = schema.find_property(name, position);
+            if (field == nullptr)
+            {
+                skip_value();
+                break;
+            }
+
+            read_mapped_property(field->type, field->member(entity));
+            break;
+        }
+
+        default:
+            // Type annotations and other OData values are not needed, because the mapping determines the type of every property
+            skip_value();
+            break;
+        }
+    }
+
+    void table_entity_json_reader::read_mapped_property(edm_type type, void* member)
+    {
+        switch (peek())
+        {
+        case 't':
+        case 'f':
+        {
+            bool value = peek() == 't';
+            read_literal(value ? "true" : "false");
+            if (type != edm_type::boolean)
+            {
+                throw std::runtime_error(get_type_mismatch_error(type));
+            }
+
+            *static_cast<bool*>(member) = value;
+            break;
+        }
+
+        case '"':
+        {
+            // Values of types that JSON cannot represent arrive as strings
+            std::string text;
+            read_string(text);
+            read_mapped_text(type, text, member);
+            break;
+        }
+
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        {
+            int64_t integer;
+            double floating;
+            bool is_integer = read_number(integer, floating);
+            if (type == edm_type::int32 && is_integer && integer >= std::numeric_limits<int32_t>::min() && integer <= std::numeric_limits<int32_t>::max())
+            {
+                *static_cast<int32_t*>(member) = static_cast<int32_t>(integer);
+            }
+            else if (type == edm_type::int64 && is_integer)
+            {
+                *static_cast<int64_t*>(member) = integer;
+            }
+            else if (type == edm_type::double_floating_point)
+            {
+                // Whole numbers are written without a decimal point
+                *static_cast<double*>(member) = is_integer ? static_cast<double>(integer) : floating;
+            }
+            else
+            {
+                throw std::runtime_error(get_type_mismatch_error(type));
+            }
+            break;
+        }
+
+        default:
+            skip_value();
+            break;
+        }
+    }
+
+    table_entity_json_reader::member_kind table_entity_json_reader::classify_member(std::string& name)
+    {
+        const char type_suffix[] = "@odata.type";
+        const size_t type_suffix_size = sizeof(type_suffix) - 1;
+
+        if (name.size() >= 6 && name.compare(0, 6, "odata.") == 0)
+        {
+            // The object is a special OData value, of which only the ETag is used
+            return name.compare(6, name.size() - 6, "etag") == 0 ? member_kind::etag : member_kind::ignored;
+        }
+
+        if (name.size() >= type_suffix_size && name.compare(name.size() - type_suffix_size, type_suffix_size, type_suffix) == 0)
+        {
+            name.resize(name.size() - type_suffix_size);
+            return member_kind::type_annotation;
+        }
+
+        if (name == "PartitionKey")
+        {
+            return member_kind::partition_key;
+        }
+
+        if (name == "RowKey")
+        {
+            return member_kind::row_key;
+        }
+
+        if (name == "Timestamp")
+        {
+            return member_kind::timestamp;
+        }
+
+        return member_kind::property;
+    }
+
+    table_entity_json_reader::value_kind table_entity_json_reader::read_value(std::string& text, entity_property& scalar)
+    {
+        switch (peek())
+        {
+        case 't':
+            read_literal("true");
+            scalar.set_value(true);
+            return value_kind::boolean;
+
+        case 'f':
+            read_literal("false");
+            scalar.set_value(false);
+            return value_kind::boolean;
+
+        case '"':
+            read_string(text);
+            return value_kind::string;
+
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            read_number(scalar);
+            return value_kind::number;
+
+        default:
+            skip_value();
+            return value_kind::null_value;
+        }
+    }
+
+    void table_entity_json_reader::read_property_value(entity_property& property)
+    {
+        // Null, object and array values leave the property null
+        std::string text;
+        if (read_value(text, property) == value_kind::string)
+        {
+            property.set_value(utility::conversions::to_string_t(std::move(text)));
+        }
+    }
+
+    void table_entity_json_reader::read_string(std::string& value)
+    {
+        expect('"');
+        value.clear();
+
+        for (;;)
+        {
+            const unsigned char* run_start = m_current;
+            while (m_current != m_end && *m_current != '"' && *m_current != '\\')
+            {
+                ++m_current;
+            }
+
+            value.append(reinterpret_cast<const char*>(run_start), m_current - run_start);
+            if (m_current == m_end)
+            {
+                throw storage_exception(protocol::error_json_not_valid, false);
+            }
+
+            if (*m_current++ == '"')
+            {
+                return;
+            }
+
+            if (m_current == m_end)
+            {
+                throw storage_exception(protocol::error_json_not_valid, false);
+            }
+
+            unsigned char escaped = *m_current++;
+            switch (escaped)
+            {
+            case '"': value.push_back('"'); break;
+            case '\\': value.push_back('\\'); break;
+            case '/': value.push_back('/'); break;
+            case 'b': value.push_back('\b'); break;
+            case 'f': value.push_back('\f'); break;
+            case 'n': value.push_back('\n'); break;
+            case 'r': value.push_back('\r'); break;
+            case 't': value.push_back('\t'); break;
+            case 'u':
+            {
+                auto read_code_unit = [this] () -> uint32_t
+                {
+                    if (m_end - m_current < 4)
+                    {
+                        throw storage_exception(protocol::error_json_not_valid, false);
+                    }
+
+                    uint32_t code_unit = 0;
+                    for (int i = 0; i < 4; ++i)
+                    {
+                        unsigned char c = *m_current++;
+                        code_unit <<= 4;
+                        if (c >= '0' && c <= '9') code_unit |= c - '0';
+                        else if (c >= 'a' && c <= 'f') code_unit |= c - 'a' + 10;
+                        else if (c >= 'A' && c <= 'F') code_unit |= c - 'A' + 10;
+                        else throw storage_exception(protocol::error_json_not_valid, false);
+                    }
+
+                    return code_unit;
+                };
+
+                uint32_t code_point = read_code_unit();
+                if (code_point >= 0xD800 && code_point <= 0xDBFF && m_end - m_current >= 6 && m_current[0] == '\\' && m_current[1] == 'u')
+                {
+                    m_current += 2;
+                    uint32_t low_surrogate = read_code_unit();
+                    if (low_surrogate < 0xDC00 || low_surrogate > 0xDFFF)
+                    {
+                        throw storage_exception(protocol::error_json_not_valid, false);
+                    }
+
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                }
+
+                if (code_point < 0x80)
+                {
+                    value.push_back(static_cast<char>(code_point));
+                }
+                else if (code_point < 0x800)
+                {
+                    value.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                    value.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+                else if (code_point < 0x10000)
+                {
+                    value.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                    value.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    value.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+                else
+                {
+                    value.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                    value.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                    value.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    value.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+                break;
+            }
+
+            default:
+                throw storage_exception(protocol::error_json_not_valid, false);
+            }
+        }
+    }
+
+    utility::string_t table_entity_json_reader::read_string()
+    {
+        std::string value;
+        read_string(value);
+        return utility::conversions::to_string_t(std::move(value));
+    }
+
+    void table_entity_json_reader::read_number(entity_property& property)
+    {
+        int64_t integer;
+        double floating;
+        if (!read_number(integer, floating))
+        {
+            property.set_value(floating);
+        }
+        else if (integer >= std::numeric_limits<int32_t>::min() && integer <= std::numeric_limits<int32_t>::max())
+        {
+            // Whole numbers that fit are 32-bit integers, matching what the service sends for Edm.Int32 values. Larger whole numbers
+            // stay integers so that no precision is lost, and only those outside the 64-bit range fall back to a double.
+            property.set_value(static_cast<int32_t>(integer));
+        }
+        else
+        {
+            property.set_value(integer);
+        }
+    }
+
+    bool table_entity_json_reader::read_number(int64_t& integer, double& floating)
+    {
+        const unsigned char* start = m_current;
+        bool is_integral = true;
+        while (m_current != m_end)
+        {
+            unsigned char c = *m_current;
+            if (c == '.' || c == 'e' || c == 'E')
+            {
+                is_integral = false;
+            }
+            else if (!(c >= '0' && c <= '9') && c != '-' && c != '+')
+            {
+                break;
+            }
+
+            ++m_current;
+        }
+
+        if (m_current == start)
+        {
+            throw storage_exception(protocol::error_json_not_valid, false);
+        }
+
+        std::string text(reinterpret_cast<const char*>(start), m_current - start);
+        if (is_integral)
+        {
+            integer_parse_result result = parse_integer(text, integer);
+            if (result == integer_parse_result::not_valid)
+            {
+                throw storage_exception(protocol::error_json_not_valid, false);
+            }
+
+            if (result == integer_parse_result::valid)
+            {
+                return true;
+            }
+        }
+
+        if (!parse_double(text, floating))
+        {
+            throw storage_exception(protocol::error_json_not_valid, false);
+        }
+
+        return false;
+    }
+
+    void table_entity_json_reader::read_literal(const char* literal)
+    {
+        size_t size = std::strlen(literal);
+        if (static_cast<size_t>(m_end - m_current) < size || std::memcmp(m_current, literal, size) != 0)
+        {
+            throw storage_exception(protocol::error_json_not_valid, false);
+        }
+
+        m_current += size;
+    }
+
+    void table_entity_json_reader::skip_value()
+    {
+        std::string ignored;
+        switch (peek())
+        {
+        case '{':
+            expect('{');
+            if (!try_consume('}'))
+            {
+                do
+                {
+                    read_string(ignored);
+                    expect(':');
+                    skip_value();
+                } while (try_consume(','));
+
+                expect('}');
+            }
+            break;
+
+        case '[':
+            expect('[');
+            if (!try_consume(']'))
+            {
+                do
+                {
+                    skip_value();
+                } while (try_consume(','));
+
+                expect(']');
+            }
+            break;
+
+        case '"':
+            read_string(ignored);
+            break;
+
+        case 't':
+            read_literal("true");
+            break;
+
+        case 'f':
+            read_literal("false");
+            break;
+
+        case 'n':
+            read_literal("null");
+            break;
+
+        default:
+        {
+            entity_property ignored_number;
+            read_number(ignored_number);
+            break;
+        }
+        }
+    }
+
+    void table_entity_json_reader::skip_whitespace()
+    {
+        while (m_current != m_end && (*m_current == ' ' || *m_current == '\t' || *m_current == '\n' || *m_current == '\r'))
+        {
+            ++m_current;
+        }
+    }
+
+    bool table_entity_json_reader::try_consume(char c)
+    {
+        if (peek() == c)
+        {
+            ++m_current;
+            return true;
+        }
+
+        return false;
+    }
+
+    void table_entity_json_reader::expect(char c)
+    {
+        if (!try_consume(c))
+        {
+            throw storage_exception(protocol::error_json_not_valid, false);
+        }
+    }
+
+    char table_entity_json_reader::peek()
+    {
+        skip_whitespace();
+        return m_current == m_end ? '\0' : static_cast<char>(*m_current);
+    }
+
+    void table_entity_json_writer::write_entity(const table_entity& entity)
+    {
+        m_buffer.push_back('{');
+        m_first_member = true;
+
+        write_name(_XPLATSTR("PartitionKey"));
+        write_string(entity.partition_key());
+        write_name(_XPLATSTR("RowKey"));
+        write_string(entity.row_key());
+
+        const table_entity::properties_type& properties = entity.properties();
+        for (table_entity::properties_type::const_iterator it = properties.cbegin(); it != properties.cend(); ++it)
+        {
+            write_property(it->first, it->second);
+        }
+
+        m_buffer.push_back('}');
+    }
+
+    void table_entity_json_writer::write_entity(const table_entity_schema& schema, void* entity)
+    {
+        m_buffer.push_back('{');
+        m_first_member = true;
+
+        write_name(_XPLATSTR("PartitionKey"));
+        write_string(*schema.partition_key(entity));
+        write_name(_XPLATSTR("RowKey"));
+        write_string(*schema.row_key(entity));
+
+        const std::vector<table_entity_schema::property_field>& properties = schema.properties();
+        for (auto it = properties.cbegin(); it != properties.cend(); ++it)
+        {
+            write_mapped_property(*it, it->member(entity));
+        }
+
+        m_buffer.push_back('}');
+    }
+
+    size_t table_entity_json_writer::estimate_size(const table_entity& entity)
+    {
+        // The braces and the two key names, plus the worst case of every key character being escaped
+        size_t size = 32 + 6 * (entity.partition_key().size() + entity.row_key().size());
+
+        const table_entity::properties_type& properties = entity.properties();
+        for (table_entity::properties_type::const_iterator it = properties.cbegin(); it != properties.cend(); ++it)
+        {
+            // The quoted name and type annotation, plus room for any fixed-size value
+            size += 2 * it->first.size() + 64;
+
+            edm_type type = it->second.property_type();
+            if (type == edm_type::string || type == edm_type::binary)
+            {
+                size += it->second.str().size();
+            }
+        }
+
+        return size;
+    }
+
+    void table_entity_json_writer::write_property(const utility::string_t& name, const entity_property& property)
+    {
+        // Types that JSON cannot represent unambiguously are written with an @odata.type annotation ahead of the value
+        switch (property.property_type())
+        {
+        case edm_type::boolean:
+            write_boolean(name, property.boolean_value());
+            break;
+
+        case edm_type::int32:
+            write_int32(name, property.int32_value());
+            break;
+
+        case edm_type::double_floating_point:
+            write_double(name, property.double_value());
+            break;
+
+        case edm_type::int64:
+            write_int64(name, property.int64_value());
+            break;
+
+        case edm_type::string:
+            write_name(name);
+            write_string(property.str());
+            break;
+
+        default:
+            write_annotated_string(name, property.property_type(), property.str());
+            break;
+        }
+    }
+
+    void table_entity_json_writer::write_mapped_property(const table_entity_schema::property_field& field, void* member)
+    {
+        switch (field.type)
+        {
+        case edm_type::binary:
+            write_annotated_string(field.name, field.type, core::to_base64(*static_cast<const std::vector<uint8_t>*>(member)));
+            break;
+
+        case edm_type::boolean:
+            write_boolean(field.name, *static_cast<const bool*>(member));
+            break;
+
+        case edm_type::datetime:
+            write_annotated_string(field.name, field.type, static_cast<const utility::datetime*>(member)->to_string(utility::datetime::ISO_8601));
+            break;
+
+        case edm_type::double_floating_point:
+            write_double(field.name, *static_cast<const double*>(member));
+            break;
+
+        case edm_type::guid:
+            write_annotated_string(field.name, field.type, utility::uuid_to_string(*static_cast<const utility::uuid*>(member)));
+            break;
+
+        case edm_type::int32:
+            write_int32(field.name, *static_cast<const int32_t*>(member));
+            break;
+
+        case edm_type::int64:
+            write_int64(field.name, *static_cast<const int64_t*>(member));
+            break;
+
+        default:
+            write_name(field.name);
+            write_string(*static_cast<const utility::string_t*>(member));
+            break;
+        }
+    }
+
+    void table_entity_json_writer::write_boolean(const utility::string_t& name, bool value)
+    {
+        write_name(name);
+        m_buffer.append(value ? "true" : "false");
+    }
+
+    void table_entity_json_writer::write_int32(const utility::string_t& name, int32_t value)
+    {
+        char number[32];
+        write_name(name);
+        m_buffer.append(number, std::snprintf(number, sizeof(number), "%d", static_cast<int>(value)));
+    }
+
+    void table_entity_json_writer::write_int64(const utility::string_t& name, int64_t value)
+    {
+        char number[32];
+        write_type_annotation(name, edm_type::int64);
+        write_name(name);
+        m_buffer.push_back('"');
+        m_buffer.append(number, std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value)));
+        m_buffer.push_back('"');
+    }
+
+    void table_entity_json_writer::write_double(const utility::string_t& name, double value)
+    {
+        if (!core::is_finite(value))
+        {
+            // Serialize special double values as strings
+            write_annotated_string(name, edm_type::double_floating_point, core::is_nan(value) ? protocol::double_not_a_number : value > 0 ? protocol::double_infinity : protocol::double_negative_infinity);
+            return;
+        }
+
+        // 17 significant digits are enough to read back the same double
+        char number[64];
+        int length = std::snprintf(number, sizeof(number), "%.17g", value);
+
+        // snprintf follows the C locale of the application, so its decimal separator is replaced by a point
+        const char* separator = std::localeconv()->decimal_point;
+        size_t separator_length = std::strlen(separator);
+        if (separator_length != 0 && (separator_length != 1 || separator[0] != '.'))
+        {
+            char* position = std::strstr(number, separator);
+            if (position != nullptr)
+            {
+                *position = '.';
+                std::memmove(position + 1, position + separator_length, number + length + 1 - (position + separator_length));
+                length -= static_cast<int>(separator_length - 1);
+            }
+        }
+
+        if (std::strspn(number, "-0123456789") == static_cast<size_t>(length))
+        {
+            // The value is a whole number, so write it as an annotated string with a decimal point to make it clear it is not an int32
+            write_type_annotation(name, edm_type::double_floating_point);
+            write_name(name);
+            m_buffer.push_back('"');
+            m_buffer.append(number, length);
+            m_buffer.append(".0\"");
+        }
+        else
+        {
+            write_name(name);
+            m_buffer.append(number, length);
+        }
+    }
+
+    void table_entity_json_writer::write_annotated_string(const utility::string_t& name, edm_type type, const utility::string_t& value)
+    {
+        write_type_annotation(name, type);
+        write_name(name);
+        write_string(value);
+    }
+
+    void table_entity_json_writer::write_type_annotation(const utility::string_t& name, edm_type type)
+    {
+        write_separator();
+        m_buffer.push_back('"');
+        write_string_content(name);
+        m_buffer.append("@odata.type\":\"");
+        core::append_utf8(m_buffer, get_property_type_name(type));
+        m_buffer.push_back('"');
+    }
+
+    void table_entity_json_writer::write_name(const utility::string_t& name)
+    {
+        write_separator();
+        write_string(name);
+        m_buffer.push_back(':');
+    }
+
+    void table_entity_json_writer::write_string(const utility::string_t& value)
+    {
+        m_buffer.push_back('"');
+        write_string_content(value);
+        m_buffer.push_back('"');
+    }
+
+    void table_entity_json_writer::write_string_content(const utility::string_t& value)
+    {
+        static const char hex_digits[] = "0123456789abcdef";
+
+        for (utility::string_t::const_iterator it = value.cbegin(); it != value.cend(); ++it)
+        {
+            uint32_t c = static_cast<uint32_t>(static_cast<std::make_unsigned<utility::char_t>::type>(*it));
+            switch (c)
+            {
+            case '"':
+                m_buffer.append("\\\"");
+                break;
+
+            case '\\':
+                m_buffer.append("\\\\");
+                break;
+
+            case '\b':
+                m_buffer.append("\\b");
+                break;
+
+            case '\f':
+                m_buffer.append("\\f");
+                break;
+
+            case '\n':
+                m_buffer.append("\\n");
+                break;
+
+            case '\r':
+                m_buffer.append("\\r");
+                break;
+
+            case '\t':
+                m_buffer.append("\\t");
+                break;
+
+            default:
+                if (c < 0x20)
+                {
+                    m_buffer.append("\\u00");
+                    m_buffer.push_back(hex_digits[c >> 4]);
+                    m_buffer.push_back(hex_digits[c & 0xf]);
+                }
+#ifdef _WIN32
+                else if (c >= 0x80)
+                {
+                    // Encode the UTF-16 code unit, or the surrogate pair starting with it, as UTF-8
+                    if (c >= 0xd800 && c <= 0xdbff && it + 1 != value.cend())
+                    {
+                        uint32_t low = static_cast<uint32_t>(*(it + 1));
+                        if (low >= 0xdc00 && low <= 0xdfff)
+                        {
+                            c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+                            ++it;
+                        }
+                    }
+
+                    if (c < 0x800)
+                    {
+                        m_buffer.push_back(static_cast<char>(0xc0 | (c >> 6)));
+                    }
+                    else
+                    {
+                        if (c < 0x10000)
+                        {
+                            m_buffer.push_back(static_cast<char>(0xe0 | (c >> 12)));
+                        }
+                        else
+                        {
+                            m_buffer.push_back(static_cast<char>(0xf0 | (c >> 18)));
+                            m_buffer.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3f)));
+                        }
+
+                        m_buffer.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+                    }
+
+                    m_buffer.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+                }
+#endif
+                else
+                {
+                    // The string is already UTF-8, so bytes of multi-byte sequences are copied as they are
+                    m_buffer.push_back(static_cast<char>(c));
+                }
+                break;
+            }
+        }
+    }
+
+    void table_entity_json_writer::write_separator()
+    {
+        if (m_first_member)
+        {
+            m_first_member = false;
+        }
+        else
+        {
+            m_buffer.push_back(',');
+        }
+    }
+
     storage_extended_error parse_table_error(const web::json::value& document)
     {
         utility::string_t error_code;
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
+#include "wascore/base64.h"
 #include "wascore/util.h"
 
 namespace azure { namespace storage { namespace protocol {
@@ -137,9 +138,58 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
+    list_blobs_reader::element_token list_blobs_reader::get_element_token(const utility::string_t& element_name)
+    {
+        static const std::unordered_map<utility::string_t, element_token> element_tokens =
+        {
+            { xml_enumeration_results, element_token::enumeration_results },
+            { xml_blobs, element_token::blobs },
+            { xml_blob, element_token::blob },
+            { xml_blob_prefix, element_token::blob_prefix },
+            { xml_properties, element_token::properties },
+            { xml_metadata, element_token::metadata },
+            { xml_name, element_token::name },
+            { xml_snapshot, element_token::snapshot },
+            { xml_version_id, element_token::version_id },
+            { xml_is_current_version, element_token::is_current_version },
+            { xml_next_marker, element_token::next_marker },
+            { xml_last_modified, element_token::last_modified },
+            { xml_etag, element_token::etag },
+            { xml_lease_status, element_token::lease_status },
+            { xml_lease_state, element_token::lease_state },
+            { xml_lease_duration, element_token::lease_duration },
+            { xml_content_length, element_token::content_length },
+            { xml_content_disposition, element_token::content_disposition },
+            { xml_content_type, element_token::content_type },
+            { xml_content_encoding, element_token::content_encoding },
+            { xml_content_language, element_token::content_language },
+            { xml_content_md5, element_token::content_md5 },
+            { xml_cache_control, element_token::cache_control },
+            { xml_blob_sequence_number, element_token::blob_sequence_number },
+            { xml_blob_type, element_token::blob_type },
+            { xml_copy_id, element_token::copy_id },
+            { xml_copy_status, element_token::copy_status },
+            { xml_copy_source, element_token::copy_source },
+            { xml_copy_progress, element_token::copy_progress },
+            { xml_copy_completion_time, element_token::copy_completion_time },
+            { xml_copy_status_description, element_token::copy_status_description },
+            { xml_incremental_copy, element_token::incremental_copy },
+            { xml_copy_destination_snapshot, element_token::copy_destination_snapshot },
+            { xml_access_tier, element_token::access_tier },
+            { xml_access_tier_inferred, element_token::access_tier_inferred },
+            { xml_access_tier_change_time, element_token::access_tier_change_time },
+        };
+
+        auto iter = element_tokens.find(element_name);
+        return iter == element_tokens.end() ? element_token::unknown : iter->second;
+    }
+
     void list_blobs_reader::handle_begin_element(const utility::string_t& element_name)
     {
-        if (element_name == xml_enumeration_results)
+        auto token = get_element_token(element_name);
+        m_element_tokens.push_back(token);
+
+        if (token == element_token::enumeration_results)
         {
             if (move_to_first_attribute())
             {
@@ -163,204 +213,194 @@ namespace azure { namespace storage { namespace protocol {
 
     void list_blobs_reader::handle_element(const utility::string_t& element_name)
     {
-        if (get_parent_element_name() == xml_metadata)
+        auto parent_token = get_parent_element_token();
+        if (parent_token == element_token::metadata)
         {
-            m_metadata[element_name] = get_current_element_text();
+            if (m_record_callback != nullptr)
+            {
+                m_metadata_pairs.emplace_back(element_name, get_current_element_text());
+            }
+            else
+            {
+                m_metadata[element_name] = get_current_element_text();
+            }
             return;
         }
 
-        if (get_parent_element_name() == xml_properties)
+        auto token = m_element_tokens.back();
+        if (parent_token == element_token::properties)
         {
-            if (element_name == xml_last_modified)
-            {
-                m_properties.m_last_modified = parse_datetime_rfc1123(get_current_element_text());
-                return;
-            }
+            handle_property_element(token);
+        }
 
-            if (element_name == xml_etag)
-            {
-                utility::string_t str;
-                str.append(_XPLATSTR("\""));
-                str.append(get_current_element_text());
-                str.append(_XPLATSTR("\""));
-                m_properties.m_etag.swap(str);
-                return;
-            }
+        switch (token)
+        {
+        case element_token::snapshot:
+            m_snapshot_time = get_current_element_text();
+            break;
 
-            if (element_name == xml_lease_status)
-            {
-                m_properties.m_lease_status = parse_lease_status(get_current_element_text());
-                return;
-            }
+        case element_token::version_id:
+            m_properties.m_version_id = get_current_element_text();
+            break;
 
-            if (element_name == xml_lease_state)
-            {
-                m_properties.m_lease_state = parse_lease_state(get_current_element_text());
-                return;
-            }
+        case element_token::is_current_version:
+            m_is_current_version = response_parsers::parse_boolean(get_current_element_text());
+            break;
 
-            if (element_name == xml_lease_duration)
+        case element_token::name:
+            m_name = get_current_element_text();
+            if (m_record_callback == nullptr)
             {
-                m_properties.m_lease_duration = parse_lease_duration(get_current_element_text());
-                return;
+                m_uri = web::http::uri_builder(m_service_uri).append_path(m_name, true).to_uri();
             }
+            break;
 
-            if (element_name == xml_content_length)
-            {
-                extract_current_element(m_properties.m_size);
-                return;
-            }
+        case element_token::next_marker:
+            m_next_marker = get_current_element_text();
+            break;
 
-            if (element_name == xml_content_disposition)
-            {
-                m_properties.m_content_disposition = get_current_element_text();
-                return;
-            }
+        default:
+            break;
+        }
+    }
 
-            if (element_name == xml_content_type)
-            {
-                m_properties.m_content_type = get_current_element_text();
-                return;
-            }
+    void list_blobs_reader::handle_property_element(element_token token)
+    {
+        switch (token)
+        {
+        case element_token::last_modified:
+            m_properties.m_last_modified = parse_datetime_rfc1123(get_current_element_text());
+            break;
 
-            if (element_name == xml_content_encoding)
-            {
-                m_properties.m_content_encoding = get_current_element_text();
-                return;
-            }
+        case element_token::etag:
+        {
+            utility::string_t str;
+            str.append(_XPLATSTR("\""));
+            str.append(get_current_element_text());
+            str.append(_XPLATSTR("\""));
+            m_properties.m_etag.swap(str);
+            break;
+        }
 
-            if (element_name == xml_content_language)
-            {
-                m_properties.m_content_language = get_current_element_text();
-                return;
-            }
+        case element_token::lease_status:
+            m_properties.m_lease_status = parse_lease_status(get_current_element_text());
+            break;
 
-            if (element_name == xml_content_md5)
-            {
-                m_properties.m_content_md5 = get_current_element_text();
-                return;
-            }
+        case element_token::lease_state:
+            m_properties.m_lease_state = parse_lease_state(get_current_element_text());
+            break;
 
-            if (element_name == xml_cache_control)
-            {
-                m_properties.m_cache_control = get_current_element_text();
-                return;
-            }
+        case element_token::lease_duration:
+            m_properties.m_lease_duration = parse_lease_duration(get_current_element_text());
+            break;
 
-            if (element_name == xml_blob_sequence_number)
-            {
-                extract_current_element(m_properties.m_page_blob_sequence_number);
-                return;
-            }
+        case element_token::content_length:
+            extract_current_element(m_properties.m_size);
+            break;
 
-            if (element_name == xml_blob_type)
-            {
-                m_properties.m_type = blob_response_parsers::parse_blob_type(get_current_element_text());
-                return;
-            }
+        case element_token::content_disposition:
+            m_properties.m_content_disposition = get_current_element_text();
+            break;
 
-            if (element_name == xml_copy_id)
-            {
-                m_copy_state.m_copy_id = get_current_element_text();
-                return;
-            }
+        case element_token::content_type:
+            m_properties.m_content_type = get_current_element_text();
+            break;
 
-            if (element_name == xml_copy_status)
-            {
-                m_copy_state.m_status = response_parsers::parse_copy_status(get_current_element_text());
-                return;
-            }
+        case element_token::content_encoding:
+            m_properties.m_content_encoding = get_current_element_text();
+            break;
 
-            if (element_name == xml_copy_source)
-            {
-                m_copy_state.m_source = get_current_element_text();
-                return;
-            }
+        case element_token::content_language:
+            m_properties.m_content_language = get_current_element_text();
+            break;
 
-            if (element_name == xml_copy_progress)
-            {
-                response_parsers::parse_copy_progress(get_current_element_text(), m_copy_state.m_bytes_copied, m_copy_state.m_total_bytes);
-                return;
-            }
+        case element_token::content_md5:
+            m_properties.m_content_md5 = get_current_element_text();
+            break;
 
-            if (element_name == xml_copy_completion_time)
-            {
-                m_copy_state.m_completion_time = response_parsers::parse_datetime(get_current_element_text());
-                return;
-            }
+        case element_token::cache_control:
+            m_properties.m_cache_control = get_current_element_text();
+            break;
 
-            if (element_name == xml_copy_status_description)
-            {
-                m_copy_state.m_status_description = get_current_element_text();
-                return;
-            }
+        case element_token::blob_sequence_number:
+            extract_current_element(m_properties.m_page_blob_sequence_number);
+            break;
 
-            if (element_name == xml_incremental_copy)
-            {
-                m_properties.m_is_incremental_copy = response_parsers::parse_boolean(get_current_element_text());
-                return;
-            }
+        case element_token::blob_type:
+            m_properties.m_type = blob_response_parsers::parse_blob_type(get_current_element_text());
+            break;
 
-            if (element_name == xml_copy_destination_snapshot)
-            {
-                m_copy_state.m_destination_snapshot_time = response_parsers::parse_datetime(get_current_element_text(), utility::datetime::date_format::ISO_8601);
-            }
+        case element_token::copy_id:
+            m_copy_state.m_copy_id = get_current_element_text();
+            break;
 
-            if (element_name == xml_access_tier)
-            {
-                auto current_text = get_current_element_text();
-                m_properties.m_standard_blob_tier = response_parsers::parse_standard_blob_tier(current_text);
-                m_properties.m_premium_blob_tier = response_parsers::parse_premium_blob_tier(current_text);
-            }
+        case element_token::copy_status:
+            m_copy_state.m_status = response_parsers::parse_copy_status(get_current_element_text());
+            break;
 
-            if (element_name == xml_access_tier_inferred)
-            {
-                m_properties.m_access_tier_inferred = response_parsers::parse_boolean(get_current_element_text());
-            }
+        case element_token::copy_source:
+            m_copy_state.m_source = get_current_element_text();
+            break;
 
-            if (element_name == xml_access_tier_change_time)
-            {
-                m_properties.m_access_tier_change_time = response_parsers::parse_datetime(get_current_element_text());
-            }
-        }
+        case element_token::copy_progress:
+            response_parsers::parse_copy_progress(get_current_element_text(), m_copy_state.m_bytes_copied, m_copy_state.m_total_bytes);
+            break;
 
-        if (element_name == xml_snapshot)
-        {
-            m_snapshot_time = get_current_element_text();
-            return;
-        }
+        case element_token::copy_completion_time:
+            m_copy_state.m_completion_time = response_parsers::parse_datetime(get_current_element_text());
+            break;
 
-        if (element_name == xml_version_id)
-        {
-            m_properties.m_version_id = get_current_element_text();
-            return;
-        }
+        case element_token::copy_status_description:
+            m_copy_state.m_status_description = get_current_element_text();
+            break;
 
-        if (element_name == xml_is_current_version)
-        {
-            m_is_current_version = response_parsers::parse_boolean(get_current_element_text());
-            return;
-        }
+        case element_token::incremental_copy:
+            m_properties.m_is_incremental_copy = response_parsers::parse_boolean(get_current_element_text());
+            break;
 
-        if (element_name == xml_name)
+        case element_token::copy_destination_snapshot:
+            m_copy_state.m_destination_snapshot_time = response_parsers::parse_datetime(get_current_element_text(), utility::datetime::date_format::ISO_8601);
+            break;
+
+        case element_token::access_tier:
         {
-            m_name = get_current_element_text();
-            m_uri = web::http::uri_builder(m_service_uri).append_path(m_name, true).to_uri();
-            return;
+            auto current_text = get_current_element_text();
+            m_properties.m_standard_blob_tier = response_parsers::parse_standard_blob_tier(current_text);
+            m_properties.m_premium_blob_tier = response_parsers::parse_premium_blob_tier(current_text);
+            break;
         }
 
-        if (element_name == xml_next_marker)
-        {
-            m_next_marker = get_current_element_text();
-            return;
+        case element_token::access_tier_inferred:
+            m_properties.m_access_tier_inferred = response_parsers::parse_boolean(get_current_element_text());
+            break;
+
+        case element_token::access_tier_change_time:
+            m_properties.m_access_tier_change_time = response_parsers::parse_datetime(get_current_element_text());
+            break;
+
+        default:
+            break;
         }
     }
 
     void list_blobs_reader::handle_end_element(const utility::string_t& element_name)
     {
-        if (get_parent_element_name() == xml_blobs)
+        UNREFERENCED_PARAMETER(element_name);
+
+        if (get_parent_element_token() == element_token::blobs)
         {
-            if (element_name == xml_blob)
+            auto token = m_element_tokens.back();
+            if (token == element_token::blob && m_record_callback != nullptr)
+            {
+                (*m_record_callback)(m_name, m_snapshot_time, m_properties, m_metadata_pairs);
+                m_name.clear();
+                m_snapshot_time.clear();
+                m_is_current_version = false;
+                m_metadata_pairs.clear();
+                m_properties = azure::storage::cloud_blob_properties();
+                m_copy_state = azure::storage::copy_state();
+            }
+            else if (token == element_token::blob)
             {
                 m_blob_items.push_back(cloud_blob_list_item(std::move(m_uri), std::move(m_name), std::move(m_snapshot_time), m_is_current_version, std::move(m_metadata), std::move(m_properties), std::move(m_copy_state)));
                 m_uri = web::uri();
@@ -370,14 +410,72 @@ namespace azure { namespace storage { namespace protocol {
                 m_metadata = azure::storage::cloud_metadata();
                 m_properties = azure::storage::cloud_blob_properties();
                 m_copy_state = azure::storage::copy_state();
+
+                if (m_pause_on_item)
+                {
+                    pause();
+                }
             }
-            else if (element_name == xml_blob_prefix)
+            else if (token == element_token::blob_prefix)
             {
                 m_blob_prefix_items.push_back(cloud_blob_prefix_list_item(std::move(m_uri), std::move(m_name)));
                 m_uri = web::uri();
                 m_name = utility::string_t();
+
+                if (m_pause_on_item)
+                {
+                    pause();
+                }
+            }
+        }
+
+        m_element_tokens.pop_back();
+    }
+
+    utility::string_t list_blobs_reader::parse_items(const std::function<void(cloud_blob_list_item&)>& blob_callback, const std::function<void(cloud_blob_prefix_list_item&)>& blob_prefix_callback)
+    {
+        m_pause_on_item = true;
+
+        xml_reader::parse_result result;
+        do
+        {
+            // Parsing pauses after every completed item, so at most one item is buffered at a time.
+            result = parse();
+
+            for (auto iter = m_blob_items.begin(); iter != m_blob_items.end(); ++iter)
+            {
+                blob_callback(*iter);
             }
+            m_blob_items.clear();
+
+            for (auto iter = m_blob_prefix_items.begin(); iter != m_blob_prefix_items.end(); ++iter)
+            {
+                blob_prefix_callback(*iter);
+            }
+            m_blob_prefix_items.clear();
+        } while (result == xml_reader::parse_result::can_continue);
+
+        if (result == xml_reader::parse_result::xml_not_complete)
+        {
+            throw storage_exception(protocol::error_xml_not_complete, true);
+        }
+
+        return std::move(m_next_marker);
+    }
+
+    utility::string_t list_blobs_reader::parse_records(const record_callback& blob_callback)
+    {
+        // Blobs go straight to the callback from handle_end_element, so the whole document is parsed in one pass.
+        m_record_callback = &blob_callback;
+        auto result = parse();
+        m_record_callback = nullptr;
+
+        if (result == xml_reader::parse_result::xml_not_complete)
+        {
+            throw storage_exception(protocol::error_xml_not_complete, true);
         }
+
+        return std::move(m_next_marker);
     }
 
     void page_list_reader::handle_element(const utility::string_t& element_name)
@@ -748,6 +846,67 @@ namespace azure { namespace storage { namespace protocol {
         return outstream.str();
     }
 
+    void message_writer::write(const cloud_queue_message& message, std::string& buffer)
+    {
+        buffer.assign("<?xml version=\"1.0\" encoding=\"utf-8\"?><QueueMessage><MessageText>");
+
+        // Binary content is encoded straight into the buffer, and Base64 never needs escaping
+        if (message.m_is_binary)
+        {
+            const std::vector<uint8_t>& content = *message.m_binary_content;
+            core::append_base64(buffer, content.data(), content.size());
+            buffer.append("</MessageText></QueueMessage>");
+            return;
+        }
+
+        size_t content_start = buffer.size();
+        core::append_utf8(buffer, message.m_content);
+
+        // Message text is usually Base64, so it only has to be escaped when a character that needs it is present
+        const char escaped_characters[] = "&<>\"'\r";
+        size_t position = buffer.find_first_of(escaped_characters, content_start);
+        if (position != std::string::npos)
+        {
+            std::string tail = buffer.substr(position);
+            buffer.resize(position);
+            for (auto it = tail.cbegin(); it != tail.cend(); ++it)
+            {
+                switch (*it)
+                {
+                case '&':
+                    buffer.append("&amp;");
+                    break;
+
+                case '<':
+                    buffer.append("&lt;");
+                    break;
+
+                case '>':
+                    buffer.append("&gt;");
+                    break;
+
+                case '"':
+                    buffer.append("&quot;");
+                    break;
+
+                case '\'':
+                    buffer.append("&apos;");
+                    break;
+
+                case '\r':
+                    buffer.append("&#xD;");
+                    break;
+
+                default:
+                    buffer.push_back(*it);
+                    break;
+                }
+            }
+        }
+
+        buffer.append("</MessageText></QueueMessage>");
+    }
+
     void list_shares_reader::handle_begin_element(const utility::string_t& element_name)
     {
         if (element_name == xml_enumeration_results)
@@ -16,6 +16,9 @@
 // -----------------------------------------------------------------------------------------
 
 #include "stdafx.h"
+
+#include "cpprest/rawptrstream.h"
+
 #include "wascore/protocol.h"
 #include "wascore/protocol_xml.h"
 #include "wascore/constants.h"
@@ -153,7 +156,7 @@ namespace azure { namespace storage { namespace protocol {
         return request;
     }
 
-    web::http::http_request add_message(const cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    static web::http::http_request add_message_base_request(std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
     {
         if (time_to_live.count() >= -1LL && time_to_live.count() != 604800LL)
         {
@@ -165,12 +168,26 @@ namespace azure { namespace storage { namespace protocol {
             uri_builder.append_query(core::make_query_parameter(_XPLATSTR("visibilitytimeout"), initial_visibility_timeout.count(), /* do_encoding */ false));
         }
 
-        web::http::http_request request = queue_base_request(web::http::methods::POST, uri_builder, timeout, context);
+        return queue_base_request(web::http::methods::POST, uri_builder, timeout, context);
+    }
 
-        protocol::message_writer writer;
-        std::string content = writer.write(message);
-        request.set_body(content);
+    web::http::http_request add_message(const cloud_queue_message& message, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    {
+        std::string body;
+        protocol::message_writer::write(message, body);
+
+        web::http::http_request request = add_message_base_request(time_to_live, initial_visibility_timeout, uri_builder, timeout, context);
+        request.set_body(std::move(body));
+        return request;
+    }
+
+    web::http::http_request add_message_with_body(const std::string& body, std::chrono::seconds time_to_live, std::chrono::seconds initial_visibility_timeout, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    {
+        web::http::http_request request = add_message_base_request(time_to_live, initial_visibility_timeout, uri_builder, timeout, context);
 
+        // The body is read in place rather than copied into the request, since it is sent again unchanged by every retry
+        concurrency::streams::istream body_stream = concurrency::streams::rawptr_stream<uint8_t>::open_istream(reinterpret_cast<const uint8_t*>(body.data()), body.size());
+        request.set_body(body_stream, body.size(), _XPLATSTR("text/plain; charset=utf-8"));
         return request;
     }
 
@@ -213,8 +230,8 @@ namespace azure { namespace storage { namespace protocol {
 
         if (update_contents)
         {
-            protocol::message_writer writer;
-            std::string content = writer.write(message);
+            std::string content;
+            protocol::message_writer::write(message, content);
             request.set_body(content);
         }
 
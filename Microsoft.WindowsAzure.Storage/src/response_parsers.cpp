@@ -26,6 +26,77 @@
 
 namespace azure { namespace storage { namespace protocol {
 
+    namespace
+    {
+        bool parse_digits(const utility::char_t* text, size_t count, int& result)
+        {
+            result = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (text[i] < _XPLATSTR('0') || text[i] > _XPLATSTR('9'))
+                {
+                    return false;
+                }
+
+                result = result * 10 + (text[i] - _XPLATSTR('0'));
+            }
+
+            return true;
+        }
+
+        int64_t days_from_civil(int year, int month, int day)
+        {
+            // Days since 1970-01-01 in the proleptic Gregorian calendar.
+            year -= month <= 2 ? 1 : 0;
+            const int64_t era = (year >= 0 ? year : year - 399) / 400;
+            const int64_t year_of_era = year - era * 400;
+            const int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+            return era * 146097 + day_of_era - 719468;
+        }
+
+        // The service always formats dates as the fixed-width "Wdy, DD Mon YYYY HH:MM:SS GMT". Decode that form
+        // directly; anything else is left to the general purpose parser.
+        bool try_parse_fixed_rfc1123(const utility::string_t& value, utility::datetime& result)
+        {
+            static const utility::char_t* const month_names[] = {
+                _XPLATSTR("Jan"), _XPLATSTR("Feb"), _XPLATSTR("Mar"), _XPLATSTR("Apr"), _XPLATSTR("May"), _XPLATSTR("Jun"),
+                _XPLATSTR("Jul"), _XPLATSTR("Aug"), _XPLATSTR("Sep"), _XPLATSTR("Oct"), _XPLATSTR("Nov"), _XPLATSTR("Dec") };
+
+            if (value.size() != 29 || value[3] != _XPLATSTR(',') || value[4] != _XPLATSTR(' ') || value[7] != _XPLATSTR(' ') ||
+                value[11] != _XPLATSTR(' ') || value[16] != _XPLATSTR(' ') || value[19] != _XPLATSTR(':') || value[22] != _XPLATSTR(':') ||
+                value.compare(25, 4, _XPLATSTR(" GMT")) != 0)
+            {
+                return false;
+            }
+
+            const utility::char_t* text = value.c_str();
+            int day, year, hour, minute, second;
+            if (!parse_digits(text + 5, 2, day) || !parse_digits(text + 12, 4, year) || !parse_digits(text + 17, 2, hour) ||
+                !parse_digits(text + 20, 2, minute) || !parse_digits(text + 23, 2, second))
+            {
+                return false;
+            }
+
+            int month = 0;
+            while (month < 12 && value.compare(8, 3, month_names[month]) != 0)
+            {
+                ++month;
+            }
+
+            if (month == 12 || day < 1 || day > 31 || year < 1601 || hour > 23 || minute > 59 || second > 59)
+            {
+                return false;
+            }
+
+            // utility::datetime counts 100ns ticks since 1601-01-01.
+            const int64_t seconds_from_1601_to_1970 = 11644473600LL;
+            const int64_t seconds = days_from_civil(year, month + 1, day) * 86400 + hour * 3600 + minute * 60 + second + seconds_from_1601_to_1970;
+            result = utility::datetime() + static_cast<utility::datetime::interval_type>(seconds) * 10000000ULL;
+            return true;
+        }
+    }
+
     void preprocess_response_void(const web::http::http_response& response, const request_result& result, operation_context context)
     {
         preprocess_response<char>(0, response, result, context);
@@ -63,6 +134,12 @@ namespace azure { namespace storage { namespace protocol {
 
     utility::datetime parse_datetime_rfc1123(const utility::string_t& value)
     {
+        utility::datetime result;
+        if (try_parse_fixed_rfc1123(value, result))
+        {
+            return result;
+        }
+
         return utility::datetime::from_string(value, utility::datetime::date_format::RFC_1123);
     }
 
@@ -306,6 +383,11 @@ namespace azure { namespace storage { namespace protocol {
     {
         if (!value.empty())
         {
+            if (format == utility::datetime::date_format::RFC_1123)
+            {
+                return parse_datetime_rfc1123(value);
+            }
+
             return utility::datetime::from_string(value, format);
         }
         else
@@ -25,6 +25,7 @@
 #include "was/storage_account.h"
 #include "wascore/logging.h"
 #include "wascore/util.h"
+#include "wascore/base64.h"
 #include "wascore/resources.h"
 
 namespace azure { namespace storage { namespace protocol {
@@ -236,7 +237,7 @@ namespace azure { namespace storage { namespace protocol {
         string_to_sign += headers.content_language() + new_line;
         string_to_sign += headers.content_type();
 
-        auto signature = calculate_hmac_sha256_hash(string_to_sign, utility::conversions::from_base64(key.key));
+        auto signature = calculate_hmac_sha256_hash(string_to_sign, core::from_base64(key.key));
 
         auto builder = get_sas_token_builder(utility::string_t(), policy, signature);
 
@@ -17,6 +17,7 @@
 
 #include "stdafx.h"
 #include "wascore/protocol.h"
+#include "wascore/protocol_json.h"
 #include "wascore/constants.h"
 #include "wascore/resources.h"
 #include "was/common.h"
@@ -64,7 +65,7 @@ namespace azure { namespace storage { namespace protocol {
         return builder.to_uri();
     }
 
-    web::http::uri generate_table_uri(const web::http::uri& base_uri, const cloud_table& table, const table_operation& operation)
+    web::http::uri generate_table_uri(const web::http::uri& base_uri, const cloud_table& table, table_operation_type operation_type, const utility::string_t& partition_key, const utility::string_t& row_key)
     {
         if (base_uri.is_empty())
         {
@@ -72,14 +73,14 @@ namespace azure { namespace storage { namespace protocol {
         }
 
         utility::string_t path;
-        if (operation.operation_type() == table_operation_type::insert_operation)
+        if (operation_type == table_operation_type::insert_operation)
         {
             path.append(table.name());
         }
         else
         {
-            utility::string_t modified_partition_key = core::single_quote(operation.entity().partition_key());
-            utility::string_t modified_row_key = core::single_quote(operation.entity().row_key());
+            utility::string_t modified_partition_key = core::single_quote(partition_key);
+            utility::string_t modified_row_key = core::single_quote(row_key);
 
             path.reserve(table.name().size() + modified_partition_key.size() + modified_row_key.size() + 23U);
 
@@ -96,6 +97,11 @@ namespace azure { namespace storage { namespace protocol {
         return builder.to_uri();
     }
 
+    web::http::uri generate_table_uri(const web::http::uri& base_uri, const cloud_table& table, const table_operation& operation)
+    {
+        return generate_table_uri(base_uri, table, operation.operation_type(), operation.entity().partition_key(), operation.entity().row_key());
+    }
+
     web::http::uri generate_table_uri(const web::http::uri& base_uri, const cloud_table& table, const table_batch_operation& operation)
     {
         UNREFERENCED_PARAMETER(table);
@@ -185,6 +191,14 @@ namespace azure { namespace storage { namespace protocol {
         return storage_uri(std::move(primary_uri), std::move(secondary_uri));
     }
 
+    storage_uri generate_table_uri(const cloud_table_client& service_client, const cloud_table& table, table_operation_type operation_type, const utility::string_t& partition_key, const utility::string_t& row_key)
+    {
+        web::http::uri primary_uri(generate_table_uri(service_client.base_uri().primary_uri(), table, operation_type, partition_key, row_key));
+        web::http::uri secondary_uri(generate_table_uri(service_client.base_uri().secondary_uri(), table, operation_type, partition_key, row_key));
+
+        return storage_uri(std::move(primary_uri), std::move(secondary_uri));
+    }
+
     storage_uri generate_table_uri(const cloud_table_client& service_client, const cloud_table& table, const table_batch_operation& operation)
     {
         web::http::uri primary_uri(generate_table_uri(service_client.base_uri().primary_uri(), table, operation));
@@ -262,131 +276,57 @@ namespace azure { namespace storage { namespace protocol {
         }
     }
 
-    void populate_http_headers(web::http::http_headers& headers, const table_operation& operation, table_payload_format payload_format)
+    void populate_http_headers(web::http::http_headers& headers, table_operation_type operation_type, const utility::string_t& etag, table_payload_format payload_format)
     {
-        table_operation_type operation_type = operation.operation_type();
         populate_http_headers(headers, operation_type, payload_format);
 
         if (operation_type == table_operation_type::delete_operation || 
             operation_type == table_operation_type::merge_operation || 
             operation_type == table_operation_type::replace_operation)
         {
-            utility::string_t etag;
-            if (operation.entity().etag().empty())
-            {
-                // Default to update/merge/delete any present entity
-                etag = _XPLATSTR("*");
-            }
-            else
-            {
-                etag = operation.entity().etag();
-            }
-
-            headers.add(web::http::header_names::if_match, etag);
+            // Default to update/merge/delete any present entity
+            headers.add(web::http::header_names::if_match, etag.empty() ? utility::string_t(_XPLATSTR("*")) : etag);
         }
     }
 
-    web::json::value generate_json_object(const table_operation& operation)
+    void populate_http_headers(web::http::http_headers& headers, const table_operation& operation, table_payload_format payload_format)
     {
-        if (operation.operation_type() == table_operation_type::insert_operation || 
-            operation.operation_type() == table_operation_type::insert_or_merge_operation || 
-            operation.operation_type() == table_operation_type::insert_or_replace_operation || 
-            operation.operation_type() == table_operation_type::merge_operation || 
-            operation.operation_type() == table_operation_type::replace_operation)
-        {
-            const table_entity::properties_type& properties = operation.entity().properties();
-            std::vector<std::pair<utility::string_t, web::json::value>> fields;
-
-            // The PartitionKey and RowKey each need a field, and every property can have up to 2 fields for a value and type
-            fields.reserve(properties.size() * 2 + 2);
-
-            web::json::value partition_key_value(operation.entity().partition_key());
-            fields.push_back(std::make_pair(_XPLATSTR("PartitionKey"), std::move(partition_key_value)));
-
-            web::json::value row_key_value(operation.entity().row_key());
-            fields.push_back(std::make_pair(_XPLATSTR("RowKey"), std::move(row_key_value)));
-
-            for (table_entity::properties_type::const_iterator it = properties.cbegin(); it != properties.cend(); ++it)
-            {
-                const utility::string_t& property_name = it->first;
-                const entity_property& entity_property = it->second;
-
-                bool requires_type;
-                web::json::value property_value;
-
-                if (entity_property.property_type() == edm_type::boolean)
-                {
-                    requires_type = false;
-                    property_value = web::json::value(entity_property.boolean_value());
-                }
-                else if (entity_property.property_type() == edm_type::int32)
-                {
-                    requires_type = false;
-                    property_value = web::json::value(entity_property.int32_value());
-                }
-                else if (entity_property.property_type() == edm_type::double_floating_point)
-                {
-                    double double_value = entity_property.double_value();
-                    if (core::is_finite(double_value))
-                    {
-                        const utility::string_t& string_value = entity_property.str();
-                        if (core::is_integral(string_value))
-                        {
-                            // TODO: Remove this temporary workaround after Casablanca starts serializing whole number doubles with a decimal point
-
-                            // The value consists entirely of an optional negative sign followed by digits, so add a decimal point to make it clear it is not an int32
-                            utility::string_t modified_string_value;
-                            modified_string_value.reserve(string_value.size() + 2);
-                            modified_string_value.append(string_value);
-                            modified_string_value.append(_XPLATSTR(".0"));
-
-                            requires_type = true;
-                            property_value = web::json::value(modified_string_value);
-                        }
-                        else
-                        {
-                            requires_type = false;
-                            property_value = web::json::value(double_value);
-                        }
-                    }
-                    else
-                    {
-                        // Serialize special double values as strings
-                        requires_type = true;
-                        property_value = web::json::value(entity_property.str());
-                    }
-                }
-                else if (entity_property.property_type() == edm_type::string)
-                {
-                    requires_type = false;
-                    property_value = web::json::value(entity_property.str());
-                }
-                else
-                {
-                    requires_type = true;
-                    property_value = web::json::value(entity_property.str());
-                }
+        populate_http_headers(headers, operation.operation_type(), operation.entity().etag(), payload_format);
+    }
 
-                if (requires_type)
-                {
-                    // The type name length is the length of the property name plus 11 characters for the @odata.type suffix
-                    utility::string_t type_name;
-                    type_name.reserve(property_name.size() + 11);
-                    type_name.append(property_name);
-                    type_name.append(_XPLATSTR("@odata.type"));
+    bool has_json_body(table_operation_type operation_type)
+    {
+        return operation_type == table_operation_type::insert_operation || 
+            operation_type == table_operation_type::insert_or_merge_operation || 
+            operation_type == table_operation_type::insert_or_replace_operation || 
+            operation_type == table_operation_type::merge_operation || 
+            operation_type == table_operation_type::replace_operation;
+    }
 
-                    web::json::value type_value(get_property_type_name(entity_property.property_type()));
+    std::string generate_json_body(const table_operation& operation)
+    {
+        std::string body;
+        if (has_json_body(operation.operation_type()))
+        {
+            body.reserve(table_entity_json_writer::estimate_size(operation.entity()));
 
-                    fields.push_back(std::make_pair(std::move(type_name), std::move(type_value)));
-                }
+            table_entity_json_writer writer(body);
+            writer.write_entity(operation.entity());
+        }
 
-                fields.push_back(std::make_pair(property_name, std::move(property_value)));
-            }
+        return body;
+    }
 
-            return web::json::value::object(fields);
+    std::string generate_json_body(table_operation_type operation_type, const table_entity_schema& schema, void* entity)
+    {
+        std::string body;
+        if (has_json_body(operation_type))
+        {
+            table_entity_json_writer writer(body);
+            writer.write_entity(schema, entity);
         }
 
-        return web::json::value::null();
+        return body;
     }
 
     web::http::http_request table_base_request(web::http::method method, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
@@ -432,10 +372,27 @@ namespace azure { namespace storage { namespace protocol {
         web::http::http_headers& headers = request.headers();
         populate_http_headers(headers, operation, payload_format);
 
-        web::json::value json_object = generate_json_object(operation);
-        if (!json_object.is_null())
+        std::string body = generate_json_body(operation);
+        if (!body.empty())
         {
-            request.set_body(json_object);
+            // The Content-Type header has already been set to JSON by populate_http_headers
+            request.set_body(std::move(body));
+        }
+
+        return request;
+    }
+
+    web::http::http_request execute_operation(table_operation_type operation_type, const utility::string_t& etag, const std::string& body, table_payload_format payload_format, web::http::uri_builder& uri_builder, const std::chrono::seconds& timeout, operation_context context)
+    {
+        web::http::method method = get_http_method(operation_type);
+        web::http::http_request request = table_base_request(method, uri_builder, timeout, context);
+
+        web::http::http_headers& headers = request.headers();
+        populate_http_headers(headers, operation_type, etag, payload_format);
+
+        if (!body.empty())
+        {
+            request.set_body(body);
         }
 
         return request;
@@ -452,12 +409,22 @@ namespace azure { namespace storage { namespace protocol {
         request_headers.add(web::http::header_names::accept_charset, header_value_charset_utf8);
         populate_http_headers(request_headers, batch_boundary_name);
 
-        table_batch_operation::operations_type operations = batch_operation.operations();
+        const table_batch_operation::operations_type& operations = batch_operation.operations();
 
         web::http::uri base_uri = table.service_client().base_uri().primary_uri();
-        utility::string_t body_text;
 
-        core::write_boundary(body_text, batch_boundary_name);
+        // The whole multipart body is written as UTF-8 into a single buffer, sized up front from the framing and the entities
+        size_t base_uri_size = base_uri.to_string().size();
+        size_t body_size = 256;
+        for (table_batch_operation::operations_type::const_iterator it = operations.cbegin(); it != operations.cend(); ++it)
+        {
+            body_size += 512 + base_uri_size + table_entity_json_writer::estimate_size(it->entity());
+        }
+
+        std::string body;
+        body.reserve(body_size);
+
+        core::write_boundary(body, batch_boundary_name);
 
         // Write batch headers
         if (!is_query)
@@ -465,12 +432,12 @@ namespace azure { namespace storage { namespace protocol {
             web::http::http_headers changeset_headers;
             populate_http_headers(changeset_headers, changeset_boundary_name);
 
-            core::write_request_headers(body_text, changeset_headers);
+            core::write_request_headers(body, changeset_headers);
         }
 
         if (operations.size() > 0U)
         {
-            int content_id = 0;
+            table_entity_json_writer writer(body);
             for (table_batch_operation::operations_type::const_iterator it = operations.cbegin(); it != operations.cend(); ++it)
             {
                 const table_operation& operation = *it;
@@ -482,32 +449,35 @@ namespace azure { namespace storage { namespace protocol {
 
                 if (!is_query)
                 {
-                    core::write_boundary(body_text, changeset_boundary_name);
+                    core::write_boundary(body, changeset_boundary_name);
                 }
 
-                core::write_mime_changeset_headers(body_text);
-                core::write_request_line(body_text, method, uri);
-                core::write_request_headers(body_text, operation_headers);
+                core::write_mime_changeset_headers(body);
+                core::write_request_line(body, method, uri);
+                core::write_request_headers(body, operation_headers);
 
-                web::json::value json_object = generate_json_object(operation);
-                core::write_request_payload(body_text, json_object);
+                if (has_json_body(operation.operation_type()))
+                {
+                    writer.write_entity(operation.entity());
+                }
 
-                ++content_id;
+                body.append("\r\n");
             }
         }
         else
         {
-            core::write_boundary(body_text, changeset_boundary_name);
+            core::write_boundary(body, changeset_boundary_name);
         }
 
         if (!is_query)
         {
-            core::write_boundary(body_text, changeset_boundary_name, /* is_closure */ true);
+            core::write_boundary(body, changeset_boundary_name, /* is_closure */ true);
         }
 
-        core::write_boundary(body_text, batch_boundary_name, /* is_closure */ true);
+        core::write_boundary(body, batch_boundary_name, /* is_closure */ true);
 
-        request.set_body(body_text);
+        // The Content-Type header has already been set to the multipart type by populate_http_headers
+        request.set_body(std::move(body));
 
         return request;
     }
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 #include "wascore/protocol.h"
 #include "wascore/protocol_json.h"
+#include "wascore/resources.h"
 #include "was/common.h"
 
 #include "cpprest/asyncrt_utils.h"
@@ -73,160 +74,74 @@ namespace azure { namespace storage { namespace protocol {
         std::vector<table_result> batch_result;
         batch_result.reserve(batch_size);
 
-        // TODO: We make a copy of the response here, we may optimize it in the future
-        const std::vector<uint8_t>& response_collection = response_buffer.collection();
-        const std::string response_body(response_collection.begin(), response_collection.end());
+        // The response is parsed in place. Only ETags, and the bodies of failed operations, are copied out of the buffer.
+        core::mime_multipart_reader reader(response_buffer.collection());
 
-        // TODO: Make this Casablanca code more robust
+        core::mime_byte_range batch_delimiter = reader.read_opening_delimiter();
+        std::string delimiter = batch_delimiter.str();
 
-        // More strings we will search for during the course of parsing
-        std::string http_begin("HTTP"), etag_header("ETag: "), crlf("\r\n"), crlfcrlf("\r\n\r\n"), space(" ");
-
-        if (is_query)
+        // A query is answered in a single part, while other operations are answered in the parts of a nested changeset
+        core::mime_byte_range changeset_boundary = reader.read_part_headers();
+        bool has_part = true;
+        if (!changeset_boundary.empty())
         {
-            // Find the HTTP status line
-            size_t response_begin = response_body.find(http_begin);
+            delimiter.assign("--");
+            delimiter.append(changeset_boundary.begin, changeset_boundary.end);
+
+            has_part = reader.read_next_part(delimiter);
+            if (has_part)
+            {
+                reader.read_part_headers();
+            }
+        }
 
-            // Find the status code within that line
-            size_t status_code_begin = response_body.find(space, response_begin) + space.size();
-            size_t status_code_end = response_body.find(space, status_code_begin);
-            std::string status_code_string = response_body.substr(status_code_begin, status_code_end - status_code_begin);
+        core::mime_headers headers;
+        while (has_part)
+        {
+            int status_code;
+            core::mime_byte_range status_message;
+            core::mime_byte_range body;
+            reader.read_http_response(delimiter, status_code, status_message, headers, body);
 
-            // Extract the status code as an integer
-            int status_code = utility::conversions::details::scan_string<int>(utility::conversions::to_string_t(status_code_string));
+            // Delete operations do not return an ETag header
+            core::mime_byte_range etag = core::mime_multipart_reader::find_header(headers, "ETag");
 
-            // Acceptable codes are 'Created' and 'NoContent'
-            if (status_code == web::http::status_codes::OK || status_code == web::http::status_codes::Created || status_code == web::http::status_codes::Accepted || status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::PartialContent || status_code == web::http::status_codes::NotFound)
+            // Acceptable codes are 'Created' and 'NoContent', and 'NotFound' for a retrieve
+            if (status_code == web::http::status_codes::OK || status_code == web::http::status_codes::Created || status_code == web::http::status_codes::Accepted || status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::PartialContent || (is_query && status_code == web::http::status_codes::NotFound))
             {
                 table_result result;
                 result.set_http_status_code(status_code);
 
-                // The operation succeeded. Try to find an ETag: header if it exists. Delete operations will not have an etag header
-                // so copy the list of headers into a substring and search within the list, lest we cross a changeset boundary.
-                size_t headersBegin = response_body.find(crlf, status_code_end) + crlf.size();
-                size_t headersEnd = response_body.find(crlfcrlf, headersBegin) + crlf.size();
-                std::string headers = response_body.substr(headersBegin, headersEnd - headersBegin);
-
                 utility::string_t etag_value;
-
-                size_t etagBegin = headers.find(etag_header);
-                if (etagBegin != std::string::npos)
+                if (!etag.empty())
                 {
-                    etagBegin += etag_header.size();
-                    size_t etagEnd = headers.find(crlf, etagBegin);
-                    std::string etag = headers.substr(etagBegin, etagEnd - etagBegin);
-                    etag_value = utility::conversions::to_string_t(etag);
-
+                    etag_value = utility::conversions::to_string_t(etag.str());
                     result.set_etag(etag_value);
                 }
 
-                size_t content_begin_offset = response_body.find(crlfcrlf, status_code_end) + crlfcrlf.size();
-                size_t content_end_offset = response_body.find("\r\n--batchresponse", content_begin_offset) + crlf.size();
-
-                std::string content_string = response_body.substr(content_begin_offset, content_end_offset - content_begin_offset);
-
-                web::json::value document = web::json::value::parse(utility::conversions::to_string_t(content_string));
-                table_entity entity = protocol::parse_table_entity(document);
-                entity.set_etag(etag_value);
-                result.set_entity(entity);
+                if (is_query)
+                {
+                    table_entity_json_reader entity_reader(body.begin, body.end);
+                    table_entity entity = entity_reader.read_entity();
+                    entity.set_etag(std::move(etag_value));
+                    result.set_entity(std::move(entity));
+                }
 
-                batch_result.push_back(result);
+                batch_result.push_back(std::move(result));
             }
             else
             {
-                size_t status_message_begin = status_code_end + space.size();
-                size_t status_message_end = response_body.find(crlf, status_message_begin);
-
-                std::string status_message = response_body.substr(status_message_begin, status_message_end - status_message_begin);
-
-                // An operation failed. Find the start of the XML block that contains information about the error
-                size_t content_begin_offset = response_body.find(crlfcrlf, status_message_end) + crlfcrlf.size();
-                size_t content_end_offset = response_body.find("\r\n--batchresponse", content_begin_offset) + crlf.size();
-
-                std::string error_string = response_body.substr(content_begin_offset, content_end_offset - content_begin_offset);
-
-                web::json::value document = web::json::value::parse(utility::conversions::to_string_t(error_string));
+                // An operation failed. The body contains information about the error.
+                web::json::value document = web::json::value::parse(utility::conversions::to_string_t(body.str()));
                 storage_extended_error extended_error = protocol::parse_table_error(document);
                 request_result request_result(utility::datetime(), storage_location::unspecified, response, (web::http::status_code) status_code, extended_error);
-                throw storage_exception(status_message, request_result);
+                throw storage_exception(status_message.str(), request_result);
             }
-        }
-        else
-        {
-            // Strings we will search for during the course of parsing
-            std::string content_type("Content-Type"), boundary_begin("boundary=");
-
-            // Find the Content-Type header for the batch - it contains the changeset marker right after the occurence of "boundary="
-            size_t content_typeOffset = response_body.find(content_type);
-            size_t changeset_begin_offset = response_body.find(boundary_begin, content_typeOffset) + boundary_begin.size();
-            size_t changeset_end_offset = response_body.find(crlf, changeset_begin_offset);
-
-            std::string changeset_marker_prefix = "--" + response_body.substr(changeset_begin_offset, changeset_end_offset - changeset_begin_offset);
-            std::string changeset_begin_marker = changeset_marker_prefix + crlf;
 
-            size_t result_index = SIZE_MAX;
-
-            // Loop through the response looking for changeset begin markers.
-            size_t next_changeset = response_body.find(changeset_begin_marker, changeset_end_offset);
-
-            while(next_changeset != std::string::npos)
+            has_part = reader.read_next_part(delimiter);
+            if (has_part)
             {
-                ++result_index;
-                // Find the HTTP status line
-                size_t response_begin = response_body.find(http_begin, next_changeset + changeset_begin_marker.size());
-
-                // Find the status code within that line
-                size_t status_code_begin = response_body.find(space, response_begin) + space.size();
-                size_t status_code_end = response_body.find(space, status_code_begin);
-                std::string status_code_string = response_body.substr(status_code_begin, status_code_end - status_code_begin);
-
-                // Extract the status code as an integer
-                int status_code = utility::conversions::details::scan_string<int>(utility::conversions::to_string_t(status_code_string));
-
-                // Acceptable codes are 'Created' and 'NoContent'
-                if (status_code == web::http::status_codes::OK || status_code == web::http::status_codes::Created || status_code == web::http::status_codes::Accepted || status_code == web::http::status_codes::NoContent || status_code == web::http::status_codes::PartialContent)
-                {
-                    table_result result;
-                    result.set_http_status_code(status_code);
-
-                    // The operation succeeded. Try to find an ETag: header if it exists. Delete operations will not have an etag header
-                    // so copy the list of headers into a substring and search within the list, lest we cross a changeset boundary.
-                    size_t headersBegin = response_body.find(crlf, status_code_end) + crlf.size();
-                    size_t headersEnd = response_body.find(crlfcrlf, headersBegin) + crlf.size();
-                    std::string headers = response_body.substr(headersBegin, headersEnd - headersBegin);
-
-                    size_t etagBegin = headers.find(etag_header);
-                    if (etagBegin != std::string::npos)
-                    {
-                        etagBegin += etag_header.size();
-                        size_t etagEnd = headers.find(crlf, etagBegin);
-                        std::string etag = headers.substr(etagBegin, etagEnd - etagBegin);
-
-                        result.set_etag(utility::conversions::to_string_t(etag));
-                    }
-
-                    batch_result.push_back(result);
-
-                    next_changeset = response_body.find(changeset_begin_marker, headersEnd);
-                }
-                else
-                {
-                    size_t status_message_begin = status_code_end + space.size();
-                    size_t status_message_end = response_body.find(crlf, status_message_begin);
-
-                    std::string status_message = response_body.substr(status_message_begin, status_message_end - status_message_begin);
-
-                    // An operation failed. Find the start of the XML block that contains information about the error
-                    size_t content_begin_offset = response_body.find(crlfcrlf, status_message_end) + crlfcrlf.size();
-                    size_t content_end_offset = response_body.find(changeset_marker_prefix, content_begin_offset);
-
-                    std::string error_string = response_body.substr(content_begin_offset, content_end_offset - content_begin_offset);
-
-                    web::json::value document = web::json::value::parse(utility::conversions::to_string_t(error_string));
-                    storage_extended_error extended_error = protocol::parse_table_error(document);
-                    request_result request_result(utility::datetime(), storage_location::unspecified, response, (web::http::status_code) status_code, extended_error);
-                    throw storage_exception(status_message, request_result);
-                }
+                reader.read_part_headers();
             }
         }
 
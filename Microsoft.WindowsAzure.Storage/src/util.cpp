@@ -266,7 +266,9 @@ namespace azure { namespace storage {  namespace core {
 
     utility::string_t convert_to_string(double value)
     {
+        // The C locale is used so that the text sent to the service does not depend on the application's global locale
         utility::ostringstream_t buffer;
+        buffer.imbue(std::locale::classic());
         buffer.precision(std::numeric_limits<double>::digits10 + 2);
         buffer << value;
         return buffer.str();
@@ -292,6 +294,24 @@ namespace azure { namespace storage {  namespace core {
         return source;
     }
 
+    void append_utf8(std::string& buffer, const utility::string_t& value)
+    {
+#ifdef _WIN32
+        buffer.append(utility::conversions::to_utf8string(value));
+#else
+        buffer.append(value);
+#endif
+    }
+
+    void append_from_utf8(utility::string_t& buffer, const std::string& value)
+    {
+#ifdef _WIN32
+        buffer.append(utility::conversions::to_string_t(value));
+#else
+        buffer.append(value);
+#endif
+    }
+
     utility::string_t convert_to_iso8601_string(const utility::datetime& value, int num_decimal_digits)
     {
         if (!value.is_initialized())
@@ -39,6 +39,26 @@ xml_text_reader_wrapper::xml_text_reader_wrapper(const unsigned char * buffer, u
     m_reader = xmlReaderForMemory((const char*)buffer, size, NULL, 0, 0);
 }
 
+xml_text_reader_wrapper::xml_text_reader_wrapper(concurrency::streams::istream stream)
+    : m_stream(std::move(stream))
+{
+    m_reader = xmlReaderForIO(&xml_text_reader_wrapper::read_stream, NULL, &m_stream, NULL, NULL, 0);
+}
+
+int xml_text_reader_wrapper::read_stream(void* context, char* buffer, int length)
+{
+    auto stream = static_cast<concurrency::streams::istream*>(context);
+    try
+    {
+        return static_cast<int>(stream->streambuf().getn(reinterpret_cast<uint8_t*>(buffer), static_cast<size_t>(length)).get());
+    }
+    catch (const std::exception&)
+    {
+        // libxml2 treats a negative count as a read error and stops parsing.
+        return -1;
+    }
+}
+
 xml_text_reader_wrapper::~xml_text_reader_wrapper()
 {
     if (m_reader != nullptr)
@@ -65,13 +85,14 @@ bool xml_text_reader_wrapper::is_empty_element()
 
 std::string xml_text_reader_wrapper::get_local_name()
 {
-    auto xml_char = xmlTextReaderLocalName(m_reader);
-    std::string result; 
+    // The const accessors return strings owned by the reader, so the result is built directly from them
+    // without an intermediate heap copy that has to be freed again.
+    auto xml_char = xmlTextReaderConstLocalName(m_reader);
+    std::string result;
 
     if (xml_char != nullptr)
     {
         result = xml_char_to_string(xml_char);
-        xmlFree(xml_char);
     }
 
     return result;
@@ -79,13 +100,12 @@ std::string xml_text_reader_wrapper::get_local_name()
 
 std::string xml_text_reader_wrapper::get_value()
 {
-    auto xml_char = xmlTextReaderValue(m_reader);
+    auto xml_char = xmlTextReaderConstValue(m_reader);
     std::string result;
 
     if (xml_char != nullptr)
     {
         result = xml_char_to_string(xml_char);
-        xmlFree(xml_char);
     }
     return result;
 }
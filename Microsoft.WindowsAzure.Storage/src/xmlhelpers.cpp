@@ -41,6 +41,7 @@
 
 #include "stdafx.h"
 #include "wascore/xmlhelpers.h"
+#include "wascore/resources.h"
 
 #ifdef _WIN32
 #include "wascore/xmlstream.h"
@@ -58,6 +59,84 @@ using namespace concurrency;
 
 namespace azure { namespace storage { namespace core { namespace xml {
 
+    namespace
+    {
+        // Parses the leading integer of the text the same way std::stoll and std::stoull do: leading whitespace is
+        // skipped, an optional sign is accepted and parsing stops at the first non-digit. Text without any digits
+        // and magnitudes that do not fit into 64 bits are rejected as a malformed response, which is not retried.
+        uint64_t parse_integer_text(const utility::string_t& text, bool& negative)
+        {
+            auto iter = text.cbegin();
+            while (iter != text.cend() && (*iter == _XPLATSTR(' ') || *iter == _XPLATSTR('\t') || *iter == _XPLATSTR('\r') || *iter == _XPLATSTR('\n')))
+            {
+                ++iter;
+            }
+
+            negative = false;
+            if (iter != text.cend() && (*iter == _XPLATSTR('-') || *iter == _XPLATSTR('+')))
+            {
+                negative = *iter == _XPLATSTR('-');
+                ++iter;
+            }
+
+            if (iter == text.cend() || *iter < _XPLATSTR('0') || *iter > _XPLATSTR('9'))
+            {
+                throw storage_exception(protocol::error_xml_integer_not_valid, false);
+            }
+
+            uint64_t result = 0;
+            for (; iter != text.cend() && *iter >= _XPLATSTR('0') && *iter <= _XPLATSTR('9'); ++iter)
+            {
+                auto digit = static_cast<uint64_t>(*iter - _XPLATSTR('0'));
+                if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+                {
+                    throw storage_exception(protocol::error_xml_integer_not_valid, false);
+                }
+
+                result = result * 10 + digit;
+            }
+
+            return result;
+        }
+    }
+
+    void xml_reader::extract_current_element(int64_t& value)
+    {
+        bool negative;
+        auto magnitude = parse_integer_text(get_current_element_text(), negative);
+        const auto max_magnitude = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        if (negative)
+        {
+            if (magnitude > max_magnitude + 1)
+            {
+                throw storage_exception(protocol::error_xml_integer_not_valid, false);
+            }
+
+            value = magnitude == max_magnitude + 1 ? std::numeric_limits<int64_t>::min() : -static_cast<int64_t>(magnitude);
+        }
+        else
+        {
+            if (magnitude > max_magnitude)
+            {
+                throw storage_exception(protocol::error_xml_integer_not_valid, false);
+            }
+
+            value = static_cast<int64_t>(magnitude);
+        }
+    }
+
+    void xml_reader::extract_current_element(uint64_t& value)
+    {
+        bool negative;
+        auto magnitude = parse_integer_text(get_current_element_text(), negative);
+        if (negative)
+        {
+            throw storage_exception(protocol::error_xml_integer_not_valid, false);
+        }
+
+        value = magnitude;
+    }
+
     void xml_reader::initialize(streams::istream stream)
     {
 #ifdef _WIN32
@@ -96,13 +175,8 @@ namespace azure { namespace storage { namespace core { namespace xml {
             throw utility::details::create_system_error(error);
         }
 #else
-        concurrency::streams::stringstreambuf buffer;
-        stream.read_to_end(buffer).get();
-        m_data = buffer.collection();
-        if (m_data.empty())
-            m_reader.reset();
-        else
-            m_reader.reset(new xml_text_reader_wrapper(reinterpret_cast<const unsigned char*>(m_data.data()), static_cast<unsigned int>(m_data.size())));
+        // libxml2 pulls the body from the stream as it parses, so the document is never copied into a buffer of its own.
+        m_reader.reset(new xml_text_reader_wrapper(stream));
 #endif
     }
 
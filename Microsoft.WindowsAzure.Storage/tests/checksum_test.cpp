@@ -110,4 +110,4 @@ SUITE(Core)
             CHECK_UTF8_EQUAL(cs.hmac_sha256(), hmac_sha256_str);
         }
     }
-}
\ No newline at end of file
+}
@@ -369,4 +369,56 @@ SUITE(Blob)
             CHECK_EQUAL("", ex_msg);
         }
     }
+
+    TEST_FIXTURE(blob_test_base, blob_batch)
+    {
+        std::vector<azure::storage::cloud_block_blob> blobs;
+        std::vector<pplx::task<void>> uploads;
+        for (int i = 0; i < 300; ++i)
+        {
+            auto blob = m_container.get_block_blob_reference(_XPLATSTR("blob") + azure::storage::core::convert_to_string(i));
+            blobs.push_back(blob);
+            uploads.push_back(blob.upload_text_async(_XPLATSTR("content"), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context));
+        }
+        pplx::when_all(uploads.begin(), uploads.end()).wait();
+
+        {
+            azure::storage::blob_batch_operation operation;
+            operation.set_standard_blob_tier(blobs[0], azure::storage::standard_blob_tier::cool);
+            operation.delete_blob(blobs[1]);
+            operation.delete_blob(m_container.get_block_blob_reference(_XPLATSTR("missing")));
+
+            auto results = m_client.execute_batch(operation, azure::storage::blob_request_options(), m_context);
+            CHECK_EQUAL(3U, results.size());
+            CHECK(results[0].succeeded());
+            CHECK(results[1].succeeded());
+            CHECK(!results[2].succeeded());
+            CHECK_EQUAL(web::http::status_codes::NotFound, results[2].http_status_code());
+            CHECK(_XPLATSTR("BlobNotFound") == results[2].extended_error().code());
+
+            blobs[0].download_attributes(azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+            CHECK(azure::storage::standard_blob_tier::cool == blobs[0].properties().standard_blob_tier());
+            CHECK(!blobs[1].exists(azure::storage::blob_request_options(), m_context));
+        }
+
+        azure::storage::blob_batch_operation operation;
+        for (size_t i = 2; i < blobs.size(); ++i)
+        {
+            operation.delete_blob(blobs[i]);
+        }
+        CHECK_THROW(m_client.execute_batch(operation, azure::storage::blob_request_options(), m_context), std::invalid_argument);
+        CHECK_THROW(m_client.execute_batch(azure::storage::blob_batch_operation(), azure::storage::blob_request_options(), m_context), std::invalid_argument);
+
+        azure::storage::blob_request_options options;
+        options.set_parallelism_factor(2);
+        auto results = m_client.execute_bulk_batch(operation, options, m_context);
+        CHECK_EQUAL(operation.size(), results.size());
+        for (auto it = results.cbegin(); it != results.cend(); ++it)
+        {
+            CHECK(it->succeeded());
+        }
+
+        CHECK(m_container.list_blobs_segmented(utility::string_t(), true, azure::storage::blob_listing_details::none, 0, azure::storage::continuation_token(), azure::storage::blob_request_options(), m_context).results().size() == 1U);
+        CHECK_THROW(operation.set_standard_blob_tier(azure::storage::cloud_blob(blobs[2].uri(), _XPLATSTR("2019-01-01T00:00:00.0000000Z"), m_client.credentials()), azure::storage::standard_blob_tier::hot), std::invalid_argument);
+    }
 }
@@ -19,9 +19,13 @@
 #include "blob_test_base.h"
 #include "check_macros.h"
 
+#include "wascore/protocol.h"
+#include "wascore/protocol_xml.h"
 #include "wascore/util.h"
 #include "cpprest/asyncrt_utils.h"
 
+#include <set>
+
 #pragma region Fixture
 
 void container_test_base::check_public_access(azure::storage::blob_container_public_access_type access)
@@ -90,6 +94,21 @@ std::vector<azure::storage::cloud_blob> container_test_base::list_all_blobs(cons
 
 #pragma endregion
 
+namespace
+{
+    azure::storage::protocol::cloud_blob_list_item parse_single_blob(const std::string& content_length, const std::string& sequence_number)
+    {
+        std::string body = "<?xml version=\"1.0\" encoding=\"utf-8\"?><EnumerationResults ServiceEndpoint=\"https://account.blob.core.windows.net/\" ContainerName=\"container\">"
+            "<Blobs><Blob><Name>blob</Name><Properties><Last-Modified>Sun, 06 Nov 1994 08:49:37 GMT</Last-Modified>"
+            "<Content-Length>" + content_length + "</Content-Length><x-ms-blob-sequence-number>" + sequence_number + "</x-ms-blob-sequence-number>"
+            "<BlobType>PageBlob</BlobType></Properties></Blob></Blobs><NextMarker /></EnumerationResults>";
+        azure::storage::protocol::list_blobs_reader reader(concurrency::streams::bytestream::open_istream(body));
+        auto items = reader.move_blob_items();
+        CHECK_EQUAL(1U, items.size());
+        return std::move(items.front());
+    }
+}
+
 SUITE(Blob)
 {
     TEST_FIXTURE(container_test_base, container_get_reference)
@@ -354,6 +373,184 @@ SUITE(Blob)
         CHECK_EQUAL(0U, blobs.size());
     }
 
+    TEST_FIXTURE(container_test_base, container_list_blobs_with_callback)
+    {
+        m_container.create(azure::storage::blob_container_public_access_type::off, azure::storage::blob_request_options(), m_context);
+        std::set<utility::string_t> blob_names;
+
+        for (int i = 0; i < 5; i++)
+        {
+            auto blob = m_container.get_block_blob_reference(_XPLATSTR("dir") + azure::storage::core::convert_to_string(i % 2) + _XPLATSTR("/blockblob") + azure::storage::core::convert_to_string(i));
+            blob.metadata()[_XPLATSTR("index")] = azure::storage::core::convert_to_string(i);
+            blob.upload_text(_XPLATSTR("test"), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+            blob_names.insert(blob.name());
+        }
+
+        std::set<utility::string_t> listed_names;
+        azure::storage::continuation_token token;
+        do
+        {
+            token = m_container.list_blobs_segmented(utility::string_t(), true, azure::storage::blob_listing_details::metadata, 2, token, [&listed_names] (azure::storage::list_blob_item item)
+            {
+                CHECK(item.is_blob());
+                auto blob = item.as_blob();
+                CHECK_EQUAL(4U, blob.properties().size());
+                CHECK(blob.metadata().find(_XPLATSTR("index")) != blob.metadata().end());
+                listed_names.insert(blob.name());
+            }, azure::storage::blob_request_options(), m_context);
+        } while (!token.empty());
+
+        CHECK(blob_names == listed_names);
+
+        std::set<utility::string_t> directory_names;
+        m_container.list_blobs_segmented(utility::string_t(), false, azure::storage::blob_listing_details::none, 0, azure::storage::continuation_token(), [&directory_names] (azure::storage::list_blob_item item)
+        {
+            CHECK(!item.is_blob());
+            directory_names.insert(item.as_directory().prefix());
+        }, azure::storage::blob_request_options(), m_context);
+
+        CHECK_EQUAL(2U, directory_names.size());
+        CHECK(directory_names.find(_XPLATSTR("dir0/")) != directory_names.end());
+        CHECK(directory_names.find(_XPLATSTR("dir1/")) != directory_names.end());
+    }
+
+    TEST_FIXTURE(container_test_base, container_list_blobs_with_callback_retry)
+    {
+        m_container.create(azure::storage::blob_container_public_access_type::off, azure::storage::blob_request_options(), m_context);
+        std::vector<utility::string_t> blob_names;
+
+        for (int i = 0; i < 5; i++)
+        {
+            auto blob = m_container.get_block_blob_reference(_XPLATSTR("blockblob") + azure::storage::core::convert_to_string(i));
+            blob.upload_text(_XPLATSTR("test"), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+            blob_names.push_back(blob.name());
+        }
+
+        azure::storage::blob_request_options options;
+        options.set_retry_policy(azure::storage::linear_retry_policy(std::chrono::seconds(1), 1));
+
+        // A callback failure ends the listing without a retry and is reported as is
+        std::vector<utility::string_t> listed_names;
+        azure::storage::operation_context context;
+        CHECK_THROW(m_container.list_blobs_segmented(utility::string_t(), true, azure::storage::blob_listing_details::none, 0, azure::storage::continuation_token(), [&listed_names] (azure::storage::list_blob_item item)
+        {
+            if (listed_names.size() == 2)
+            {
+                throw std::runtime_error("callback failure");
+            }
+
+            listed_names.push_back(item.as_blob().name());
+        }, options, context), std::runtime_error);
+
+        CHECK_EQUAL(1U, context.request_results().size());
+        CHECK_EQUAL(2U, listed_names.size());
+        CHECK(std::vector<utility::string_t>(blob_names.begin(), blob_names.begin() + 2) == listed_names);
+
+        // Without failures, every blob is delivered once
+        listed_names.clear();
+        auto token = m_container.list_blobs_segmented(utility::string_t(), true, azure::storage::blob_listing_details::none, 0, azure::storage::continuation_token(), [&listed_names] (azure::storage::list_blob_item item)
+        {
+            listed_names.push_back(item.as_blob().name());
+        }, options, m_context);
+
+        CHECK(token.empty());
+        CHECK(blob_names == listed_names);
+    }
+
+    TEST_FIXTURE(container_test_base, container_list_blobs_parallel)
+    {
+        m_container.create(azure::storage::blob_container_public_access_type::off, azure::storage::blob_request_options(), m_context);
+
+        const utility::string_t names[] = { _XPLATSTR("a"), _XPLATSTR("a-b"), _XPLATSTR("a/b/c"), _XPLATSTR("a/b/d"), _XPLATSTR("a/c"), _XPLATSTR("b/a"), _XPLATSTR("b/b/a"), _XPLATSTR("c") };
+        for (const auto& name : names)
+        {
+            m_container.get_block_blob_reference(name).upload_text(_XPLATSTR("test"), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        }
+
+        std::vector<utility::string_t> flat_names;
+        for (auto iter = m_container.list_blobs(utility::string_t(), true, azure::storage::blob_listing_details::none, 0, azure::storage::blob_request_options(), m_context); iter != azure::storage::list_blob_item_iterator(); ++iter)
+        {
+            flat_names.push_back(iter->as_blob().name());
+        }
+
+        CHECK_EQUAL(8U, flat_names.size());
+
+        azure::storage::blob_request_options options;
+        options.set_parallelism_factor(4);
+
+        std::vector<utility::string_t> ordered_names;
+        m_container.list_blobs_parallel(utility::string_t(), azure::storage::blob_listing_details::none, true, [&ordered_names] (azure::storage::list_blob_item item)
+        {
+            CHECK(item.is_blob());
+            ordered_names.push_back(item.as_blob().name());
+        }, options, m_context);
+
+        CHECK(flat_names == ordered_names);
+
+        std::set<utility::string_t> unordered_names;
+        m_container.list_blobs_parallel(_XPLATSTR("a/"), azure::storage::blob_listing_details::metadata, false, [&unordered_names] (azure::storage::list_blob_item item)
+        {
+            CHECK(item.is_blob());
+            unordered_names.insert(item.as_blob().name());
+        }, options, m_context);
+
+        CHECK_EQUAL(3U, unordered_names.size());
+        CHECK(unordered_names.find(_XPLATSTR("a/b/d")) != unordered_names.end());
+
+        CHECK_THROW(m_container.list_blobs_parallel(utility::string_t(), azure::storage::blob_listing_details::snapshots, true, [] (azure::storage::list_blob_item) {}, options, m_context), std::invalid_argument);
+    }
+
+    TEST_FIXTURE(container_test_base, container_list_blob_records)
+    {
+        m_container.create(azure::storage::blob_container_public_access_type::off, azure::storage::blob_request_options(), m_context);
+        std::map<utility::string_t, azure::storage::cloud_block_blob> blobs;
+
+        for (int i = 0; i < 4; i++)
+        {
+            auto index = azure::storage::core::convert_to_string(i);
+            auto blob = m_container.get_block_blob_reference(_XPLATSTR("dir/blockblob") + index);
+            blob.metadata()[_XPLATSTR("index")] = index;
+            blob.upload_text(_XPLATSTR("test") + index, azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+            blobs[blob.name()] = blob;
+        }
+
+        size_t count = 0;
+        azure::storage::continuation_token token;
+        do
+        {
+            auto segment = m_container.list_blob_records_segmented(utility::string_t(), azure::storage::blob_listing_details::metadata, 3, token, azure::storage::blob_request_options(), m_context);
+            for (const auto& record : segment.results())
+            {
+                auto iter = blobs.find(record.name());
+                CHECK(iter != blobs.end());
+                CHECK(record.name() == iter->first);
+                CHECK_EQUAL(iter->first.size(), record.name().size());
+                CHECK_EQUAL(iter->second.properties().size(), record.size());
+                CHECK_UTF8_EQUAL(iter->second.properties().etag(), record.etag());
+                CHECK(iter->second.properties().last_modified() == record.last_modified());
+                CHECK_UTF8_EQUAL(iter->second.properties().content_md5(), record.content_md5());
+                CHECK(record.snapshot_time().empty());
+                CHECK_UTF8_EQUAL(iter->second.metadata()[_XPLATSTR("index")], record.metadata().at(_XPLATSTR("index")));
+                CHECK_EQUAL(1U, record.metadata_size());
+                CHECK_UTF8_EQUAL(_XPLATSTR("index"), record.metadata_name(0));
+                CHECK_UTF8_EQUAL(iter->second.metadata()[_XPLATSTR("index")], record.metadata_value(0));
+                CHECK_THROW(record.metadata_name(1), std::out_of_range);
+
+                auto blob = record.as_blob(m_container);
+                CHECK_UTF8_EQUAL(iter->second.name(), blob.name());
+                CHECK(iter->second.uri().primary_uri() == blob.uri().primary_uri());
+                CHECK_EQUAL(record.size(), blob.properties().size());
+                CHECK_UTF8_EQUAL(record.etag(), blob.properties().etag());
+                CHECK_EQUAL(1U, blob.metadata().size());
+                count++;
+            }
+
+            token = segment.continuation_token();
+        } while (!token.empty());
+
+        CHECK_EQUAL(blobs.size(), count);
+    }
+
     TEST_FIXTURE(container_test_base, container_list_premium_blobs)
     {
         //preparation
@@ -820,4 +1017,68 @@ SUITE(Blob)
             CHECK_EQUAL("", ex_msg);
         }
     }
+
+    TEST(xml_integer_parsing)
+    {
+        {
+            auto properties = parse_single_blob("1024", "-7").move_properties();
+            CHECK_EQUAL(1024U, properties.size());
+            CHECK_EQUAL(-7, properties.page_blob_sequence_number());
+        }
+
+        {
+            auto properties = parse_single_blob(" 18446744073709551615", "-9223372036854775808").move_properties();
+            CHECK_EQUAL(std::numeric_limits<utility::size64_t>::max(), properties.size());
+            CHECK_EQUAL(std::numeric_limits<int64_t>::min(), properties.page_blob_sequence_number());
+        }
+
+        {
+            auto properties = parse_single_blob("+0", "9223372036854775807").move_properties();
+            CHECK_EQUAL(0U, properties.size());
+            CHECK_EQUAL(std::numeric_limits<int64_t>::max(), properties.page_blob_sequence_number());
+        }
+
+        CHECK_THROW(parse_single_blob("18446744073709551616", "0"), azure::storage::storage_exception);
+        CHECK_THROW(parse_single_blob("0", "9223372036854775808"), azure::storage::storage_exception);
+        CHECK_THROW(parse_single_blob("0", "-9223372036854775809"), azure::storage::storage_exception);
+        CHECK_THROW(parse_single_blob("-5", "0"), azure::storage::storage_exception);
+        CHECK_THROW(parse_single_blob("abc", "0"), azure::storage::storage_exception);
+
+        // A malformed response is not fixed by sending the request again
+        try
+        {
+            parse_single_blob("abc", "0");
+        }
+        catch (const azure::storage::storage_exception& e)
+        {
+            CHECK(!e.retryable());
+        }
+    }
+
+    TEST(rfc1123_date_parsing)
+    {
+        const utility::string_t dates[] =
+        {
+            _XPLATSTR("Thu, 01 Jan 1970 00:00:00 GMT"),
+            _XPLATSTR("Sun, 06 Nov 1994 08:49:37 GMT"),
+            _XPLATSTR("Tue, 29 Feb 2000 12:00:01 GMT"),
+            _XPLATSTR("Thu, 29 Feb 2024 23:59:59 GMT"),
+            _XPLATSTR("Mon, 01 Jan 2001 00:00:00 GMT"),
+        };
+
+        for (const auto& date : dates)
+        {
+            auto expected = utility::datetime::from_string(date, utility::datetime::date_format::RFC_1123);
+            CHECK(expected.is_initialized());
+            CHECK(expected == azure::storage::protocol::parse_datetime_rfc1123(date));
+            CHECK(date == azure::storage::protocol::parse_datetime_rfc1123(date).to_string(utility::datetime::date_format::RFC_1123));
+        }
+
+        // Forms other than the fixed-width service format go through the general purpose parser
+        const utility::string_t other_date(_XPLATSTR("Sun, 6 Nov 1994 08:49:37 GMT"));
+        CHECK(utility::datetime::from_string(other_date, utility::datetime::date_format::RFC_1123) == azure::storage::protocol::parse_datetime_rfc1123(other_date));
+
+        auto properties = parse_single_blob("0", "0").move_properties();
+        CHECK(utility::datetime::from_string(_XPLATSTR("Sun, 06 Nov 1994 08:49:37 GMT"), utility::datetime::date_format::RFC_1123) == properties.last_modified());
+    }
 }
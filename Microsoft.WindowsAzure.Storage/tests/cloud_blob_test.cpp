@@ -22,6 +22,7 @@
 
 #include "cpprest/producerconsumerstream.h"
 
+#include "wascore/protocol.h"
 #include "wascore/util.h"
 
 #pragma region Fixture
@@ -731,6 +732,92 @@ SUITE(Blob)
         CHECK_THROW(copy2.start_copy(blob, azure::storage::access_condition::generate_if_match_condition(blob.properties().etag()), azure::storage::access_condition::generate_if_match_condition(_XPLATSTR("\"0xFFFFFFFFFFFFFFF\"")), azure::storage::blob_request_options(), m_context), azure::storage::storage_exception);
     }
 
+    TEST_FIXTURE(blob_test_base, blob_copy_orchestrator)
+    {
+        auto blob = m_container.get_block_blob_reference(_XPLATSTR("blob"));
+        blob.upload_text(_XPLATSTR("content"), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+
+        azure::storage::cloud_copy_orchestrator orchestrator(2, std::chrono::milliseconds(100), std::chrono::milliseconds(2000));
+
+        std::vector<azure::storage::cloud_block_blob> copies;
+        std::vector<pplx::task<azure::storage::copy_state>> tasks;
+        for (int i = 0; i < 5; ++i)
+        {
+            auto copy = m_container.get_block_blob_reference(_XPLATSTR("copy") + azure::storage::core::convert_to_string(i));
+            copies.push_back(copy);
+            tasks.push_back(orchestrator.start_copy_async(copy, blob, azure::storage::blob_request_options(), m_context));
+        }
+
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            auto state = tasks[i].get();
+            CHECK(azure::storage::copy_status::success == state.status());
+            CHECK(!state.copy_id().empty());
+            CHECK(_XPLATSTR("content") == copies[i].download_text(azure::storage::access_condition(), azure::storage::blob_request_options(), m_context));
+        }
+        CHECK_EQUAL(0U, orchestrator.pending_count());
+
+        auto failed = orchestrator.start_copy_async([] () -> pplx::task<azure::storage::copy_state>
+        {
+            throw std::runtime_error("start");
+        }, [] ()
+        {
+            return pplx::task_from_result(azure::storage::copy_state());
+        });
+        CHECK_THROW(failed.get(), std::runtime_error);
+        CHECK_EQUAL(0U, orchestrator.pending_count());
+
+        // A pending copy is polled until it completes, less often while it makes little or no progress
+        auto make_state = [] (const utility::string_t& status, const utility::string_t& progress) -> azure::storage::copy_state
+        {
+            web::http::http_response response(web::http::status_codes::OK);
+            response.headers().add(azure::storage::protocol::ms_header_copy_status, status);
+            response.headers().add(azure::storage::protocol::ms_header_copy_progress, progress);
+            return azure::storage::protocol::response_parsers::parse_copy_state(response);
+        };
+
+        auto check_times = std::make_shared<std::vector<std::chrono::steady_clock::time_point>>();
+        azure::storage::cloud_copy_orchestrator polling_orchestrator(1, std::chrono::milliseconds(50), std::chrono::milliseconds(5000));
+        auto polled = polling_orchestrator.start_copy_async([check_times, make_state] () -> pplx::task<azure::storage::copy_state>
+        {
+            check_times->push_back(std::chrono::steady_clock::now());
+            return pplx::task_from_result(make_state(azure::storage::protocol::header_value_copy_pending, _XPLATSTR("0/1000")));
+        }, [check_times, make_state] () -> pplx::task<azure::storage::copy_state>
+        {
+            check_times->push_back(std::chrono::steady_clock::now());
+            switch (check_times->size())
+            {
+            case 2:
+                return pplx::task_from_result(make_state(azure::storage::protocol::header_value_copy_pending, _XPLATSTR("10/1000")));
+            case 3:
+            case 4:
+                return pplx::task_from_result(make_state(azure::storage::protocol::header_value_copy_pending, _XPLATSTR("20/1000")));
+            default:
+                return pplx::task_from_result(make_state(azure::storage::protocol::header_value_copy_success, _XPLATSTR("1000/1000")));
+            }
+        });
+        CHECK_EQUAL(1U, polling_orchestrator.pending_count());
+
+        auto polled_state = polled.get();
+        CHECK(azure::storage::copy_status::success == polled_state.status());
+        CHECK_EQUAL(1000, polled_state.bytes_copied());
+        CHECK_EQUAL(1000, polled_state.total_bytes());
+        CHECK_EQUAL(0U, polling_orchestrator.pending_count());
+
+        // The copy was started once and checked four times, each time later than the last
+        CHECK_EQUAL(5U, check_times->size());
+        std::chrono::steady_clock::duration previous_interval = std::chrono::milliseconds(40);
+        for (size_t i = 1; i < check_times->size(); ++i)
+        {
+            std::chrono::steady_clock::duration interval = (*check_times)[i] - (*check_times)[i - 1];
+            CHECK(interval > previous_interval);
+            previous_interval = interval;
+        }
+
+        CHECK_THROW(azure::storage::cloud_copy_orchestrator(0), std::invalid_argument);
+        CHECK_THROW(azure::storage::cloud_copy_orchestrator(1, std::chrono::milliseconds(1000), std::chrono::milliseconds(100)), std::invalid_argument);
+    }
+
     TEST_FIXTURE(blob_test_base, blob_copy_with_premium_access_tier)
     {
         m_premium_container.create(azure::storage::blob_container_public_access_type::off, azure::storage::blob_request_options(), m_context);
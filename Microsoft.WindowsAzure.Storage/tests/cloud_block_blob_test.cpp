@@ -1922,4 +1922,55 @@ SUITE(Blob)
             }
         }
     }
+
+    TEST_FIXTURE(block_blob_test_base, block_blob_copy_from_blob)
+    {
+        utility::size64_t length = 3 * 1024 * 1024 + 1234;
+        std::vector<uint8_t> buffer(static_cast<size_t>(length));
+        fill_buffer(buffer);
+
+        auto source = m_container.get_block_blob_reference(_XPLATSTR("source"));
+        source.properties().set_content_type(_XPLATSTR("application/octet-stream"));
+        source.metadata()[_XPLATSTR("key")] = _XPLATSTR("value");
+        source.upload_from_stream(concurrency::streams::bytestream::open_istream(buffer), length, azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+
+        azure::storage::blob_shared_access_policy access_policy;
+        access_policy.set_expiry(utility::datetime::utc_now() + utility::datetime::from_minutes(30));
+        access_policy.set_permissions(azure::storage::blob_shared_access_policy::read);
+        azure::storage::cloud_block_blob sas_source(source.uri(), azure::storage::storage_credentials(source.get_shared_access_signature(access_policy)));
+
+        azure::storage::blob_request_options options;
+        options.set_stream_write_size_in_bytes(1024 * 1024);
+        options.set_parallelism_factor(3);
+        m_blob.copy_from_blob(sas_source, azure::storage::access_condition(), azure::storage::access_condition(), options, m_context);
+
+        CHECK_EQUAL(4U, m_blob.download_block_list(azure::storage::block_listing_filter::committed, azure::storage::access_condition(), azure::storage::blob_request_options(), m_context).size());
+        concurrency::streams::container_buffer<std::vector<uint8_t>> download_buffer;
+        m_blob.download_to_stream(concurrency::streams::ostream(download_buffer), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        CHECK(buffer == download_buffer.collection());
+        CHECK(_XPLATSTR("application/octet-stream") == m_blob.properties().content_type());
+        CHECK(_XPLATSTR("value") == m_blob.metadata()[_XPLATSTR("key")]);
+
+        // The blocks of a leased destination are staged under the lease given in the destination condition
+        auto leased = m_container.get_block_blob_reference(_XPLATSTR("leased"));
+        leased.upload_text(_XPLATSTR(""), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        azure::storage::access_condition lease_condition;
+        lease_condition.set_lease_id(leased.acquire_lease(azure::storage::lease_time(), _XPLATSTR("")));
+        leased.copy_from_blob(sas_source, azure::storage::access_condition(), lease_condition, options, m_context);
+        concurrency::streams::container_buffer<std::vector<uint8_t>> leased_buffer;
+        leased.download_to_stream(concurrency::streams::ostream(leased_buffer), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        CHECK(buffer == leased_buffer.collection());
+        leased.release_lease(lease_condition, azure::storage::blob_request_options(), m_context);
+
+        auto source_uri = sas_source.service_client().credentials().transform_uri(sas_source.uri().primary_uri());
+        auto block_id = get_block_id(0);
+        auto partial = m_container.get_block_blob_reference(_XPLATSTR("partial"));
+        partial.upload_block_from_url(block_id, source_uri, 1024, 4096, azure::storage::checksum_none, azure::storage::access_condition(), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        partial.upload_block_list(std::vector<azure::storage::block_list_item>(1, azure::storage::block_list_item(block_id)), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        concurrency::streams::container_buffer<std::vector<uint8_t>> partial_buffer;
+        partial.download_to_stream(concurrency::streams::ostream(partial_buffer), azure::storage::access_condition(), azure::storage::blob_request_options(), m_context);
+        CHECK(std::vector<uint8_t>(buffer.begin() + 1024, buffer.begin() + 1024 + 4096) == partial_buffer.collection());
+
+        CHECK_THROW(partial.upload_block_from_url(block_id, source_uri, 0, 0, azure::storage::checksum_none), std::invalid_argument);
+    }
 }
@@ -21,6 +21,8 @@
 
 #include "wascore/util.h"
 
+#include <set>
+
 #pragma region Fixture
 
 #pragma endregion
@@ -365,6 +367,64 @@ SUITE(File)
         CHECK(files.empty());
     }
 
+    TEST_FIXTURE(file_directory_test_base, directory_list_and_delete_recursively)
+    {
+        m_directory.create_if_not_exists(azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
+
+        std::set<utility::string_t> expected_names;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto subdirectory = m_directory.get_subdirectory_reference(_XPLATSTR("dir") + azure::storage::core::convert_to_string(i));
+            subdirectory.create();
+            expected_names.insert(subdirectory.name());
+
+            for (int j = 0; j < 2; ++j)
+            {
+                auto nested = subdirectory.get_subdirectory_reference(_XPLATSTR("nested") + azure::storage::core::convert_to_string(i) + azure::storage::core::convert_to_string(j));
+                nested.create();
+                expected_names.insert(nested.name());
+
+                auto file = nested.get_file_reference(_XPLATSTR("file") + azure::storage::core::convert_to_string(i) + azure::storage::core::convert_to_string(j));
+                file.create(1);
+                expected_names.insert(file.name());
+            }
+
+            auto file = subdirectory.get_file_reference(_XPLATSTR("file") + azure::storage::core::convert_to_string(i));
+            file.create(1);
+            expected_names.insert(file.name());
+        }
+
+        azure::storage::file_request_options options;
+        options.set_parallelism_factor(4);
+
+        std::set<utility::string_t> listed_names;
+        m_directory.list_files_and_directories_recursively([&listed_names](const azure::storage::list_file_and_directory_item& item)
+        {
+            CHECK(listed_names.insert(item.name()).second);
+        }, options, m_context);
+        CHECK(expected_names == listed_names);
+
+        CHECK_THROW(m_directory.list_files_and_directories_recursively([](const azure::storage::list_file_and_directory_item&)
+        {
+            throw std::runtime_error("handler");
+        }, options, m_context), std::runtime_error);
+
+        m_directory.delete_directory_recursively(options, m_context);
+        CHECK(!m_directory.exists(azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context));
+
+        auto root_directory = m_share.get_root_directory_reference();
+        root_directory.get_file_reference(_XPLATSTR("file")).create(1);
+        root_directory.get_subdirectory_reference(_XPLATSTR("dir")).create();
+        root_directory.delete_directory_recursively(options, m_context);
+
+        size_t remaining_count = 0;
+        root_directory.list_files_and_directories_recursively([&remaining_count](const azure::storage::list_file_and_directory_item&)
+        {
+            ++remaining_count;
+        });
+        CHECK_EQUAL(0U, remaining_count);
+    }
+
     TEST_FIXTURE(file_directory_test_base, directory_get_directory_ref)
     {
         m_directory.create_if_not_exists(azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
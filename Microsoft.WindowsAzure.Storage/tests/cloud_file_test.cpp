@@ -21,6 +21,9 @@
 #include "blob_test_base.h"
 
 #include "wascore/util.h"
+#include "was/crc64.h"
+
+#include <atomic>
 
 #pragma region Fixture
 
@@ -488,6 +491,55 @@ SUITE(File)
         CHECK_ARRAY_EQUAL(original_file_buffer.collection(), downloaded_file_buffer.collection(), (int)downloaded_file_buffer.collection().size());
     }
 
+    TEST_FIXTURE(file_test_base, file_parallel_upload_from_file)
+    {
+        temp_file file(10 * 1024 * 1024 + 1000);
+
+        azure::storage::file_request_options options;
+        options.set_parallelism_factor(4);
+        options.set_use_transactional_crc64(true);
+
+        std::atomic<int> crc64_ranges(0);
+        m_context.set_sending_request([&crc64_ranges] (web::http::http_request& request, azure::storage::operation_context)
+        {
+            if (request.headers().has(azure::storage::protocol::ms_header_content_crc64))
+            {
+                ++crc64_ranges;
+            }
+        });
+
+        m_file.upload_from_file(file.path(), azure::storage::file_access_condition(), options, m_context);
+        CHECK_EQUAL(10 * 1024 * 1024 + 1000, m_file.properties().length());
+        CHECK_EQUAL(3, crc64_ranges.load());
+        m_context.set_sending_request(std::function<void(web::http::http_request &, azure::storage::operation_context)>());
+
+        options.set_use_transactional_crc64(false);
+        options.set_use_transactional_md5(true);
+        m_file.upload_from_file(file.path(), azure::storage::file_access_condition(), options, m_context);
+
+        temp_file file2(0);
+        m_file.download_to_file(file2.path(), azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> original_file_buffer;
+        auto original_file = concurrency::streams::file_stream<uint8_t>::open_istream(file.path()).get();
+        original_file.read_to_end(original_file_buffer).wait();
+        original_file.close().wait();
+
+        concurrency::streams::container_buffer<std::vector<uint8_t>> downloaded_file_buffer;
+        auto downloaded_file = concurrency::streams::file_stream<uint8_t>::open_istream(file2.path()).get();
+        downloaded_file.read_to_end(downloaded_file_buffer).wait();
+        downloaded_file.close().wait();
+
+        CHECK_EQUAL(original_file_buffer.collection().size(), downloaded_file_buffer.collection().size());
+        CHECK_ARRAY_EQUAL(original_file_buffer.collection(), downloaded_file_buffer.collection(), (int)downloaded_file_buffer.collection().size());
+
+        utility::string_t content = _XPLATSTR("content");
+        auto utf8_content = utility::conversions::to_utf8string(content);
+        uint64_t crc64 = azure::storage::crc64(reinterpret_cast<const uint8_t*>(utf8_content.data()), utf8_content.size());
+        m_file.write_range(concurrency::streams::bytestream::open_istream(utf8_content), 0, crc64, azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
+        CHECK_THROW(m_file.write_range(concurrency::streams::bytestream::open_istream(utf8_content), 0, azure::storage::checksum(azure::storage::checksum_crc64, 1), azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context), azure::storage::storage_exception);
+    }
+
     TEST_FIXTURE(file_test_base, file_range)
     {
         m_file.create_if_not_exists(2048, azure::storage::file_access_condition(), azure::storage::file_request_options(), m_context);
@@ -168,6 +168,46 @@ SUITE(Queue)
         CHECK(!message.insertion_time().is_initialized());
         CHECK(!message.next_visible_time().is_initialized());
         CHECK_EQUAL(0, message.dequeue_count());
+
+        // Copies share the data, and releasing it from one copy leaves the other intact
+        azure::storage::cloud_queue_message copy(message);
+        CHECK(copy.shared_content_as_binary() == message.shared_content_as_binary());
+        std::vector<uint8_t> released = message.release_content_as_binary();
+        CHECK_ARRAY_EQUAL(content, released, (int)content.size());
+        CHECK(message.content_as_binary().empty());
+        CHECK_ARRAY_EQUAL(content, copy.content_as_binary(), (int)content.size());
+
+        // Text content is decoded once and the decoded data is kept
+        azure::storage::cloud_queue_message text_message(copy.content_as_string());
+        std::shared_ptr<const std::vector<uint8_t>> decoded = text_message.shared_content_as_binary();
+        CHECK_ARRAY_EQUAL(content, *decoded, (int)content.size());
+        CHECK(decoded == text_message.shared_content_as_binary());
+
+        // Concurrent readers of a const message share the data decoded by one of them
+        const azure::storage::cloud_queue_message shared_message(copy.content_as_string());
+        std::vector<std::shared_ptr<const std::vector<uint8_t>>> results(4);
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            readers.push_back(std::thread([&shared_message, &results, i] ()
+            {
+                results[i] = shared_message.shared_content_as_binary();
+            }));
+        }
+
+        for (auto it = readers.begin(); it != readers.end(); ++it)
+        {
+            it->join();
+        }
+
+        for (auto it = results.cbegin(); it != results.cend(); ++it)
+        {
+            CHECK(*it == results.front());
+        }
+
+        CHECK_ARRAY_EQUAL(content, *results.front(), (int)content.size());
+        CHECK(copy.content_as_string() == text_message.release_content_as_string());
+        CHECK(text_message.content_as_string().empty());
     }
 
     TEST_FIXTURE(queue_service_test_base, Message_IdAndPopReceipt)
@@ -192,6 +232,10 @@ SUITE(Queue)
         azure::storage::queue_request_options options;
 
         CHECK(options.location_mode() == azure::storage::location_mode::primary_only);
+        CHECK_EQUAL(1, options.parallelism_factor());
+
+        options.set_parallelism_factor(16);
+        CHECK_EQUAL(16, options.parallelism_factor());
     }
 
     TEST_FIXTURE(queue_service_test_base, Queue_CreateAndDelete)
@@ -642,6 +686,249 @@ SUITE(Queue)
         queue.delete_queue();
     }
 
+    TEST_FIXTURE(queue_service_test_base, Queue_AddMessages)
+    {
+        azure::storage::cloud_queue queue = get_queue();
+
+        azure::storage::queue_request_options options;
+        options.set_parallelism_factor(8);
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        std::vector<azure::storage::cloud_queue_message> messages;
+        for (int i = 0; i < 40; ++i)
+        {
+            // The content needs escaping in the request body
+            messages.push_back(azure::storage::cloud_queue_message(_XPLATSTR("<message & \"quoted\" 'text'>") + get_random_string()));
+        }
+
+        queue.add_messages(messages, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), true, options, context);
+        for (auto it = messages.cbegin(); it != messages.cend(); ++it)
+        {
+            CHECK(!it->id().empty());
+            CHECK(!it->pop_receipt().empty());
+            CHECK(it->insertion_time().is_initialized());
+        }
+
+        std::vector<azure::storage::cloud_queue_message> unparsed_messages(10, azure::storage::cloud_queue_message(_XPLATSTR("Hello World!")));
+        queue.add_messages(unparsed_messages, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), false, options, context);
+        for (auto it = unparsed_messages.cbegin(); it != unparsed_messages.cend(); ++it)
+        {
+            CHECK(it->id().empty());
+        }
+
+        queue.download_attributes(options, context);
+        CHECK_EQUAL(50, queue.approximate_message_count());
+
+        std::vector<azure::storage::cloud_queue_message> peeked = queue.peek_messages(32U, options, context);
+        for (auto it = peeked.cbegin(); it != peeked.cend(); ++it)
+        {
+            bool found = false;
+            for (auto message_it = messages.cbegin(); message_it != messages.cend() && !found; ++message_it)
+            {
+                found = message_it->id() == it->id() && message_it->content_as_string() == it->content_as_string();
+            }
+
+            for (auto message_it = unparsed_messages.cbegin(); message_it != unparsed_messages.cend() && !found; ++message_it)
+            {
+                found = message_it->content_as_string() == it->content_as_string();
+            }
+
+            CHECK(found);
+        }
+
+        std::vector<azure::storage::cloud_queue_message> no_messages;
+        queue.add_messages(no_messages, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), true, options, context);
+        CHECK_THROW(queue.add_messages(messages, std::chrono::seconds(0LL), std::chrono::seconds(0LL), true, options, context), std::invalid_argument);
+
+        queue.delete_queue();
+    }
+
+    TEST_FIXTURE(queue_service_test_base, Queue_Consumer)
+    {
+        azure::storage::cloud_queue queue = get_queue();
+
+        azure::storage::queue_request_options options;
+        options.set_parallelism_factor(4);
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        std::vector<azure::storage::cloud_queue_message> messages;
+        for (int i = 0; i < 50; ++i)
+        {
+            messages.push_back(azure::storage::cloud_queue_message(get_random_string()));
+        }
+
+        queue.add_messages(messages, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), false, options, context);
+
+        std::mutex mutex;
+        std::vector<utility::string_t> handled;
+        bool failed_once = false;
+        auto handler = [&mutex, &handled, &failed_once] (azure::storage::cloud_queue_message message)
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+
+            // The first message is not handled, so it becomes visible again once its visibility timeout ends
+            if (!failed_once)
+            {
+                failed_once = true;
+                throw std::runtime_error("handler");
+            }
+
+            handled.push_back(message.content_as_string());
+        };
+
+        std::vector<utility::string_t> failed;
+        auto error_handler = [&mutex, &failed] (const azure::storage::cloud_queue_message& message, std::exception_ptr exception)
+        {
+            CHECK_THROW(std::rethrow_exception(exception), std::runtime_error);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            failed.push_back(message.content_as_string());
+        };
+
+        {
+            azure::storage::cloud_queue_consumer consumer(queue, handler, error_handler, std::chrono::seconds(2LL), options, context);
+            consumer.start();
+
+            for (int i = 0; i < 60; ++i)
+            {
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    if (handled.size() >= messages.size())
+                    {
+                        break;
+                    }
+                }
+
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+
+            consumer.stop();
+        }
+
+        CHECK_EQUAL(messages.size(), handled.size());
+        CHECK_EQUAL(1U, failed.size());
+        CHECK(failed.empty() || std::find(handled.cbegin(), handled.cend(), failed.front()) != handled.cend());
+        for (auto it = messages.cbegin(); it != messages.cend(); ++it)
+        {
+            CHECK(std::find(handled.cbegin(), handled.cend(), it->content_as_string()) != handled.cend());
+        }
+
+        queue.download_attributes(options, context);
+        CHECK_EQUAL(0, queue.approximate_message_count());
+
+        CHECK_THROW(azure::storage::cloud_queue_consumer(queue, handler, std::chrono::seconds(0LL), options, context), std::invalid_argument);
+        CHECK_THROW(azure::storage::cloud_queue_consumer(queue, std::function<void(azure::storage::cloud_queue_message)>(), std::chrono::seconds(30LL), options, context), std::invalid_argument);
+
+        queue.delete_queue();
+    }
+
+    TEST_FIXTURE(queue_service_test_base, Queue_Sharded)
+    {
+        azure::storage::cloud_queue_client client = get_queue_client();
+        utility::string_t name_prefix = get_queue_name() + _XPLATSTR("-");
+        azure::storage::cloud_sharded_queue queue = client.get_sharded_queue_reference(name_prefix, 3);
+        CHECK_EQUAL(3U, queue.shard_count());
+        CHECK_THROW(client.get_sharded_queue_reference(get_queue_name(), 0), std::invalid_argument);
+        CHECK_THROW(azure::storage::cloud_sharded_queue().shard_for_key(_XPLATSTR("key")), std::logic_error);
+
+        azure::storage::queue_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        queue.create_if_not_exists(options, context);
+        for (size_t i = 0; i < queue.shard_count(); ++i)
+        {
+            CHECK(queue.shard(i).exists());
+        }
+
+        // Messages without a key go to each shard in turn, and messages with the same key go to the same shard
+        std::vector<size_t> added(queue.shard_count(), 0);
+        for (int i = 0; i < 6; ++i)
+        {
+            azure::storage::cloud_queue_message message(get_random_string());
+            ++added[queue.add_message(message, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), options, context)];
+        }
+
+        for (size_t i = 0; i < queue.shard_count(); ++i)
+        {
+            CHECK_EQUAL(2U, added[i]);
+        }
+
+        utility::string_t key = get_random_string();
+        size_t key_shard = queue.shard_for_key(key);
+        for (int i = 0; i < 3; ++i)
+        {
+            azure::storage::cloud_queue_message message(get_random_string());
+            CHECK_EQUAL(key_shard, queue.add_message(key, message, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), options, context));
+        }
+
+        std::vector<int> depths = queue.download_shard_depths(options, context);
+        CHECK_EQUAL(queue.shard_count(), depths.size());
+        for (size_t i = 0; i < queue.shard_count(); ++i)
+        {
+            CHECK_EQUAL(i == key_shard ? 5 : 2, depths[i]);
+        }
+
+        // Messages are taken from every shard until all have been retrieved
+        size_t received = 0;
+        for (int i = 0; i < 10 && received < 9; ++i)
+        {
+            std::vector<azure::storage::cloud_sharded_queue_message> messages = queue.get_messages(4, std::chrono::seconds(60LL), options, context);
+            for (auto it = messages.begin(); it != messages.end(); ++it)
+            {
+                CHECK(it->shard_index() < queue.shard_count());
+                queue.delete_message(*it, options, context);
+            }
+
+            received += messages.size();
+        }
+
+        CHECK_EQUAL(9U, received);
+
+        CHECK(queue.get_messages(4, std::chrono::seconds(60LL), options, context).empty());
+
+        // Once every shard has been found empty, only the shard that becomes due first is polled
+        size_t request_count = context.request_results().size();
+        CHECK(queue.get_messages(4, std::chrono::seconds(60LL), options, context).empty());
+        CHECK_EQUAL(request_count + 1, context.request_results().size());
+
+        depths = queue.download_shard_depths(options, context);
+        for (size_t i = 0; i < queue.shard_count(); ++i)
+        {
+            CHECK_EQUAL(0, depths[i]);
+        }
+
+        // A shard that fails does not lose the messages retrieved from the other shards, and the failure is reported when nothing was retrieved.
+        // A new reference is used so that every shard is due again.
+        azure::storage::cloud_queue failing_shard = queue.shard(1);
+        failing_shard.delete_queue(options, context);
+        for (size_t i = 0; i < queue.shard_count(); i += 2)
+        {
+            azure::storage::cloud_queue shard = queue.shard(i);
+            azure::storage::cloud_queue_message message(get_random_string());
+            shard.add_message(message, std::chrono::seconds(604800LL), std::chrono::seconds(0LL), options, context);
+        }
+
+        azure::storage::cloud_sharded_queue new_queue = client.get_sharded_queue_reference(name_prefix, 3);
+        std::vector<azure::storage::cloud_sharded_queue_message> messages = new_queue.get_messages(4, std::chrono::seconds(60LL), options, context);
+        CHECK_EQUAL(2U, messages.size());
+        for (auto it = messages.begin(); it != messages.end(); ++it)
+        {
+            CHECK(it->shard_index() != 1U);
+            new_queue.delete_message(*it, options, context);
+        }
+
+        CHECK_THROW(new_queue.get_messages(4, std::chrono::seconds(60LL), options, context), azure::storage::storage_exception);
+
+        queue.delete_if_exists(options, context);
+        for (size_t i = 0; i < queue.shard_count(); ++i)
+        {
+            CHECK(!queue.shard(i).exists());
+        }
+    }
+
     TEST_FIXTURE(queue_service_test_base, Queue_Metadata)
     {
         azure::storage::cloud_queue_client client = get_queue_client();
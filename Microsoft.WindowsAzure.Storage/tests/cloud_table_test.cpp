@@ -19,6 +19,11 @@
 #include "table_test_base.h"
 #include "was/table.h"
 #include "was/storage_account.h"
+#include "wascore/util.h"
+#include "wascore/protocol_json.h"
+
+#include <clocale>
+#include <locale>
 
 // TODO: Consider making storage_account.h automatically included from blob.h/table.h/queue.h
 
@@ -38,6 +43,40 @@ std::vector<azure::storage::table_entity> execute_table_query(
     return results;
 }
 
+struct table_test_order
+{
+    utility::string_t customer;
+    utility::string_t id;
+    utility::string_t etag;
+    utility::datetime timestamp;
+    utility::string_t description;
+    int32_t quantity;
+    int64_t sequence;
+    double total;
+    bool shipped;
+};
+
+namespace azure { namespace storage {
+
+    template<>
+    struct table_entity_traits<table_test_order>
+    {
+        static void map(table_entity_mapping<table_test_order>& mapping)
+        {
+            mapping.partition_key(&table_test_order::customer)
+                .row_key(&table_test_order::id)
+                .etag(&table_test_order::etag)
+                .timestamp(&table_test_order::timestamp)
+                .property(_XPLATSTR("Description"), &table_test_order::description)
+                .property(_XPLATSTR("Quantity"), &table_test_order::quantity)
+                .property(_XPLATSTR("Sequence"), &table_test_order::sequence)
+                .property(_XPLATSTR("Total"), &table_test_order::total)
+                .property(_XPLATSTR("Shipped"), &table_test_order::shipped);
+        }
+    };
+
+}} // namespace azure::storage
+
 SUITE(Table)
 {
     TEST_FIXTURE(table_service_test_base, Table_Empty)
@@ -678,6 +717,69 @@ SUITE(Table)
         CHECK_THROW(property.string_value(), std::runtime_error);
     }
 
+    TEST_FIXTURE(table_service_test_base, EntityProperty_TypeConversion)
+    {
+        azure::storage::entity_property property((int32_t)-42);
+        CHECK(property.str().compare(_XPLATSTR("-42")) == 0);
+
+        property.set_property_type(azure::storage::edm_type::int64);
+        CHECK(property.int64_value() == -42);
+        CHECK(property.str().compare(_XPLATSTR("-42")) == 0);
+
+        property.set_value(utility::string_t(_XPLATSTR("1234567890123")));
+        property.set_property_type(azure::storage::edm_type::int64);
+        CHECK(property.int64_value() == 1234567890123LL);
+        CHECK(property.str().compare(_XPLATSTR("1234567890123")) == 0);
+
+        property.set_value(utility::string_t(_XPLATSTR("2.5")));
+        property.set_property_type(azure::storage::edm_type::double_floating_point);
+        CHECK(property.double_value() == 2.5);
+        CHECK(property.str().compare(_XPLATSTR("2.5")) == 0);
+
+        property.set_value(std::numeric_limits<double>::infinity());
+        CHECK(property.str().compare(_XPLATSTR("Infinity")) == 0);
+
+        utility::datetime datetime_value = get_random_datetime();
+        property.set_value(datetime_value);
+        utility::string_t datetime_string = property.str();
+        property.set_value(datetime_string);
+        property.set_property_type(azure::storage::edm_type::datetime);
+        CHECK(property.datetime_value() == datetime_value);
+
+        utility::uuid guid_value = get_random_guid();
+        property.set_value(guid_value);
+        CHECK(utility::uuid_equal(property.guid_value(), guid_value));
+        property.set_value(property.str());
+        property.set_property_type(azure::storage::edm_type::guid);
+        CHECK(utility::uuid_equal(property.guid_value(), guid_value));
+
+        property.set_value(true);
+        property.set_property_type(azure::storage::edm_type::int32);
+        CHECK_THROW(property.int32_value(), std::runtime_error);
+        CHECK(property.str().compare(_XPLATSTR("true")) == 0);
+
+        // The text of a value set natively is formatted on first access and then returned by the same reference
+        property.set_value((int64_t)-9876543210LL);
+        const azure::storage::entity_property& const_property = property;
+        const utility::string_t& text = const_property.str();
+        CHECK(text.compare(_XPLATSTR("-9876543210")) == 0);
+        CHECK(&text == &const_property.str());
+        CHECK(const_property.int64_value() == -9876543210LL);
+
+        // A copy taken before the text is formatted formats its own
+        property.set_value((int32_t)7);
+        azure::storage::entity_property copy(property);
+        CHECK(copy.str().compare(_XPLATSTR("7")) == 0);
+        CHECK(property.str().compare(_XPLATSTR("7")) == 0);
+        property.set_value((int32_t)8);
+        property.set_property_type(azure::storage::edm_type::int64);
+        CHECK(property.int64_value() == 8);
+
+        property.set_value(utility::string_t(_XPLATSTR("not a guid")));
+        property.set_property_type(azure::storage::edm_type::guid);
+        CHECK_THROW(property.guid_value(), std::runtime_error);
+    }
+
     TEST_FIXTURE(table_service_test_base, Entity_PartitionKeyAndRowKey)
     {
         utility::string_t partition_key = get_random_string();
@@ -753,6 +855,200 @@ SUITE(Table)
         CHECK(entity.properties().size() == 5U);
     }
 
+    TEST_FIXTURE(table_service_test_base, Entity_JsonReader)
+    {
+        std::string body = "{\"odata.metadata\":\"https://account.table.core.windows.net/$metadata#table\",\"value\":[{"
+            "\"odata.etag\":\"W/\\\"datetime'2019-01-01T00%3A00%3A00.0000000Z'\\\"\",\"PartitionKey\":\"pk\",\"RowKey\":\"r\\u00e9\\\"k\","
+            "\"Timestamp\":\"2019-01-01T00:00:00.0000000Z\",\"Int32\":-2147483648,\"Int64\":9223372036854775807,\"Negative64\":-9223372036854775808,"
+            "\"Large\":92233720368547758070,\"Double\":2.5e1,\"Boolean\":true,\"Null\":null,"
+            "\"Guid\":\"c9da6455-213d-42c9-9a79-3e9149a57833\",\"Guid@odata.type\":\"Edm.Guid\","
+            "\"Annotated@odata.type\":\"Edm.Int64\",\"Annotated\":\"123\"},{}]}";
+        std::vector<unsigned char> buffer(body.cbegin(), body.cend());
+        std::vector<azure::storage::table_entity> entities = azure::storage::protocol::table_entity_json_reader(buffer).read_query_results();
+
+        CHECK_EQUAL(1U, entities.size());
+        const azure::storage::table_entity& entity = entities.front();
+        CHECK(entity.partition_key() == _XPLATSTR("pk"));
+        CHECK(entity.row_key() == utility::conversions::to_string_t("r\xc3\xa9\"k"));
+        CHECK(!entity.etag().empty());
+        CHECK(entity.timestamp().is_initialized());
+
+        const azure::storage::table_entity::properties_type& properties = entity.properties();
+        CHECK(properties.at(_XPLATSTR("Int32")).property_type() == azure::storage::edm_type::int32);
+        CHECK(properties.at(_XPLATSTR("Int32")).int32_value() == std::numeric_limits<int32_t>::min());
+        CHECK(properties.at(_XPLATSTR("Int64")).property_type() == azure::storage::edm_type::int64);
+        CHECK(properties.at(_XPLATSTR("Int64")).int64_value() == std::numeric_limits<int64_t>::max());
+        CHECK(properties.at(_XPLATSTR("Negative64")).property_type() == azure::storage::edm_type::int64);
+        CHECK(properties.at(_XPLATSTR("Negative64")).int64_value() == std::numeric_limits<int64_t>::min());
+        CHECK(properties.at(_XPLATSTR("Large")).property_type() == azure::storage::edm_type::double_floating_point);
+        CHECK(properties.at(_XPLATSTR("Double")).double_value() == 25.0);
+        CHECK(properties.at(_XPLATSTR("Boolean")).boolean_value());
+        CHECK(properties.at(_XPLATSTR("Null")).is_null());
+        CHECK(properties.at(_XPLATSTR("Guid")).property_type() == azure::storage::edm_type::guid);
+        CHECK(properties.at(_XPLATSTR("Annotated")).int64_value() == 123);
+
+        const char* malformed_bodies[] =
+        {
+            "{\"value\":[{\"PartitionKey\":\"pk\"",
+            "{\"value\":[{\"PartitionKey\":\"p\\qk\"}]}",
+            "{\"value\":[{\"Number\":-}]}",
+            "{\"value\":[{\"Boolean\":tru}]}",
+            "{\"value\":[{\"String\":\"\\u12\"}]}",
+        };
+
+        for (const char* malformed_body : malformed_bodies)
+        {
+            std::vector<unsigned char> malformed_buffer(malformed_body, malformed_body + std::strlen(malformed_body));
+            try
+            {
+                azure::storage::protocol::table_entity_json_reader(malformed_buffer).read_query_results();
+                CHECK(false);
+            }
+            catch (const azure::storage::storage_exception& e)
+            {
+                // Retrying cannot fix a response that is not valid JSON
+                CHECK(!e.retryable());
+            }
+        }
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_JsonRecordReader)
+    {
+        // The first entity has empty keys, which must be kept rather than replaced by a later duplicate member
+        std::string body = "{\"value\":[{\"PartitionKey\":\"\",\"RowKey\":\"\",\"PartitionKey\":\"other\",\"Timestamp\":\"2019-01-01T00:00:00.0000000Z\","
+            "\"Large\":9876543210,\"Small\":-5,\"Ratio\":0.25,\"Flag\":false,\"Name\":\"text\",\"Missing\":null,"
+            "\"Count@odata.type\":\"Edm.Int64\",\"Count\":\"42\"},"
+            "{\"odata.etag\":\"W/\\\"etag\\\"\",\"PartitionKey\":\"pk\",\"RowKey\":\"rk\"}]}";
+        std::vector<unsigned char> buffer(body.cbegin(), body.cend());
+        std::vector<azure::storage::table_entity_record> records = azure::storage::protocol::table_entity_json_reader(buffer).read_query_records();
+
+        CHECK_EQUAL(2U, records.size());
+        const azure::storage::table_entity_record& first = records[0];
+        CHECK(first.partition_key().empty());
+        CHECK(first.row_key().empty());
+        CHECK(!first.etag().empty());
+        CHECK(first.etag().data() == first.etag().data());
+        CHECK(first.property_name(0) == _XPLATSTR("Large"));
+        CHECK_EQUAL(7U, first.property_count());
+
+        CHECK(first.property_value(first.find_property(_XPLATSTR("Large"))).property_type() == azure::storage::edm_type::int64);
+        CHECK(first.property_value(first.find_property(_XPLATSTR("Large"))).int64_value() == 9876543210LL);
+        CHECK_EQUAL(-5, first.property_value(first.find_property(_XPLATSTR("Small"))).int32_value());
+        CHECK(first.property_value(first.find_property(_XPLATSTR("Ratio"))).double_value() == 0.25);
+        CHECK(!first.property_value(first.find_property(_XPLATSTR("Flag"))).boolean_value());
+        CHECK(first.property_value(first.find_property(_XPLATSTR("Name"))).string_value() == _XPLATSTR("text"));
+        CHECK(first.property_value(first.find_property(_XPLATSTR("Missing"))).is_null());
+        CHECK(first.property_value(first.find_property(_XPLATSTR("Count"))).int64_value() == 42);
+
+        const azure::storage::table_entity_record& second = records[1];
+        CHECK(second.partition_key() == _XPLATSTR("pk"));
+        CHECK(second.row_key() == _XPLATSTR("rk"));
+        CHECK(second.etag() == _XPLATSTR("W/\"etag\""));
+        CHECK_EQUAL(0U, second.property_count());
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_Mapping)
+    {
+        std::shared_ptr<const azure::storage::table_entity_mapping<table_test_order>> mapping = azure::storage::table_entity_mapping<table_test_order>::instance();
+        CHECK(mapping == azure::storage::table_entity_mapping<table_test_order>::instance());
+
+        CHECK_EQUAL(5U, mapping->properties().size());
+        CHECK(mapping->find_property("Quantity") == &mapping->properties()[1]);
+        CHECK(mapping->find_property("Shipped") == &mapping->properties()[4]);
+        CHECK(mapping->find_property("quantity") == nullptr);
+        CHECK(mapping->find_property("PartitionKey") == nullptr);
+
+        // Members found at the expected position advance it, and any other member is found by scanning
+        size_t position = 1;
+        CHECK(mapping->find_property("Quantity", position) == &mapping->properties()[1]);
+        CHECK_EQUAL(2U, position);
+        CHECK(mapping->find_property("Description", position) == &mapping->properties()[0]);
+        CHECK_EQUAL(1U, position);
+
+        std::string body = "{\"PartitionKey\":\"customer\",\"RowKey\":\"order\",\"Sequence@odata.type\":\"Edm.Int64\",\"Sequence\":\"9876543210\","
+            "\"Quantity\":7,\"Total\":12.5,\"Shipped\":true,\"Description\":\"order\",\"Unmapped\":[1,{\"a\":2}]}";
+        std::vector<unsigned char> buffer(body.cbegin(), body.cend());
+        table_test_order order = table_test_order();
+        azure::storage::protocol::table_entity_json_reader(buffer).read_entity(*mapping, &order);
+
+        CHECK(order.customer == _XPLATSTR("customer"));
+        CHECK(order.id == _XPLATSTR("order"));
+        CHECK(order.description == _XPLATSTR("order"));
+        CHECK_EQUAL(7, order.quantity);
+        CHECK(order.sequence == 9876543210LL);
+        CHECK(order.total == 12.5);
+        CHECK(order.shipped);
+
+        // The members are written and read back without going through entity_property values
+        order.total = 3.0;
+        std::string written;
+        azure::storage::protocol::table_entity_json_writer(written).write_entity(*mapping, &order);
+        std::vector<unsigned char> written_buffer(written.cbegin(), written.cend());
+        table_test_order copy = table_test_order();
+        azure::storage::protocol::table_entity_json_reader(written_buffer).read_entity(*mapping, &copy);
+        CHECK(copy.customer == order.customer);
+        CHECK(copy.id == order.id);
+        CHECK(copy.description == order.description);
+        CHECK_EQUAL(order.quantity, copy.quantity);
+        CHECK(copy.sequence == order.sequence);
+        CHECK(copy.total == 3.0);
+        CHECK(copy.shipped);
+
+        std::string mismatch = "{\"PartitionKey\":\"customer\",\"RowKey\":\"order\",\"Quantity\":true}";
+        std::vector<unsigned char> mismatch_buffer(mismatch.cbegin(), mismatch.cend());
+        CHECK_THROW(azure::storage::protocol::table_entity_json_reader(mismatch_buffer).read_entity(*mapping, &copy), std::runtime_error);
+    }
+
+    TEST_FIXTURE(table_service_test_base, Entity_JsonWriterLocale)
+    {
+        // Switch both the C and the C++ global locale to one whose decimal separator is a comma
+        const char* comma_locale_names[] = { "de_DE.UTF-8", "de_DE.utf8", "de_DE", "de-DE", "German_Germany.1252" };
+        std::locale comma_locale = std::locale::classic();
+        const char* comma_locale_name = nullptr;
+        for (const char* locale_name : comma_locale_names)
+        {
+            try
+            {
+                comma_locale = std::locale(locale_name);
+                comma_locale_name = locale_name;
+                break;
+            }
+            catch (const std::runtime_error&)
+            {
+            }
+        }
+
+        if (comma_locale_name == nullptr)
+        {
+            // No locale with a comma decimal separator is installed on this machine
+            return;
+        }
+
+        std::string previous_c_locale = std::setlocale(LC_ALL, nullptr);
+        std::locale previous_locale = std::locale::global(comma_locale);
+        std::setlocale(LC_ALL, comma_locale_name);
+
+        azure::storage::table_entity entity(_XPLATSTR("pk"), _XPLATSTR("rk"));
+        entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("Double"), azure::storage::entity_property(2.5)));
+        entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("Whole"), azure::storage::entity_property(1234567.0)));
+        entity.properties().insert(azure::storage::table_entity::property_type(_XPLATSTR("Int64"), azure::storage::entity_property((int64_t)1234567890123LL)));
+        utility::string_t double_text = entity.properties().at(_XPLATSTR("Double")).str();
+        utility::string_t int64_text = entity.properties().at(_XPLATSTR("Int64")).str();
+
+        std::string body;
+        azure::storage::protocol::table_entity_json_writer(body).write_entity(entity);
+
+        std::setlocale(LC_ALL, previous_c_locale.c_str());
+        std::locale::global(previous_locale);
+
+        CHECK(double_text == _XPLATSTR("2.5"));
+        CHECK(int64_text == _XPLATSTR("1234567890123"));
+        CHECK(body.find("\"Double\":2.5") != std::string::npos);
+        CHECK(body.find("\"Whole\":\"1234567.0\"") != std::string::npos);
+        CHECK(body.find("\"Int64\":\"1234567890123\"") != std::string::npos);
+        CHECK(body.find("2,5") == std::string::npos);
+    }
+
     TEST_FIXTURE(table_service_test_base, Operation_Delete)
     {
         utility::string_t partition_key = get_random_string();
@@ -3511,6 +3807,200 @@ SUITE(Table)
         CHECK_THROW(table.execute_batch(operation, options, context), std::invalid_argument);
     }
 
+    TEST_FIXTURE(table_service_test_base, EntityBatch_Writer)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        options.set_parallelism_factor(4);
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        std::vector<utility::string_t> partition_keys;
+        for (int i = 0; i < 3; ++i)
+        {
+            partition_keys.push_back(get_random_string());
+        }
+
+        // An entity that already exists makes its batch fail, which must only fail that one insert
+        azure::storage::table_entity existing(partition_keys[0], azure::storage::core::convert_to_string(42));
+        table.execute(azure::storage::table_operation::insert_entity(existing), options, context);
+
+        {
+            azure::storage::table_batch_writer writer(table, options, context);
+
+            CHECK_THROW(writer.add(azure::storage::table_operation::retrieve_entity(partition_keys[0], _XPLATSTR("0"))), std::invalid_argument);
+
+            for (int i = 0; i < 250; ++i)
+            {
+                for (size_t j = 0; j < partition_keys.size(); ++j)
+                {
+                    azure::storage::table_entity entity(partition_keys[j], azure::storage::core::convert_to_string(i));
+                    entity.properties()[_XPLATSTR("Index")] = azure::storage::entity_property(i);
+                    writer.add(azure::storage::table_operation::insert_entity(entity));
+                }
+            }
+
+            try
+            {
+                writer.flush();
+                CHECK(false);
+            }
+            catch (const azure::storage::storage_exception& e)
+            {
+                CHECK_EQUAL(web::http::status_codes::Conflict, e.result().http_status_code());
+            }
+
+            // Operations on the same entity are sent in separate batches, in order
+            azure::storage::table_entity entity(partition_keys[1], _XPLATSTR("0"));
+            entity.properties()[_XPLATSTR("Index")] = azure::storage::entity_property(1000);
+            writer.add(azure::storage::table_operation::replace_entity(entity));
+            entity.properties()[_XPLATSTR("Index")] = azure::storage::entity_property(2000);
+            writer.add(azure::storage::table_operation::replace_entity(entity));
+            writer.flush();
+        }
+
+        for (size_t j = 0; j < partition_keys.size(); ++j)
+        {
+            azure::storage::table_query query;
+            query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), azure::storage::query_comparison_operator::equal, partition_keys[j]));
+
+            std::vector<azure::storage::table_entity> results = execute_table_query(table, query, options, context);
+            CHECK_EQUAL(250U, results.size());
+        }
+
+        azure::storage::table_result result = table.execute(azure::storage::table_operation::retrieve_entity(partition_keys[1], _XPLATSTR("0")), options, context);
+        CHECK_EQUAL(2000, result.entity().properties().at(_XPLATSTR("Index")).int32_value());
+
+        // Operations still buffered when the writer is destroyed are sent without waiting for them
+        {
+            azure::storage::table_batch_writer writer(table, options, context);
+            writer.add(azure::storage::table_operation::insert_entity(azure::storage::table_entity(partition_keys[2], _XPLATSTR("unflushed"))));
+        }
+
+        for (int attempt = 0; attempt < 30; ++attempt)
+        {
+            result = table.execute(azure::storage::table_operation::retrieve_entity(partition_keys[2], _XPLATSTR("unflushed")), options, context);
+            if (result.http_status_code() == web::http::status_codes::OK)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+
+        CHECK_EQUAL(web::http::status_codes::OK, result.http_status_code());
+
+        table.delete_table();
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityBatch_WriteCache)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        CHECK_THROW(azure::storage::table_write_cache(table, std::chrono::milliseconds(0)), std::invalid_argument);
+
+        utility::string_t partition_key = get_random_string();
+
+        // The window is long enough that nothing is sent before the cache is flushed
+        azure::storage::table_write_cache cache(table, std::chrono::milliseconds(60000), options, context);
+
+        CHECK_THROW(cache.write(azure::storage::table_operation::retrieve_entity(partition_key, _XPLATSTR("0"))), std::invalid_argument);
+
+        for (int i = 0; i < 50; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                azure::storage::table_entity entity(partition_key, azure::storage::core::convert_to_string(j));
+                entity.properties()[_XPLATSTR("Count")] = azure::storage::entity_property(i);
+                if (i == 0)
+                {
+                    entity.properties()[_XPLATSTR("First")] = azure::storage::entity_property(j);
+                }
+
+                cache.write(azure::storage::table_operation::insert_or_merge_entity(entity));
+            }
+        }
+
+        // Every write to an entity is combined into one operation, and the three entities share one batch
+        size_t request_count = context.request_results().size();
+        cache.flush();
+        CHECK_EQUAL(request_count + 1, context.request_results().size());
+
+        for (int j = 0; j < 3; ++j)
+        {
+            azure::storage::table_result result = table.execute(azure::storage::table_operation::retrieve_entity(partition_key, azure::storage::core::convert_to_string(j)), options, context);
+            CHECK_EQUAL(49, result.entity().properties().at(_XPLATSTR("Count")).int32_value());
+            CHECK_EQUAL(j, result.entity().properties().at(_XPLATSTR("First")).int32_value());
+        }
+
+        // A replacement supersedes the buffered merges, including the properties they added
+        {
+            azure::storage::table_entity entity(partition_key, _XPLATSTR("0"));
+            entity.properties()[_XPLATSTR("Count")] = azure::storage::entity_property(100);
+            cache.write(azure::storage::table_operation::insert_or_merge_entity(entity));
+
+            entity.properties().clear();
+            entity.properties()[_XPLATSTR("Other")] = azure::storage::entity_property(200);
+            cache.write(azure::storage::table_operation::insert_or_replace_entity(entity));
+            cache.flush();
+
+            azure::storage::table_result result = table.execute(azure::storage::table_operation::retrieve_entity(partition_key, _XPLATSTR("0")), options, context);
+            CHECK_EQUAL(1U, result.entity().properties().size());
+            CHECK_EQUAL(200, result.entity().properties().at(_XPLATSTR("Other")).int32_value());
+        }
+
+        // An operation with a specific ETag is not combined, so its precondition is still checked
+        {
+            azure::storage::table_entity entity(partition_key, _XPLATSTR("1"));
+            entity.properties()[_XPLATSTR("Count")] = azure::storage::entity_property(300);
+            cache.write(azure::storage::table_operation::insert_or_merge_entity(entity));
+
+            entity.set_etag(_XPLATSTR("W/\"datetime'2000-01-01T00%3A00%3A00.0000000Z'\""));
+            entity.properties()[_XPLATSTR("Count")] = azure::storage::entity_property(400);
+            cache.write(azure::storage::table_operation::replace_entity(entity));
+
+            try
+            {
+                cache.flush();
+                CHECK(false);
+            }
+            catch (const azure::storage::storage_exception& e)
+            {
+                CHECK_EQUAL(web::http::status_codes::PreconditionFailed, e.result().http_status_code());
+            }
+
+            azure::storage::table_result result = table.execute(azure::storage::table_operation::retrieve_entity(partition_key, _XPLATSTR("1")), options, context);
+            CHECK_EQUAL(300, result.entity().properties().at(_XPLATSTR("Count")).int32_value());
+        }
+
+        // An operation that is never combined is still sent when the window ends, without a flush
+        {
+            azure::storage::table_write_cache short_cache(table, std::chrono::milliseconds(500), options, context);
+            short_cache.write(azure::storage::table_operation::delete_entity(azure::storage::table_entity(partition_key, _XPLATSTR("2"))));
+
+            azure::storage::table_result result;
+            for (int attempt = 0; attempt < 30; ++attempt)
+            {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                result = table.execute(azure::storage::table_operation::retrieve_entity(partition_key, _XPLATSTR("2")), options, context);
+                if (result.http_status_code() == web::http::status_codes::NotFound)
+                {
+                    break;
+                }
+            }
+
+            CHECK_EQUAL(web::http::status_codes::NotFound, result.http_status_code());
+            short_cache.flush();
+        }
+
+        table.delete_table();
+    }
+
     TEST_FIXTURE(table_service_test_base, EntityQuery_Normal)
     {
         azure::storage::cloud_table table = get_table();
@@ -4150,6 +4640,313 @@ SUITE(Table)
         table.delete_table();
     }
 
+    TEST_FIXTURE(table_service_test_base, EntityOperation_Mapped)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        utility::string_t partition_key = get_random_string();
+
+        for (int i = 0; i < 3; ++i)
+        {
+            table_test_order order;
+            order.customer = partition_key;
+            order.id = azure::storage::core::convert_to_string(i);
+            order.description = _XPLATSTR("order ") + order.id;
+            order.quantity = i;
+            order.sequence = 0x100000000LL + i;
+            order.total = 1.5 * i;
+            order.shipped = (i % 2) == 0;
+
+            azure::storage::table_result result = table.execute(azure::storage::table_operation_type::insert_operation, order, options, context);
+            CHECK(result.http_status_code() == web::http::status_codes::Created || result.http_status_code() == web::http::status_codes::NoContent);
+            CHECK(!order.etag.empty());
+            CHECK(order.etag == result.etag());
+        }
+
+        {
+            table_test_order order;
+            order.customer = partition_key;
+            order.id = _XPLATSTR("1");
+
+            azure::storage::table_result result = table.execute(azure::storage::table_operation_type::retrieve_operation, order, options, context);
+            CHECK_EQUAL(web::http::status_codes::OK, result.http_status_code());
+            CHECK(!order.etag.empty());
+            CHECK(order.timestamp.is_initialized());
+            CHECK(order.description == _XPLATSTR("order 1"));
+            CHECK_EQUAL(1, order.quantity);
+            CHECK_EQUAL(0x100000001LL, order.sequence);
+            CHECK_EQUAL(1.5, order.total);
+            CHECK(!order.shipped);
+
+            order.description = _XPLATSTR("updated");
+            result = table.execute(azure::storage::table_operation_type::replace_operation, order, options, context);
+            CHECK_EQUAL(web::http::status_codes::NoContent, result.http_status_code());
+            CHECK(order.etag == result.etag());
+        }
+
+        {
+            table_test_order order;
+            order.customer = partition_key;
+            order.id = _XPLATSTR("missing");
+            order.quantity = 7;
+
+            azure::storage::table_result result = table.execute(azure::storage::table_operation_type::retrieve_operation, order, options, context);
+            CHECK_EQUAL(web::http::status_codes::NotFound, result.http_status_code());
+            CHECK_EQUAL(7, order.quantity);
+        }
+
+        {
+            azure::storage::table_query query;
+            query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), azure::storage::query_comparison_operator::equal, partition_key));
+
+            std::vector<table_test_order> results;
+            azure::storage::result_iterator<table_test_order> end_of_result;
+            for (azure::storage::result_iterator<table_test_order> iter = table.execute_query<table_test_order>(query, options, context); iter != end_of_result; ++iter)
+            {
+                results.push_back(*iter);
+            }
+
+            CHECK_EQUAL(3U, results.size());
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                CHECK(results[i].customer == partition_key);
+                CHECK(results[i].id == azure::storage::core::convert_to_string(i));
+                CHECK(!results[i].etag.empty());
+                CHECK_EQUAL((int32_t)i, results[i].quantity);
+                CHECK_EQUAL((int64_t)(0x100000000LL + i), results[i].sequence);
+                CHECK_EQUAL(i % 2 == 0, results[i].shipped);
+            }
+
+            CHECK(results[1].description == _XPLATSTR("updated"));
+        }
+
+        table.delete_table();
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityQuery_Parallel)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        options.set_parallelism_factor(4);
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        utility::string_t prefix = get_random_string();
+        std::vector<utility::string_t> partition_keys;
+        for (utility::char_t c = _XPLATSTR('a'); c <= _XPLATSTR('e'); ++c)
+        {
+            partition_keys.push_back(prefix + _XPLATSTR("_") + utility::string_t(1, c));
+        }
+
+        {
+            azure::storage::table_batch_writer writer(table, options, context);
+            for (size_t i = 0; i < partition_keys.size(); ++i)
+            {
+                for (int j = 0; j < 30; ++j)
+                {
+                    azure::storage::table_entity entity(partition_keys[i], azure::storage::core::convert_to_string(100 + j));
+                    entity.properties()[_XPLATSTR("Index")] = azure::storage::entity_property(j);
+                    writer.add(azure::storage::table_operation::insert_entity(entity));
+                }
+            }
+
+            writer.flush();
+        }
+
+        std::vector<utility::string_t> split_points;
+        split_points.push_back(partition_keys[3]);
+        split_points.push_back(partition_keys[1]);
+        split_points.push_back(partition_keys[1]);
+        std::vector<azure::storage::table_partition_key_range> ranges = azure::storage::table_partition_key_range::split(split_points);
+        CHECK_EQUAL(3U, ranges.size());
+        CHECK(ranges[0].lower_bound().empty());
+        CHECK(ranges[0].upper_bound() == partition_keys[1]);
+        CHECK(ranges[2].lower_bound() == partition_keys[3]);
+        CHECK(ranges[2].upper_bound().empty());
+
+        // Small pages make every range follow continuation tokens
+        azure::storage::table_query query;
+        query.set_take_count(7);
+
+        {
+            std::vector<azure::storage::table_entity> results;
+            table.execute_query_parallel(query, ranges, true, [&results] (azure::storage::table_entity entity)
+            {
+                results.push_back(std::move(entity));
+            }, options, context);
+
+            CHECK_EQUAL(150U, results.size());
+            for (size_t i = 1; i < results.size(); ++i)
+            {
+                CHECK(results[i - 1].partition_key() < results[i].partition_key() ||
+                    (results[i - 1].partition_key() == results[i].partition_key() && results[i - 1].row_key() < results[i].row_key()));
+            }
+        }
+
+        {
+            query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("Index"), azure::storage::query_comparison_operator::less_than, 10));
+
+            size_t count = 0;
+            table.execute_query_parallel(query, ranges, false, [&count] (azure::storage::table_entity entity)
+            {
+                CHECK(entity.properties().at(_XPLATSTR("Index")).int32_value() < 10);
+                ++count;
+            }, options, context);
+
+            CHECK_EQUAL(50U, count);
+        }
+
+        {
+            std::vector<azure::storage::table_partition_key_range> overlapping;
+            overlapping.push_back(azure::storage::table_partition_key_range(partition_keys[0], partition_keys[2]));
+            overlapping.push_back(azure::storage::table_partition_key_range(partition_keys[1], partition_keys[3]));
+            CHECK_THROW(table.execute_query_parallel(query, overlapping, false, [] (azure::storage::table_entity) {}, options, context), std::invalid_argument);
+        }
+
+        table.delete_table();
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityQuery_Records)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        utility::string_t partition_key = get_random_string();
+        std::vector<uint8_t> binary_value = get_random_binary_data();
+
+        {
+            azure::storage::table_batch_operation batch;
+            for (int i = 0; i < 20; ++i)
+            {
+                azure::storage::table_entity entity(partition_key, azure::storage::core::convert_to_string(100 + i));
+                entity.properties()[_XPLATSTR("Index")] = azure::storage::entity_property(i);
+                entity.properties()[_XPLATSTR("Large")] = azure::storage::entity_property(int64_t(i) << 40);
+                entity.properties()[_XPLATSTR("Name")] = azure::storage::entity_property(get_random_string());
+                entity.properties()[_XPLATSTR("Data")] = azure::storage::entity_property(binary_value);
+                batch.insert_entity(entity);
+            }
+
+            table.execute_batch(batch, options, context);
+        }
+
+        azure::storage::table_query query;
+        query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("PartitionKey"), azure::storage::query_comparison_operator::equal, partition_key));
+
+        std::vector<azure::storage::table_entity> entities = table.execute_query_segmented(query, azure::storage::continuation_token(), options, context).results();
+        azure::storage::table_entity_record_segment segment = table.execute_query_records_segmented(query, azure::storage::continuation_token(), options, context);
+        CHECK(segment.continuation_token().empty());
+        CHECK_EQUAL(entities.size(), segment.results().size());
+
+        for (size_t i = 0; i < entities.size() && i < segment.results().size(); ++i)
+        {
+            const azure::storage::table_entity& entity = entities[i];
+            const azure::storage::table_entity_record& record = segment.results()[i];
+
+            CHECK(entity.partition_key() == record.partition_key());
+            CHECK(entity.row_key() == record.row_key());
+            CHECK(entity.etag() == record.etag());
+            CHECK(entity.timestamp() == record.timestamp());
+            CHECK_EQUAL(entity.properties().size(), record.property_count());
+
+            for (size_t j = 0; j < record.property_count(); ++j)
+            {
+                const azure::storage::entity_property& expected = entity.properties().at(record.property_name(j));
+                azure::storage::entity_property actual = record.property_value(j);
+                CHECK(expected.property_type() == actual.property_type());
+                CHECK(expected.str() == actual.str());
+            }
+
+            size_t index = record.find_property(_XPLATSTR("Large"));
+            CHECK(index < record.property_count());
+            CHECK_EQUAL(int64_t(record.property_value(record.find_property(_XPLATSTR("Index"))).int32_value()) << 40, record.property_value(index).int64_value());
+            CHECK_ARRAY_EQUAL(binary_value, record.property_value(record.find_property(_XPLATSTR("Data"))).binary_value(), (int)binary_value.size());
+            CHECK_EQUAL(record.property_count(), record.find_property(_XPLATSTR("Missing")));
+
+            azure::storage::table_entity copy = record.to_entity();
+            CHECK(entity.row_key() == copy.row_key());
+            CHECK(entity.etag() == copy.etag());
+            CHECK(entity.timestamp() == copy.timestamp());
+            CHECK_EQUAL(entity.properties().size(), copy.properties().size());
+            CHECK(entity.properties().at(_XPLATSTR("Name")).string_value() == copy.properties().at(_XPLATSTR("Name")).string_value());
+        }
+
+        table.delete_table();
+    }
+
+    TEST_FIXTURE(table_service_test_base, EntityQuery_BulkDelete)
+    {
+        azure::storage::cloud_table table = get_table();
+
+        azure::storage::table_request_options options;
+        options.set_parallelism_factor(4);
+        azure::storage::operation_context context;
+        print_client_request_id(context, _XPLATSTR(""));
+
+        std::vector<utility::string_t> partition_keys;
+        for (int i = 0; i < 3; ++i)
+        {
+            partition_keys.push_back(get_random_string());
+        }
+
+        {
+            azure::storage::table_batch_writer writer(table, options, context);
+            for (size_t i = 0; i < partition_keys.size(); ++i)
+            {
+                for (int j = 0; j < 120; ++j)
+                {
+                    azure::storage::table_entity entity(partition_keys[i], azure::storage::core::convert_to_string(1000 + j));
+                    entity.properties()[_XPLATSTR("Index")] = azure::storage::entity_property(j);
+                    writer.add(azure::storage::table_operation::insert_entity(entity));
+                }
+            }
+
+            writer.flush();
+        }
+
+        // Small pages make the deletes of one segment overlap with the query for the next
+        azure::storage::table_query query;
+        query.set_take_count(25);
+        query.set_filter_string(azure::storage::table_query::generate_filter_condition(_XPLATSTR("Index"), azure::storage::query_comparison_operator::less_than, 100));
+
+        CHECK_EQUAL(300U, table.delete_entities(query, options, context));
+        CHECK_EQUAL(0U, table.delete_entities(query, options, context));
+
+        azure::storage::table_query remaining_query;
+        std::vector<azure::storage::table_entity> results = execute_table_query(table, remaining_query, options, context);
+        CHECK_EQUAL(60U, results.size());
+        for (auto it = results.cbegin(); it != results.cend(); ++it)
+        {
+            CHECK(it->properties().at(_XPLATSTR("Index")).int32_value() >= 100);
+        }
+
+        // The ETags the deletes are conditional on are requested even when the options ask for no metadata
+        azure::storage::table_request_options no_metadata_options(options);
+        no_metadata_options.set_payload_format(azure::storage::table_payload_format::json_no_metadata);
+        azure::storage::operation_context no_metadata_context;
+        bool metadata_requested = true;
+        no_metadata_context.set_sending_request([&metadata_requested] (web::http::http_request& request, azure::storage::operation_context)
+        {
+            if (request.method() == web::http::methods::GET && request.headers()[web::http::header_names::accept].find(_XPLATSTR("nometadata")) != utility::string_t::npos)
+            {
+                metadata_requested = false;
+            }
+        });
+
+        CHECK_EQUAL(60U, table.delete_entities(remaining_query, no_metadata_options, no_metadata_context));
+        CHECK(metadata_requested);
+        CHECK(execute_table_query(table, remaining_query, options, context).empty());
+
+        table.delete_table();
+    }
+
     TEST_FIXTURE(table_service_test_base, EntityQuery_InvalidInput)
     {
         azure::storage::cloud_table table = get_table();
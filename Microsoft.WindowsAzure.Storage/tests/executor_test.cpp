@@ -18,6 +18,7 @@
 #include "stdafx.h"
 #include "blob_test_base.h"
 #include "check_macros.h"
+#include "wascore/base64.h"
 #include "wascore/util.h"
 
 SUITE(Core)
@@ -170,6 +171,40 @@ SUITE(Core)
         CHECK_EQUAL(true, caught_http_exception);
     }
 
+    TEST(base64_codec)
+    {
+        // Cover the scalar tail on its own and after the vectorized blocks, with each padding length
+        for (size_t size = 0; size < 300; ++size)
+        {
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; ++i)
+            {
+                data[i] = static_cast<uint8_t>(i * 131 + size);
+            }
+
+            utility::string_t text = azure::storage::core::to_base64(data);
+            CHECK(text == utility::conversions::to_base64(data));
+
+            std::vector<uint8_t> decoded = azure::storage::core::from_base64(text);
+            CHECK(decoded == data);
+
+            std::string buffer("prefix");
+            azure::storage::core::append_base64(buffer, data.data(), data.size());
+            CHECK_EQUAL(6 + text.size(), buffer.size());
+        }
+
+        CHECK(azure::storage::core::from_base64(_XPLATSTR("")).empty());
+        CHECK_THROW(azure::storage::core::from_base64(_XPLATSTR("abc")), std::runtime_error);
+        CHECK_THROW(azure::storage::core::from_base64(_XPLATSTR("ab==abcd")), std::runtime_error);
+        CHECK_THROW(azure::storage::core::from_base64(_XPLATSTR("a===")), std::runtime_error);
+
+        // An invalid character in a block long enough for the vectorized decoder
+        utility::string_t long_text(64, _XPLATSTR('A'));
+        CHECK_EQUAL(48U, azure::storage::core::from_base64(long_text).size());
+        long_text[17] = _XPLATSTR('-');
+        CHECK_THROW(azure::storage::core::from_base64(long_text), std::runtime_error);
+    }
+
 #ifdef _WIN32
     class delayed_scheduler : public azure::storage::delayed_scheduler_interface
     {
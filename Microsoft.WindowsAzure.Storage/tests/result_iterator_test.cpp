@@ -21,6 +21,8 @@
 
 #include "wascore/util.h"
 
+#include <atomic>
+
 typedef std::function<azure::storage::result_segment<int>(const azure::storage::continuation_token &, size_t)> result_generator_type;
 
 class test_result_provider
@@ -111,6 +113,27 @@ void result_iterator_check_result_number(result_generator_type generator, size_t
     CHECK_EQUAL(num_of_results, (size_t)count);
 }
 
+void result_iterator_check_result_number(result_generator_type generator, size_t max_results, size_t max_results_per_segment, size_t prefetch_depth, size_t num_of_results)
+{
+    auto async_generator = [generator](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> pplx::task<azure::storage::result_segment<int>>
+    {
+        return pplx::create_task([generator, token, max_results_per_segment]()
+        {
+            return generator(token, max_results_per_segment);
+        });
+    };
+
+    azure::storage::result_iterator<int> iter(async_generator, max_results, max_results_per_segment, prefetch_depth);
+    int count = 0;
+    for (auto& item : iter)
+    {
+        count++;
+        CHECK(item == count);
+    }
+
+    CHECK_EQUAL(num_of_results, (size_t)count);
+}
+
 SUITE(Core)
 {
     TEST_FIXTURE(test_base, result_iterator_default_constructor)
@@ -163,6 +186,92 @@ SUITE(Core)
         }
     }
 
+    TEST_FIXTURE(test_base, result_iterator_prefetch_get_results)
+    {
+        size_t test_data[][6] = {
+                /*{total_results, segment_size, return_full_segment, max_results, max_results_per_segment, num_of_results_returned}*/
+                { 0, 1000, 1, 0, 0, 0 },            // empty result
+                { 1, 1000, 1, 0, 0, 1 },            // one result
+                { 3201, 100, 1, 0, 0, 3201 },       // many segments
+                { 100, 1000, 1, 50, 1, 50 },        // max_results_per_segment = 1
+                { 100, 1000, 1, 99, 50, 99 },       // max_results_per_segment = 50
+                { 250, 1000, 1, 500, 50, 250 },     // max_results > total_results
+                { 500, 100, 0, 400, 100, 400 },     // return_full_segment = false
+                { 500, 100, 0, 1000, 100, 500 },    // return_full_segment = false
+        };
+
+        size_t prefetch_depths[] = { 0, 1, 4 };
+
+        for (auto& data : test_data)
+        {
+            for (auto prefetch_depth : prefetch_depths)
+            {
+                // Prefetched requests may still be running after the iterator is gone, so they share ownership of the provider.
+                auto provider = std::make_shared<test_result_provider>(data[0], data[1], data[2] != 0);
+                result_generator_type generator = [provider](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> azure::storage::result_segment<int>
+                {
+                    return provider->get_next_segment(token, max_results_per_segment);
+                };
+
+                result_iterator_check_result_number(generator, data[3], data[4], prefetch_depth, data[5]);
+            }
+        }
+    }
+
+    TEST_FIXTURE(test_base, result_iterator_prefetch_fail_to_fetch_next_segment)
+    {
+        test_result_provider provider(1000, 200, true);
+        std::atomic<bool> throw_exception_in_result_generator(false);
+        auto async_generator = [&provider, &throw_exception_in_result_generator](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> pplx::task<azure::storage::result_segment<int>>
+        {
+            return pplx::create_task([&provider, &throw_exception_in_result_generator, token, max_results_per_segment]()
+            {
+                if (throw_exception_in_result_generator)
+                {
+                    throw std::runtime_error("result_iterator next segment error");
+                }
+
+                return provider.get_next_segment(token, max_results_per_segment);
+            });
+        };
+
+        throw_exception_in_result_generator = false;
+        azure::storage::result_iterator<int> end_of_results;
+        azure::storage::result_iterator<int> iter(async_generator, 0, 0, 0);
+
+        int count = 0;
+        try
+        {
+            for (; iter != end_of_results; ++iter)
+            {
+                count++;
+                CHECK(*iter == (int)count);
+
+                if (count == 600)
+                {
+                    throw_exception_in_result_generator = true;
+                }
+            }
+        }
+        catch (std::runtime_error&)
+        {
+        }
+
+        CHECK_EQUAL(600, count);
+
+        throw_exception_in_result_generator = false;
+
+        // retry to continue. the iterator shall be able to read out remaining results upon successful retry
+        ++iter;
+        for (; iter != end_of_results; ++iter)
+        {
+            count++;
+            CHECK(*iter == (int)count);
+        }
+
+        CHECK_EQUAL(1000, count);
+    }
+
     TEST_FIXTURE(test_base, result_iterator_fail_to_fetch_first_segment)
     {
         auto generator = [](const azure::storage::continuation_token &, size_t ) -> azure::storage::result_segment<int>
@@ -222,4 +331,158 @@ SUITE(Core)
             CHECK(*iter == (int)count);
         }
     }
+
+    TEST_FIXTURE(test_base, result_iterator_prefetch_fail_to_fetch_prefetched_segment)
+    {
+        test_result_provider provider(1000, 200, true);
+        std::atomic<bool> failed(false);
+        auto async_generator = [&provider, &failed](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> pplx::task<azure::storage::result_segment<int>>
+        {
+            return pplx::create_task([&provider, &failed, token, max_results_per_segment]()
+            {
+                // The request for the fourth segment is issued ahead of time and fails once
+                if (token.next_marker() == _XPLATSTR("600") && !failed.exchange(true))
+                {
+                    throw std::runtime_error("result_iterator prefetched segment error");
+                }
+
+                return provider.get_next_segment(token, max_results_per_segment);
+            });
+        };
+
+        azure::storage::result_iterator<int> end_of_results;
+        azure::storage::result_iterator<int> iter(async_generator, 0, 0, 2);
+
+        int count = 0;
+        try
+        {
+            for (; iter != end_of_results; ++iter)
+            {
+                count++;
+                CHECK(*iter == (int)count);
+            }
+        }
+        catch (std::runtime_error&)
+        {
+        }
+
+        CHECK(failed);
+        CHECK_EQUAL(600, count);
+
+        // retry to continue. the failed request and everything chained to it are requested again
+        ++iter;
+        for (; iter != end_of_results; ++iter)
+        {
+            count++;
+            CHECK(*iter == (int)count);
+        }
+
+        CHECK_EQUAL(1000, count);
+    }
+
+    TEST_FIXTURE(test_base, result_iterator_prefetch_copies)
+    {
+        // Each segment is derived from the continuation token alone, so copies of an iterator can request the same segment independently
+        auto async_generator = [](const azure::storage::continuation_token &token, size_t) -> pplx::task<azure::storage::result_segment<int>>
+        {
+            return pplx::create_task([token]()
+            {
+                int start = token.empty() ? 0 : std::stoi(utility::conversions::to_utf8string(token.next_marker()));
+                std::vector<int> results;
+                for (int i = start + 1; i <= start + 100 && i <= 1000; ++i)
+                {
+                    results.push_back(i);
+                }
+
+                int next = start + (int)results.size();
+                return azure::storage::result_segment<int>(results, next < 1000 ? azure::storage::continuation_token(azure::storage::core::convert_to_string(next)) : azure::storage::continuation_token());
+            });
+        };
+
+        azure::storage::result_iterator<int> end_of_results;
+        azure::storage::result_iterator<int> iter(async_generator, 0, 0, 3);
+        for (int i = 0; i < 50; ++i)
+        {
+            ++iter;
+        }
+
+        // Both iterators share the requests queued so far and must each see the complete results
+        azure::storage::result_iterator<int> copy = iter;
+        int count = 50;
+        for (; iter != end_of_results; ++iter)
+        {
+            count++;
+            CHECK(*iter == count);
+        }
+        CHECK_EQUAL(1000, count);
+
+        count = 50;
+        for (; copy != end_of_results; ++copy)
+        {
+            count++;
+            CHECK(*copy == count);
+        }
+        CHECK_EQUAL(1000, count);
+    }
+
+    TEST_FIXTURE(test_base, result_iterator_enumerate_segments_async)
+    {
+        size_t test_data[][4] = {
+                /*{total_results, segment_size, max_results, num_of_results_returned}*/
+                { 0, 100, 0, 0 },           // empty result
+                { 1, 100, 0, 1 },           // one result
+                { 3201, 100, 0, 3201 },     // many segments
+                { 3201, 100, 250, 250 },    // max_results within a later segment
+                { 250, 100, 500, 250 },     // max_results > total_results
+        };
+
+        size_t prefetch_depths[] = { 0, 1, 4 };
+
+        for (auto& data : test_data)
+        {
+            for (auto prefetch_depth : prefetch_depths)
+            {
+                // Prefetched requests may still be running after the enumeration stops, so they share ownership of the provider.
+                auto provider = std::make_shared<test_result_provider>(data[0], data[1], true);
+                size_t segment_size = data[1];
+                auto async_generator = [provider, segment_size](const azure::storage::continuation_token &token, size_t max_results_per_segment) -> pplx::task<azure::storage::result_segment<int>>
+                {
+                    // The service caps each segment, whatever number of remaining results is asked for
+                    max_results_per_segment = std::min(max_results_per_segment, segment_size);
+                    return pplx::create_task([provider, token, max_results_per_segment]()
+                    {
+                        return provider->get_next_segment(token, max_results_per_segment);
+                    });
+                };
+
+                int count = 0;
+                azure::storage::core::enumerate_segments_async<int>(async_generator, data[2], prefetch_depth, [&count](const int& item)
+                {
+                    count++;
+                    CHECK(item == count);
+                }).wait();
+
+                CHECK_EQUAL(data[3], (size_t)count);
+            }
+        }
+
+        auto failing_generator = [](const azure::storage::continuation_token &token, size_t) -> pplx::task<azure::storage::result_segment<int>>
+        {
+            if (!token.empty())
+            {
+                return pplx::task_from_exception<azure::storage::result_segment<int>>(std::runtime_error("enumerate_segments_async next segment error"));
+            }
+
+            return pplx::task_from_result(azure::storage::result_segment<int>(std::vector<int>(10, 1), azure::storage::continuation_token(_XPLATSTR("10"))));
+        };
+
+        int count = 0;
+        auto enumeration = azure::storage::core::enumerate_segments_async<int>(failing_generator, 0, 2, [&count](const int&)
+        {
+            count++;
+        });
+
+        CHECK_THROW(enumeration.wait(), std::runtime_error);
+        CHECK_EQUAL(10, count);
+    }
 }